@@ -10,6 +10,8 @@
 #cmakedefine HAVE_UNISTD_H 1
 #cmakedefine STDC_HEADERS 1
 #cmakedefine HAVE_GLOG_H 1
+#cmakedefine HAVE_LZ4_H 1
 
 #cmakedefine HAVE_NANOSLEEP 1
+#cmakedefine HAVE_CLOCK_GETTIME 1
 
@@ -0,0 +1,37 @@
+/*
+ Copyright (C) 2011 Kai Sterker <kai.sterker@gmail.com>
+ Part of the Adonthell Project http://adonthell.linuxgames.com
+
+ Adonthell is free software; you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation; either version 2 of the License, or
+ (at your option) any later version.
+
+ Adonthell is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with Adonthell; if not, write to the Free Software
+ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+/**
+ * @file   base/allow_threads.cc
+ * @author Kai Sterker <kai.sterker@gmail.com>
+ *
+ * @brief  Defines the allow_threads class.
+ *
+ *
+ */
+
+#include <cstddef>
+#include "allow_threads.h"
+
+namespace base
+{
+    // no interpreter installed by default
+    void* (*allow_threads::Release)() = NULL;
+    void (*allow_threads::Acquire)(void*) = NULL;
+}
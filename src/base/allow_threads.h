@@ -0,0 +1,92 @@
+/*
+ Copyright (C) 2011 Kai Sterker <kai.sterker@gmail.com>
+ Part of the Adonthell Project http://adonthell.linuxgames.com
+
+ Adonthell is free software; you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation; either version 2 of the License, or
+ (at your option) any later version.
+
+ Adonthell is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with Adonthell; if not, write to the Free Software
+ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+/**
+ * @file   base/allow_threads.h
+ * @author Kai Sterker <kai.sterker@gmail.com>
+ *
+ * @brief  Declares the allow_threads class.
+ *
+ *
+ */
+
+#ifndef BASE_ALLOW_THREADS_H
+#define BASE_ALLOW_THREADS_H
+
+namespace base
+{
+    /**
+     * Releases the lock of the embedded script interpreter for as
+     * long as it exists, so that scripts may keep running on other
+     * threads. This is meant for long running operations of modules
+     * that cannot depend on the %python module. Code in the scope of
+     * an allow_threads instance must not touch any %python objects.
+     *
+     * The interpreter installs the functions to release and acquire
+     * its lock with set_hooks. Until then, or if the calling thread
+     * does not hold the lock, allow_threads does nothing.
+     */
+    class allow_threads
+    {
+    public:
+        /**
+         * Release the interpreter lock, if held by the calling thread.
+         */
+        allow_threads () : State (Release ? Release () : 0)
+        {
+        }
+
+        /**
+         * Acquire the interpreter lock again, if it was released.
+         */
+        ~allow_threads ()
+        {
+            if (State) Acquire (State);
+        }
+
+#ifndef SWIG
+        /**
+         * Set the functions that release and acquire the interpreter
+         * lock. Pass NULL to remove them.
+         * @param release returns a handle for acquire, or NULL if
+         *      the lock was not released.
+         * @param acquire takes the handle returned by release.
+         */
+        static void set_hooks (void* (*release)(), void (*acquire)(void*))
+        {
+            Release = release;
+            Acquire = acquire;
+        }
+#endif
+
+    private:
+        /// forbid copy construction
+        allow_threads (const allow_threads & a);
+
+        /// handle returned when releasing the lock
+        void *State;
+
+        /// function releasing the interpreter lock
+        static void* (*Release)();
+        /// function acquiring the interpreter lock
+        static void (*Acquire)(void*);
+    };
+}
+
+#endif // BASE_ALLOW_THREADS_H
@@ -36,6 +36,7 @@ namespace base
         return Paths;
     }
     base::timer Timer;
+    base::frame_scheduler Scheduler;
     u_int8 Scale = 1;
 }
 
@@ -32,6 +32,7 @@
 #include "paths.h"
 #include "callback.h"
 #include "timer.h"
+#include "frame_scheduler.h"
 
 /**
  * This module provides the basic stuff needed by many other modules:
@@ -52,6 +53,9 @@ namespace base
     /// timer instance used by the engine
     extern base::timer Timer;
 
+    /// scheduler pacing the main loop
+    extern base::frame_scheduler Scheduler;
+
     /// scale factor used by the display
     extern u_int8 Scale;
 }
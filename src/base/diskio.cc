@@ -34,6 +34,7 @@
 #include "logging.h"
 #include "diskwriter_gz.h"
 #include "diskwriter_xml.h"
+#include "savegame_writer.h"
 
 using base::flat;
 using base::diskio;
@@ -41,6 +42,8 @@ using base::diskio;
 // ctor
 diskio::diskio (const diskio::file_format & format) : flat (256)
 {
+    Format = format;
+    
     switch (format)
     {
         case GZ_FILE:
@@ -61,6 +64,7 @@ diskio::diskio (const diskio::file_format & format) : flat (256)
         default:
         {
             Writer = NULL;
+            Format = BY_EXTENSION;
             LOG(ERROR) << "*** diskio: unknown format specified!";
             break;
         }
@@ -105,9 +109,18 @@ bool diskio::put_record (const std::string & filename)
         get_writer_for_extension (filename);
     }
     
-    if (Writer != NULL)
+    // while a game is being saved, only take a snapshot of the data
+    if (base::savegame_writer::capture (filename, Format, *this))
+    {
+        clear ();
+        return true;
+    }
+    
+    if (Writer != NULL && Writer->put_state (filename, *this))
     {
-        return Writer->put_state (filename, *this);
+        // make sure the file can be found in the search path
+        base::Paths().add_file (filename);
+        return true;
     }
     
     return false;
@@ -120,10 +133,12 @@ void diskio::get_writer_for_extension (const std::string & filename)
     if (filename.compare (filename.length() - 4, 4, ".xml"))
     {
         Writer = new base::disk_writer_gz ();
+        Format = GZ_FILE;
     }
     else
     {
         Writer = new base::disk_writer_xml ();
+        Format = XML_FILE;
     }
 }
 
@@ -144,9 +159,11 @@ void diskio::get_writer_for_filemagic (const std::string & filename)
     if (!memcmp (buffer, GZ_MAGIC, 2))
     {
         Writer = new base::disk_writer_gz ();
+        Format = GZ_FILE;
     }
     else
     {
         Writer = new base::disk_writer_xml ();
+        Format = XML_FILE;
     }
 }
@@ -109,6 +109,8 @@ namespace base {
 
             /// writer to use for i/o operations
             base::disk_writer_base *Writer;
+            /// format of the writer
+            file_format Format;
 #endif
     };
 }
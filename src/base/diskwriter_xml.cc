@@ -28,6 +28,7 @@
 
 #include <sstream>
 #include <vector>
+#include <sys/stat.h>
 #include <libxml/parser.h>
 
 #include "base.h"
@@ -86,22 +87,14 @@ struct data_sax_context
     data_sax_context (base::flat *record)
     {
         Type = flat::T_UNKNOWN;
-        Id = "Root";
         Record = record;
         State = disk_writer_xml::UNDEF;
-        Stack.push_back (this);
-    }
-    
-    /**
-     * delete parser context.
-     */
-    ~data_sax_context ()
-    {
-        Stack.pop_back ();
     }
     
     /// Storage for parameters
     base::flat *Record;
+    /// positions of the lists currently being read
+    std::vector<u_int32> Lists;
     /// id attribute of current element
     std::string Id;
     /// value of primitive element
@@ -110,29 +103,68 @@ struct data_sax_context
     flat::data_type Type;
     /// current state of sax parser
     u_int8 State;
-    /// stack of all contexts
-    static std::vector<data_sax_context*> Stack;
     /// checksum of file
-    static std::string Checksum;
+    std::string Checksum;
 };
 
-// context stack
-std::vector<data_sax_context*> data_sax_context::Stack;
-std::string data_sax_context::Checksum;
+/**
+ * Lookup table for converting ascii to binary. 
+ */
+static class hex_table
+{
+public:
+    /**
+     * Fill table, mapping everything but hex digits to 0xFF.
+     */
+    hex_table ()
+    {
+        memset (Value, 0xFF, sizeof (Value));
+        for (u_int8 i = 0; i < 16; i++)
+        {
+            Value[(u_int8) disk_writer_xml::Bin2Hex[i]] = i;
+            Value[(u_int8) tolower (disk_writer_xml::Bin2Hex[i])] = i;
+        }
+    }
+    
+    /// value of each character
+    u_int8 Value[256];
+} HexTable;
+
+// parse decimal digits, returning whether the whole string was consumed
+static bool parse_decimal (const char* value, u_int32 & result, bool & negative)
+{
+    // skip leading whitespace, just like strtol
+    while (isspace (*value)) value++;
+    
+    negative = (*value == '-');
+    if (negative || *value == '+') value++;
+    
+    result = 0;
+    while (*value >= '0' && *value <= '9')
+    {
+        u_int32 digit = *value++ - '0';
+        
+        // saturate, so the range checks of the caller still apply
+        if (result > (UINT32_MAX - digit) / 10) result = UINT32_MAX;
+        else result = result * 10 + digit;
+    }
+    
+    return *value == '\0';
+}
 
 // safely convert string to unsigned integer
 static u_int32 string_to_uint (const char* value, const u_int32 & max)
 {
-    char *end = NULL;
-    u_int32 intval = (u_int32) strtoul (value, &end, 10);
+    u_int32 intval;
+    bool negative;
     
     // parsing okay?
-    if (*end == '\0') 
+    if (parse_decimal (value, intval, negative) && !negative) 
     {
         // in range?
         if (intval > max)
         {
-            LOG(ERROR) << "*** string_to_uint: integer overflow: value '" << intval << "' > max '" << max << "'!";
+            LOG(ERROR) << "*** string_to_uint: integer overflow: value '" << value << "' > max '" << max << "'!";
             return max;
         }
     }
@@ -149,22 +181,22 @@ static u_int32 string_to_uint (const char* value, const u_int32 & max)
 // safely convert string to signed integer
 static s_int32 string_to_sint (const char* value, const s_int32 & min, const s_int32 & max)
 {
-    char *end = NULL;
-    s_int32 intval = (s_int32) strtol (value, &end, 10);
+    u_int32 intval;
+    bool negative;
     
     // parsing okay?
-    if (*end == '\0') 
+    if (parse_decimal (value, intval, negative)) 
     {
         // in range?
-        if (intval < min)
+        if (negative && intval > (u_int32) -(min + 1) + 1)
         {
-            LOG(ERROR) << "*** string_to_sint: integer underflow: value '" << intval << "' < min '" << min << "'!";
+            LOG(ERROR) << "*** string_to_sint: integer underflow: value '" << value << "' < min '" << min << "'!";
             return min;
         }
         
-        if (intval > max)
+        if (!negative && intval > (u_int32) max)
         {
-            LOG(ERROR) << "*** string_to_sint: integer overflow: value '" << intval << "' > max '" << max << "'!";
+            LOG(ERROR) << "*** string_to_sint: integer overflow: value '" << value << "' > max '" << max << "'!";
             return max;
         }
     }
@@ -175,11 +207,11 @@ static s_int32 string_to_sint (const char* value, const s_int32 & min, const s_i
         return -1;
     }    
     
-    return intval;
+    return negative && intval != 0 ? -(s_int32) (intval - 1) - 1 : (s_int32) intval;
 }
 
 // convert primitive params
-static void param_to_value (const data_sax_context *context)
+static void param_to_value (data_sax_context *context)
 {
     const char *value = context->Value.c_str();
     
@@ -187,21 +219,27 @@ static void param_to_value (const data_sax_context *context)
     {
         case flat::T_BLOB:
         {
-            u_int32 j = 0;
             u_int32 size = context->Value.size()/2;
-            u_int8 *bin = new u_int8[size];
             
-            while (*value != '\0')
+            // decode in place, as the hex string is no longer needed 
+            u_int8 *bin = (u_int8*) &context->Value[0];
+            const u_int8 *hex = (const u_int8*) value;
+            
+            for (u_int32 j = 0; j < size; j++, hex += 2)
             {
-                bin[j] = (strchr(disk_writer_xml::Bin2Hex, *value) - disk_writer_xml::Bin2Hex) << 4;
-                bin[j] |= strchr(disk_writer_xml::Bin2Hex, *(value+1)) - disk_writer_xml::Bin2Hex;
-
-                value += 2;
-                j++;
+                u_int8 hi = HexTable.Value[hex[0]];
+                u_int8 lo = HexTable.Value[hex[1]];
+                if ((hi | lo) > 0x0F)
+                {
+                    LOG(ERROR) << "*** param_to_value: invalid character in blob '" << context->Id << "'!";
+                    hi &= 0x0F;
+                    lo &= 0x0F;
+                }
+                
+                bin[j] = (hi << 4) | lo;
             }
 
             context->Record->put_block (context->Id, bin, size);
-            delete[] bin;
             break;
         }
         case flat::T_BOOL:
@@ -267,6 +305,22 @@ static void param_to_value (const data_sax_context *context)
     }
 }
 
+// get type of element without creating temporary strings
+static flat::data_type type_for_element (const char *name)
+{
+    for (int i = 0; i < flat::NBR_TYPES; i++)
+    {
+        const char *type_name = flat::name_for_type ((flat::data_type) i);
+        if (type_name[0] == name[0] && strcmp (type_name, name) == 0)
+        {
+            return (flat::data_type) i;
+        }
+    }
+    
+    LOG(ERROR) << "unknown type '" << name << "' encountered!";
+    return flat::T_UNKNOWN;
+}
+
 /**
  * Called when an xml entity such as &amp; is encountered.
  * @param ctx the parser context
@@ -281,11 +335,19 @@ static xmlEntityPtr data_get_entity(void *ctx, const xmlChar *name)
  * Called when an opening tag has been processed.
  * @param ctx the parser context
  * @param name The element name
- * @param atts Element attributes
+ * @param prefix Element namespace prefix (unused)
+ * @param URI Element namespace URI (unused)
+ * @param nb_namespaces Number of namespace definitions (unused)
+ * @param namespaces Namespace definitions (unused)
+ * @param nb_attributes Number of attributes
+ * @param nb_defaulted Number of defaulted attributes (unused)
+ * @param atts Element attributes, five pointers per attribute
  */
-static void data_start_element (void *ctx, const xmlChar *name, const xmlChar **atts)
+static void data_start_element (void *ctx, const xmlChar *name, const xmlChar *prefix, 
+    const xmlChar *URI, int nb_namespaces, const xmlChar **namespaces,
+    int nb_attributes, int nb_defaulted, const xmlChar **atts)
 {
-    data_sax_context *context = data_sax_context::Stack.back ();
+    data_sax_context *context = (data_sax_context*) ctx;
 
     switch (context->State)
     {
@@ -298,17 +360,14 @@ static void data_start_element (void *ctx, const xmlChar *name, const xmlChar **
                 context->State = disk_writer_xml::DATA;
                 
        	       	// get attribute "cs", if present
-		    	if (atts != NULL) 
-		    	{
-		    		for (u_int32 i = 0; atts[i] != NULL; i += 2) 
-		    		{
-						if (atts[i][0] == 'c' && atts[i][1] == 's')
-						{
-							context->Checksum = (char*) atts[i+1];
-							break;
-						}		
-					}
-		    	}
+	    		for (int i = 0; i < nb_attributes * 5; i += 5) 
+	    		{
+					if (atts[i][0] == 'c' && atts[i][1] == 's')
+					{
+						context->Checksum.assign ((char*) atts[i+3], atts[i+4] - atts[i+3]);
+						break;
+					}		
+				}
             }
             else
             {
@@ -321,24 +380,21 @@ static void data_start_element (void *ctx, const xmlChar *name, const xmlChar **
         case disk_writer_xml::LIST:
         {
         	// get type of element
-        	flat::data_type type = flat::type_for_name ((char*) name);
+        	flat::data_type type = type_for_element ((char*) name);
 
             // reset id
-            context->Id = "";
+            context->Id.clear ();
             
         	// get attribute "id", if present
-        	if (atts != NULL) 
-        	{
-        		for (u_int32 i = 0; atts[i] != NULL; i += 2) 
-        		{
-					if (atts[i][0] == 'i' && atts[i][1] == 'd')
-					{
-						// store checksum in the Id field
-						context->Id = (char*) atts[i+1];
-						break;
-					}		
-				}
-        	}
+       		for (int i = 0; i < nb_attributes * 5; i += 5) 
+       		{
+				if (atts[i][0] == 'i' && atts[i][1] == 'd')
+				{
+                    // attribute values are not zero-terminated
+					context->Id.assign ((char*) atts[i+3], atts[i+4] - atts[i+3]);
+					break;
+				}		
+			}
         	
 			// set type of parameter
           	context->Type = type;
@@ -354,18 +410,15 @@ static void data_start_element (void *ctx, const xmlChar *name, const xmlChar **
         		// list type
         		case flat::T_FLAT:
         		{
-        			base::flat *record = new base::flat(16);
-        			
-        			// create child context for sublist
-        			context = new data_sax_context (record);
+                    // list is built in place inside its parent
+                    context->Lists.push_back (context->Record->begin_flat (context->Id));
 	            	context->State = disk_writer_xml::LIST;
-                    
                     break;
         		}
         		// primitive type
         		default:
         		{
-                    context->Value = "";
+                    context->Value.clear ();
 	            	context->State = disk_writer_xml::PARAM;
         			break;
         		}
@@ -386,10 +439,12 @@ static void data_start_element (void *ctx, const xmlChar *name, const xmlChar **
  * Called when the end of an element has been detected.
  * @param ctx the parser context
  * @param name the element name
+ * @param prefix the element namespace prefix (unused)
+ * @param URI the element namespace URI (unused)
  */
-static void data_end_element (void *ctx, const xmlChar *name)
+static void data_end_element (void *ctx, const xmlChar *name, const xmlChar *prefix, const xmlChar *URI)
 {
-    data_sax_context *context = data_sax_context::Stack.back ();
+    data_sax_context *context = (data_sax_context*) ctx;
     
     switch (context->State)
     {
@@ -405,18 +460,11 @@ static void data_end_element (void *ctx, const xmlChar *name)
         case disk_writer_xml::LIST:
         {
             // this could also be </Data>, in which case we do nothing
-            if (strcmp ((char*) name, XML_ROOT_NODE) != 0)
+            if (!context->Lists.empty ())
             {
-                // get parent context
-                std::vector<data_sax_context*>::reverse_iterator end = data_sax_context::Stack.rbegin();
-                data_sax_context *parent = *(++end);
-                
-                // add completed list to parent list
-                parent->Record->put_flat (parent->Id, *(context->Record));
-                
-                // cleanup
-                delete context->Record;
-                delete context;
+                // list is complete, so its size is known now
+                context->Record->end_flat (context->Lists.back ());
+                context->Lists.pop_back ();
             }
             break;
         }
@@ -443,14 +491,14 @@ static void data_end_element (void *ctx, const xmlChar *name)
  */
 static void data_read_characters (void *ctx, const xmlChar *content, int len)
 {
-    data_sax_context *context = data_sax_context::Stack.back ();
+    data_sax_context *context = (data_sax_context*) ctx;
 
     // only read characters if we're inside a primitive type
     if (context->State == disk_writer_xml::PARAM)
     {
         // store value first and assign when closing element, as
         // 'data_read_characters' is not called for empty elements.
-        context->Value += std::string ((char*) content, len);
+        context->Value.append ((char*) content, len);
     }
 }
 
@@ -490,8 +538,8 @@ xmlSAXHandler data_sax_handler = {
     NULL, /* setDocumentLocator */
     NULL, /* startDocument */
     NULL, /* endDocument */
-    data_start_element,
-    data_end_element,
+    NULL, /* startElement */
+    NULL, /* endElement */
     NULL, /* reference */
     data_read_characters,
     NULL, /* ignorableWhitespace */
@@ -505,8 +553,8 @@ xmlSAXHandler data_sax_handler = {
     NULL, /* externalSubset; */
     XML_SAX2_MAGIC,
     NULL,
-    NULL, /* startElementNsDebug */
-    NULL, /* endElementNsDebug */
+    data_start_element,
+    data_end_element,
     NULL
 };
 
@@ -543,6 +591,14 @@ bool disk_writer_xml::get_state (const std::string & name, base::flat & data) co
     // clear contents of data
     data.clear ();
     
+    // the binary record is smaller than its (uncompressed) xml representation,
+    // so reserving that much avoids growing the record while parsing
+    struct stat statbuf;
+    if (stat (name.c_str (), &statbuf) == 0)
+    {
+        data.reserve (statbuf.st_size);
+    }
+    
 	// prepare context
     data_sax_context ctx (&data);
     
@@ -592,8 +648,8 @@ void disk_writer_xml::record_to_xml (base::flat &record, xmlNodePtr parent) cons
     	if (type != flat::T_FLAT)
     	{
     		// convert primitive value to xml char string
-    		const xmlChar* str_val = value_to_xmlChar (type, value, size);
-    		node = xmlNewTextChild (parent, NULL, (const xmlChar *) str_type, str_val);
+    		const std::string str_val = value_to_string (type, value, size);
+    		node = xmlNewTextChild (parent, NULL, (const xmlChar *) str_type, (const xmlChar *) str_val.c_str ());
     	}
     	else
     	{
@@ -611,10 +667,9 @@ void disk_writer_xml::record_to_xml (base::flat &record, xmlNodePtr parent) cons
     }
 }
 
-// convert value to xml character
-xmlChar *disk_writer_xml::value_to_xmlChar (const flat::data_type & type, void *value, const u_int32 & size) const
+// convert value to xml character string
+std::string disk_writer_xml::value_to_string (const flat::data_type & type, void *value, const u_int32 & size) const
 {
-    static std::string retval;
 	std::ostringstream tmp;
     
     switch (type)
@@ -704,11 +759,10 @@ xmlChar *disk_writer_xml::value_to_xmlChar (const flat::data_type & type, void *
 		// we should never get there
 		default:
 		{
-			LOG(ERROR) << "*** diskwriter_xml::value_to_xmlChar: cannot convert '" << flat::name_for_type (type) << "'.";
+			LOG(ERROR) << "*** diskwriter_xml::value_to_string: cannot convert '" << flat::name_for_type (type) << "'.";
 			break;
 		}
 	}
     
-    retval = tmp.str();
-    return (xmlChar*) retval.c_str();
+    return tmp.str();
 }
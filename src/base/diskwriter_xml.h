@@ -80,13 +80,15 @@ namespace base {
         void record_to_xml (base::flat &record, xmlNodePtr parent) const;
         
         /**
-         * Convert the given value to an xml character string.
+         * Convert the given value to an xml character string. As
+         * records may be saved on a background thread, this must
+         * not use any static storage.
          * @param type data type of given value.
          * @param value data to convert.
          * @param size length of data.
          * @return string representation of given value.
          */ 
-        xmlChar *value_to_xmlChar (const flat::data_type & type, void *value, const u_int32 & size) const;
+        std::string value_to_string (const flat::data_type & type, void *value, const u_int32 & size) const;
 #endif
     };
 }
@@ -27,6 +27,7 @@
  */
 
 #include <cstdio>
+#include <algorithm>
 #include "flat.h"
 #include "endians.h"
 #include "logging.h"
@@ -101,7 +102,7 @@ void flat::put (const string & name, const data_type & type, const u_int32 & siz
 	u_int8 t = type;
     u_int32 nl = name.length () + 1;
     u_int32 need = size + nl + 5;
-    while (Size + need > Capacity) grow ();
+    if (Size + need > Capacity) grow (Size + need);
     
     memcpy (Ptr, name.c_str (), nl);
     Ptr += nl;
@@ -114,6 +115,29 @@ void flat::put (const string & name, const data_type & type, const u_int32 & siz
     Size += need;
 }
 
+// start a nested flat in place
+u_int32 flat::begin_flat (const string & name)
+{
+    char byte_order = DATA_BYTE_ORDER;
+    
+    // the nested flat's size is not yet known 
+    put (name, T_FLAT, 1, &byte_order);
+    return Size - 5;
+}
+
+// finish a nested flat started in place
+void flat::end_flat (const u_int32 & pos)
+{
+    u_int32 size = Size - pos - 4;
+    memcpy (Buffer + pos, &size, 4);
+}
+
+// reserve space for given number of bytes
+void flat::reserve (const u_int32 & size)
+{
+    if (Size + size > Capacity) grow (Size + size);
+}
+
 // retrieve given data
 flat::data* flat::get (const string & name, const data_type & type, const bool & optional)
 {
@@ -276,9 +300,9 @@ u_int32 flat::checksum () const
 }
 
 // grow internal buffer
-void flat::grow ()
+void flat::grow (const u_int32 & need)
 {
-    Capacity *= 2;
+    Capacity = std::max (Capacity * 2, need);
     char *tmp = new char[Capacity];
     
     if (tmp == NULL) {
@@ -313,6 +313,25 @@ namespace base
             void put_flat (const string & name, const flat & out) {
                 put (name, T_FLAT, out.size (), out.getBuffer ());
             }
+            
+#ifndef SWIG
+            /**
+             * Start storing a nested %flat in place. Data added until the
+             * matching call to end_flat() will become part of the nested
+             * %flat. This saves building the nested %flat separately and 
+             * copying it with put_flat() afterwards. Nested flats started
+             * this way may be nested themselves.
+             * @param name id used to retrieve the value later on.
+             * @return position of the nested %flat, to pass to end_flat().
+             */
+            u_int32 begin_flat (const string & name);
+            
+            /**
+             * Finish storing a nested %flat started with begin_flat().
+             * @param pos the value returned by the matching begin_flat().
+             */
+            void end_flat (const u_int32 & pos);
+#endif // SWIG
             //@}
             
             /**
@@ -620,6 +639,14 @@ namespace base
             void copy (const flat & source);
 	        //@}
             
+            /**
+             * Make sure the internal buffer can hold the given number of 
+             * additional bytes without having to grow. Useful when the
+             * final size of the data is known in advance.
+             * @param size number of bytes that will be added.
+             */
+            void reserve (const u_int32 & size);
+            
         private:
             /// Pointer to unflattened data. Valid after first call to parse().
             data *Data;
@@ -655,9 +682,11 @@ namespace base
             void parse ();
             
             /**
-             * Grow the internal buffer. This will double its current capacity.
+             * Grow the internal buffer. This will at least double its current 
+             * capacity.
+             * @param need minimum number of bytes required.
              */
-            void grow ();
+            void grow (const u_int32 & need);
             
             /// Buffer storing the flattened objects
             char *Buffer;
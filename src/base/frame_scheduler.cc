@@ -0,0 +1,214 @@
+/*
+ Copyright (C) 2011 Kai Sterker <kai.sterker@gmail.com>
+ Part of the Adonthell Project http://adonthell.linuxgames.com
+
+ Adonthell is free software; you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation; either version 2 of the License, or
+ (at your option) any later version.
+
+ Adonthell is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with Adonthell; if not, write to the Free Software
+ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+/**
+ * @file   base/frame_scheduler.cc
+ * @author Kai Sterker <kai.sterker@gmail.com>
+ *
+ * @brief  Defines the frame_scheduler class.
+ *
+ *
+ */
+
+#include <cstring>
+#include <thread>
+
+#include "frame_scheduler.h"
+#include "profiler.h"
+#include "configuration.h"
+#include "savegame.h"
+#include "base.h"
+
+/// default number of simulation steps per second
+#define DEFAULT_UPDATE_RATE 40
+/// default number of frames per second
+#define DEFAULT_FRAME_RATE 60
+/// default number of steps to catch up per frame
+#define DEFAULT_MAX_STEPS 5
+/// default time to busy wait at the end of a frame, in microseconds
+#define DEFAULT_SPIN_TIME 2000
+
+namespace base
+{
+    // ctor
+    frame_scheduler::frame_scheduler ()
+    {
+        UpdateRate = DEFAULT_UPDATE_RATE;
+        StepLength = 1000000000 / UpdateRate;
+        FrameRate = DEFAULT_FRAME_RATE;
+        MaxSteps = DEFAULT_MAX_STEPS;
+        SpinTime = (u_int64) DEFAULT_SPIN_TIME * 1000;
+        Interpolate = true;
+        Active = false;
+        Accumulator = 0;
+        FrameStart = 0;
+
+        reset_stats ();
+    }
+
+    // read settings from config file
+    void frame_scheduler::setup (base::configuration & cfg)
+    {
+        set_update_rate (cfg.get_int ("General", "UpdateRate", DEFAULT_UPDATE_RATE));
+        set_frame_rate (cfg.get_int ("Video", "FrameRate", DEFAULT_FRAME_RATE));
+        set_interpolation (cfg.get_int ("Video", "Interpolate", 1) == 1);
+        cfg.option ("Video", "Interpolate", base::cfg_option::BOOL);
+    }
+
+    // set number of steps per second
+    void frame_scheduler::set_update_rate (const u_int32 & hz)
+    {
+        UpdateRate = hz ? hz : DEFAULT_UPDATE_RATE;
+        StepLength = 1000000000 / UpdateRate;
+
+        // keep game cycles in sync with simulation steps
+        Timer.set_slice (1000 / UpdateRate);
+    }
+
+    // set number of frames per second
+    void frame_scheduler::set_frame_rate (const u_int32 & fps)
+    {
+        FrameRate = fps;
+    }
+
+    // start new frame
+    void frame_scheduler::begin_frame ()
+    {
+        // notify about games saved in the background
+        savegame::update ();
+
+        u_int64 now = timer::monotonic_time ();
+
+        if (Active)
+        {
+            u_int64 elapsed = now - FrameStart;
+
+            u_int32 ms = elapsed / 1000000;
+            Histogram[ms < FRAME_HISTOGRAM_SIZE ? ms : FRAME_HISTOGRAM_SIZE - 1]++;
+            Frames++;
+
+            Accumulator += elapsed;
+        }
+        else
+        {
+            Active = true;
+            Accumulator = StepLength;
+        }
+
+        // rather slow down than trying to catch up forever
+        if (Accumulator > MaxSteps * StepLength)
+        {
+            StepsDropped += Accumulator / StepLength - MaxSteps;
+            Accumulator = MaxSteps * StepLength;
+        }
+
+        FrameStart = now;
+        profiler::next_frame ();
+
+        // each step is a single game cycle
+        Timer.synch ();
+    }
+
+    // check if simulation needs to advance
+    bool frame_scheduler::step ()
+    {
+        if (Accumulator < StepLength) return false;
+
+        Accumulator -= StepLength;
+        return true;
+    }
+
+    // progress towards next step
+    float frame_scheduler::alpha () const
+    {
+        if (!Active || !Interpolate) return 1.0f;
+        return (float) Accumulator / StepLength;
+    }
+
+    // wait for start of next frame
+    void frame_scheduler::end_frame ()
+    {
+        u_int64 deadline = FrameStart + frame_length ();
+        u_int64 now = timer::monotonic_time ();
+
+        while (now < deadline)
+        {
+            u_int64 remaining = deadline - now;
+
+            // sleep is not precise, so only sleep while far from the deadline ...
+            if (remaining > SpinTime + 1000000)
+            {
+                timer::sleep ((remaining - SpinTime) / 1000000);
+            }
+            // ... and busy wait for the rest
+            else
+            {
+                std::this_thread::yield ();
+            }
+
+            now = timer::monotonic_time ();
+        }
+    }
+
+    // restart from current time
+    void frame_scheduler::synch ()
+    {
+        Active = false;
+        Timer.synch ();
+    }
+
+    // number of frames with given duration
+    u_int32 frame_scheduler::histogram (const u_int32 & ms) const
+    {
+        return ms < FRAME_HISTOGRAM_SIZE ? Histogram[ms] : 0;
+    }
+
+    // frame time not exceeded by given share of frames
+    u_int32 frame_scheduler::percentile (const float & p) const
+    {
+        u_int32 limit = (u_int32) (p * Frames);
+        u_int32 count = 0;
+
+        for (u_int32 ms = 0; ms < FRAME_HISTOGRAM_SIZE; ms++)
+        {
+            count += Histogram[ms];
+            if (count >= limit && count > 0) return ms;
+        }
+
+        return 0;
+    }
+
+    // clear statistics
+    void frame_scheduler::reset_stats ()
+    {
+        Frames = 0;
+        StepsDropped = 0;
+        memset (Histogram, 0, sizeof (Histogram));
+    }
+
+    // time between start of two frames
+    u_int64 frame_scheduler::frame_length () const
+    {
+        u_int64 length = FrameRate ? 1000000000 / FrameRate : 0;
+
+        // without interpolation, frames between steps would look the same
+        if (!Interpolate && length < StepLength) return StepLength;
+        return length;
+    }
+}
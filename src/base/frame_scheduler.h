@@ -0,0 +1,256 @@
+/*
+ Copyright (C) 2011 Kai Sterker <kai.sterker@gmail.com>
+ Part of the Adonthell Project http://adonthell.linuxgames.com
+
+ Adonthell is free software; you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation; either version 2 of the License, or
+ (at your option) any later version.
+
+ Adonthell is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with Adonthell; if not, write to the Free Software
+ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+/**
+ * @file   base/frame_scheduler.h
+ * @author Kai Sterker <kai.sterker@gmail.com>
+ *
+ * @brief  Declares the frame_scheduler class.
+ *
+ *
+ */
+
+#ifndef BASE_FRAME_SCHEDULER_H
+#define BASE_FRAME_SCHEDULER_H
+
+#include "types.h"
+
+/// number of 1 ms buckets of the frame time histogram
+#define FRAME_HISTOGRAM_SIZE 100
+
+namespace base
+{
+    class configuration;
+
+    /**
+     * Paces the main loop of the game. The simulation advances in
+     * steps of fixed length, while frames are rendered at their own
+     * rate. When rendering is faster than the simulation, objects
+     * can be drawn in between their last two positions, as given
+     * by alpha().
+     *
+     * A main loop using the scheduler looks like this:
+     * @code
+     * base::Scheduler.synch ();
+     * while (running)
+     * {
+     *     base::Scheduler.begin_frame ();
+     *     while (base::Scheduler.step ())
+     *     {
+     *         // update game state
+     *     }
+     *     // render frame
+     *     base::Scheduler.end_frame ();
+     * }
+     * @endcode
+     *
+     * For that purpose, a global scheduler instance exists that
+     * should be used: base::Scheduler.
+     */
+    class frame_scheduler
+    {
+    public:
+        /**
+         * Create a scheduler running 40 steps and 60 frames per second.
+         */
+        frame_scheduler ();
+
+        /**
+         * Read the scheduler settings from the engine configuration.
+         * @param cfg the engine configuration.
+         */
+        void setup (base::configuration & cfg);
+
+        /**
+         * @name Configuration
+         */
+        //@{
+        /**
+         * Set the number of simulation steps per second. This also
+         * updates the length of a game cycle of base::Timer.
+         * @param hz number of steps per second.
+         */
+        void set_update_rate (const u_int32 & hz);
+
+        /**
+         * Get the number of simulation steps per second.
+         * @return number of steps per second.
+         */
+        u_int32 update_rate () const { return UpdateRate; }
+
+        /**
+         * Set the number of frames to render per second.
+         * @param fps frames per second, or 0 to render as fast as possible.
+         */
+        void set_frame_rate (const u_int32 & fps);
+
+        /**
+         * Get the number of frames to render per second.
+         * @return frames per second, or 0 if unlimited.
+         */
+        u_int32 frame_rate () const { return FrameRate; }
+
+        /**
+         * Set the number of steps the simulation may take in a single
+         * frame to catch up with real time. Time beyond that is dropped,
+         * so the game slows down instead of getting stuck.
+         * @param steps maximum number of steps per frame.
+         */
+        void set_max_steps (const u_int32 & steps) { MaxSteps = steps ? steps : 1; }
+
+        /**
+         * Set the time before the end of a frame during which the
+         * scheduler stops sleeping and busy waits instead. Larger
+         * values give more accurate pacing at the cost of CPU time.
+         * @param usecs time to busy wait in microseconds.
+         */
+        void set_spin_time (const u_int32 & usecs) { SpinTime = (u_int64) usecs * 1000; }
+
+        /**
+         * Set whether objects are drawn in between simulation steps.
+         * Without interpolation, no more frames than steps are rendered.
+         * @param interpolate \b true to interpolate positions.
+         */
+        void set_interpolation (const bool & interpolate) { Interpolate = interpolate; }
+
+        /**
+         * Get whether objects are drawn in between simulation steps.
+         * @return \b true if positions are interpolated.
+         */
+        bool interpolation () const { return Interpolate; }
+        //@}
+
+        /**
+         * @name Main loop
+         */
+        //@{
+        /**
+         * Start a new frame. Adds the time passed since the start
+         * of the previous frame to the time the simulation has to
+         * catch up with. Also completes games that have been saved
+         * in the background by now.
+         */
+        void begin_frame ();
+
+        /**
+         * Check whether the simulation needs to advance another step
+         * during the current frame.
+         * @return \b true if another step is due, \b false otherwise.
+         */
+        bool step ();
+
+        /**
+         * Get how far real time has advanced towards the next step,
+         * for drawing objects between their previous and current position.
+         * @return value between 0 (previous position) and 1 (current position).
+         */
+        float alpha () const;
+
+        /**
+         * Finish the current frame. Waits until it is time to start
+         * the next one, first by sleeping, then by busy waiting.
+         */
+        void end_frame ();
+
+        /**
+         * Synchronize the scheduler with the current time. This should
+         * be used after lengthy operations that interrupt the main loop,
+         * so that the simulation will not try to catch up.
+         */
+        void synch ();
+        //@}
+
+        /**
+         * @name Statistics
+         */
+        //@{
+        /**
+         * Get number of frames since statistics were last reset.
+         * @return number of frames.
+         */
+        u_int32 frames () const { return Frames; }
+
+        /**
+         * Get number of steps dropped because the simulation could
+         * not keep up with real time.
+         * @return number of steps dropped.
+         */
+        u_int32 steps_dropped () const { return StepsDropped; }
+
+        /**
+         * Get number of frames that took the given time. The last
+         * bucket counts all frames of FRAME_HISTOGRAM_SIZE - 1 ms
+         * and above.
+         * @param ms frame time in milliseconds.
+         * @return number of frames that took that long.
+         */
+        u_int32 histogram (const u_int32 & ms) const;
+
+        /**
+         * Get frame time that the given share of frames did not exceed.
+         * @param p the share of frames, between 0.0 and 1.0.
+         * @return frame time in milliseconds.
+         */
+        u_int32 percentile (const float & p) const;
+
+        /**
+         * Clear the frame time histogram and counters.
+         */
+        void reset_stats ();
+        //@}
+
+    private:
+        /// forbid copy construction
+        frame_scheduler (const frame_scheduler & s);
+
+        /**
+         * Get the time between the start of two frames.
+         * @return length of a frame in nanoseconds.
+         */
+        u_int64 frame_length () const;
+
+        /// number of simulation steps per second
+        u_int32 UpdateRate;
+        /// number of frames per second, 0 if unlimited
+        u_int32 FrameRate;
+        /// length of a step in nanoseconds
+        u_int64 StepLength;
+        /// time the simulation lags behind real time, in nanoseconds
+        u_int64 Accumulator;
+        /// time the current frame started, in nanoseconds
+        u_int64 FrameStart;
+        /// time before end of frame to busy wait, in nanoseconds
+        u_int64 SpinTime;
+        /// maximum number of steps per frame
+        u_int32 MaxSteps;
+        /// whether to draw objects between steps
+        bool Interpolate;
+        /// whether the main loop is paced by the scheduler
+        bool Active;
+
+        /// number of frames measured
+        u_int32 Frames;
+        /// number of steps dropped
+        u_int32 StepsDropped;
+        /// number of frames per 1 ms of frame time
+        u_int32 Histogram[FRAME_HISTOGRAM_SIZE];
+    };
+}
+
+#endif // BASE_FRAME_SCHEDULER_H
@@ -139,6 +139,12 @@ bool paths::init (const std::string & game, const std::string & userdatadir)
             IncludeUserDir = true;
         }
     }
+    
+    UserDataIndex.clear ();
+    if (IncludeUserDir)
+    {
+        index_directory (UserDataDir, "", UserDataIndex);
+    }
 
     // builtin data directory
     GameDataDir = DATA_DIR;
@@ -147,17 +153,28 @@ bool paths::init (const std::string & game, const std::string & userdatadir)
     LOG(INFO) << "GameDataDir: '" << GameDataDir << "'";
 
     // make sure game data dir exists
-    return exists (GameDataDir) || IncludeUserDir || Game.empty();
+    GameDataIndex.clear ();
+    if (exists (GameDataDir))
+    {
+        index_directory (GameDataDir, "", GameDataIndex);
+        return true;
+    }
+    
+    return IncludeUserDir || Game.empty();
 }
 
 // set path to saved game (before loading the game from that directory)
 void paths::set_save_dir (const std::string & dir)
 {
+    SaveDataIndex.clear ();
+    
     if (dir != "" && exists (dir))
     {
         SaveDataDir = dir;
         if (SaveDataDir[SaveDataDir.size () - 1] != '/') SaveDataDir += "/";
         IncludeSaveDir = true;
+        
+        index_directory (SaveDataDir, "", SaveDataIndex);
     }
     else
     {
@@ -166,6 +183,19 @@ void paths::set_save_dir (const std::string & dir)
     }
 }
 
+// add newly written file to index
+void paths::add_file (const std::string & path)
+{
+    if (IncludeSaveDir && path.compare (0, SaveDataDir.length (), SaveDataDir) == 0)
+    {
+        SaveDataIndex.insert (path.substr (SaveDataDir.length ()));
+    }
+    else if (IncludeUserDir && path.compare (0, UserDataDir.length (), UserDataDir) == 0)
+    {
+        UserDataIndex.insert (path.substr (UserDataDir.length ()));
+    }
+}
+
 // open the specified file
 bool paths::open (igzstream & file, const std::string & path) const
 {
@@ -180,17 +210,17 @@ bool paths::open (igzstream & file, const std::string & path) const
     if (file.is_open ()) file.close ();
     
     // otherwise try to prepend any of the build-in search paths
-    if (IncludeSaveDir && file.open (SaveDataDir + path)) 
+    if (IncludeSaveDir && in_dir (SaveDataDir, path, SaveDataIndex, false) && file.open (SaveDataDir + path)) 
     {
         VLOG(2) << "Found '" << path << "' in " << SaveDataDir;
         return true;
     }
-    if (IncludeUserDir && file.open (UserDataDir + path))
+    if (IncludeUserDir && in_dir (UserDataDir, path, UserDataIndex, false) && file.open (UserDataDir + path))
     {
         VLOG(2) << "Found '" << path << "' in " << UserDataDir;
         return true;
     }
-    if (file.open (GameDataDir + path))
+    if (in_dir (GameDataDir, path, GameDataIndex, true) && file.open (GameDataDir + path))
     {
         VLOG(2) << "Found '" << path << "' in " << GameDataDir;
         return true;
@@ -207,6 +237,18 @@ bool paths::open (igzstream & file, const std::string & path) const
 
 // find the given path in Adonthell's search paths
 bool paths::find_in_path (std::string & path, const bool & log_error) const
+{
+    return find (path, log_error, IncludeSaveDir);
+}
+
+// find the given path in Adonthell's search paths, except saved game
+bool paths::find_in_data_path (std::string & path, const bool & log_error) const
+{
+    return find (path, log_error, false);
+}
+
+// find the given path in the selected search paths
+bool paths::find (std::string & path, const bool & log_error, const bool & include_save_dir) const
 {
     struct stat statbuf;
     
@@ -217,19 +259,19 @@ bool paths::find_in_path (std::string & path, const bool & log_error) const
     }
 
     // try whether path exists in the search path
-    if (IncludeSaveDir && stat ((SaveDataDir + path).c_str (), &statbuf) != -1)
+    if (include_save_dir && in_dir (SaveDataDir, path, SaveDataIndex, false))
     {
         VLOG(2) << "Found '" << path << "' in " << SaveDataDir;
         path.insert (0, SaveDataDir);
         return true;
     }
-    if (IncludeUserDir && stat ((UserDataDir + path).c_str (), &statbuf) != -1)
+    if (IncludeUserDir && in_dir (UserDataDir, path, UserDataIndex, false))
     {
         VLOG(2) << "Found '" << path << "' in " << UserDataDir;
         path.insert (0, UserDataDir);
         return true;
     }
-    if (stat ((GameDataDir + path).c_str (), &statbuf) != -1)
+    if (in_dir (GameDataDir, path, GameDataIndex, true))
     {
         VLOG(2) << "Found '" << path << "' in " << GameDataDir;
         path.insert (0, GameDataDir);
@@ -246,7 +288,7 @@ bool paths::find_in_path (std::string & path, const bool & log_error) const
     {
         // print search paths on failure
         LOG(ERROR) << "*** paths::find_in_path: file '" << path << "' does not exist in search path:";
-        if (IncludeSaveDir) LOG(ERROR) << "  - " << SaveDataDir;
+        if (include_save_dir) LOG(ERROR) << "  - " << SaveDataDir;
         if (IncludeUserDir) LOG(ERROR) << "  - " << UserDataDir;
         LOG(ERROR) << "  - " << GameDataDir;
 
@@ -272,3 +314,54 @@ bool paths::exists (const std::string & path) const
     LOG(WARNING) << "*** paths::exists: directory '" << path << "' cannot be accessed!";
     return false;
 }
+
+// index contents of given directory
+void paths::index_directory (const std::string & root, const std::string & dir, std::hash_set<std::string> & index)
+{
+    struct dirent *dirent;
+    struct stat statbuf;
+    DIR *handle;
+    
+    if ((handle = opendir ((root + dir).c_str ())) == NULL)
+    {
+        return;
+    }
+    
+    while ((dirent = readdir (handle)) != NULL)
+    {
+        if (strcmp (dirent->d_name, ".") == 0 || strcmp (dirent->d_name, "..") == 0)
+        {
+            continue;
+        }
+        
+        std::string name = dir + dirent->d_name;
+        index.insert (name);
+        
+        // descend into subdirectories
+        if (stat ((root + name).c_str (), &statbuf) != -1 && S_ISDIR (statbuf.st_mode))
+        {
+            index_directory (root, name + "/", index);
+        }
+    }
+    
+    closedir (handle);
+}
+
+// look up file in given directory
+bool paths::in_dir (const std::string & dir, const std::string & path, const std::hash_set<std::string> & index, const bool & check_disk) const
+{
+    struct stat statbuf;
+    
+    // only paths in canonical form can be found in the index
+    if (path.find ("./") != std::string::npos || path.find ("//") != std::string::npos)
+    {
+        return stat ((dir + path).c_str (), &statbuf) != -1;
+    }
+    
+    if (index.find (path) != index.end ())
+    {
+        return true;
+    }
+    
+    return check_disk && stat ((dir + path).c_str (), &statbuf) != -1;
+}
@@ -38,6 +38,7 @@
 #include <ltdl.h>
 
 #include "file.h"
+#include "hash_map.h"
 
 namespace base
 {
@@ -58,6 +59,12 @@ namespace base
      * - a saved game directory
      * - a user supplied data directory
      * - the builtin data directory
+     *
+     * To avoid querying the file system for each file, the contents of
+     * these directories are indexed when they are added to the search path.
+     * Files written by the engine are added to the index by diskio. Only
+     * the builtin data directory, which comes last, is also searched on 
+     * disk for files missing from its index.
      */
     class paths
     {
@@ -84,6 +91,15 @@ namespace base
              */
             void set_save_dir (const std::string & dir);
 
+            /**
+             * Notify the search path that the given file has been written.
+             * If it is located in the saved game or user data directory, it
+             * will be added to the index, so that it takes precedence over a
+             * file of the same name in the builtin data directory.
+             * @param path full path of the file.
+             */
+            void add_file (const std::string & path);
+
             /**
              * Try to open the given file at the given location. Searches for the
              * file in saved game dir (if set before with set_save_dir()), the
@@ -104,6 +120,17 @@ namespace base
              * @return \c true on success, \c false if the file doesn't exist.
              */
             bool find_in_path (std::string & location, const bool & log_error = true) const;
+
+            /**
+             * Try to find a file at the given location, like find_in_path(),
+             * but ignoring the saved game directory. This will locate the file
+             * as it was shipped with the game, even if a saved game contains a 
+             * modified copy.
+             * @param location file to locate within the Adonthell search path.
+             * @param log_error whether to log error if file not found. True by default.
+             * @return \c true on success, \c false if the file doesn't exist.
+             */
+            bool find_in_data_path (std::string & location, const bool & log_error = true) const;
                 
             /**
              * Return the configuration data directory.
@@ -130,12 +157,42 @@ namespace base
             std::string game () const { return Game; }
             
         private:
+            /**
+             * Try to find a file in the search path.
+             * @param location file to locate within the Adonthell search path.
+             * @param log_error whether to log error if file not found.
+             * @param include_save_dir whether to search the saved game directory.
+             * @return \c true on success, \c false if the file doesn't exist.
+             */
+            bool find (std::string & location, const bool & log_error, const bool & include_save_dir) const;
+
             /**
              * Check whether the given directory exists and is accessible.
              * @param path an absolute path to check.
              * @return \c true if directory can be opened, \c false otherwise.
              */
             bool exists (const std::string & path) const;
+
+            /**
+             * Recursively add the contents of a directory to an index.
+             * @param root the directory being indexed.
+             * @param dir subdirectory of root to add to the index.
+             * @param index index the contents are added to.
+             */
+            void index_directory (const std::string & root, const std::string & dir, std::hash_set<std::string> & index);
+
+            /**
+             * Check whether a file exists in the given directory by consulting
+             * the directory's index. Files missing from the index can optionally
+             * be looked up on disk, for directories that might be modified by
+             * external tools while the engine is running.
+             * @param dir directory to search.
+             * @param path file to locate within that directory.
+             * @param index index of the directory.
+             * @param check_disk whether to look for files missing from the index on disk.
+             * @return \c true if the file exists, \c false otherwise.
+             */
+            bool in_dir (const std::string & dir, const std::string & path, const std::hash_set<std::string> & index, const bool & check_disk) const;
             
             /// current game
             std::string Game;
@@ -151,6 +208,12 @@ namespace base
             bool IncludeSaveDir;
             /// whether to include user supplied data directory in search path
             bool IncludeUserDir;
+            /// files contained in the saved game directory
+            std::hash_set<std::string> SaveDataIndex;
+            /// files contained in the user supplied data directory
+            std::hash_set<std::string> UserDataIndex;
+            /// files contained in the builtin data directory
+            std::hash_set<std::string> GameDataIndex;
     };
 }
 
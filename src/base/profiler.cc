@@ -0,0 +1,300 @@
+/*
+ Copyright (C) 2011 Kai Sterker <kai.sterker@gmail.com>
+ Part of the Adonthell Project http://adonthell.linuxgames.com
+
+ Adonthell is free software; you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation; either version 2 of the License, or
+ (at your option) any later version.
+
+ Adonthell is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with Adonthell; if not, write to the Free Software
+ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+/**
+ * @file   base/profiler.cc
+ * @author Kai Sterker <kai.sterker@gmail.com>
+ *
+ * @brief  Defines the profiler class.
+ *
+ *
+ */
+
+#include <cstdio>
+#include <cstring>
+#include <map>
+#include <mutex>
+#include <algorithm>
+
+#include "profiler.h"
+#include "logging.h"
+
+namespace base
+{
+    /**
+     * The zones recorded by a single thread.
+     */
+    class profile_buffer
+    {
+    public:
+        /**
+         * A zone that has been left.
+         */
+        struct sample
+        {
+            /// name of the zone
+            const char *Name;
+            /// time the zone was entered, in nanoseconds
+            u_int64 Start;
+            /// time the zone was left, in nanoseconds
+            u_int64 End;
+        };
+
+        /**
+         * Create empty buffer.
+         * @param thread id of the recording thread in the trace.
+         */
+        profile_buffer (const u_int32 & thread) : Thread (thread), InUse (true), Next (0), Count (0)
+        {
+        }
+
+        /// id of the recording thread in the trace
+        u_int32 Thread;
+        /// whether a running thread records into the buffer
+        bool InUse;
+        /// the most recent zones
+        sample Samples[PROFILER_BUFFER_SIZE];
+        /// index of the slot to record next
+        u_int32 Next;
+        /// number of slots used
+        u_int32 Count;
+        /// time spent per zone during the current frame
+        std::map<const char*, u_int64> FrameTime;
+        /// protects the buffer from being read while it is written
+        std::mutex Lock;
+    };
+
+    /**
+     * Time spent in a zone over the last frames.
+     */
+    struct zone_history
+    {
+        zone_history ()
+        {
+            memset (Time, 0, sizeof (Time));
+        }
+
+        /// time spent per frame, in nanoseconds
+        u_int64 Time[PROFILER_HISTORY];
+    };
+
+    /// whether zones are recorded
+    std::atomic<bool> profiler::Enabled (false);
+
+    /// buffers of all threads that recorded something
+    static std::vector<profile_buffer*> Buffers;
+    /// protects the list of buffers
+    static std::mutex BuffersLock;
+
+    /**
+     * Hands the buffer of a thread on to later threads once it ends.
+     * Threads such as those saving the game in the background come
+     * and go, so giving each its own buffer would never stop growing.
+     */
+    struct thread_buffer
+    {
+        thread_buffer () : Buffer (NULL)
+        {
+        }
+
+        ~thread_buffer ()
+        {
+            if (Buffer == NULL) return;
+
+            // recorded zones remain in the trace until overwritten
+            std::lock_guard<std::mutex> guard (BuffersLock);
+            Buffer->InUse = false;
+        }
+
+        /// the buffer of the thread, or NULL
+        profile_buffer *Buffer;
+    };
+
+    /// the buffer of the current thread
+    static thread_local thread_buffer ThreadBuffer;
+
+    /// time spent per zone, by name, over the last frames
+    static std::map<std::string, zone_history> History;
+    /// slot of the current frame in the history
+    static u_int32 Frame = 0;
+    /// start of the current frame
+    static u_int64 FrameStart = 0;
+
+    // get buffer of calling thread
+    profile_buffer *profiler::buffer ()
+    {
+        if (ThreadBuffer.Buffer == NULL)
+        {
+            std::lock_guard<std::mutex> guard (BuffersLock);
+
+            // reuse the buffer of a thread that finished
+            for (std::vector<profile_buffer*>::const_iterator buf = Buffers.begin (); buf != Buffers.end (); buf++)
+            {
+                if (!(*buf)->InUse)
+                {
+                    (*buf)->InUse = true;
+                    ThreadBuffer.Buffer = *buf;
+                    return ThreadBuffer.Buffer;
+                }
+            }
+
+            ThreadBuffer.Buffer = new profile_buffer (Buffers.size () + 1);
+            Buffers.push_back (ThreadBuffer.Buffer);
+        }
+
+        return ThreadBuffer.Buffer;
+    }
+
+    // store zone in ring buffer
+    void profiler::record (const char *name, const u_int64 & start, const u_int64 & end)
+    {
+        profile_buffer *buf = buffer ();
+        std::lock_guard<std::mutex> guard (buf->Lock);
+
+        profile_buffer::sample & s = buf->Samples[buf->Next];
+        s.Name = name;
+        s.Start = start;
+        s.End = end;
+
+        buf->Next = (buf->Next + 1) % PROFILER_BUFFER_SIZE;
+        if (buf->Count < PROFILER_BUFFER_SIZE) buf->Count++;
+
+        buf->FrameTime[name] += end - start;
+    }
+
+    // collect time spent during last frame
+    void profiler::next_frame ()
+    {
+        if (!Enabled)
+        {
+            FrameStart = 0;
+            return;
+        }
+
+        u_int64 now = timer::monotonic_time ();
+        if (FrameStart) record ("frame", FrameStart, now);
+        FrameStart = now;
+
+        for (std::map<std::string, zone_history>::iterator i = History.begin (); i != History.end (); i++)
+        {
+            i->second.Time[Frame] = 0;
+        }
+
+        std::lock_guard<std::mutex> guard (BuffersLock);
+        for (std::vector<profile_buffer*>::const_iterator buf = Buffers.begin (); buf != Buffers.end (); buf++)
+        {
+            std::lock_guard<std::mutex> buf_guard ((*buf)->Lock);
+            for (std::map<const char*, u_int64>::const_iterator i = (*buf)->FrameTime.begin (); i != (*buf)->FrameTime.end (); i++)
+            {
+                History[i->first].Time[Frame] += i->second;
+            }
+            (*buf)->FrameTime.clear ();
+        }
+
+        Frame = (Frame + 1) % PROFILER_HISTORY;
+    }
+
+    // save zones for chrome://tracing
+    bool profiler::write_trace (const std::string & filename)
+    {
+        FILE *file = fopen (filename.c_str (), "w");
+        if (file == NULL)
+        {
+            LOG(ERROR) << "*** profiler::write_trace: cannot open '" << filename << "' for writing";
+            return false;
+        }
+
+        fputs ("{\"traceEvents\":[", file);
+
+        bool first = true;
+        std::lock_guard<std::mutex> guard (BuffersLock);
+        for (std::vector<profile_buffer*>::const_iterator buf = Buffers.begin (); buf != Buffers.end (); buf++)
+        {
+            std::lock_guard<std::mutex> buf_guard ((*buf)->Lock);
+
+            // oldest zone first
+            u_int32 idx = ((*buf)->Next + PROFILER_BUFFER_SIZE - (*buf)->Count) % PROFILER_BUFFER_SIZE;
+            for (u_int32 i = 0; i < (*buf)->Count; i++, idx = (idx + 1) % PROFILER_BUFFER_SIZE)
+            {
+                const profile_buffer::sample & s = (*buf)->Samples[idx];
+                fprintf (file, "%s\n{\"name\":\"%s\",\"ph\":\"X\",\"pid\":1,\"tid\":%u,\"ts\":%.3f,\"dur\":%.3f}",
+                    first ? "" : ",", s.Name, (*buf)->Thread, s.Start / 1000.0, (s.End - s.Start) / 1000.0);
+                first = false;
+            }
+        }
+
+        fputs ("\n]}\n", file);
+        fclose (file);
+        return true;
+    }
+
+    /// sort zones by time spent
+    static bool by_time (const std::pair<double, std::string> & a, const std::pair<double, std::string> & b)
+    {
+        return a.first > b.first;
+    }
+
+    // human readable statistics
+    std::string profiler::summary (const u_int32 & max_lines)
+    {
+        std::vector<std::pair<double, std::string> > lines;
+        for (std::map<std::string, zone_history>::const_iterator i = History.begin (); i != History.end (); i++)
+        {
+            u_int64 total = 0, max = 0;
+            for (u_int32 j = 0; j < PROFILER_HISTORY; j++)
+            {
+                total += i->second.Time[j];
+                max = std::max (max, i->second.Time[j]);
+            }
+
+            double avg = total / 1000000.0 / PROFILER_HISTORY;
+
+            char line[128];
+            snprintf (line, sizeof (line), "%-24s %6.2f ms %6.2f ms max\n", i->first.c_str (), avg, max / 1000000.0);
+            lines.push_back (std::make_pair (avg, std::string (line)));
+        }
+
+        std::sort (lines.begin (), lines.end (), by_time);
+
+        std::string result;
+        for (u_int32 i = 0; i < lines.size () && i < max_lines; i++)
+        {
+            result += lines[i].second;
+        }
+
+        return result;
+    }
+
+    // start over
+    void profiler::clear ()
+    {
+        std::lock_guard<std::mutex> guard (BuffersLock);
+        for (std::vector<profile_buffer*>::const_iterator buf = Buffers.begin (); buf != Buffers.end (); buf++)
+        {
+            std::lock_guard<std::mutex> buf_guard ((*buf)->Lock);
+            (*buf)->Next = 0;
+            (*buf)->Count = 0;
+            (*buf)->FrameTime.clear ();
+        }
+
+        History.clear ();
+        Frame = 0;
+        FrameStart = 0;
+    }
+}
@@ -0,0 +1,171 @@
+/*
+ Copyright (C) 2011 Kai Sterker <kai.sterker@gmail.com>
+ Part of the Adonthell Project http://adonthell.linuxgames.com
+
+ Adonthell is free software; you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation; either version 2 of the License, or
+ (at your option) any later version.
+
+ Adonthell is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with Adonthell; if not, write to the Free Software
+ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+/**
+ * @file   base/profiler.h
+ * @author Kai Sterker <kai.sterker@gmail.com>
+ *
+ * @brief  Declares the profiler class and PROFILE_ZONE macro.
+ *
+ *
+ */
+
+#ifndef BASE_PROFILER_H
+#define BASE_PROFILER_H
+
+#include <atomic>
+#include <string>
+#include <vector>
+
+#include "timer.h"
+
+/// number of zones kept per thread for the trace
+#define PROFILER_BUFFER_SIZE 16384
+/// number of frames the statistics are averaged over
+#define PROFILER_HISTORY 60
+
+#ifndef SWIG
+/// helper to create a unique variable name
+#define PROFILE_CONCAT_(a, b) a ## b
+/// helper to create a unique variable name
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_(a, b)
+
+/**
+ * Measure the time spent from here to the end of the enclosing
+ * block, if the profiler is enabled.
+ * @param name of the zone. Must be a string literal.
+ */
+#define PROFILE_ZONE(name) \
+    base::profile_zone PROFILE_CONCAT(profile_zone_, __LINE__) (name)
+#endif
+
+namespace base
+{
+    class profile_buffer;
+
+    /**
+     * Records the time spent in zones of the code that have been
+     * marked with PROFILE_ZONE. Each thread records into a ring buffer
+     * of its own, which keeps the most recent PROFILER_BUFFER_SIZE zones.
+     * These can be written to a file in Chrome's trace event format,
+     * to be viewed with chrome://tracing or similar tools.
+     *
+     * In addition, the time per zone is summed up per frame and
+     * averaged over the last PROFILER_HISTORY frames, for display
+     * while the game is running.
+     *
+     * While disabled, a zone costs little more than a single check.
+     */
+    class profiler
+    {
+    public:
+        /**
+         * Start or stop recording.
+         * @param enable \b true to start recording.
+         */
+        static void set_enabled (const bool & enable) { Enabled.store (enable, std::memory_order_relaxed); }
+
+        /**
+         * Check whether zones are recorded.
+         * @return \b true if the profiler is recording.
+         */
+        static bool enabled () { return Enabled.load (std::memory_order_relaxed); }
+
+        /**
+         * Mark the start of a new frame. Called by base::frame_scheduler.
+         */
+        static void next_frame ();
+
+        /**
+         * Write recorded zones of all threads in Chrome's trace
+         * event format.
+         * @param filename full path of the file to write.
+         * @return \b true on success, \b false otherwise.
+         */
+        static bool write_trace (const std::string & filename);
+
+        /**
+         * Get the average and maximum time spent per frame in each
+         * zone, sorted by average time, one zone per line.
+         * @param max_lines maximum number of zones to list.
+         * @return the statistics in human readable form.
+         */
+        static std::string summary (const u_int32 & max_lines = 10);
+
+        /**
+         * Discard everything recorded so far.
+         */
+        static void clear ();
+
+#ifndef SWIG
+        /**
+         * Record a zone for the calling thread.
+         * @param name name of the zone.
+         * @param start time the zone was entered, in nanoseconds.
+         * @param end time the zone was left, in nanoseconds.
+         */
+        static void record (const char *name, const u_int64 & start, const u_int64 & end);
+
+    private:
+        /**
+         * Get the buffer of the calling thread, creating it if required.
+         * @return buffer of the calling thread.
+         */
+        static profile_buffer *buffer ();
+
+        /// whether zones are recorded, read by all threads
+        static std::atomic<bool> Enabled;
+#endif
+    };
+
+#ifndef SWIG
+    /**
+     * Measures the time between its construction and destruction.
+     * Use the PROFILE_ZONE macro instead of creating it directly.
+     */
+    class profile_zone
+    {
+    public:
+        /**
+         * Enter a zone.
+         * @param name of the zone. Must be a string literal.
+         */
+        profile_zone (const char *name) : Name (name)
+        {
+            Start = profiler::enabled () ? timer::monotonic_time () : 0;
+        }
+
+        /**
+         * Leave the zone.
+         */
+        ~profile_zone ()
+        {
+            if (Start) profiler::record (Name, Start, timer::monotonic_time ());
+        }
+
+    private:
+        /// name of the zone
+        const char *Name;
+        /// time the zone was entered, or 0 if not recorded
+        u_int64 Start;
+    };
+#endif
+}
+
+#endif // BASE_PROFILER_H
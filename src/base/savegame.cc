@@ -32,9 +32,12 @@
 #include <sys/stat.h>
 
 #include "savegame.h"
+#include "savegame_writer.h"
+#include "allow_threads.h"
 #include "base.h"
 #include "diskio.h"
 #include "logging.h"
+#include "profiler.h"
 
 using base::savegame;
 using base::savegame_data;
@@ -55,6 +58,12 @@ static int get_file_type (const std::string & path, const std::string & name)
 
 /// current slot
 s_int32 savegame::CurrentSlot = savegame::INITIAL_SAVE;
+/// game being saved in the background
+base::savegame_writer *savegame::Pending = NULL;
+/// notified once the game has been saved in the background
+base::functor_1<bool> *savegame::PendingCallback = NULL;
+/// updates written after the game being saved in the background
+std::list<base::savegame_writer*> savegame::Queued;
 
 // ctor
 savegame_data::savegame_data (const std::string & dir, const std::string & desc, const u_int32 & time)
@@ -90,6 +99,9 @@ bool savegame::load (const s_int32 & slot)
     savegame_data *data = get (slot);
     if (data == NULL) return false;
     
+    // make sure we do not read a partially written game
+    wait ();
+    
     u_int32 current = 1;
     u_int32 count = Serializer().size();
     
@@ -123,12 +135,68 @@ bool savegame::load (const s_int32 & slot)
 // save the game
 bool savegame::save (const s_int32 & slot, const std::string & desc, const u_int32 & gametime)
 {
-    if (slot == INITIAL_SAVE) return false;
+    PROFILE_ZONE ("savegame::save");
+
+    savegame_writer *writer = snapshot (slot, desc, gametime);
+    if (writer == NULL) return false;
+    
+    // write game data, which no longer involves any scripts
+    bool result;
+    {
+        base::allow_threads nogil;
+        result = writer->write ();
+    }
+    if (result)
+    {
+        CurrentSlot = slot_for_directory (writer->directory());
+        
+        // game data is now found in the saved game directory
+        base::Paths().set_save_dir (writer->directory());
+    }
+    else
+    {
+        forget_unsaved (writer->directory());
+    }
+    
+    delete writer;
+    
+    base::Timer.synch();
+    return result;
+}
+
+// save the game on a background thread
+bool savegame::save_in_background (const s_int32 & slot, const std::string & desc, const u_int32 & gametime, base::functor_1<bool> *callback)
+{
+    savegame_writer *writer = snapshot (slot, desc, gametime);
+    if (writer == NULL)
+    {
+        delete callback;
+        return false;
+    }
+    
+    // write game data
+    Pending = writer;
+    PendingCallback = callback;
+    Pending->start ();
+    
+    base::Timer.synch();
+    return true;
+}
+
+// capture state of the game
+base::savegame_writer *savegame::snapshot (const s_int32 & slot, const std::string & desc, const u_int32 & gametime)
+{
+    PROFILE_ZONE ("savegame::snapshot");
+
+    if (slot == INITIAL_SAVE) return NULL;
 
+    // only save one game at a time
+    wait ();
+    
     savegame_data *data = get (slot);
+    std::string filepath;
     if (data == NULL)
     {
-        std::string filepath;
         u_int32 pos = 0;
         char t[10];
         
@@ -156,32 +224,31 @@ bool savegame::save (const s_int32 & slot, const std::string & desc, const u_int
         {
             LOG(ERROR) << "*** savegame::save: seems like you have no write permission in";
             LOG(ERROR) << "    " << base::Paths().cfg_data_dir();
-            return false;
+            return NULL;
         }
-
-        // we'll need a new gamedata record
-        data = new savegame_data (filepath, desc, gametime);
-        Games().push_back (data);
     }
     else
     {
-        // we have to update the gamedata record
-        data->update (desc, gametime);
+        filepath = data->directory();
     }
 
-    // prepare the directory before saving
-    cleanup (data->directory());
-
-    // save game data
+    // game data goes to a staging directory first
+    savegame_writer *writer = new savegame_writer (filepath);
+    cleanup (writer->staging_dir());
+    
+    // capture game data
+    writer->begin_capture ();
+    
     u_int32 current = 1;
     u_int32 size = Serializer().size();
     std::list<base::serializer_base*>::iterator i;
     for (i = Serializer().begin(); i != Serializer().end(); i++)
     {
-        if (!(*i)->save (data->directory()))
+        if (!(*i)->save (writer->staging_dir()))
         {
-            cleanup (data->directory());
-            return false;
+            writer->discard ();
+            delete writer;
+            return NULL;
         }
         
         if (ProgressCallback != NULL)
@@ -193,7 +260,25 @@ bool savegame::save (const s_int32 & slot, const std::string & desc, const u_int
     }
     
     // finally save meta data, making the saved game valid
-    save_meta_data (data);
+    savegame_data meta (filepath, desc, gametime);
+    if (!save_meta_data (&meta, writer->staging_dir()))
+    {
+        writer->discard ();
+        delete writer;
+        return NULL;
+    }
+    writer->end_capture ();
+
+    // only list the game once its snapshot is complete
+    if (data == NULL)
+    {
+        data = new savegame_data (filepath, desc, gametime);
+        Games().push_back (data);
+    }
+    else
+    {
+        data->update (desc, gametime);
+    }
 
     // update timestamp ...
     data->set_last_modified (time (NULL));
@@ -201,9 +286,124 @@ bool savegame::save (const s_int32 & slot, const std::string & desc, const u_int
     // ... and re-sort
     std::sort (Games().begin()+SPECIAL_SLOT_COUNT, Games().end());
 
-    base::Timer.synch();
-    CurrentSlot = slot;
-    return true;
+    return writer;
+}
+
+// check for game being saved in the background
+bool savegame::is_saving ()
+{
+    return Pending != NULL;
+}
+
+// check whether saving in background has finished
+void savegame::update ()
+{
+    if (Pending != NULL && Pending->is_done ())
+    {
+        complete_pending ();
+    }
+}
+
+// wait until saving in background has finished
+bool savegame::wait ()
+{
+    bool result = true;
+    while (Pending != NULL)
+    {
+        result &= complete_pending ();
+    }
+    return result;
+}
+
+// update current game in the background
+void savegame::update_in_background (base::savegame_writer *writer)
+{
+    if (Pending != NULL)
+    {
+        Queued.push_back (writer);
+        return;
+    }
+
+    Pending = writer;
+    Pending->start ();
+}
+
+// path of the game after saving in the background
+std::string savegame::save_path ()
+{
+    return Pending != NULL ? Pending->directory() : current_path();
+}
+
+// finish saving in the background
+bool savegame::complete_pending ()
+{
+    bool result = Pending->finish ();
+    if (result)
+    {
+        CurrentSlot = slot_for_directory (Pending->directory());
+        
+        // game data is now found in the saved game directory
+        base::Paths().set_save_dir (Pending->directory());
+    }
+    else
+    {
+        forget_unsaved (Pending->directory());
+    }
+    
+    delete Pending;
+    Pending = NULL;
+    
+    // notify about completion
+    base::functor_1<bool> *callback = PendingCallback;
+    PendingCallback = NULL;
+    
+    if (callback != NULL)
+    {
+        (*callback)(result);
+        delete callback;
+    }
+    
+    // start next update, unless the callback already saved again
+    if (Pending == NULL && !Queued.empty())
+    {
+        Pending = Queued.front ();
+        Queued.pop_front ();
+        Pending->start ();
+    }
+    
+    return result;
+}
+
+// find slot of saved game
+s_int32 savegame::slot_for_directory (const std::string & directory)
+{
+    for (u_int32 i = 0; i < Games().size(); i++)
+    {
+        if (Games()[i]->directory() == directory)
+        {
+            return (s_int32) i - SPECIAL_SLOT_COUNT;
+        }
+    }
+    
+    return CurrentSlot;
+}
+
+// remove game that failed to save for the first time
+void savegame::forget_unsaved (const std::string & directory)
+{
+    // a previous version of the game is still there
+    struct stat statbuf;
+    if (stat (directory.c_str (), &statbuf) != -1) return;
+
+    for (std::vector<savegame_data*>::iterator i = Games().begin() + SPECIAL_SLOT_COUNT; i != Games().end(); i++)
+    {
+        if ((*i)->directory() == directory)
+        {
+            delete *i;
+            Games().erase (i);
+            return;
+        }
+    }
 }
 
 // read available games
@@ -239,6 +439,9 @@ void savegame::init ()
         {
             std::string filepath = base::Paths().cfg_data_dir() + dirent->d_name; 
             
+            // skip staging or backup directories of saved games
+            if (strchr (dirent->d_name, '.') != NULL) continue;
+            
             if (strncmp (name_save.c_str (), dirent->d_name, name_save.length ()) == 0)
             {
                 load_meta_data (filepath);
@@ -253,6 +456,9 @@ void savegame::init ()
 
 void savegame::cleanup()
 {
+    // finish saving before serializers go away
+    wait ();
+    
     for (std::vector<savegame_data*>::iterator i = Games().begin(); i != Games().end(); i++)
     {
         delete *i;
@@ -321,14 +527,14 @@ savegame_data *savegame::get (const s_int32 & slot)
 }
 
 // save meta data
-bool savegame::save_meta_data (savegame_data *data)
+bool savegame::save_meta_data (savegame_data *data, const std::string & path)
 {
     base::diskio file;
     
     file.put_string ("desc", data->description());
     file.put_uint32 ("time", data->gametime());
     
-    return file.put_record (data->directory() + "/meta.data");
+    return file.put_record (path + "/meta.data");
 }
 
 // load saved game meta data
@@ -41,6 +41,8 @@
 
 namespace base
 {
+    class savegame_writer;
+    
     /**
      * Savegame meta data.
      */
@@ -212,6 +214,77 @@ namespace base
          * @return true on success, false otherwise.
          */
         bool save (const s_int32 & slot, const std::string & desc, const u_int32 & gametime);
+
+#ifndef SWIG
+        /**
+         * Save the game at the given slot, without blocking the game.
+         * The state of all serializers is captured in memory right away,
+         * but written to disk on a background thread. The saved game
+         * only replaces the previous contents of the slot once all of
+         * its data has been written successfully.
+         *
+         * Completion is checked by update(), which runs at the start
+         * of every frame of the main loop.
+         *
+         * @param slot index of saved game slot.
+         * @param desc user supplied description of the game.
+         * @param gametime in-game timestamp.
+         * @param callback notified from update() with the final result
+         *      of the save. Will be deleted afterwards.
+         * @return true if the game state could be captured, false otherwise.
+         */
+        bool save_in_background (const s_int32 & slot, const std::string & desc, const u_int32 & gametime, base::functor_1<bool> *callback = NULL);
+#endif
+        //@}
+        
+        /**
+         * @name Background saving
+         */
+        //@{
+        /**
+         * Check whether a game is currently being saved in the background.
+         * @return true if saving is in progress, false otherwise.
+         */
+        static bool is_saving ();
+        
+        /**
+         * Check whether a game that is being saved in the background
+         * has been written completely. In that case, notify the callback
+         * passed to save_in_background. Called once per frame from
+         * frame_scheduler::begin_frame.
+         */
+        static void update ();
+        
+        /**
+         * Block until a game that is being saved in the background has
+         * been written completely and notify the callback passed to
+         * save_in_background.
+         * @return result of the pending save, or true if there was none.
+         */
+        static bool wait ();
+
+#ifndef SWIG
+        /**
+         * Update files of the saved game the game is running from,
+         * without blocking the game. The writer must update the
+         * directory returned by save_path() in place. It is written
+         * on a background thread once any game still being saved
+         * in the background has been written.
+         *
+         * @param writer the captured files. Will be deleted once written.
+         */
+        static void update_in_background (base::savegame_writer *writer);
+#endif
+
+        /**
+         * Return the path to the saved game the game is running from
+         * once all games being saved in the background are written.
+         * Unlike current_path(), files can safely be added to this
+         * directory with update_in_background().
+         *
+         * @return path to saved game data directory.
+         */
+        static std::string save_path ();
         //@}
         
         /**
@@ -254,11 +327,44 @@ namespace base
         void cleanup (const std::string & name);
             
         /**
-         * Save meta information for the given saved gaem.
+         * Save meta information for the given saved game.
          * @param data the game data structure to save.
+         * @param path directory to write meta information to.
+         * @return true on success, false otherwise.
+         */
+        bool save_meta_data (savegame_data *data, const std::string & path);
+        
+        /**
+         * Capture the state of all serializers for the game at
+         * the given slot.
+         * @param slot index of saved game slot.
+         * @param desc user supplied description of the game.
+         * @param gametime in-game timestamp.
+         * @return snapshot of the game state, or NULL on error.
+         */
+        savegame_writer *snapshot (const s_int32 & slot, const std::string & desc, const u_int32 & gametime);
+        
+        /**
+         * Find the slot of the saved game with the given directory.
+         * @param directory path of a saved game.
+         * @return slot of the saved game.
+         */
+        static s_int32 slot_for_directory (const std::string & directory);
+
+        /**
+         * Remove the saved game with the given directory from the list
+         * of saved games, unless it exists on disk. Used when a game
+         * could not be saved to a new slot.
+         * @param directory path of the saved game.
+         */
+        static void forget_unsaved (const std::string & directory);
+        
+        /**
+         * Finish saving in the background and make the saved game
+         * the current slot on success.
          * @return true on success, false otherwise.
          */
-        bool save_meta_data (savegame_data *data);
+        static bool complete_pending ();
         
         /**
          * Load meta information of given saved game. If
@@ -273,6 +379,12 @@ namespace base
     private:
         /// the slot the current game is running from
         static s_int32 CurrentSlot;
+        /// game currently saved in the background
+        static savegame_writer *Pending;
+        /// notified when the game in the background has been saved
+        static base::functor_1<bool> *PendingCallback;
+        /// updates waiting for the game in the background to be saved
+        static std::list<base::savegame_writer*> Queued;
         /// list of available saved games
         static std::vector<savegame_data*>& Games();
         /// classes that read write game data
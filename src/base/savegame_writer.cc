@@ -0,0 +1,272 @@
+/*
+ Copyright (C) 2011 Kai Sterker <kai.sterker@gmail.com>
+ Part of the Adonthell Project http://adonthell.linuxgames.com
+
+ Adonthell is free software; you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation; either version 2 of the License, or
+ (at your option) any later version.
+
+ Adonthell is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with Adonthell; if not, write to the Free Software
+ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+*/
+
+/**
+ * @file   base/savegame_writer.cc
+ * @author Kai Sterker <kai.sterker@gmail.com>
+ *
+ * @brief  Writes a snapshot of the game state to disk.
+ *
+ *
+ */
+
+#include <cstdio>
+#include <unistd.h>
+#include <dirent.h>
+#include <sys/stat.h>
+
+#include "savegame_writer.h"
+#include "diskwriter_gz.h"
+#include "diskwriter_xml.h"
+#include "logging.h"
+#include "profiler.h"
+
+using base::savegame_writer;
+
+/// snapshot currently capturing records
+savegame_writer *savegame_writer::Capturing = NULL;
+
+// delete a directory and all regular files it contains
+static bool remove_directory (const std::string & name)
+{
+    struct dirent *dirent;
+    struct stat statbuf;
+    DIR *dir;
+
+    if ((dir = opendir (name.c_str ())) == NULL)
+    {
+        return false;
+    }
+
+    while ((dirent = readdir (dir)) != NULL)
+    {
+        std::string file = name + "/" + dirent->d_name;
+        if (stat (file.c_str (), &statbuf) != -1 && S_ISREG (statbuf.st_mode))
+        {
+            unlink (file.c_str());
+        }
+    }
+
+    closedir (dir);
+    return rmdir (name.c_str ()) == 0;
+}
+
+// ctor
+savegame_writer::savegame_writer (const std::string & directory, const bool & in_place)
+    : Directory (directory), InPlace (in_place), Result (false), Done (false), Thread (NULL)
+{
+}
+
+// dtor
+savegame_writer::~savegame_writer ()
+{
+    end_capture ();
+    finish ();
+
+    for (std::list<record*>::iterator i = Records.begin(); i != Records.end(); i++)
+    {
+        delete *i;
+    }
+}
+
+// redirect diskio to this snapshot
+void savegame_writer::begin_capture ()
+{
+    Capturing = this;
+}
+
+// stop redirecting diskio
+void savegame_writer::end_capture ()
+{
+    if (Capturing == this)
+    {
+        Capturing = NULL;
+    }
+}
+
+// drop incomplete snapshot
+void savegame_writer::discard ()
+{
+    end_capture ();
+
+    // never remove the saved game itself
+    if (!InPlace) remove_directory (staging_dir ());
+}
+
+// add record to snapshot currently being captured
+bool savegame_writer::capture (const std::string & filename, const base::diskio::file_format & format, const base::flat & data)
+{
+    if (Capturing == NULL) return false;
+
+    // only capture files that belong to the saved game
+    std::string staging_dir = Capturing->staging_dir() + "/";
+    if (filename.compare (0, staging_dir.length(), staging_dir) != 0)
+    {
+        return false;
+    }
+
+    record *rec = new record ();
+    rec->Filename = filename;
+    rec->Format = format;
+    rec->Data = data;
+
+    Capturing->Records.push_back (rec);
+    return true;
+}
+
+// write snapshot in the calling thread
+bool savegame_writer::write ()
+{
+    run ();
+    return Result;
+}
+
+// write snapshot in a background thread
+void savegame_writer::start ()
+{
+    Thread = new std::thread (&savegame_writer::run, this);
+}
+
+// wait for background thread
+bool savegame_writer::finish ()
+{
+    if (Thread != NULL)
+    {
+        Thread->join ();
+        delete Thread;
+        Thread = NULL;
+    }
+
+    return Result;
+}
+
+// write records to staging directory
+void savegame_writer::run ()
+{
+    PROFILE_ZONE ("savegame_writer::run");
+
+    base::disk_writer_gz gz_writer;
+    base::disk_writer_xml xml_writer;
+
+    Result = true;
+
+    while (!Records.empty())
+    {
+        record *rec = Records.front ();
+        Records.pop_front ();
+
+        if (InPlace)
+        {
+            Result &= replace (rec);
+        }
+        else if (rec->Format == base::diskio::XML_FILE)
+        {
+            Result &= xml_writer.put_state (rec->Filename, rec->Data);
+        }
+        else
+        {
+            Result &= gz_writer.put_state (rec->Filename, rec->Data);
+        }
+
+        delete rec;
+    }
+
+    if (InPlace)
+    {
+        if (!Result) LOG(ERROR) << "*** savegame_writer: failed updating '" << Directory << "'";
+    }
+    else if (Result)
+    {
+        Result = commit ();
+    }
+    else
+    {
+        LOG(ERROR) << "*** savegame_writer: failed writing to '" << staging_dir() << "'";
+        remove_directory (staging_dir ());
+    }
+
+    Done = true;
+}
+
+// replace saved game with staging directory
+bool savegame_writer::commit ()
+{
+    struct stat statbuf;
+    std::string backup = Directory + BACKUP_EXT;
+
+    // remains of an earlier, interrupted commit
+    remove_directory (backup);
+
+    // keep previous version until the new one is in place
+    bool exists = stat (Directory.c_str (), &statbuf) != -1;
+    if (exists && rename (Directory.c_str (), backup.c_str ()) != 0)
+    {
+        LOG(ERROR) << "*** savegame_writer::commit: cannot rename '" << Directory << "'";
+        remove_directory (staging_dir ());
+        return false;
+    }
+
+    if (rename (staging_dir().c_str (), Directory.c_str ()) != 0)
+    {
+        LOG(ERROR) << "*** savegame_writer::commit: cannot rename '" << staging_dir() << "'";
+
+        // try restoring the previous version
+        if (exists) rename (backup.c_str (), Directory.c_str ());
+        remove_directory (staging_dir ());
+        return false;
+    }
+
+    if (exists)
+    {
+        remove_directory (backup);
+    }
+
+    return true;
+}
+
+// replace single file of existing saved game
+bool savegame_writer::replace (record *rec)
+{
+    std::string tmp = rec->Filename + STAGING_EXT;
+    bool result;
+
+    if (rec->Format == base::diskio::XML_FILE)
+    {
+        result = base::disk_writer_xml ().put_state (tmp, rec->Data);
+    }
+    else
+    {
+        result = base::disk_writer_gz ().put_state (tmp, rec->Data);
+    }
+
+#ifdef WIN32
+    // rename does not replace existing files
+    if (result) unlink (rec->Filename.c_str ());
+#endif
+    // the file might be a hard link shared with other saved games,
+    // so it must be replaced rather than written to
+    if (!result || rename (tmp.c_str (), rec->Filename.c_str ()) != 0)
+    {
+        LOG(ERROR) << "*** savegame_writer::replace: cannot write '" << rec->Filename << "'";
+        unlink (tmp.c_str ());
+        return false;
+    }
+
+    return true;
+}
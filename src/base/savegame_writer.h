@@ -0,0 +1,220 @@
+/*
+ Copyright (C) 2011 Kai Sterker <kai.sterker@gmail.com>
+ Part of the Adonthell Project http://adonthell.linuxgames.com
+
+ Adonthell is free software; you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation; either version 2 of the License, or
+ (at your option) any later version.
+
+ Adonthell is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with Adonthell; if not, write to the Free Software
+ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+/**
+ * @file   base/savegame_writer.h
+ * @author Kai Sterker <kai.sterker@gmail.com>
+ *
+ * @brief  Writes a snapshot of the game state to disk.
+ *
+ *
+ */
+
+#ifndef BASE_SAVEGAME_WRITER_H
+#define BASE_SAVEGAME_WRITER_H
+
+#include <list>
+#include <string>
+#include <atomic>
+#include <thread>
+
+#include "diskio.h"
+
+/// extension of directory a saved game is written to first
+#define STAGING_EXT ".tmp"
+/// extension of the previous version of a saved game during commit
+#define BACKUP_EXT ".old"
+
+namespace base
+{
+    /**
+     * Saving a game happens in two stages. First, each registered
+     * serializer writes its state as usual. But instead of going
+     * to disk, every record passed to diskio::put_record is copied
+     * into an in-memory snapshot. This is cheap and happens on the
+     * main thread, while the game state is consistent.
+     *
+     * In the second stage, the snapshot is compressed and written
+     * to a staging directory, either right away or on a background
+     * thread. Only when all files have been written successfully,
+     * the staging directory replaces the actual saved game directory.
+     * A crash or error while writing will therefore never leave a
+     * saved game in an inconsistent state.
+     *
+     * A writer can also update single files of an existing saved
+     * game in place. Each file is then written next to its final
+     * location first and renamed once complete, which also breaks
+     * up any hard links it shares with other saved games.
+     */
+    class savegame_writer
+    {
+    public:
+        /**
+         * Create a new snapshot for the given saved game directory.
+         * @param directory the saved game directory.
+         * @param in_place \b true to update files of the existing
+         *      saved game instead of replacing the whole directory.
+         */
+        savegame_writer (const std::string & directory, const bool & in_place = false);
+
+        /**
+         * Destructor. Waits for a background write to complete.
+         */
+        ~savegame_writer ();
+
+        /**
+         * @name Capturing the snapshot
+         */
+        //@{
+        /**
+         * Start redirecting diskio::put_record to this snapshot.
+         * Only records located in staging_dir() are captured.
+         */
+        void begin_capture ();
+
+        /**
+         * Stop capturing records.
+         */
+        void end_capture ();
+
+        /**
+         * Stop capturing records and drop the snapshot without writing
+         * it, removing the staging directory.
+         */
+        void discard ();
+
+        /**
+         * Called by diskio::put_record to add a record to the
+         * snapshot currently being captured, if any.
+         * @param filename full path of the file to write.
+         * @param format format of the file to write.
+         * @param data record to write.
+         * @return \b true if the record has been captured, \b false
+         *      if it must be written to disk immediately.
+         */
+        static bool capture (const std::string & filename, const base::diskio::file_format & format, const base::flat & data);
+        //@}
+
+        /**
+         * @name Writing the snapshot
+         */
+        //@{
+        /**
+         * Write snapshot to disk and commit it in the calling thread.
+         * @return \b true on success, \b false otherwise.
+         */
+        bool write ();
+
+        /**
+         * Write snapshot to disk and commit it on a background thread.
+         */
+        void start ();
+
+        /**
+         * Check whether the snapshot has been committed.
+         * @return \b true if writing is finished, \b false otherwise.
+         */
+        bool is_done () const { return Done; }
+
+        /**
+         * Block until writing on the background thread is finished.
+         * @return \b true on success, \b false otherwise.
+         */
+        bool finish ();
+        //@}
+
+        /**
+         * @name Member access
+         */
+        //@{
+        /**
+         * Get directory the snapshot will finally be committed to.
+         * @return the saved game's directory.
+         */
+        std::string directory () const { return Directory; }
+
+        /**
+         * Get directory serializers should write their data to.
+         * @return the staging directory.
+         */
+        std::string staging_dir () const { return InPlace ? Directory : Directory + STAGING_EXT; }
+
+        /**
+         * Check whether this writer updates an existing saved game.
+         * @return \b true if files are updated in place.
+         */
+        bool in_place () const { return InPlace; }
+        //@}
+
+    private:
+        /// forbid copy construction
+        savegame_writer (const savegame_writer & w);
+
+        /**
+         * Write all captured records to the staging directory and
+         * move it in place of the saved game directory, or replace
+         * the files of the saved game one by one.
+         */
+        void run ();
+
+        /**
+         * Replace the saved game directory with the staging directory.
+         * @return \b true on success, \b false otherwise.
+         */
+        bool commit ();
+
+        /**
+         * A single file of the snapshot.
+         */
+        struct record
+        {
+            /// full path of the file
+            std::string Filename;
+            /// file format to use
+            base::diskio::file_format Format;
+            /// contents of the file
+            base::flat Data;
+        };
+
+        /**
+         * Write a single file of an existing saved game and move it
+         * in place of the previous version.
+         * @param rec the file to write.
+         * @return \b true on success, \b false otherwise.
+         */
+        bool replace (record *rec);
+
+        /// the saved game directory
+        std::string Directory;
+        /// whether files of the existing saved game are updated
+        bool InPlace;
+        /// files to write
+        std::list<record*> Records;
+        /// whether all files have been written successfully
+        bool Result;
+        /// whether writing to disk has finished
+        std::atomic<bool> Done;
+        /// thread used for writing in the background
+        std::thread *Thread;
+        /// snapshot currently capturing records
+        static savegame_writer *Capturing;
+    };
+}
+
+#endif
@@ -65,7 +65,7 @@ namespace base
     // ctor
     timer::timer() : Slice(25), Lasttime(0), FramesMissed(0)
     {
-        gettimeofday (&InitialTime, NULL);
+        InitialTime = monotonic_time ();
     }
 
     // set duration of one game cycle in ms
@@ -77,9 +77,21 @@ namespace base
     // return time passed since creation of timer 
     u_int32 timer::current_time() const
     {
+        return (monotonic_time () - InitialTime) / 1000000;
+    }
+
+    // time that never jumps back or forth
+    u_int64 timer::monotonic_time ()
+    {
+#if defined(HAVE_CLOCK_GETTIME) && defined(CLOCK_MONOTONIC)
+        struct timespec ts;
+        clock_gettime (CLOCK_MONOTONIC, &ts);
+        return (u_int64) ts.tv_sec * 1000000000 + ts.tv_nsec;
+#else
         struct timeval tv;
-        gettimeofday(&tv, NULL);
-        return convert_timeval(tv);
+        gettimeofday (&tv, NULL);
+        return (u_int64) tv.tv_sec * 1000000000 + (u_int64) tv.tv_usec * 1000;
+#endif
     }
 
     // suspend application for given time
@@ -101,6 +113,7 @@ namespace base
     void timer::synch ()
     {
         Lasttime = current_time ();
+        FramesMissed = 0;
     }
 
     // wait until current game cycle is over
@@ -115,18 +115,16 @@ namespace base
          */
         static void sleep (u_int32 msecs);
 
-    private:
         /**
-         * Calculate difference between given time and creation
-         * time of the timer in milliseconds.
-         * @param tv a timestamp
-         * @return difference between timestamp and creation time.
+         * Return time of a clock that is not affected by changes
+         * of the system time, with the best available resolution.
+         * @return time in nanoseconds since an unspecified point in the past.
          */
-        u_int32 convert_timeval (const struct timeval & tv) const
-        { return ((tv.tv_sec - InitialTime.tv_sec) * 1000 + (tv.tv_usec - InitialTime.tv_usec) / 1000); }
+        static u_int64 monotonic_time ();
 
-        /// creation time of the %timer
-        struct timeval InitialTime;
+    private:
+        /// creation time of the %timer, in nanoseconds
+        u_int64 InitialTime;
         /// length of a game cycle in milliseconds
         u_int32 Slice;
         /// amount of time this timer is running (in milliseconds)
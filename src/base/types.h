@@ -33,6 +33,9 @@
 
 // We are assuming CMAKE guarantees the existence of <stdint.h>
 
+/// 64 bits long unsigned
+    typedef uint64_t u_int64;
+
 /// 32 bits long unsigned
     typedef uint32_t u_int32;
 
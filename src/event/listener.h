@@ -191,6 +191,22 @@ namespace events
         virtual bool connect_callback (const string & file, const string & classname, 
             const string & callback, PyObject *args = NULL) = 0;
 
+        /**
+         * Sets a python method to be executed with all events that
+         * occured during one sweep of the %event %manager. Instead of
+         * being called once per %event, the method receives a single
+         * list of (%listener, %event) tuples. Listeners connected to the
+         * same method share that list, so a script can process many
+         * events with a single call.
+         *
+         * @param file Name of the script to load.
+         * @param classname Name of the class containing the callback.
+         * @param callback Name of the method to call.
+         * @return \b false if connecting the callback failed, \b true otherwise.
+         */
+        virtual bool connect_batch_callback (const string & file, const string & classname,
+            const string & callback) = 0;
+
 #ifndef SWIG
         /**
          * Sets a C++ method to be executed whenever a %event
@@ -51,6 +51,13 @@ bool listener_cxx::connect_callback (const string & file, const string & classna
     return false;
 }
 
+// set python method to be called with all events of a sweep
+bool listener_cxx::connect_batch_callback (const string & file, const string & classname, const string & callback)
+{
+    LOG(ERROR) << "listener_cxx::connect_batch_callback: unsupported operation!";
+    return false;
+}
+
 // set a C/C++ callback as event's action
 void listener_cxx::connect_callback (base::functor_1<const event*> * callback)
 {
@@ -72,6 +72,18 @@ namespace events
          */
         bool connect_callback (const string & file, const string & classname, 
                                const string & callback, PyObject *args = NULL);
+
+        /**
+         * Sets a python method to be executed with all events that
+         * occured during one sweep of the %event %manager.
+         *
+         * @param file Name of the script to load.
+         * @param classname Name of the class containing the callback.
+         * @param callback Name of the method to call.
+         * @return \b false if connecting the callback failed, \b true otherwise.
+         */
+        bool connect_batch_callback (const string & file, const string & classname,
+                                     const string & callback);
         
 #ifndef SWIG
         /**
@@ -32,11 +32,17 @@
 using events::listener;
 using events::listener_python;
 
+// batched listeners waiting for dispatch
+std::vector<std::pair<listener_python*, const events::event*> > listener_python::Pending;
+// batch whose callbacks are currently executed
+std::vector<std::pair<listener_python*, const events::event*> > *listener_python::Dispatching = NULL;
+
 // ctor
 listener_python::listener_python (factory *f, event *e) : listener (f, e)
 {
     Method = NULL;
     Args = NULL;
+    Batched = false;
 }
 
 // destructor
@@ -46,6 +52,22 @@ listener_python::~listener_python ()
     delete Method;
     // ... and the arguments neither
     Py_XDECREF (Args);
+
+    // make sure a pending batch does not refer to us
+    for (std::vector<std::pair<listener_python*, const event*> >::iterator i = Pending.begin (); i != Pending.end (); /* nothing */)
+    {
+        if (i->first == this) i = Pending.erase (i);
+        else i++;
+    }
+
+    // ... and neither does the batch being dispatched
+    if (Dispatching != NULL)
+    {
+        for (std::vector<std::pair<listener_python*, const event*> >::iterator i = Dispatching->begin (); i != Dispatching->end (); i++)
+        {
+            if (i->first == this) i->first = NULL;
+        }
+    }
 }
 
 // set python method to be called when the event occurs
@@ -71,6 +93,7 @@ bool listener_python::connect_callback (const string & file, const string & clas
     
     // free old args
     Py_XDECREF(Args);
+    Batched = false;
 
     // make room for additional parameters
     Args = python::pad_tuple(args, 2);
@@ -81,6 +104,34 @@ bool listener_python::connect_callback (const string & file, const string & clas
     return true;
 }
 
+// set python method to be called with all events of a sweep
+bool listener_python::connect_batch_callback (const string & file, const string & classname, const string & callback)
+{
+    // cleanup
+    delete Method;
+    Py_XDECREF (Args);
+    Args = NULL;
+    Batched = false;
+
+    // just disconnect the callback
+    if (file == "")
+    {
+        Method = NULL;
+        return false;
+    }
+
+    // create the callback
+    Method = python::pool::connect (EVENTS_DIR + file, classname, callback);
+    if (!Method)
+    {
+        LOG(ERROR) << "listener::connect_batch_callback: connecting callback failed!";
+        return false;
+    }
+
+    Batched = true;
+    return true;
+}
+
 // set a C/C++ callback as event's action
 void listener_python::connect_callback (base::functor_1<const event*> * callback)
 {
@@ -90,7 +141,15 @@ void listener_python::connect_callback (base::functor_1<const event*> * callback
 // execute callback for given event
 s_int32 listener_python::raise_event (const event* evnt) 
 {
-    if (Method && Event->repeat ())
+    if (Method && Event->repeat () && Batched)
+    {
+        // adjust repeat count
+        Event->do_repeat ();
+
+        // callback is executed once the manager is done
+        Pending.push_back (std::make_pair (this, evnt));
+    }
+    else if (Method && Event->repeat ())
     {
         // event that triggered the script is 2nd argument of callback
         PyTuple_SetItem (Args, 1, python::pass_instance ((event*) evnt));
@@ -118,6 +177,51 @@ s_int32 listener_python::raise_event (const event* evnt)
     return Event->repeat ();
 }
 
+// execute pending batch callbacks
+void listener_python::dispatch_batches ()
+{
+    if (Pending.empty ()) return;
+
+    // callbacks may raise further events
+    std::vector<std::pair<listener_python*, const event*> > batch;
+    batch.swap (Pending);
+
+    // callbacks may also delete listeners of this batch
+    std::vector<std::pair<listener_python*, const event*> > *outer = Dispatching;
+    Dispatching = &batch;
+
+    std::vector<bool> done (batch.size (), false);
+    for (u_int32 i = 0; i < batch.size (); i++)
+    {
+        if (done[i] || batch[i].first == NULL || batch[i].first->Method == NULL) continue;
+        python::method *method = batch[i].first->Method;
+
+        // collect all events for the same callback
+        PyObject *events = PyList_New (0);
+        for (u_int32 j = i; j < batch.size (); j++)
+        {
+            if (done[j] || batch[j].first == NULL || batch[j].first->Method == NULL) continue;
+            if (!batch[j].first->Method->equals (*method)) continue;
+
+            PyObject *pair = PyTuple_New (2);
+            PyTuple_SET_ITEM (pair, 0, python::pass_instance (batch[j].first));
+            PyTuple_SET_ITEM (pair, 1, python::pass_instance ((event*) batch[j].second));
+            PyList_Append (events, pair);
+            Py_DECREF (pair);
+
+            done[j] = true;
+        }
+
+        // execute callback
+        PyObject *args = PyTuple_New (1);
+        PyTuple_SET_ITEM (args, 0, events);
+        method->execute (args);
+        Py_DECREF (args);
+    }
+
+    Dispatching = outer;
+}
+
 // save the state of the script associated with the event
 void listener_python::put_state (base::flat & file) const
 {
@@ -134,7 +238,8 @@ void listener_python::put_state (base::flat & file) const
     if (Method != NULL)
     {
         Method->put_state (record);
-        python::put_tuple (Args, record, 2);
+        record.put_bool ("lbt", Batched);
+        if (!Batched) python::put_tuple (Args, record, 2);
     }
     
     file.put_flat ("", record);
@@ -155,8 +260,13 @@ bool listener_python::get_state (base::flat & file)
             return false;
         }
         
-        Args = python::get_tuple (file, 2);
-        PyTuple_SET_ITEM (Args, 0, python::pass_instance (this));
+        // older saves do not know about batches
+        Batched = file.get_bool ("lbt", true);
+        if (!Batched)
+        {
+            Args = python::get_tuple (file, 2);
+            PyTuple_SET_ITEM (Args, 0, python::pass_instance (this));
+        }
     }
 
     return file.success ();
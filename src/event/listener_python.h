@@ -28,6 +28,7 @@
 #ifndef EVENT_LISTENER_PYTHON_H
 #define EVENT_LISTENER_PYTHON_H
 
+#include <vector>
 #include "listener.h"
 #include <adonthell/python/method.h>
 
@@ -73,6 +74,19 @@ namespace events
          */
         bool connect_callback (const string & file, const string & classname, 
                                        const string & callback, PyObject *args = NULL);
+
+        /**
+         * Sets a python method to be executed with all events that
+         * occured during one sweep of the %event %manager. The method
+         * is called with a list of (%listener, %event) tuples.
+         *
+         * @param file Name of the script to load.
+         * @param classname Name of the class containing the callback.
+         * @param callback Name of the method to call.
+         * @return \b false if connecting the callback failed, \b true otherwise.
+         */
+        bool connect_batch_callback (const string & file, const string & classname,
+                                     const string & callback);
         
 #ifndef SWIG
         /**
@@ -91,6 +105,16 @@ namespace events
          * @return The number of times the %event needs to be repeated.
          */ 
         s_int32 raise_event (const event* evnt);
+
+#ifndef SWIG
+        /**
+         * Execute the batch callbacks of all listeners raised since
+         * the last call. Listeners sharing the same callback are
+         * passed to it in a single list. Called by the %event %manager
+         * after each sweep.
+         */
+        static void dispatch_batches ();
+#endif // SWIG
         //@}
 
         /**
@@ -129,6 +153,25 @@ namespace events
         * Arguments to pass to the method
          */
         PyObject *Args;
+
+        /**
+         * Whether the callback is passed all events of a sweep at once
+         */
+        bool Batched;
+
+#ifndef SWIG
+        /**
+         * Batched listeners raised since the last dispatch, with the
+         * event that raised them
+         */
+        static std::vector<std::pair<listener_python*, const event*> > Pending;
+
+        /**
+         * Batch currently dispatched, if any. Listeners deleted by
+         * a callback remove themselves from it.
+         */
+        static std::vector<std::pair<listener_python*, const event*> > *Dispatching;
+#endif // SWIG
     };
 }
 
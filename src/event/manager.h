@@ -31,6 +31,7 @@
 
 #include "factory.h"
 #include "manager_base.h"
+#include "listener_python.h"
 
 namespace events
 {
@@ -57,6 +58,7 @@ namespace events
     
         /** 
          * Check if an %event corresponding to ev exists, and execute it. 
+         * Batch callbacks of the listeners raised are executed afterwards.
          * 
          * @param ev %event to raise.
          */
@@ -66,6 +68,7 @@ namespace events
             if (manager != NULL)
             {
                 manager->raise_event (ev);
+                listener_python::dispatch_batches ();
             }
         }
     
@@ -26,8 +26,10 @@
  * @brief 	Implements the time_event_manager class.
  */
 
+#include <adonthell/base/profiler.h>
 #include "time_event_manager.h"
 #include "time_event.h"
+#include "listener_python.h"
 #include "date.h"
 #include <algorithm>
 
@@ -48,8 +50,11 @@ time_event_manager::time_event_manager () : manager_base (&new_time_event)
 // according script(s) 
 void time_event_manager::raise_event (const event * e)
 {
+    PROFILE_ZONE ("time_event_manager::raise_event");
+
     s_int32 repeat;
     listener *li;
+    std::vector<listener*> expired;
     
     // As long as matching events are in the list
     while (!Listeners.empty () && (li = Listeners.back ())->equals (e))
@@ -63,7 +68,15 @@ void time_event_manager::raise_event (const event * e)
 
         // only re-register listener if time event is repeating
         if (repeat) add (li);
-        else delete li;
+        else expired.push_back (li);
+    }
+
+    // batch callbacks still need the expired listeners
+    listener_python::dispatch_batches ();
+
+    for (std::vector<listener*>::iterator i = expired.begin (); i != expired.end (); i++)
+    {
+        delete *i;
     }
     
     return;
@@ -28,7 +28,9 @@
  */
 
 
+#include <algorithm>
 #include "drawable.h"
+#include "screen.h"
 
 // Public methods.
 
@@ -48,5 +50,27 @@ namespace gfx
     {
         return true; 
     }
+
+    // remember position on screen
+    void drawable::drawn_at (const s_int16 & x, const s_int16 & y, const gfx::surface * target) const
+    {
+        if (!screen::damage_tracking()) return;
+        if (target != NULL && target != screen::get_surface()) return;
+
+        DrawnArea.move (x, y);
+        DrawnArea.resize (length(), height());
+    }
+
+    // report position on screen as changed
+    void drawable::invalidate () const
+    {
+        if (DrawnArea.length() && DrawnArea.height())
+        {
+            // the object might have grown since it was drawn
+            drawing_area area (DrawnArea.x(), DrawnArea.y(),
+                std::max (DrawnArea.length(), length()), std::max (DrawnArea.height(), height()));
+            screen::invalidate (area);
+        }
+    }
     
 }
@@ -119,6 +119,40 @@ namespace gfx
                            gfx::surface * target = NULL) const = 0;
 
     protected:
+        /**
+         * @name Damage tracking
+         * While the %screen tracks damage, drawables that change their
+         * appearance report the area they occupy on %screen as changed,
+         * so that only this area needs to be redrawn.
+         */
+        //@{
+        /**
+         * Remember where the object has been drawn, if drawn on the
+         * %screen. Implementations of draw() call this with their
+         * unclipped position.
+         * @param x X position where the object has been drawn.
+         * @param y Y position where the object has been drawn.
+         * @param target surface the object has been drawn to.
+         */
+        void drawn_at (const s_int16 & x, const s_int16 & y, const gfx::surface * target) const;
+
+        /**
+         * Report the area the object has last been drawn to as changed.
+         * Does nothing if the object has never been drawn on %screen.
+         * Objects drawn as part of another one may override this to
+         * report the change to their container as well.
+         */
+        virtual void invalidate () const;
+
+        /**
+         * Return the area the object has last been drawn to.
+         * @return area on %screen, empty if never drawn there.
+         */
+        const drawing_area & drawn_area () const
+        {
+            return DrawnArea;
+        }
+        //@}
     
         /** 
          * Sets the length of the drawable.
@@ -149,6 +183,8 @@ namespace gfx
         u_int16 Length; 
         /// height of the image
         u_int16 Height; 
+        /// area of the %screen the object has last been drawn to
+        mutable drawing_area DrawnArea;
     };
 
 }
@@ -32,6 +32,7 @@
 #include <adonthell/base/paths.h>
 #include "gfx.h"
 #include "surface_cacher.h"
+#include "image_pack.h"
 
 /**
  * The handler of our library file.
@@ -137,6 +138,9 @@ namespace gfx
             goto bigerror;
         }
         
+        // optional, as not every backend can preserve screen contents
+        screen::set_damage_tracking_p = (bool (*)(bool)) lt_dlsym(dlhandle, "gfx_screen_set_damage_tracking");
+
         create_surface_p = (surface *(*)()) lt_dlsym(dlhandle, "gfx_create_surface");
         if (!create_surface_p)
         {
@@ -159,7 +163,10 @@ namespace gfx
     void setup (base::configuration & cfg)
     {
     	screen::setup(cfg);
-        
+
+        // use pre-decoded images, if available
+        image_pack::mount ();
+
         if (!(surfaces = new surface_cacher()))
         {
             LOG(ERROR) << logging::indent() << "Unable to create a surface cacher";
@@ -167,6 +174,12 @@ namespace gfx
         }
 
         surfaces->set_max_mem (cfg.get_int("Video", "CacheSize", DEFAULT_CACHE_SIZE));
+        surfaces->set_max_texture_mem (cfg.get_int("Video", "TextureCacheSize", DEFAULT_TEXTURE_CACHE_SIZE));
+
+        // decode images in the background
+        surfaces->set_upload_rate (cfg.get_int("Video", "UploadRate", DEFAULT_UPLOAD_SIZE));
+        surfaces->set_async_loading (cfg.get_int("Video", "AsyncLoading", 0) == 1);
+        cfg.option ("Video", "AsyncLoading", base::cfg_option::BOOL);
     }
 
     // shutdown gfx
@@ -174,7 +187,9 @@ namespace gfx
     {
     	delete surfaces;
         surfaces = NULL;
-        
+
+        image_pack::unmount_all ();
+
         if (gfxcleanup) gfxcleanup();
         gfxcleanup = NULL;
 
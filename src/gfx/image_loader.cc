@@ -0,0 +1,165 @@
+/*
+   Copyright (C) 2011 Kai Sterker <kai.sterker@gmail.com>
+   Part of the Adonthell Project http://adonthell.linuxgames.com
+
+   Adonthell is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 2 of the License, or
+   (at your option) any later version.
+
+   Adonthell is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with Adonthell; if not, write to the Free Software
+   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+*/
+
+/**
+ * @file   gfx/image_loader.cc
+ * @author Kai Sterker <kai.sterker@gmail.com>
+ *
+ * @brief  Defines the image_loader class.
+ *
+ *
+ */
+
+#include <cstdlib>
+#include <fstream>
+
+#include <adonthell/base/logging.h>
+#include <adonthell/base/profiler.h>
+#include "image_loader.h"
+#include "png_wrapper.h"
+
+namespace gfx
+{
+    // ctor
+    image_loader::image_loader () : Stop (false), Busy (0), NextTicket (1)
+    {
+        Thread = new std::thread (&image_loader::run, this);
+    }
+
+    // dtor
+    image_loader::~image_loader ()
+    {
+        {
+            std::lock_guard<std::mutex> guard (Lock);
+            Stop = true;
+        }
+
+        Wakeup.notify_one ();
+        Thread->join ();
+        delete Thread;
+
+        for (std::list<job>::iterator i = Finished.begin (); i != Finished.end (); i++)
+        {
+            free (i->Pixels);
+        }
+    }
+
+    // queue image for decoding
+    u_int32 image_loader::add (const std::string & path)
+    {
+        job j;
+        j.Path = path;
+        j.Pixels = NULL;
+        j.Length = 0;
+        j.Height = 0;
+        j.Alpha = false;
+
+        {
+            std::lock_guard<std::mutex> guard (Lock);
+            j.Ticket = NextTicket++;
+
+            // 0 is never a valid ticket
+            if (NextTicket == 0) NextTicket = 1;
+            Queue.push_back (j);
+        }
+
+        Wakeup.notify_one ();
+        return j.Ticket;
+    }
+
+    // drop request not yet decoded
+    void image_loader::cancel (const u_int32 & ticket)
+    {
+        std::lock_guard<std::mutex> guard (Lock);
+        for (std::list<job>::iterator i = Queue.begin (); i != Queue.end (); i++)
+        {
+            if (i->Ticket == ticket)
+            {
+                Queue.erase (i);
+                return;
+            }
+        }
+    }
+
+    // retrieve decoded image
+    bool image_loader::get_finished (job & result)
+    {
+        std::lock_guard<std::mutex> guard (Lock);
+        if (Finished.empty ()) return false;
+
+        result = Finished.front ();
+        Finished.pop_front ();
+        return true;
+    }
+
+    // number of outstanding requests
+    u_int32 image_loader::pending ()
+    {
+        std::lock_guard<std::mutex> guard (Lock);
+        return Queue.size () + Finished.size () + (Busy != 0);
+    }
+
+    // worker thread
+    void image_loader::run ()
+    {
+        std::unique_lock<std::mutex> guard (Lock);
+        while (true)
+        {
+            while (!Stop && Queue.empty ())
+            {
+                Wakeup.wait (guard);
+            }
+
+            if (Stop) break;
+
+            job j = Queue.front ();
+            Queue.pop_front ();
+            Busy = j.Ticket;
+
+            // decode without holding the lock
+            guard.unlock ();
+            decode (j);
+            guard.lock ();
+
+            Busy = 0;
+            Finished.push_back (j);
+        }
+    }
+
+    // decode image
+    void image_loader::decode (job & j)
+    {
+        PROFILE_ZONE ("image_loader::decode");
+
+        std::ifstream file (j.Path.c_str (), std::ifstream::binary);
+        if (!file.is_open ())
+        {
+            LOG(ERROR) << "*** image_loader::decode: unable to open '" << j.Path << "'";
+            return;
+        }
+
+        j.Pixels = png::get (file, j.Length, j.Height, &j.Alpha);
+        file.close ();
+
+        if (j.Pixels == NULL)
+        {
+            LOG(ERROR) << "*** image_loader::decode: failed opening '" << j.Path << "'";
+        }
+    }
+}
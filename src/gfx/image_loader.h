@@ -0,0 +1,144 @@
+/*
+   Copyright (C) 2011 Kai Sterker <kai.sterker@gmail.com>
+   Part of the Adonthell Project http://adonthell.linuxgames.com
+
+   Adonthell is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 2 of the License, or
+   (at your option) any later version.
+
+   Adonthell is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with Adonthell; if not, write to the Free Software
+   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+*/
+
+/**
+ * @file   gfx/image_loader.h
+ * @author Kai Sterker <kai.sterker@gmail.com>
+ *
+ * @brief  Declares the image_loader class.
+ *
+ *
+ */
+
+#ifndef GFX_IMAGE_LOADER_H
+#define GFX_IMAGE_LOADER_H
+
+#include <list>
+#include <string>
+#include <mutex>
+#include <thread>
+#include <condition_variable>
+
+#include <adonthell/base/types.h>
+
+namespace gfx
+{
+    /**
+     * Decodes PNG images on a background thread. Decoding only
+     * touches plain memory, so it can happen in parallel to the
+     * game. Turning the decoded pixels into a
+     * surface has to happen on the main thread, as most backends
+     * cannot create textures from other threads.
+     *
+     * Images are decoded in the order they have been requested.
+     */
+    class image_loader
+    {
+    public:
+        /**
+         * An image to decode.
+         */
+        struct job
+        {
+            /// id of the request
+            u_int32 Ticket;
+            /// full path of the PNG file
+            std::string Path;
+            /// decoded pixels, allocated with malloc, or NULL on failure
+            void *Pixels;
+            /// length of the decoded image
+            u_int16 Length;
+            /// height of the decoded image
+            u_int16 Height;
+            /// whether pixels are RGBA or RGB
+            bool Alpha;
+        };
+
+        /**
+         * Create loader and start its worker thread.
+         */
+        image_loader ();
+
+        /**
+         * Stop worker thread and discard pending images.
+         */
+        ~image_loader ();
+
+        /**
+         * Request decoding of the given PNG file.
+         * @param path full path of the file.
+         * @return ticket to identify the decoded image later on.
+         */
+        u_int32 add (const std::string & path);
+
+        /**
+         * Drop the given request if it has not been decoded yet.
+         * @param ticket the request to drop.
+         */
+        void cancel (const u_int32 & ticket);
+
+        /**
+         * Get the next decoded image, if any. The caller takes
+         * ownership of the image's pixels.
+         * @param result will receive the decoded image.
+         * @return \b true if an image has been returned, \b false otherwise.
+         */
+        bool get_finished (job & result);
+
+        /**
+         * Get number of images not yet retrieved with get_finished.
+         * @return number of outstanding requests.
+         */
+        u_int32 pending ();
+
+    private:
+        /// forbid copy construction
+        image_loader (const image_loader & l);
+
+        /**
+         * Decode requested images until the loader is destroyed.
+         */
+        void run ();
+
+        /**
+         * Decode a single image.
+         * @param j the request, receiving the decoded image.
+         */
+        static void decode (job & j);
+
+        /// images waiting to be decoded
+        std::list<job> Queue;
+        /// images decoded, but not yet retrieved
+        std::list<job> Finished;
+        /// protects the queues
+        std::mutex Lock;
+        /// signals new requests to the worker
+        std::condition_variable Wakeup;
+        /// whether the worker thread should terminate
+        bool Stop;
+        /// request currently decoded, or 0
+        u_int32 Busy;
+        /// id of the next request
+        u_int32 NextTicket;
+        /// the thread decoding images
+        std::thread *Thread;
+    };
+}
+
+#endif
@@ -0,0 +1,403 @@
+/*
+ Copyright (C) 2011 Kai Sterker <kai.sterker@gmail.com>
+ Part of the Adonthell Project http://adonthell.linuxgames.com
+
+ Adonthell is free software; you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation; either version 2 of the License, or
+ (at your option) any later version.
+
+ Adonthell is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with Adonthell; if not, write to the Free Software
+ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+/**
+ * @file   gfx/image_pack.cc
+ * @author Kai Sterker <kai.sterker@gmail.com>
+ *
+ * @brief  Defines the image_pack class.
+ *
+ *
+ */
+
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#ifndef WIN32
+#include <sys/mman.h>
+#endif
+
+#include <adonthell/base/base.h>
+#include <adonthell/base/endians.h>
+#include <adonthell/base/logging.h>
+
+#ifdef HAVE_LZ4_H
+#include <lz4.h>
+#endif
+
+#include "image_pack.h"
+#include "png_wrapper.h"
+#include "surface.h"
+
+using gfx::image_pack;
+
+/// identifies an image pack
+#define PACK_MAGIC "AIPK"
+/// current version of the file format
+#define PACK_VERSION 1
+/// size of the file header
+#define PACK_HEADER_SIZE 16
+/// image data is LZ4 compressed
+#define PACK_LZ4 1
+
+/// packs searched by load_image
+std::vector<image_pack*> image_pack::Mounted;
+
+// read little endian value from unaligned memory
+static u_int32 read_uint32 (const char *data)
+{
+    u_int32 value;
+    memcpy (&value, data, 4);
+    return SwapLE32 (value);
+}
+
+// read little endian value from unaligned memory
+static u_int16 read_uint16 (const char *data)
+{
+    u_int16 value;
+    memcpy (&value, data, 2);
+    return SwapLE16 (value);
+}
+
+// write little endian value to file
+static void write_uint32 (std::ofstream & file, u_int32 value)
+{
+    value = SwapLE32 (value);
+    file.write ((const char*) &value, 4);
+}
+
+// write little endian value to file
+static void write_uint16 (std::ofstream & file, u_int16 value)
+{
+    value = SwapLE16 (value);
+    file.write ((const char*) &value, 2);
+}
+
+// ctor
+image_pack::image_pack () : Data (NULL), Size (0)
+{
+}
+
+// dtor
+image_pack::~image_pack ()
+{
+    close ();
+}
+
+// map pack into memory
+bool image_pack::open (const std::string & file)
+{
+    struct stat statbuf;
+
+    close ();
+
+    int fd = ::open (file.c_str (), O_RDONLY);
+    if (fd == -1 || fstat (fd, &statbuf) == -1 || statbuf.st_size < PACK_HEADER_SIZE)
+    {
+        LOG(ERROR) << "*** image_pack::open: cannot read '" << file << "'";
+        if (fd != -1) ::close (fd);
+        return false;
+    }
+
+    Size = statbuf.st_size;
+
+#ifndef WIN32
+    void *data = mmap (NULL, Size, PROT_READ, MAP_SHARED, fd, 0);
+    ::close (fd);
+
+    if (data == MAP_FAILED)
+    {
+        LOG(ERROR) << "*** image_pack::open: cannot map '" << file << "'";
+        Size = 0;
+        return false;
+    }
+
+    Data = (const char*) data;
+#else
+    char *data = new char[Size];
+    bool read_ok = read (fd, data, Size) == (int) Size;
+    ::close (fd);
+
+    Data = data;
+    if (!read_ok)
+    {
+        LOG(ERROR) << "*** image_pack::open: cannot read '" << file << "'";
+        close ();
+        return false;
+    }
+#endif
+
+    if (memcmp (Data, PACK_MAGIC, 4) != 0 || read_uint32 (Data + 4) != PACK_VERSION)
+    {
+        LOG(ERROR) << "*** image_pack::open: '" << file << "' is not a supported image pack";
+        close ();
+        return false;
+    }
+
+    u_int32 count = read_uint32 (Data + 8);
+    const char *pos = Data + read_uint32 (Data + 12);
+    const char *end = Data + Size;
+
+    // read index
+    for (u_int32 i = 0; i < count; i++)
+    {
+        if (pos + 16 > end || pos + 16 + read_uint16 (pos + 14) > end)
+        {
+            LOG(ERROR) << "*** image_pack::open: index of '" << file << "' is corrupt";
+            close ();
+            return false;
+        }
+
+        entry e;
+        e.Offset = read_uint32 (pos);
+        e.Size = read_uint32 (pos + 4);
+        e.Length = read_uint16 (pos + 8);
+        e.Height = read_uint16 (pos + 10);
+        e.BytesPerPixel = pos[12];
+        e.Flags = pos[13];
+
+        if (e.Offset > Size || e.Size > Size - e.Offset)
+        {
+            LOG(ERROR) << "*** image_pack::open: index of '" << file << "' is corrupt";
+            close ();
+            return false;
+        }
+
+        Index[std::string (pos + 16, read_uint16 (pos + 14))] = e;
+        pos += 16 + read_uint16 (pos + 14);
+    }
+
+    VLOG(1) << "Opened image pack '" << file << "' with " << count << " images";
+    return true;
+}
+
+// unmap pack
+void image_pack::close ()
+{
+    if (Data != NULL)
+    {
+#ifndef WIN32
+        munmap ((void*) Data, Size);
+#else
+        delete[] Data;
+#endif
+        Data = NULL;
+    }
+
+    Size = 0;
+    Index.clear ();
+}
+
+// upload image into surface
+bool image_pack::load (const std::string & name, surface *target) const
+{
+    std::hash_map<std::string, entry>::const_iterator i = Index.find (name);
+    if (i == Index.end ()) return false;
+
+    const entry & e = i->second;
+    const char *pixels = Data + e.Offset;
+    u_int32 size = e.Length * e.Height * e.BytesPerPixel;
+    char *buffer = NULL;
+
+    if (e.Flags & PACK_LZ4)
+    {
+#ifdef HAVE_LZ4_H
+        buffer = (char*) malloc (size);
+        if (LZ4_decompress_safe (pixels, buffer, e.Size, size) != (int) size)
+        {
+            LOG(ERROR) << "*** image_pack::load: failed to decompress '" << name << "'";
+            free (buffer);
+            return false;
+        }
+        pixels = buffer;
+#else
+        LOG(ERROR) << "*** image_pack::load: cannot load '" << name << "', LZ4 support not compiled in";
+        return false;
+#endif
+    }
+    else if (e.Size != size)
+    {
+        LOG(ERROR) << "*** image_pack::load: size mismatch for '" << name << "'";
+        return false;
+    }
+
+    target->clear ();
+    target->set_pixels (pixels, e.Length, e.Height, e.BytesPerPixel == 4);
+
+    free (buffer);
+    return true;
+}
+
+// mount pack from data directory
+bool image_pack::mount (const std::string & name)
+{
+    std::string path = name;
+    if (!base::Paths().find_in_data_path (path, false))
+    {
+        return false;
+    }
+
+    image_pack *pack = new image_pack ();
+    if (!pack->open (path))
+    {
+        delete pack;
+        return false;
+    }
+
+    Mounted.push_back (pack);
+    return true;
+}
+
+// close all packs
+void image_pack::unmount_all ()
+{
+    for (std::vector<image_pack*>::iterator i = Mounted.begin (); i != Mounted.end (); i++)
+    {
+        delete *i;
+    }
+
+    Mounted.clear ();
+}
+
+// load image from mounted packs
+bool image_pack::load_image (const std::string & name, surface *target)
+{
+    for (std::vector<image_pack*>::const_iterator i = Mounted.begin (); i != Mounted.end (); i++)
+    {
+        if ((*i)->load (name, target)) return true;
+    }
+
+    return false;
+}
+
+// check mounted packs for image
+bool image_pack::is_packed (const std::string & name)
+{
+    for (std::vector<image_pack*>::const_iterator i = Mounted.begin (); i != Mounted.end (); i++)
+    {
+        if ((*i)->contains (name)) return true;
+    }
+
+    return false;
+}
+
+// build pack from png files
+bool image_pack::create (const std::string & file, const std::string & root,
+                         const std::vector<std::string> & images, const bool & compress)
+{
+    std::ofstream pack (file.c_str (), std::ios::binary | std::ios::trunc);
+    if (!pack.is_open ())
+    {
+        LOG(ERROR) << "*** image_pack::create: cannot create '" << file << "'";
+        return false;
+    }
+
+#ifndef HAVE_LZ4_H
+    if (compress)
+    {
+        LOG(WARNING) << "*** image_pack::create: LZ4 support not compiled in, images will not be compressed";
+    }
+#endif
+
+    std::vector<std::string> names;
+    std::vector<entry> entries;
+
+    // header, with index location filled in later
+    pack.write (PACK_MAGIC, 4);
+    write_uint32 (pack, PACK_VERSION);
+    write_uint32 (pack, 0);
+    write_uint32 (pack, 0);
+
+    for (std::vector<std::string>::const_iterator i = images.begin (); i != images.end (); i++)
+    {
+        std::ifstream png_file ((root + "/" + *i).c_str (), std::ifstream::binary);
+        if (!png_file.is_open ())
+        {
+            LOG(ERROR) << "*** image_pack::create: cannot open '" << *i << "'";
+            continue;
+        }
+
+        entry e;
+        bool alpha = false;
+        char *pixels = (char*) png::get (png_file, e.Length, e.Height, &alpha);
+        if (pixels == NULL)
+        {
+            LOG(ERROR) << "*** image_pack::create: cannot decode '" << *i << "'";
+            continue;
+        }
+
+        e.BytesPerPixel = alpha ? 4 : 3;
+        e.Size = e.Length * e.Height * e.BytesPerPixel;
+        e.Offset = pack.tellp ();
+        e.Flags = 0;
+
+#ifdef HAVE_LZ4_H
+        if (compress)
+        {
+            int bound = LZ4_compressBound (e.Size);
+            char *compressed = (char*) malloc (bound);
+            int size = LZ4_compress_default (pixels, compressed, e.Size, bound);
+
+            // only keep compressed data if it actually saves space
+            if (size > 0 && (u_int32) size < e.Size)
+            {
+                free (pixels);
+                pixels = compressed;
+                e.Size = size;
+                e.Flags |= PACK_LZ4;
+            }
+            else
+            {
+                free (compressed);
+            }
+        }
+#endif
+
+        pack.write (pixels, e.Size);
+        free (pixels);
+
+        names.push_back (*i);
+        entries.push_back (e);
+    }
+
+    // write index
+    u_int32 index = pack.tellp ();
+    for (u_int32 i = 0; i < entries.size (); i++)
+    {
+        write_uint32 (pack, entries[i].Offset);
+        write_uint32 (pack, entries[i].Size);
+        write_uint16 (pack, entries[i].Length);
+        write_uint16 (pack, entries[i].Height);
+        pack.put (entries[i].BytesPerPixel);
+        pack.put (entries[i].Flags);
+        write_uint16 (pack, names[i].length ());
+        pack.write (names[i].c_str (), names[i].length ());
+    }
+
+    // complete header
+    pack.seekp (8);
+    write_uint32 (pack, entries.size ());
+    write_uint32 (pack, index);
+
+    pack.close ();
+    return !pack.fail () && entries.size () == images.size ();
+}
@@ -0,0 +1,191 @@
+/*
+ Copyright (C) 2011 Kai Sterker <kai.sterker@gmail.com>
+ Part of the Adonthell Project http://adonthell.linuxgames.com
+
+ Adonthell is free software; you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation; either version 2 of the License, or
+ (at your option) any later version.
+
+ Adonthell is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with Adonthell; if not, write to the Free Software
+ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+/**
+ * @file   gfx/image_pack.h
+ * @author Kai Sterker <kai.sterker@gmail.com>
+ *
+ * @brief  Declares the image_pack class.
+ *
+ *
+ */
+
+#ifndef GFX_IMAGE_PACK_H
+#define GFX_IMAGE_PACK_H
+
+#include <string>
+#include <vector>
+#include <adonthell/base/hash_map.h>
+#include <adonthell/base/types.h>
+
+/// name of the image pack loaded at startup, if present
+#define IMAGE_PACK_FILE "gfx.pak"
+
+namespace gfx
+{
+    class surface;
+
+    /**
+     * An image pack is a single file holding many images in decoded
+     * form, so that they can be uploaded into a surface without
+     * the cost of decoding PNG files. The file is mapped into memory
+     * and images are read straight from the mapping. Optionally,
+     * images are LZ4 compressed, if support for it has been compiled in.
+     *
+     * Image packs are built offline from the PNG files in the game's data
+     * directory. At runtime, surface::load_png will take images from the
+     * mounted packs, unless the image is overridden by a file in the user
+     * data or saved game directory.
+     *
+     * The file format is the following. All numbers are little endian.
+     *
+     * <pre>
+     * header: magic "AIPK" | version (u_int32) | number of images (u_int32) |
+     *         offset of index (u_int32)
+     * data:   pixels of each image, as returned by png::get
+     * index:  for each image:
+     *           offset (u_int32) | stored size (u_int32) | length (u_int16) |
+     *           height (u_int16) | bytes per pixel (u_int8) | flags (u_int8) |
+     *           name length (u_int16) | name
+     * </pre>
+     */
+    class image_pack
+    {
+    public:
+        /**
+         * Create an empty image pack.
+         */
+        image_pack ();
+
+        /**
+         * Destructor. Unmaps the pack file.
+         */
+        ~image_pack ();
+
+        /**
+         * Map the given pack file into memory and read its index.
+         * @param file full path of the pack file.
+         * @return \b true on success, \b false otherwise.
+         */
+        bool open (const std::string & file);
+
+        /**
+         * Unmap the pack file.
+         */
+        void close ();
+
+        /**
+         * Check whether the pack contains the given image.
+         * @param name path of the image relative to the data directory.
+         * @return \b true if the image is in the pack, \b false otherwise.
+         */
+        bool contains (const std::string & name) const
+        {
+            return Index.find (name) != Index.end ();
+        }
+
+        /**
+         * Upload the given image into a surface.
+         * @param name path of the image relative to the data directory.
+         * @param target surface to receive the image.
+         * @return \b true on success, \b false if image is not in the pack.
+         */
+        bool load (const std::string & name, surface *target) const;
+
+        /**
+         * @name Mounted packs
+         */
+        //@{
+        /**
+         * Open a pack found in the game's data directory and use it
+         * for loading images. It is not an error if the pack does
+         * not exist.
+         * @param name name of the pack file.
+         * @return \b true if the pack has been mounted, \b false otherwise.
+         */
+        static bool mount (const std::string & name = IMAGE_PACK_FILE);
+
+        /**
+         * Close all mounted packs.
+         */
+        static void unmount_all ();
+
+        /**
+         * Upload an image from any of the mounted packs into a surface.
+         * @param name path of the image relative to the data directory.
+         * @param target surface to receive the image.
+         * @return \b true on success, \b false if no pack contains the image.
+         */
+        static bool load_image (const std::string & name, surface *target);
+
+        /**
+         * Check whether any of the mounted packs contains the given image.
+         * @param name path of the image relative to the data directory.
+         * @return \b true if the image is in a pack, \b false otherwise.
+         */
+        static bool is_packed (const std::string & name);
+        //@}
+
+        /**
+         * Create an image pack from PNG files.
+         * @param file full path of the pack file to create.
+         * @param root directory the images are located in.
+         * @param images paths of the images, relative to root.
+         * @param compress whether to compress images with LZ4.
+         * @return \b true on success, \b false otherwise.
+         */
+        static bool create (const std::string & file, const std::string & root,
+                            const std::vector<std::string> & images, const bool & compress = false);
+
+    private:
+        /// forbid copy construction
+        image_pack (const image_pack & p);
+
+        /**
+         * Location of an image inside the pack.
+         */
+        struct entry
+        {
+            /// offset of pixel data from start of file
+            u_int32 Offset;
+            /// size of pixel data in the file
+            u_int32 Size;
+            /// length of the image
+            u_int16 Length;
+            /// height of the image
+            u_int16 Height;
+            /// number of bytes per pixel, 3 or 4
+            u_int8 BytesPerPixel;
+            /// whether pixel data is compressed
+            u_int8 Flags;
+        };
+
+        /// the memory mapped file
+        const char *Data;
+        /// size of the memory mapped file
+        u_int32 Size;
+        /// the images in the pack
+        std::hash_map<std::string, entry> Index;
+
+        /// packs searched by load_image
+        static std::vector<image_pack*> Mounted;
+    };
+}
+
+#endif
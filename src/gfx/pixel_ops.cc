@@ -0,0 +1,682 @@
+/*
+ Copyright (C) 2011 Kai Sterker <kai.sterker@gmail.com>
+ Part of the Adonthell Project http://adonthell.linuxgames.com
+
+ Adonthell is free software; you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation; either version 2 of the License, or
+ (at your option) any later version.
+
+ Adonthell is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with Adonthell; if not, write to the Free Software
+ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+/**
+ * @file   gfx/pixel_ops.cc
+ * @author Kai Sterker <kai.sterker@gmail.com>
+ *
+ * @brief  Defines the pixel_ops class.
+ *
+ *
+ */
+
+#include <cstring>
+#include <algorithm>
+#include "pixel_ops.h"
+
+// SIMD kernels are compiled with per-function target attributes and
+// picked at runtime, so they need GCC or clang on x86
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define PIXEL_OPS_X86 1
+#include <immintrin.h>
+#define TARGET_SSE2 __attribute__((target("sse2")))
+#define TARGET_AVX2 __attribute__((target("avx2")))
+#endif
+
+using gfx::pixel_ops;
+
+/// values for blurring R, G and B channels
+static const float kernel_rgb[] = { .056, .126, .201, .235, .201, .126, .056 };
+/// values for blurring alpha channel
+static const float kernel_a[]   = { .075, .18,  .3,   .35,  .3,   .18,  .075 };
+
+/// instruction set in use
+pixel_ops::instruction_set pixel_ops::Current = pixel_ops::best_instruction_set ();
+
+// ----------------------------------------------------------------------------
+// scalar kernels
+// ----------------------------------------------------------------------------
+
+/// color key that matches no pixel
+#define NO_KEY 0xFFFFFFFF
+
+// adjust brightness of given pixels
+static void brighten_scalar (u_int8 *rgba, u_int32 count, const s_int8 & mod, const u_int32 & key)
+{
+    for (; count > 0; count--, rgba += 4)
+    {
+        if (rgba[3] == 0) continue;
+        if ((*((u_int32*) rgba) & 0x00FFFFFF) == key) continue;
+
+        for (int c = 0; c < 3; c++)
+        {
+            int value = rgba[c] + mod;
+            rgba[c] = value > 255 ? 255 : (value < 0 ? 0 : value);
+        }
+    }
+}
+
+// blur a single pixel, with neighbours step bytes apart
+static void blur_pixel_scalar (u_int8 *dst, const u_int8 *src, const s_int32 & step, const int & kmin, const int & kmax)
+{
+    u_int8 r, g, b, a;
+    r = g = b = a = 0;
+
+    for (int k = kmin; k < kmax; k++)
+    {
+        const u_int8 *p = src + (k - 3) * step;
+        r = std::min ((int) (r + p[0] * kernel_rgb[k]), 0xFF);
+        g = std::min ((int) (g + p[1] * kernel_rgb[k]), 0xFF);
+        b = std::min ((int) (b + p[2] * kernel_rgb[k]), 0xFF);
+        a = std::min ((int) (a + p[3] * kernel_a[k]), 0xFF);
+    }
+
+    dst[0] = r;
+    dst[1] = g;
+    dst[2] = b;
+    dst[3] = a;
+}
+
+// scale up one row of 32 bit pixels
+static void scale_up_row32 (u_int32 *dst, const u_int32 *src, const u_int16 & length, const u_int32 & factor)
+{
+    for (u_int16 x = 0; x < length; x++)
+    {
+        for (u_int32 f = 0; f < factor; f++)
+        {
+            *dst++ = src[x];
+        }
+    }
+}
+
+// scale down one row of 32 bit pixels
+static void scale_down_row32 (u_int32 *dst, const u_int32 *src, const u_int16 & length, const u_int32 & factor)
+{
+    for (u_int32 x = factor / 2; x < length; x += factor)
+    {
+        *dst++ = src[x];
+    }
+}
+
+/// divide a value in the range of [0, 255*255] by 255, rounding to nearest
+#define DIV255(v) ((((v) + 128) + (((v) + 128) >> 8)) >> 8)
+
+// draw source pixels over target pixels
+static void blend_scalar (u_int8 *dst, const u_int8 *src, u_int32 count, const u_int8 & alpha, const bool & alpha_channel)
+{
+    for (; count > 0; count--, dst += 4, src += 4)
+    {
+        u_int32 a = alpha_channel ? DIV255(src[3] * alpha) : alpha;
+        u_int32 inv = 255 - a;
+
+        dst[0] = DIV255(src[0] * a + dst[0] * inv);
+        dst[1] = DIV255(src[1] * a + dst[1] * inv);
+        dst[2] = DIV255(src[2] * a + dst[2] * inv);
+        dst[3] = DIV255(255 * a + dst[3] * inv);
+    }
+}
+
+// copy all pixels that do not match the color key
+static void copy_keyed_scalar (u_int32 *dst, const u_int32 *src, u_int32 count, const u_int32 & key)
+{
+    for (; count > 0; count--, dst++, src++)
+    {
+        if ((*src & 0x00FFFFFF) != key) *dst = *src;
+    }
+}
+
+// ----------------------------------------------------------------------------
+// SSE2 kernels
+// ----------------------------------------------------------------------------
+
+#ifdef PIXEL_OPS_X86
+
+// adjust brightness of given pixels, 4 at a time
+TARGET_SSE2
+static void brighten_sse2 (u_int8 *rgba, u_int32 count, const s_int8 & mod, const u_int32 & key)
+{
+    // only color channels are modified
+    const u_int8 m = mod < 0 ? -mod : mod;
+    const __m128i delta = _mm_set1_epi32 (m | (m << 8) | (m << 16));
+    const __m128i alpha_mask = _mm_set1_epi32 (0xFF000000);
+    const __m128i color_mask = _mm_set1_epi32 (0x00FFFFFF);
+    const __m128i k = _mm_set1_epi32 (key);
+    const __m128i zero = _mm_setzero_si128 ();
+
+    for (; count >= 4; count -= 4, rgba += 16)
+    {
+        __m128i px = _mm_loadu_si128 ((const __m128i*) rgba);
+        __m128i adjusted = mod < 0 ? _mm_subs_epu8 (px, delta) : _mm_adds_epu8 (px, delta);
+
+        // keep fully transparent and masked pixels as they are
+        __m128i keep = _mm_or_si128 (_mm_cmpeq_epi32 (_mm_and_si128 (px, alpha_mask), zero),
+                                     _mm_cmpeq_epi32 (_mm_and_si128 (px, color_mask), k));
+        px = _mm_or_si128 (_mm_and_si128 (keep, px), _mm_andnot_si128 (keep, adjusted));
+
+        _mm_storeu_si128 ((__m128i*) rgba, px);
+    }
+
+    brighten_scalar (rgba, count, mod, key);
+}
+
+// blur a single pixel, with all 4 channels in one register
+TARGET_SSE2
+static void blur_pixel_sse2 (u_int8 *dst, const u_int8 *src, const s_int32 & step, const int & kmin, const int & kmax)
+{
+    const __m128i zero = _mm_setzero_si128 ();
+    const __m128 max = _mm_set1_ps (255.0f);
+    __m128 acc = _mm_setzero_ps ();
+
+    for (int k = kmin; k < kmax; k++)
+    {
+        s_int32 value;
+        memcpy (&value, src + (k - 3) * step, 4);
+
+        __m128i px = _mm_unpacklo_epi16 (_mm_unpacklo_epi8 (_mm_cvtsi32_si128 (value), zero), zero);
+        __m128 weight = _mm_set_ps (kernel_a[k], kernel_rgb[k], kernel_rgb[k], kernel_rgb[k]);
+
+        // same rounding as the scalar version: truncate after each step
+        acc = _mm_add_ps (acc, _mm_mul_ps (_mm_cvtepi32_ps (px), weight));
+        acc = _mm_min_ps (_mm_cvtepi32_ps (_mm_cvttps_epi32 (acc)), max);
+    }
+
+    __m128i result = _mm_cvttps_epi32 (acc);
+    result = _mm_packus_epi16 (_mm_packs_epi32 (result, zero), zero);
+
+    s_int32 value = _mm_cvtsi128_si32 (result);
+    memcpy (dst, &value, 4);
+}
+
+// scale up one row of 32 bit pixels by factor 2
+TARGET_SSE2
+static void scale_up_row32_x2_sse2 (u_int32 *dst, const u_int32 *src, const u_int16 & length)
+{
+    u_int16 x = 0;
+    for (; x + 4 <= length; x += 4, dst += 8)
+    {
+        __m128i px = _mm_loadu_si128 ((const __m128i*) (src + x));
+        _mm_storeu_si128 ((__m128i*) dst, _mm_unpacklo_epi32 (px, px));
+        _mm_storeu_si128 ((__m128i*) (dst + 4), _mm_unpackhi_epi32 (px, px));
+    }
+
+    scale_up_row32 (dst, src + x, length - x, 2);
+}
+
+// scale down one row of 32 bit pixels by factor 2
+TARGET_SSE2
+static void scale_down_row32_x2_sse2 (u_int32 *dst, const u_int32 *src, const u_int16 & length)
+{
+    // pick every odd pixel
+    u_int16 x = 0;
+    for (; x + 8 <= length; x += 8, dst += 4)
+    {
+        __m128 a = _mm_loadu_ps ((const float*) (src + x));
+        __m128 b = _mm_loadu_ps ((const float*) (src + x + 4));
+        _mm_storeu_ps ((float*) dst, _mm_shuffle_ps (a, b, _MM_SHUFFLE(3, 1, 3, 1)));
+    }
+
+    scale_down_row32 (dst, src + x, length - x, 2);
+}
+
+// draw 2 source pixels over 2 target pixels, with 16 bits per channel
+TARGET_SSE2
+static inline __m128i blend_px_sse2 (__m128i src, __m128i dst, const __m128i & alpha, const bool & alpha_channel)
+{
+    const __m128i opaque = _mm_set_epi16 (255, 0, 0, 0, 255, 0, 0, 0);
+    const __m128i max = _mm_set1_epi16 (255);
+    const __m128i half = _mm_set1_epi16 (128);
+
+    // spread alpha of each pixel over all its channels
+    __m128i a = alpha;
+    if (alpha_channel)
+    {
+        a = _mm_shufflehi_epi16 (_mm_shufflelo_epi16 (src, _MM_SHUFFLE(3, 3, 3, 3)), _MM_SHUFFLE(3, 3, 3, 3));
+        a = _mm_add_epi16 (_mm_mullo_epi16 (a, alpha), half);
+        a = _mm_srli_epi16 (_mm_add_epi16 (a, _mm_srli_epi16 (a, 8)), 8);
+    }
+
+    // resulting alpha channel is computed like the colors, with a source value of 255
+    src = _mm_or_si128 (src, opaque);
+
+    __m128i v = _mm_add_epi16 (_mm_mullo_epi16 (src, a), _mm_mullo_epi16 (dst, _mm_sub_epi16 (max, a)));
+    v = _mm_add_epi16 (v, half);
+    return _mm_srli_epi16 (_mm_add_epi16 (v, _mm_srli_epi16 (v, 8)), 8);
+}
+
+// draw source pixels over target pixels, 4 at a time
+TARGET_SSE2
+static void blend_sse2 (u_int8 *dst, const u_int8 *src, u_int32 count, const u_int8 & alpha, const bool & alpha_channel)
+{
+    const __m128i zero = _mm_setzero_si128 ();
+    const __m128i a = _mm_set1_epi16 (alpha);
+
+    for (; count >= 4; count -= 4, dst += 16, src += 16)
+    {
+        __m128i s = _mm_loadu_si128 ((const __m128i*) src);
+        __m128i d = _mm_loadu_si128 ((const __m128i*) dst);
+
+        __m128i lo = blend_px_sse2 (_mm_unpacklo_epi8 (s, zero), _mm_unpacklo_epi8 (d, zero), a, alpha_channel);
+        __m128i hi = blend_px_sse2 (_mm_unpackhi_epi8 (s, zero), _mm_unpackhi_epi8 (d, zero), a, alpha_channel);
+
+        _mm_storeu_si128 ((__m128i*) dst, _mm_packus_epi16 (lo, hi));
+    }
+
+    blend_scalar (dst, src, count, alpha, alpha_channel);
+}
+
+// copy all pixels that do not match the color key, 4 at a time
+TARGET_SSE2
+static void copy_keyed_sse2 (u_int32 *dst, const u_int32 *src, u_int32 count, const u_int32 & key)
+{
+    const __m128i color_mask = _mm_set1_epi32 (0x00FFFFFF);
+    const __m128i k = _mm_set1_epi32 (key);
+
+    for (; count >= 4; count -= 4, dst += 4, src += 4)
+    {
+        __m128i s = _mm_loadu_si128 ((const __m128i*) src);
+        __m128i d = _mm_loadu_si128 ((const __m128i*) dst);
+
+        __m128i masked = _mm_cmpeq_epi32 (_mm_and_si128 (s, color_mask), k);
+        d = _mm_or_si128 (_mm_and_si128 (masked, d), _mm_andnot_si128 (masked, s));
+
+        _mm_storeu_si128 ((__m128i*) dst, d);
+    }
+
+    copy_keyed_scalar (dst, src, count, key);
+}
+
+// ----------------------------------------------------------------------------
+// AVX2 kernels
+// ----------------------------------------------------------------------------
+
+// adjust brightness of given pixels, 8 at a time
+TARGET_AVX2
+static void brighten_avx2 (u_int8 *rgba, u_int32 count, const s_int8 & mod, const u_int32 & key)
+{
+    // only color channels are modified
+    const u_int8 m = mod < 0 ? -mod : mod;
+    const __m256i delta = _mm256_set1_epi32 (m | (m << 8) | (m << 16));
+    const __m256i alpha_mask = _mm256_set1_epi32 (0xFF000000);
+    const __m256i color_mask = _mm256_set1_epi32 (0x00FFFFFF);
+    const __m256i k = _mm256_set1_epi32 (key);
+    const __m256i zero = _mm256_setzero_si256 ();
+
+    for (; count >= 8; count -= 8, rgba += 32)
+    {
+        __m256i px = _mm256_loadu_si256 ((const __m256i*) rgba);
+        __m256i adjusted = mod < 0 ? _mm256_subs_epu8 (px, delta) : _mm256_adds_epu8 (px, delta);
+
+        // keep fully transparent and masked pixels as they are
+        __m256i keep = _mm256_or_si256 (_mm256_cmpeq_epi32 (_mm256_and_si256 (px, alpha_mask), zero),
+                                        _mm256_cmpeq_epi32 (_mm256_and_si256 (px, color_mask), k));
+        px = _mm256_blendv_epi8 (adjusted, px, keep);
+
+        _mm256_storeu_si256 ((__m256i*) rgba, px);
+    }
+
+    brighten_scalar (rgba, count, mod, key);
+}
+
+// blur two neighbouring pixels that use the same part of the kernel
+TARGET_AVX2
+static void blur_pixels_avx2 (u_int8 *dst, const u_int8 *src, const s_int32 & step, const int & kmin, const int & kmax)
+{
+    const __m256 max = _mm256_set1_ps (255.0f);
+    __m256 acc = _mm256_setzero_ps ();
+
+    for (int k = kmin; k < kmax; k++)
+    {
+        __m256i px = _mm256_cvtepu8_epi32 (_mm_loadl_epi64 ((const __m128i*) (src + (k - 3) * step)));
+        __m256 weight = _mm256_set_ps (kernel_a[k], kernel_rgb[k], kernel_rgb[k], kernel_rgb[k],
+                                       kernel_a[k], kernel_rgb[k], kernel_rgb[k], kernel_rgb[k]);
+
+        // same rounding as the scalar version: truncate after each step
+        acc = _mm256_add_ps (acc, _mm256_mul_ps (_mm256_cvtepi32_ps (px), weight));
+        acc = _mm256_min_ps (_mm256_cvtepi32_ps (_mm256_cvttps_epi32 (acc)), max);
+    }
+
+    __m256i result = _mm256_cvttps_epi32 (acc);
+    __m128i packed = _mm_packs_epi32 (_mm256_castsi256_si128 (result), _mm256_extracti128_si256 (result, 1));
+    _mm_storel_epi64 ((__m128i*) dst, _mm_packus_epi16 (packed, packed));
+}
+
+// draw 4 source pixels over 4 target pixels, with 16 bits per channel
+TARGET_AVX2
+static inline __m256i blend_px_avx2 (__m256i src, __m256i dst, const __m256i & alpha, const bool & alpha_channel)
+{
+    const __m256i opaque = _mm256_set_epi16 (255, 0, 0, 0, 255, 0, 0, 0, 255, 0, 0, 0, 255, 0, 0, 0);
+    const __m256i max = _mm256_set1_epi16 (255);
+    const __m256i half = _mm256_set1_epi16 (128);
+
+    // spread alpha of each pixel over all its channels
+    __m256i a = alpha;
+    if (alpha_channel)
+    {
+        a = _mm256_shufflehi_epi16 (_mm256_shufflelo_epi16 (src, _MM_SHUFFLE(3, 3, 3, 3)), _MM_SHUFFLE(3, 3, 3, 3));
+        a = _mm256_add_epi16 (_mm256_mullo_epi16 (a, alpha), half);
+        a = _mm256_srli_epi16 (_mm256_add_epi16 (a, _mm256_srli_epi16 (a, 8)), 8);
+    }
+
+    // resulting alpha channel is computed like the colors, with a source value of 255
+    src = _mm256_or_si256 (src, opaque);
+
+    __m256i v = _mm256_add_epi16 (_mm256_mullo_epi16 (src, a), _mm256_mullo_epi16 (dst, _mm256_sub_epi16 (max, a)));
+    v = _mm256_add_epi16 (v, half);
+    return _mm256_srli_epi16 (_mm256_add_epi16 (v, _mm256_srli_epi16 (v, 8)), 8);
+}
+
+// draw source pixels over target pixels, 8 at a time
+TARGET_AVX2
+static void blend_avx2 (u_int8 *dst, const u_int8 *src, u_int32 count, const u_int8 & alpha, const bool & alpha_channel)
+{
+    const __m256i zero = _mm256_setzero_si256 ();
+    const __m256i a = _mm256_set1_epi16 (alpha);
+
+    for (; count >= 8; count -= 8, dst += 32, src += 32)
+    {
+        __m256i s = _mm256_loadu_si256 ((const __m256i*) src);
+        __m256i d = _mm256_loadu_si256 ((const __m256i*) dst);
+
+        // unpacking and packing both work per 128 bit lane, so pixel order is kept
+        __m256i lo = blend_px_avx2 (_mm256_unpacklo_epi8 (s, zero), _mm256_unpacklo_epi8 (d, zero), a, alpha_channel);
+        __m256i hi = blend_px_avx2 (_mm256_unpackhi_epi8 (s, zero), _mm256_unpackhi_epi8 (d, zero), a, alpha_channel);
+
+        _mm256_storeu_si256 ((__m256i*) dst, _mm256_packus_epi16 (lo, hi));
+    }
+
+    blend_sse2 (dst, src, count, alpha, alpha_channel);
+}
+
+// copy all pixels that do not match the color key, 8 at a time
+TARGET_AVX2
+static void copy_keyed_avx2 (u_int32 *dst, const u_int32 *src, u_int32 count, const u_int32 & key)
+{
+    const __m256i color_mask = _mm256_set1_epi32 (0x00FFFFFF);
+    const __m256i k = _mm256_set1_epi32 (key);
+
+    for (; count >= 8; count -= 8, dst += 8, src += 8)
+    {
+        __m256i s = _mm256_loadu_si256 ((const __m256i*) src);
+        __m256i d = _mm256_loadu_si256 ((const __m256i*) dst);
+
+        __m256i masked = _mm256_cmpeq_epi32 (_mm256_and_si256 (s, color_mask), k);
+        _mm256_storeu_si256 ((__m256i*) dst, _mm256_blendv_epi8 (s, d, masked));
+    }
+
+    copy_keyed_sse2 (dst, src, count, key);
+}
+
+#endif // PIXEL_OPS_X86
+
+// ----------------------------------------------------------------------------
+// blur helpers
+// ----------------------------------------------------------------------------
+
+/// part of the kernel that lies inside an image of the given size
+#define KERNEL_MIN(pos, size) ((pos) < 4 ? 3 - (pos) : 0)
+#define KERNEL_MAX(pos, size) ((pos) > (size) - 4 ? (size) - (pos) + 3 : 7)
+
+// blur one row of the image
+static void blur_row (u_int8 *dst, const u_int8 *src, const int & length, const int & height, const int & y,
+    const bool & horizontal, const pixel_ops::instruction_set & set)
+{
+    const s_int32 step = horizontal ? 4 : length * 4;
+
+    for (int x = 0; x < length; x++)
+    {
+        int pos = horizontal ? x : y;
+        int size = horizontal ? length : height;
+        int kmin = KERNEL_MIN(pos, size);
+        int kmax = KERNEL_MAX(pos, size);
+
+#ifdef PIXEL_OPS_X86
+        if (set == pixel_ops::AVX2 && x + 1 < length)
+        {
+            // two pixels at a time, as long as both use the same kernel
+            int next = horizontal ? x + 1 : y;
+            if (KERNEL_MIN(next, size) == kmin && KERNEL_MAX(next, size) == kmax)
+            {
+                blur_pixels_avx2 (dst + x * 4, src + x * 4, step, kmin, kmax);
+                x++;
+                continue;
+            }
+        }
+
+        if (set != pixel_ops::SCALAR)
+        {
+            blur_pixel_sse2 (dst + x * 4, src + x * 4, step, kmin, kmax);
+            continue;
+        }
+#endif
+        blur_pixel_scalar (dst + x * 4, src + x * 4, step, kmin, kmax);
+    }
+}
+
+// ----------------------------------------------------------------------------
+// public interface
+// ----------------------------------------------------------------------------
+
+// detect CPU features
+pixel_ops::instruction_set pixel_ops::best_instruction_set ()
+{
+#ifdef PIXEL_OPS_X86
+    __builtin_cpu_init ();
+    if (__builtin_cpu_supports ("avx2")) return AVX2;
+    if (__builtin_cpu_supports ("sse2")) return SSE2;
+#endif
+    return SCALAR;
+}
+
+// select instruction set
+bool pixel_ops::use_instruction_set (const instruction_set & set)
+{
+    if (set > best_instruction_set ()) return false;
+
+    Current = set;
+    return true;
+}
+
+// get instruction set in use
+pixel_ops::instruction_set pixel_ops::current_instruction_set ()
+{
+    return Current;
+}
+
+// adjust brightness
+void pixel_ops::brighten (u_int8 *rgba, const u_int32 & count, const s_int8 & mod, const bool & masked, const u_int32 & key)
+{
+    if (mod == 0) return;
+
+    const u_int32 color = masked ? key & 0x00FFFFFF : NO_KEY;
+
+#ifdef PIXEL_OPS_X86
+    switch (Current)
+    {
+        case AVX2:
+            brighten_avx2 (rgba, count, mod, color);
+            return;
+        case SSE2:
+            brighten_sse2 (rgba, count, mod, color);
+            return;
+        default:
+            break;
+    }
+#endif
+
+    brighten_scalar (rgba, count, mod, color);
+}
+
+// gaussian blur
+void pixel_ops::blur (u_int8 *rgba, const u_int16 & length, const u_int16 & height, const bool & alpha)
+{
+    const u_int32 size = length * height * 4;
+    if (size == 0) return;
+
+    // each pass reads the unmodified result of the previous one
+    u_int8 *copy = new u_int8[size];
+
+    // smear horizontally
+    memcpy (copy, rgba, size);
+    for (int y = 0; y < height; y++)
+    {
+        u_int32 offset = y * length * 4;
+        blur_row (rgba + offset, copy + offset, length, height, y, true, Current);
+    }
+
+    // without alpha channel, the intermediate image is opaque
+    if (!alpha)
+    {
+        for (u_int32 i = 3; i < size; i += 4) rgba[i] = 0xFF;
+    }
+
+    // smear vertically
+    memcpy (copy, rgba, size);
+    for (int y = 0; y < height; y++)
+    {
+        u_int32 offset = y * length * 4;
+        blur_row (rgba + offset, copy + offset, length, height, y, false, Current);
+    }
+
+    delete[] copy;
+}
+
+// enlarge image
+void pixel_ops::scale_up (u_int8 *dst, const s_int32 & dst_pitch, const u_int8 *src, const s_int32 & src_pitch,
+                          const u_int16 & length, const u_int16 & height, const u_int8 & bpp, const u_int32 & factor)
+{
+    const u_int32 row_length = length * factor * bpp;
+
+    for (u_int16 y = 0; y < height; y++, src += src_pitch)
+    {
+        // scale one line horizontally
+        if (bpp == 4)
+        {
+#ifdef PIXEL_OPS_X86
+            if (factor == 2 && Current != SCALAR)
+                scale_up_row32_x2_sse2 ((u_int32*) dst, (const u_int32*) src, length);
+            else
+#endif
+            scale_up_row32 ((u_int32*) dst, (const u_int32*) src, length, factor);
+        }
+        else
+        {
+            u_int8 *target = dst;
+            for (u_int16 x = 0; x < length; x++)
+            {
+                for (u_int32 f = 0; f < factor; f++, target += bpp)
+                {
+                    memcpy (target, src + x * bpp, bpp);
+                }
+            }
+        }
+
+        // the next lines will be the same, so we just copy them
+        for (u_int32 f = 1; f < factor; f++, dst += dst_pitch)
+        {
+            memcpy (dst + dst_pitch, dst, row_length);
+        }
+
+        dst += dst_pitch;
+    }
+}
+
+// shrink image
+void pixel_ops::scale_down (u_int8 *dst, const s_int32 & dst_pitch, const u_int8 *src, const s_int32 & src_pitch,
+                            const u_int16 & length, const u_int16 & height, const u_int8 & bpp, const u_int32 & factor)
+{
+    for (u_int32 y = factor / 2; y < height; y += factor, dst += dst_pitch)
+    {
+        const u_int8 *row = src + y * src_pitch;
+
+        if (bpp == 4)
+        {
+#ifdef PIXEL_OPS_X86
+            if (factor == 2 && Current != SCALAR)
+                scale_down_row32_x2_sse2 ((u_int32*) dst, (const u_int32*) row, length);
+            else
+#endif
+            scale_down_row32 ((u_int32*) dst, (const u_int32*) row, length, factor);
+        }
+        else
+        {
+            u_int8 *target = dst;
+            for (u_int32 x = factor / 2; x < length; x += factor, target += bpp)
+            {
+                memcpy (target, row + x * bpp, bpp);
+            }
+        }
+    }
+}
+
+// draw pixels over other pixels
+void pixel_ops::blend (u_int8 *dst, const u_int8 *src, const u_int32 & count,
+                       const u_int8 & alpha, const bool & alpha_channel)
+{
+#ifdef PIXEL_OPS_X86
+    switch (Current)
+    {
+        case AVX2:
+            blend_avx2 (dst, src, count, alpha, alpha_channel);
+            return;
+        case SSE2:
+            blend_sse2 (dst, src, count, alpha, alpha_channel);
+            return;
+        default:
+            break;
+    }
+#endif
+
+    blend_scalar (dst, src, count, alpha, alpha_channel);
+}
+
+// copy pixels, skipping masked ones
+void pixel_ops::copy_keyed (u_int8 *dst, const u_int8 *src, const u_int32 & count, const u_int32 & key)
+{
+    const u_int32 color = key & 0x00FFFFFF;
+
+#ifdef PIXEL_OPS_X86
+    switch (Current)
+    {
+        case AVX2:
+            copy_keyed_avx2 ((u_int32*) dst, (const u_int32*) src, count, color);
+            return;
+        case SSE2:
+            copy_keyed_sse2 ((u_int32*) dst, (const u_int32*) src, count, color);
+            return;
+        default:
+            break;
+    }
+#endif
+
+    copy_keyed_scalar ((u_int32*) dst, (const u_int32*) src, count, color);
+}
+
+// divide color channels by alpha
+void pixel_ops::unpremultiply (u_int8 *rgba, const u_int32 & count)
+{
+    for (u_int32 i = count; i > 0; i--, rgba += 4)
+    {
+        const u_int32 a = rgba[3];
+        if (a == 0 || a == 255) continue;
+
+        rgba[0] = std::min (255u, (rgba[0] * 255 + a / 2) / a);
+        rgba[1] = std::min (255u, (rgba[1] * 255 + a / 2) / a);
+        rgba[2] = std::min (255u, (rgba[2] * 255 + a / 2) / a);
+    }
+}
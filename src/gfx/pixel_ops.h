@@ -0,0 +1,178 @@
+/*
+ Copyright (C) 2011 Kai Sterker <kai.sterker@gmail.com>
+ Part of the Adonthell Project http://adonthell.linuxgames.com
+
+ Adonthell is free software; you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation; either version 2 of the License, or
+ (at your option) any later version.
+
+ Adonthell is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with Adonthell; if not, write to the Free Software
+ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+/**
+ * @file   gfx/pixel_ops.h
+ * @author Kai Sterker <kai.sterker@gmail.com>
+ *
+ * @brief  Declares the pixel_ops class.
+ *
+ *
+ */
+
+#ifndef GFX_PIXEL_OPS_H
+#define GFX_PIXEL_OPS_H
+
+#include <adonthell/base/types.h>
+
+namespace gfx
+{
+    /**
+     * Image processing kernels working on raw pixel data, row by row.
+     * Where the CPU supports it, SSE2 or AVX2 versions of the kernels
+     * are used. The instruction set is picked at runtime, so the
+     * same binary runs on any CPU. All versions of a kernel produce
+     * exactly the same result.
+     *
+     * Unless noted otherwise, pixel data is expected as 32 bit RGBA,
+     * in byte order R, G, B, A, as returned by png::get.
+     */
+    class pixel_ops
+    {
+    public:
+        /**
+         * Instruction sets the kernels are available for.
+         */
+        typedef enum
+        {
+            SCALAR = 0,
+            SSE2,
+            AVX2
+        } instruction_set;
+
+        /**
+         * Get the best instruction set supported by this CPU.
+         * @return instruction set used by default.
+         */
+        static instruction_set best_instruction_set ();
+
+        /**
+         * Select the instruction set to use. Mainly useful for
+         * testing and benchmarking the different kernels.
+         * @param set the instruction set to use.
+         * @return \b false if the CPU does not support the given
+         *      instruction set, \b true otherwise.
+         */
+        static bool use_instruction_set (const instruction_set & set);
+
+        /**
+         * Get the instruction set currently used.
+         * @return instruction set in use.
+         */
+        static instruction_set current_instruction_set ();
+
+        /**
+         * Add the given value to the color channels of each pixel
+         * that is not fully transparent, saturating at 0 and 255.
+         * The alpha channel remains unchanged.
+         * @param rgba the pixels to modify.
+         * @param count number of pixels.
+         * @param mod value to add to each color channel.
+         * @param masked whether to leave pixels of the key color unchanged.
+         * @param key color of masked pixels. The alpha channel is ignored
+         *      when comparing.
+         */
+        static void brighten (u_int8 *rgba, const u_int32 & count, const s_int8 & mod,
+                              const bool & masked = false, const u_int32 & key = 0);
+
+        /**
+         * Apply a gaussian blur with a radius of 3 pixels, first
+         * horizontally, then vertically.
+         * @param rgba the pixels to modify.
+         * @param length length of the image.
+         * @param height height of the image.
+         * @param alpha whether the image has an alpha channel. If not,
+         *      the alpha channel is set to opaque before the vertical pass,
+         *      like reading back the intermediate image would do.
+         */
+        static void blur (u_int8 *rgba, const u_int16 & length, const u_int16 & height, const bool & alpha);
+
+        /**
+         * Enlarge an image by an integer factor, replicating each
+         * pixel. Works for any pixel format.
+         * @param dst target pixels, with room for the scaled image.
+         * @param dst_pitch bytes per row of target.
+         * @param src source pixels.
+         * @param src_pitch bytes per row of source.
+         * @param length length of the source image.
+         * @param height height of the source image.
+         * @param bpp bytes per pixel of both images.
+         * @param factor scaling factor.
+         */
+        static void scale_up (u_int8 *dst, const s_int32 & dst_pitch, const u_int8 *src, const s_int32 & src_pitch,
+                              const u_int16 & length, const u_int16 & height, const u_int8 & bpp, const u_int32 & factor);
+
+        /**
+         * Shrink an image by an integer factor, picking the center
+         * pixel of each factor x factor block. Works for any pixel format.
+         * @param dst target pixels, with room for the scaled image.
+         * @param dst_pitch bytes per row of target.
+         * @param src source pixels.
+         * @param src_pitch bytes per row of source.
+         * @param length length of the source image.
+         * @param height height of the source image.
+         * @param bpp bytes per pixel of both images.
+         * @param factor scaling factor.
+         */
+        static void scale_down (u_int8 *dst, const s_int32 & dst_pitch, const u_int8 *src, const s_int32 & src_pitch,
+                                const u_int16 & length, const u_int16 & height, const u_int8 & bpp, const u_int32 & factor);
+
+        /**
+         * Draw source pixels over target pixels. The source alpha channel
+         * and the given alpha value determine how much of the source shows
+         * through. The resulting alpha channel is that of the source drawn
+         * over the target. Integer arithmetic is used throughout, so an
+         * opaque source replaces the target exactly.
+         * @param dst target pixels.
+         * @param src source pixels.
+         * @param count number of pixels.
+         * @param alpha opacity of the whole source, 255 being opaque.
+         * @param alpha_channel whether to respect the source alpha channel.
+         *      If \b false, source pixels are treated as opaque.
+         */
+        static void blend (u_int8 *dst, const u_int8 *src, const u_int32 & count,
+                           const u_int8 & alpha, const bool & alpha_channel);
+
+        /**
+         * Copy source pixels to target, skipping those whose color matches
+         * the given key. The alpha channel is ignored when comparing.
+         * @param dst target pixels.
+         * @param src source pixels.
+         * @param count number of pixels.
+         * @param key color of the pixels to skip.
+         */
+        static void copy_keyed (u_int8 *dst, const u_int8 *src, const u_int32 & count, const u_int32 & key);
+
+        /**
+         * Turn pixels whose color channels have been multiplied by
+         * their alpha into ordinary RGBA. This is what blending onto
+         * a fully transparent image produces. Only a scalar version
+         * exists, as this is not used every frame.
+         * @param rgba the pixels to modify.
+         * @param count number of pixels.
+         */
+        static void unpremultiply (u_int8 *rgba, const u_int32 & count);
+
+    private:
+        /// instruction set in use
+        static instruction_set Current;
+    };
+}
+
+#endif
@@ -29,6 +29,7 @@
 
 #include "png_wrapper.h"
 #include <adonthell/base/logging.h>
+#include <adonthell/base/allow_threads.h>
 
 #include <cstdio>
 #include <cstdlib>
@@ -58,8 +59,34 @@ namespace gfx
         file.flush();
     }
 
+    bool png::get_size (ifstream & file, u_int16 & length, u_int16 & height)
+    {
+        // signature, followed by the IHDR chunk with big endian width and height
+        png_byte header[24];
+
+        file.read ((char *) header, sizeof (header));
+        bool ok = file.gcount () == sizeof (header) && !png_sig_cmp (header, 0, 8) &&
+            memcmp (header + 12, "IHDR", 4) == 0;
+
+        file.clear ();
+        file.seekg (0, ios::beg);
+
+        if (!ok) return false;
+
+        u_int32 l = png_get_uint_32 (header + 16);
+        u_int32 h = png_get_uint_32 (header + 20);
+        if (l > 0xFFFF || h > 0xFFFF) return false;
+
+        length = l;
+        height = h;
+        return true;
+    }
+
     void * png::get (ifstream & file, u_int16 & length, u_int16 & height, bool * alpha)
     {
+        // decoding does not involve any scripts
+        base::allow_threads nogil;
+
         const int headerbytes = 8;  //This is used to read the file and make sure its a png... can be 1-8
         png_byte header[headerbytes];
         png_structp png_ptr;
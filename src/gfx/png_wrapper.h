@@ -62,6 +62,19 @@ namespace gfx
          */
         static void *get (std::ifstream & file, u_int16 & length, u_int16 & height, bool * alpha);
 
+        /**
+         * Reads the size of a PNG %image from an opened file, without
+         * decoding the %image. The file is rewound to its start afterwards,
+         * so it can be passed to get() next.
+         *
+         * @param file opened file from which to read.
+         * @param length will contain the %image's length.
+         * @param height will contain the %image's height.
+         *
+         * @return \b true on success, \b false if the file is no PNG %image.
+         */
+        static bool get_size (std::ifstream & file, u_int16 & length, u_int16 & height);
+
         /**
          * Saves a PNG %image into an opened file.
          *
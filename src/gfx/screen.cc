@@ -32,8 +32,12 @@
 #include <cstdio>
 #include "gfx.h"
 #include "screen.h"
+#include "surface_cacher.h"
 #include <adonthell/base/logging.h>
 
+/// beyond that many separate areas, the whole screen is redrawn
+#define MAX_DIRTY_RECTS 32
+
 namespace gfx
 {
     /// Red componant
@@ -47,6 +51,12 @@ namespace gfx
     u_int16 screen::length_ = 0, screen::height_ = 0;
     u_int8 screen::bytes_per_pixel_;
     bool screen::fullscreen_;
+    u_int32 screen::draw_calls_ = 0, screen::texture_switches_ = 0;
+    u_int32 screen::last_draw_calls_ = 0, screen::last_texture_switches_ = 0;
+    const void *screen::last_texture_ = NULL;
+    bool screen::damage_tracking_ = false, screen::show_damage_ = false;
+    std::list<drawing_area> screen::dirty_, screen::damage_;
+    u_int32 screen::dirty_pixels_ = 0;
     
     void (*screen::get_video_mode_p) (u_int16 *l, u_int16 *h, u_int8 *depth) = NULL;
     bool (*screen::set_video_mode_p) (u_int16 nl, u_int16 nh, u_int8 depth) = NULL;
@@ -55,6 +65,7 @@ namespace gfx
     void (*screen::clear_p)() = NULL;
     surface * (*screen::get_surface_p)() = NULL;
     std::string (*screen::info_p)() = NULL;
+    bool (*screen::set_damage_tracking_p)(bool enable) = NULL;
     
     void screen::setup (base::configuration & cfg)
     {
@@ -143,10 +154,160 @@ namespace gfx
             length_ = nl;
             height_ = nh;
             bytes_per_pixel_ = depth;
+
+            // backend may have to set up persistent screen contents again
+            if (damage_tracking_ && !set_damage_tracking_p (true))
+            {
+                LOG(WARNING) << "*** screen::set_video_mode: cannot keep tracking damage";
+                damage_tracking_ = false;
+            }
+            invalidate_all ();
         }
 
         LOG(INFO) << info();
         
         return res;
     }    
+
+    // toggle damage tracking
+    bool screen::set_damage_tracking (const bool & enable)
+    {
+        if (enable == damage_tracking_) return true;
+
+        if (!set_damage_tracking_p || !set_damage_tracking_p (enable))
+        {
+            LOG(WARNING) << "*** screen::set_damage_tracking: not supported by backend";
+            return false;
+        }
+
+        damage_tracking_ = enable;
+        invalidate_all ();
+        return true;
+    }
+
+    // mark part of screen as changed
+    void screen::invalidate (const drawing_area & area)
+    {
+        if (!damage_tracking_) return;
+
+        // a full redraw is pending anyway
+        if (dirty_pixels_ == (u_int32) length_ * height_) return;
+
+        dirty_pixels_ += add_area (dirty_, area);
+        if (show_damage_) add_area (damage_, area);
+
+        // too many small areas are more costly than a single large one
+        if (dirty_.size () > MAX_DIRTY_RECTS || dirty_pixels_ > (u_int32) length_ * height_ * 3 / 4)
+        {
+            invalidate_all ();
+        }
+    }
+
+    // mark whole screen as changed
+    void screen::invalidate_all ()
+    {
+        if (!damage_tracking_) return;
+
+        dirty_.clear ();
+        dirty_.push_back (drawing_area (0, 0, length_, height_));
+        dirty_pixels_ = (u_int32) length_ * height_;
+
+        if (show_damage_)
+        {
+            damage_ = dirty_;
+        }
+    }
+
+    // get areas to redraw
+    const std::list<drawing_area> & screen::dirty_rects ()
+    {
+        static std::list<drawing_area> whole_screen (1);
+
+        if (damage_tracking_) return dirty_;
+
+        whole_screen.front().resize (length_, height_);
+        return whole_screen;
+    }
+
+    // merge area with existing areas
+    u_int32 screen::add_area (std::list<drawing_area> & areas, const drawing_area & area)
+    {
+        // only keep the part that is actually on screen
+        drawing_area view (0, 0, length_, height_);
+        drawing_area clipped = area;
+        clipped.assign_drawing_area (&view);
+
+        std::list<drawing_area> parts;
+        parts.push_back (clipped.setup_rects ());
+        if (!parts.front().length() || !parts.front().height()) return 0;
+
+        // remove what is already covered by other areas
+        for (std::list<drawing_area>::const_iterator i = areas.begin(); i != areas.end() && !parts.empty(); i++)
+        {
+            i->subtract_from (parts);
+        }
+
+        u_int32 pixels = 0;
+        for (std::list<drawing_area>::const_iterator i = parts.begin(); i != parts.end(); i++)
+        {
+            pixels += i->length() * i->height();
+        }
+
+        areas.splice (areas.end(), parts);
+        return pixels;
+    }
+
+    // show frame and finish background loading
+    void screen::update ()
+    {
+        if (damage_tracking_) present_damage ();
+        else update_p();
+
+        // start counting the next frame
+        last_draw_calls_ = draw_calls_;
+        last_texture_switches_ = texture_switches_;
+        draw_calls_ = 0;
+        texture_switches_ = 0;
+        last_texture_ = NULL;
+
+        // images that finished loading must be drawn in full
+        if (surfaces && surfaces->upload () && damage_tracking_)
+        {
+            invalidate_all ();
+        }
+    }
+
+    // present screen and start next frame
+    void screen::present_damage ()
+    {
+        std::list<drawing_area> outline;
+
+        if (show_damage_)
+        {
+            // outline the areas redrawn in this frame
+            surface *display = get_surface ();
+            u_int32 color = display->map_color (0x00, 0xFF, 0x00);
+            for (std::list<drawing_area>::const_iterator i = damage_.begin(); i != damage_.end(); i++)
+            {
+                display->fillrect (i->x(), i->y(), i->length(), 1, color);
+                display->fillrect (i->x(), i->y() + i->height() - 1, i->length(), 1, color);
+                display->fillrect (i->x(), i->y(), 1, i->height(), color);
+                display->fillrect (i->x() + i->length() - 1, i->y(), 1, i->height(), color);
+            }
+
+            outline.swap (damage_);
+        }
+
+        update_p ();
+
+        dirty_.clear ();
+        damage_.clear ();
+        dirty_pixels_ = 0;
+
+        // remove the outlines during the next frame
+        for (std::list<drawing_area>::const_iterator i = outline.begin(); i != outline.end(); i++)
+        {
+            dirty_pixels_ += add_area (dirty_, *i);
+        }
+    }
 }
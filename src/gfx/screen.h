@@ -31,6 +31,7 @@
 #ifndef SCREEN_H_
 #define SCREEN_H_
 
+#include <list>
 #include "surface.h"
 #include <adonthell/base/base.h>
 #include <adonthell/base/configuration.h>
@@ -117,13 +118,135 @@ namespace gfx
 
         /** 
          * Ensures the framebuffer is copied to the physical screen.
+         * Afterwards, images decoded in the background since the
+         * last frame will replace their placeholders.
          *
          */ 
-        static void update ()
+        static void update ();
+
+        /**
+         * @name Render statistics
+         */
+        //@{
+        /**
+         * Return the number of draw calls issued by the renderer
+         * during the last complete frame.
+         * @return number of draw calls in the previous frame.
+         */
+        static u_int32 draw_calls ()
+        {
+        	return last_draw_calls_;
+        }
+
+        /**
+         * Return how often the renderer had to switch textures
+         * during the last complete frame. Drawing consecutive images
+         * from the same texture does not count as a switch.
+         * @return number of texture switches in the previous frame.
+         */
+        static u_int32 texture_switches ()
+        {
+        	return last_texture_switches_;
+        }
+
+#ifndef SWIG
+        /**
+         * Called by the backend for each draw call to the screen.
+         * @param texture backend specific handle of the texture used
+         *      for drawing, or NULL if drawing without texture.
+         */
+        static void count_draw_call (const void *texture)
+        {
+        	draw_calls_++;
+        	if (texture != last_texture_)
+        	{
+        		texture_switches_++;
+        		last_texture_ = texture;
+        	}
+        }
+#endif
+        //@}
+
+        /**
+         * @name Damage tracking
+         * In damage tracking mode, the %screen keeps its content from one
+         * frame to the next. Objects that change their appearance report
+         * the affected part of the %screen as changed, and only those parts
+         * need to be redrawn before the next call to update(). The
+         * main loop looks like this:
+         *
+         * <pre>
+         * const std::list<gfx::drawing_area> & dirty = gfx::screen::dirty_rects ();
+         * for (area = dirty.begin(); area != dirty.end(); area++)
+         * {
+         *     gfx::screen::get_surface()->fillrect (area->x(), area->y(), area->length(), area->height(), 0);
+         *     view.draw (0, 0, &(*area));
+         * }
+         * gfx::screen::update ();
+         * </pre>
+         */
+        //@{
+        /**
+         * Enable or disable damage tracking. Requires a backend that
+         * can preserve the %screen contents between frames and must be
+         * called after setting the video mode. Enabling damage tracking
+         * marks the whole %screen as changed.
+         * @param enable whether to track damage.
+         * @return \b true on success, \b false if not supported by the backend.
+         */
+        static bool set_damage_tracking (const bool & enable);
+
+        /**
+         * Return whether damage tracking is enabled.
+         * @return \b true if only changed parts of the %screen are redrawn.
+         */
+        static bool damage_tracking ()
         {
-        	update_p();
+        	return damage_tracking_;
         }
 
+        /**
+         * Mark part of the %screen as changed, so that it gets
+         * redrawn during the current frame. Overlapping areas are
+         * merged, so that no pixel needs to be drawn twice. Does
+         * nothing unless damage tracking is enabled.
+         * @param area the part of the %screen that changed.
+         */
+        static void invalidate (const drawing_area & area);
+
+        /**
+         * Mark the whole %screen as changed.
+         */
+        static void invalidate_all ();
+
+        /**
+         * Return the parts of the %screen that need to be redrawn
+         * during the current frame. If damage tracking is disabled,
+         * this is always the whole %screen.
+         * @return non-overlapping list of areas to redraw.
+         */
+        static const std::list<drawing_area> & dirty_rects ();
+
+        /**
+         * Return whether anything needs to be redrawn in the current frame.
+         * @return \b false if the %screen can be presented unchanged.
+         */
+        static bool needs_redraw ()
+        {
+        	return !damage_tracking_ || !dirty_.empty();
+        }
+
+        /**
+         * Outline the areas redrawn in each frame, for debugging. The
+         * outlines are removed again during the following frame.
+         * @param show whether to display the redrawn areas.
+         */
+        static void set_show_damage (const bool & show)
+        {
+        	show_damage_ = show;
+        }
+        //@}
+
         /** 
          * Returns the display's transparent color. (i.e. the color
          * that won't be displayed for surfaces drawn when 
@@ -161,6 +284,7 @@ namespace gfx
          */
         static void clear()
         {
+        	invalidate_all();
         	clear_p();
         }
         
@@ -210,6 +334,42 @@ namespace gfx
         /// color depth
         static u_int8 bytes_per_pixel_; 
 
+        /// draw calls in the current frame
+        static u_int32 draw_calls_;
+        /// texture switches in the current frame
+        static u_int32 texture_switches_;
+        /// draw calls in the previous frame
+        static u_int32 last_draw_calls_;
+        /// texture switches in the previous frame
+        static u_int32 last_texture_switches_;
+        /// texture used by the most recent draw call
+        static const void *last_texture_;
+
+        /// whether only changed parts of the screen are redrawn
+        static bool damage_tracking_;
+        /// whether to outline redrawn areas
+        static bool show_damage_;
+        /// areas to redraw in the current frame
+        static std::list<drawing_area> dirty_;
+        /// areas reported as changed in the current frame, for the outline
+        static std::list<drawing_area> damage_;
+        /// number of pixels to redraw in the current frame
+        static u_int32 dirty_pixels_;
+
+        /**
+         * Add area to the given list of non-overlapping areas.
+         * @param areas the list to update.
+         * @param area the area to add.
+         * @return number of pixels added to the list.
+         */
+        static u_int32 add_area (std::list<drawing_area> & areas, const drawing_area & area);
+
+        /**
+         * Present the screen when tracking damage, outline changed
+         * areas if requested and start the next frame.
+         */
+        static void present_damage ();
+
         static void (*get_video_mode_p) (u_int16 *l, u_int16 *h, u_int8 *depth);
         static bool (*set_video_mode_p) (u_int16 nl, u_int16 nh, u_int8 depth);
         static void (*update_p)();
@@ -217,6 +377,7 @@ namespace gfx
         static void (*clear_p)();
         static surface * (*get_surface_p)();
         static std::string (*info_p)();
+        static bool (*set_damage_tracking_p)(bool enable);
 
         friend bool init(const std::string &);
         friend void cleanup();
@@ -47,6 +47,10 @@ bool gfx_init()
     }
 
     SDL_SetHint (SDL_HINT_RENDER_SCALE_QUALITY, "nearest");
+#ifdef SDL_HINT_RENDER_BATCHING
+    // merge consecutive draws from the same texture, i.e. atlas page
+    SDL_SetHint (SDL_HINT_RENDER_BATCHING, "1");
+#endif
 
     display = new gfx::screen_surface_sdl ();
     return true;
@@ -54,6 +58,7 @@ bool gfx_init()
 
 void gfx_cleanup()
 {
+    gfx::surface_sdl::cleanup_atlas ();
     delete display;
     //BUG  this function may cause problems because it will call destructors before python does.
     SDL_QuitSubSystem (SDL_INIT_VIDEO);
@@ -26,6 +26,7 @@
 #define gfx_screen_clear _sdl_LTX_gfx_screen_clear
 #define gfx_screen_get_surface _sdl_LTX_gfx_screen_get_surface
 #define gfx_screen_info _sdl_LTX_gfx_screen_info
+#define gfx_screen_set_damage_tracking _sdl_LTX_gfx_screen_set_damage_tracking
 #endif
 
 #include <sstream> 
@@ -42,6 +43,7 @@ extern "C"
     void gfx_screen_clear();
     gfx::surface *gfx_screen_get_surface();
     std::string gfx_screen_info();
+    bool gfx_screen_set_damage_tracking(bool enable);
 }
 
 void gfx_screen_get_video_mode(u_int16 *l, u_int16 *h, u_int8 *depth)
@@ -72,7 +74,7 @@ bool gfx_screen_set_video_mode(u_int16 nl, u_int16 nh, u_int8 depth)
 
 void gfx_screen_update()
 {
-    SDL_RenderPresent(display->get_renderer());
+    display->present();
 }
 
 u_int32 gfx_screen_trans_color()
@@ -111,3 +113,8 @@ std::string gfx_screen_info()
 
     return temp.str ();
 }
+
+bool gfx_screen_set_damage_tracking(bool enable)
+{
+    return display->set_persistent(enable);
+}
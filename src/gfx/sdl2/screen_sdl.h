@@ -36,10 +36,12 @@ namespace gfx
         {
             Renderer = NULL;
             Window = NULL;
+            Frame = NULL;
         }
 
         ~screen_surface_sdl()
         {
+            if (Frame) SDL_DestroyTexture(Frame);
             if (Renderer) SDL_DestroyRenderer(Renderer);
             if (Window) SDL_DestroyWindow(Window);
 
@@ -69,6 +71,26 @@ namespace gfx
 
         bool set_video_mode(u_int16 nl, u_int16 nh, u_int8 depth, u_int32 flags)
         {
+            // the frame texture has the size of the previous mode. It
+            // must be created again by the caller if required.
+            if (Frame)
+            {
+                SDL_SetRenderTarget(Renderer, NULL);
+                SDL_DestroyTexture(Frame);
+                Frame = NULL;
+            }
+
+            if (Window)
+            {
+                // keep the renderer, as all textures belong to it
+                SDL_SetWindowFullscreen(Window, flags & SDL_WINDOW_FULLSCREEN);
+                SDL_SetWindowSize(Window, nl, nh);
+
+                set_length(nl);
+                set_height(nh);
+                return true;
+            }
+
             Window = SDL_CreateWindow ("Adonthell", SDL_WINDOWPOS_CENTERED, SDL_WINDOWPOS_CENTERED, nl, nh, flags);
             if (!Window)
             {
@@ -93,12 +115,71 @@ namespace gfx
             return true;
         }
 
+        /**
+         * Render into a texture that keeps its contents from one
+         * frame to the next, instead of the window's back buffer,
+         * whose contents are undefined after presenting it.
+         * @param enable whether to keep the screen contents.
+         * @return \b true on success, \b false otherwise.
+         */
+        bool set_persistent(const bool & enable)
+        {
+            if (enable == (Frame != NULL)) return true;
+            if (!Renderer) return false;
+
+            if (!enable)
+            {
+                SDL_SetRenderTarget(Renderer, NULL);
+                SDL_DestroyTexture(Frame);
+                Frame = NULL;
+                return true;
+            }
+
+            if (!SDL_RenderTargetSupported(Renderer))
+            {
+                LOG(WARNING) << logging::indent() << "Renderer does not support render targets";
+                return false;
+            }
+
+            Frame = SDL_CreateTexture(Renderer, format(), SDL_TEXTUREACCESS_TARGET, length(), height());
+            if (!Frame || SDL_SetRenderTarget(Renderer, Frame) != 0)
+            {
+                LOG(ERROR) << logging::indent() << "Failed creating frame texture: " << SDL_GetError();
+                if (Frame) SDL_DestroyTexture(Frame);
+                Frame = NULL;
+                return false;
+            }
+
+            return true;
+        }
+
+        /**
+         * Bring the current frame on screen.
+         */
+        void present()
+        {
+            if (Frame)
+            {
+                SDL_SetRenderTarget(Renderer, NULL);
+                SDL_RenderCopy(Renderer, Frame, NULL, NULL);
+                SDL_RenderPresent(Renderer);
+                SDL_SetRenderTarget(Renderer, Frame);
+            }
+            else
+            {
+                SDL_RenderPresent(Renderer);
+            }
+        }
+
     private:
         /// The output window
         SDL_Window *Window;
 
         /// the render target
         SDL_Renderer *Renderer;
+
+        /// persistent screen contents, when tracking damage
+        SDL_Texture *Frame;
     };
 }
 
@@ -21,7 +21,9 @@
 
 #include <iostream>
 #include <algorithm>
+#include <map>
 
+#include "../pixel_ops.h"
 #include "surface_sdl.h"
 #include "screen_sdl.h"
 
@@ -30,17 +32,69 @@ namespace gfx
     SDL_Rect surface_sdl::srcrect; 
     SDL_Rect surface_sdl::dstrect; 
 
+    /// shared textures for images of one pixel format
+    struct surface_sdl::atlas
+    {
+        /// allocates space on the pages
+        texture_atlas Pages;
+        /// texture of each page
+        std::vector<SDL_Texture*> Textures;
+    };
+
+    /// atlases by pixel format
+    static std::map<u_int32, surface_sdl::atlas*> Atlases;
+
+    // copy rows of pixels between buffers of different pitch
+    static void copy_rows (void *dst, int dst_pitch, const void *src, int src_pitch, int row_length, int rows)
+    {
+        while (rows-- > 0)
+        {
+            SDL_memcpy (dst, src, row_length);
+            src = (const u_int8*) src + src_pitch;
+            dst = (u_int8*) dst + dst_pitch;
+        }
+    }
+
+    // copy pixels between buffers, flipping them as requested
+    static void copy_mirrored (void *dst, int dst_pitch, const void *src, int src_pitch, int bpp,
+                               int length, int rows, SDL_RendererFlip flip)
+    {
+        for (int y = 0; y < rows; y++)
+        {
+            const u_int8 *from = (const u_int8*) src + (flip & SDL_FLIP_VERTICAL ? rows - y - 1 : y) * src_pitch;
+            u_int8 *to = (u_int8*) dst + y * dst_pitch;
+
+            if (flip & SDL_FLIP_HORIZONTAL)
+            {
+                for (int x = length - 1; x >= 0; x--, to += bpp)
+                {
+                    SDL_memcpy (to, from + x * bpp, bpp);
+                }
+            }
+            else
+            {
+                SDL_memcpy (to, from, length * bpp);
+            }
+        }
+    }
+
     surface_sdl::surface_sdl() : surface_ext () 
     { 
         Surface = NULL;
+        Atlas = NULL;
+        Buffer = NULL;
+        Dirty = false;
         Info = new pixel_info();
+        Original = NULL;
+        Mirrored = false;
+        Flip = SDL_FLIP_NONE;
         mask_changed = false; 
     }
 
     surface_sdl::~surface_sdl() 
     {
+        release_texture ();
         delete Info;
-        if (Surface) SDL_DestroyTexture (Surface);
     }
 
     void surface_sdl::set_mask (bool m)
@@ -77,9 +131,8 @@ namespace gfx
 
             SDL_UnlockTexture(tmp);
 
-            SDL_FreeSurface(s1);
             SDL_FreeSurface(s2);
-            SDL_DestroyTexture(Surface);
+            release_texture();
 
             Surface = tmp;
             alpha_channel_ = true;
@@ -88,13 +141,14 @@ namespace gfx
 
     void surface_sdl::set_alpha (const u_int8 & t, const bool & alpha_channel)
     {
-        if ((t == 255) && (alpha_ != 255) && Surface)
+        // the state of a shared atlas page is set on each draw instead
+        if ((t == 255) && (alpha_ != 255) && Surface && !Atlas)
         {
             SDL_SetTextureAlphaMod(Surface, t);
             SDL_SetTextureBlendMode(Surface, SDL_BLENDMODE_NONE);
         }
         
-        else if (!alpha_channel && alpha_channel_ && Surface)
+        else if (!alpha_channel && alpha_channel_ && Surface && !Atlas)
         {
             SDL_SetTextureBlendMode(Surface, SDL_BLENDMODE_NONE);
         }
@@ -103,30 +157,74 @@ namespace gfx
         alpha_channel_ = alpha_channel || is_masked_;
     }
 
-    SDL_Surface *surface_sdl::to_sw_surface(SDL_Rect *rect) const
+    SDL_Surface *surface_sdl::to_sw_surface() const
     {
-        int bpp;
-        u_int32 rmask, gmask, bmask, amask;
+        if (!Buffer)
+        {
+            int bpp;
+            u_int32 rmask, gmask, bmask, amask;
 
-        lock(rect);
+            SDL_PixelFormatEnumToMasks(Info->Format, &bpp, &rmask, &gmask, &bmask, &amask);
+            SDL_Surface *s = SDL_CreateRGBSurface(0, length(), height(), bpp, rmask, gmask, bmask, amask);
+            if (!s)
+            {
+                LOG(FATAL) << "*** surface_sdl::to_sw_surface: " << SDL_GetError();
+            }
 
-        SDL_PixelFormatEnumToMasks(Info->Format, &bpp, &rmask, &gmask, &bmask, &amask);
-        SDL_Surface *s = SDL_CreateRGBSurfaceFrom(Info->Pixels, length(), height(),
-                bpp, Info->Pitch, rmask, gmask, bmask, amask);
+            if (Original)
+            {
+                // fetch mirrored image from the original, leaving it untouched
+                bool dirty = Original->Dirty;
+                Original->lock(NULL);
+                copy_mirrored (s->pixels, s->pitch, Original->Info->Pixels, Original->Info->Pitch,
+                    Original->Info->BytesPerPixel, length(), height(), Flip);
+                Original->unlock();
+                Original->Dirty = dirty;
+            }
+            else
+            {
+                // fetch current image from the texture, once
+                lock(NULL);
+                copy_rows (s->pixels, s->pitch, Info->Pixels, Info->Pitch, length() * Info->BytesPerPixel, height());
+                unlock();
+            }
 
-        if (is_masked_)
-        {
-            u_int32 trans_col = alpha_channel_? SDL_MapRGBA(s->format, 0xFF, 0x00, 0xFF, 0xFF) : SDL_MapRGB(s->format, 0xFF, 0x00, 0xFF);
-            SDL_SetColorKey(s, 1, trans_col);
+            Buffer = s;
+            Dirty = false;
         }
 
+        // the blit settings of the surface may have changed since last time
+        u_int32 trans_col = alpha_channel_? SDL_MapRGBA(Buffer->format, 0xFF, 0x00, 0xFF, 0xFF) : SDL_MapRGB(Buffer->format, 0xFF, 0x00, 0xFF);
+        SDL_SetColorKey(Buffer, is_masked_ ? SDL_TRUE : SDL_FALSE, trans_col);
+
         if (alpha_channel_ || alpha_ != 255)
         {
-            if (!alpha_channel_ || is_masked_) SDL_SetSurfaceAlphaMod (s, alpha_);
-            SDL_SetSurfaceBlendMode (s, SDL_BLENDMODE_BLEND);
+            SDL_SetSurfaceAlphaMod (Buffer, !alpha_channel_ || is_masked_ ? alpha_ : SDL_ALPHA_OPAQUE);
+            SDL_SetSurfaceBlendMode (Buffer, SDL_BLENDMODE_BLEND);
+        }
+        else
+        {
+            SDL_SetSurfaceAlphaMod (Buffer, SDL_ALPHA_OPAQUE);
+            SDL_SetSurfaceBlendMode (Buffer, Buffer->format->Amask ? SDL_BLENDMODE_BLEND : SDL_BLENDMODE_NONE);
         }
 
-        return s;
+        return Buffer;
+    }
+
+    void surface_sdl::upload () const
+    {
+        // a mirror image has no texture of its own
+        if (!Buffer || !Dirty || Original) return;
+
+        int pitch;
+        void *pixels;
+        SDL_Rect area = { Region.x, Region.y, Region.length, Region.height };
+
+        SDL_LockTexture (Surface, Atlas ? &area : NULL, &pixels, &pitch);
+        copy_rows (pixels, pitch, Buffer->pixels, Buffer->pitch, length() * Buffer->format->BytesPerPixel, height());
+        SDL_UnlockTexture (Surface);
+
+        Dirty = false;
     }
 
     void surface_sdl::draw (s_int16 x, s_int16 y, s_int16 sx, s_int16 sy, u_int16 sl,
@@ -140,11 +238,35 @@ namespace gfx
 
         if (!target || target == display)
         {
+            // a mirror image draws the texture of its original
+            const surface_sdl *src = Original ? Original : this;
+            SDL_Texture *texture = src->Surface;
+
+            // bring texture up to date with software changes
+            src->upload ();
+
+            // the part of the original that ends up in the requested part of the mirror image
+            if (Flip & SDL_FLIP_HORIZONTAL) srcrect.x = length() - srcrect.x - srcrect.w;
+            if (Flip & SDL_FLIP_VERTICAL) srcrect.y = height() - srcrect.y - srcrect.h;
+
             // blit to screen surface (--> hardware accelerated)
-            if (alpha_channel_ || alpha_ != 255)
+            if (src->Atlas || Original || Mirrored)
+            {
+                // the texture is shared with other images, so always set its state
+                bool blend = alpha_channel_ || alpha_ != 255;
+                SDL_SetTextureAlphaMod(texture, blend && (!alpha_channel_ || is_masked_) ? alpha_ : SDL_ALPHA_OPAQUE);
+                SDL_SetTextureBlendMode(texture, blend ? SDL_BLENDMODE_BLEND : SDL_BLENDMODE_NONE);
+            }
+            else if (alpha_channel_ || alpha_ != 255)
             {
-                if (!alpha_channel_ || is_masked_) SDL_SetTextureAlphaMod(Surface, alpha_);
-                SDL_SetTextureBlendMode(Surface, SDL_BLENDMODE_BLEND);
+                if (!alpha_channel_ || is_masked_) SDL_SetTextureAlphaMod(texture, alpha_);
+                SDL_SetTextureBlendMode(texture, SDL_BLENDMODE_BLEND);
+            }
+
+            if (src->Atlas)
+            {
+                srcrect.x += src->Region.x;
+                srcrect.y += src->Region.y;
             }
 
             if (base::Scale > 1)
@@ -155,20 +277,28 @@ namespace gfx
                 dstrect.h *= base::Scale;
             }
 
-            SDL_RenderCopy (display->get_renderer(), Surface, &srcrect, &dstrect);
+            if (Flip != SDL_FLIP_NONE)
+            {
+                SDL_RenderCopyEx (display->get_renderer(), texture, &srcrect, &dstrect, 0.0, NULL, Flip);
+            }
+            else
+            {
+                SDL_RenderCopy (display->get_renderer(), texture, &srcrect, &dstrect);
+            }
+            screen::count_draw_call (texture);
         }
         else
         {
-            // blit from one surface to another (--> needs to be in software)
+            // blit from one surface to another (--> needs to be in software).
+            // Both surfaces keep their software copy, so repeated blits
+            // neither allocate nor lock any textures.
+            surface_sdl *target_sdl = (surface_sdl*) target;
             SDL_Surface *source_surf = to_sw_surface ();
-            SDL_Surface *target_surf = ((surface_sdl*) target)->to_sw_surface ();
+            SDL_Surface *target_surf = target_sdl->to_sw_surface ();
 
             SDL_BlitSurface (source_surf, &srcrect, target_surf, &dstrect);
 
-            target->unlock();
-
-            SDL_FreeSurface(source_surf);
-            SDL_FreeSurface(target_surf);
+            target_sdl->Dirty = true;
         }
     }
 
@@ -207,6 +337,7 @@ namespace gfx
             SDL_SetRenderDrawBlendMode(display->get_renderer(), SDL_BLENDMODE_NONE);
             SDL_SetRenderDrawColor(display->get_renderer(), r, g, b, a);
             SDL_RenderFillRect(display->get_renderer(), &dstrect);
+            screen::count_draw_call (NULL);
         }
         else
         {
@@ -245,8 +376,31 @@ namespace gfx
 
         if (this != display)
         {
-            SDL_LockTexture (Surface, rect, &Info->Pixels, &Info->Pitch);
             Info->BytesPerPixel = SDL_BYTESPERPIXEL(Info->Format);
+
+            // the pixels of a mirror image only exist in software
+            if (Original) to_sw_surface ();
+
+            // the software copy is up to date, so no need to touch the texture
+            if (Buffer)
+            {
+                Info->Pixels = (u_int8*) Buffer->pixels + (rect ? rect->y * Buffer->pitch + rect->x * Info->BytesPerPixel : 0);
+                Info->Pitch = Buffer->pitch;
+                return;
+            }
+
+            SDL_Rect area;
+            if (Atlas)
+            {
+                // only lock our part of the atlas page
+                area.x = Region.x + (rect ? rect->x : 0);
+                area.y = Region.y + (rect ? rect->y : 0);
+                area.w = rect ? rect->w : length ();
+                area.h = rect ? rect->h : height ();
+                rect = &area;
+            }
+
+            SDL_LockTexture (Surface, rect, &Info->Pixels, &Info->Pitch);
         }
     }
 
@@ -256,7 +410,10 @@ namespace gfx
 
         if (Info->Pixels)
         {
-            SDL_UnlockTexture (Surface);
+            // changes to the software copy are uploaded before drawing to screen
+            if (Buffer) Dirty = true;
+            else SDL_UnlockTexture (Surface);
+
             Info->Pixels = NULL;
         }
     }
@@ -278,6 +435,7 @@ namespace gfx
             SDL_SetRenderDrawBlendMode(display->get_renderer(), SDL_BLENDMODE_NONE);
             SDL_SetRenderDrawColor(display->get_renderer(), r, g, b, a);
             SDL_RenderDrawPoint(display->get_renderer(), x, y);
+            screen::count_draw_call (NULL);
             return;
         }
 
@@ -436,41 +594,34 @@ namespace gfx
     		height() * factor > target->height())
     		return;
 
-    	lock(NULL);
-        SDL_Surface *target_surf = ((surface_sdl*) target)->to_sw_surface ();
+        surface_sdl *target_sdl = (surface_sdl*) target;
 
-        u_int8 *target_data = (u_int8*) target_surf->pixels;
-        s_int32 target_line_length = target_surf->format->BytesPerPixel * target->length();
+        // blit into the software copy of the target
+        target_sdl->to_sw_surface ();
 
-        for (s_int32 src_y = 0; src_y < height(); ++src_y)
-        {
-            s_int32 target_x = 0;
-            s_int32 target_x_end = 0;
+        lock(NULL);
+        target->lock();
 
-            // we scale one line horizontally
-            for (s_int32 src_x = 0; src_x < length(); ++src_x)
-            {
-                u_int32 px = get_pix (src_x, src_y);
-                for (target_x_end += factor; target_x < target_x_end; ++target_x)
+        if (Info->Format == target_sdl->Info->Format)
+        {
+            pixel_ops::scale_up ((u_int8*) target_sdl->Info->Pixels, target_sdl->Info->Pitch,
+                (const u_int8*) Info->Pixels, Info->Pitch, length(), height(), Info->BytesPerPixel, factor);
+        }
+        else
+        {
+            // formats differ, so convert each pixel
+            for (u_int16 src_y = 0; src_y < height(); ++src_y)
+                for (u_int16 src_x = 0; src_x < length(); ++src_x)
                 {
-                    target->put_pix (target_x, src_y * factor, px);
+                    u_int32 px = get_pix (src_x, src_y);
+                    for (u_int32 y = 0; y < factor; y++)
+                        for (u_int32 x = 0; x < factor; x++)
+                            target->put_pix (src_x * factor + x, src_y * factor + y, px);
                 }
-            }
-
-            // the next lines will be the same, so we just copy them
-            for (u_int32 i = 1; i < factor; i++)
-            {
-                u_int8 *target_next_line = target_data + target_surf->pitch;
-                memcpy (target_next_line, target_data, target_line_length);
-                target_data = target_next_line;
-            }
-
-            // goto next line
-            target_data += target_surf->pitch;
         }
 
         target->unlock();
-        SDL_FreeSurface(target_surf);
+        unlock();
     }
 
     void surface_sdl::scale_down(surface *target, const u_int32 & factor) const
@@ -482,24 +633,38 @@ namespace gfx
             height() / factor > target->height())
             return;
 
+        surface_sdl *target_sdl = (surface_sdl*) target;
+
+        // blit into the software copy of the target
+        target_sdl->to_sw_surface ();
+
         lock(NULL);
-        SDL_Surface *target_surf = ((surface_sdl*) target)->to_sw_surface ();
+        target->lock();
 
-        s_int32 target_y = 0;
-        for (s_int32 src_y = factor/2; src_y < height(); src_y += factor)
+        if (Info->Format == target_sdl->Info->Format)
+        {
+            pixel_ops::scale_down ((u_int8*) target_sdl->Info->Pixels, target_sdl->Info->Pitch,
+                (const u_int8*) Info->Pixels, Info->Pitch, length(), height(), Info->BytesPerPixel, factor);
+        }
+        else
         {
-            s_int32 target_x = 0;
-            for (s_int32 src_x = factor/2; src_x < length(); src_x += factor)
+            // formats differ, so convert each pixel
+            s_int32 target_y = 0;
+            for (s_int32 src_y = factor/2; src_y < height(); src_y += factor)
             {
-                u_int32 px = get_pix (src_x, src_y);
-                target->put_pix (target_x, target_y, px);
-                target_x++;
+                s_int32 target_x = 0;
+                for (s_int32 src_x = factor/2; src_x < length(); src_x += factor)
+                {
+                    u_int32 px = get_pix (src_x, src_y);
+                    target->put_pix (target_x, target_y, px);
+                    target_x++;
+                }
+                target_y++;
             }
-            target_y++;
         }
 
         target->unlock();
-        SDL_FreeSurface(target_surf);
+        unlock();
     }
 
     surface & surface_sdl::operator = (const surface& src)
@@ -511,30 +676,23 @@ namespace gfx
         is_masked_ = src.is_masked();
         alpha_ = src.alpha();
 
-        if (Surface) SDL_DestroyTexture(Surface);
-        if (!src_sdl.Surface)
-        {
-            Surface = NULL;
-        }
-        else
+        release_texture();
+        if (src_sdl.Surface)
         {
-            int l, h, pitch;
-            void *src_pixels, *dst_pixels;
+            int pitch;
+            void *dst_pixels;
 
-            SDL_QueryTexture(src_sdl.Surface, &Info->Format, NULL, &l, &h);
+            // the source may be part of an atlas page, so only copy its area
+            src_sdl.lock(NULL);
+            Info->Format = src_sdl.Info->Format;
             Surface = SDL_CreateTexture (display->get_renderer(), Info->Format, SDL_TEXTUREACCESS_STREAMING, length(), height());
 
-            SDL_LockTexture(src_sdl.Surface, NULL, &src_pixels, &pitch);
             SDL_LockTexture(Surface, NULL, &dst_pixels, &pitch);
-
-            while (h-- > 0)
-            {
-                SDL_memcpy (dst_pixels, src_pixels, pitch);
-                src_pixels = (u_int8*) src_pixels + pitch;
-                dst_pixels = (u_int8*) dst_pixels + pitch;
-            }
+            copy_rows (dst_pixels, pitch, src_sdl.Info->Pixels, src_sdl.Info->Pitch,
+                length() * src_sdl.Info->BytesPerPixel, height());
 
             SDL_UnlockTexture(Surface);
+            src_sdl.unlock();
         }
 
         return *this; 
@@ -544,7 +702,7 @@ namespace gfx
     {
         if (l == length () && h == height ()) return;
 
-        if (Surface) SDL_DestroyTexture(Surface);
+        release_texture();
 
         set_length (l);
         set_height (h); 
@@ -571,8 +729,7 @@ namespace gfx
     {
         if (Surface)
         {
-            SDL_DestroyTexture(Surface);
-            Surface = NULL;
+            release_texture();
             set_length (0);
             set_height (0); 
             set_alpha (255);
@@ -583,7 +740,7 @@ namespace gfx
     void surface_sdl::set_data(void * data, u_int16 l, u_int16 h, u_int8 bytes_per_pixel, u_int32 red_mask, 
                                u_int32 green_mask, u_int32 blue_mask, u_int32 alpha_mask)
     {
-        if (Surface) SDL_DestroyTexture(Surface);
+        release_texture();
 
         set_length(l);
         set_height(h);
@@ -611,6 +768,68 @@ namespace gfx
         free (data);
     }
 
+    void surface_sdl::set_pixels (const void *pixels, u_int16 l, u_int16 h, bool alpha)
+    {
+        release_texture();
+
+        set_length(l);
+        set_height(h);
+
+        alpha_channel_ = alpha;
+
+        Info->Format = SDL_MasksToPixelFormatEnum (alpha ? 32 : 24, R_MASK, G_MASK, B_MASK, alpha ? A_MASK : 0);
+        Surface = SDL_CreateTexture (display->get_renderer(), Info->Format, SDL_TEXTUREACCESS_STREAMING, l, h);
+        if (!Surface)
+        {
+            LOG(ERROR) << "*** surface_sdl::set_pixels: " << SDL_GetError();
+            return;
+        }
+
+        // copy straight from the given buffer, without intermediate copy. This
+        // goes through lock/unlock rather than SDL_UpdateTexture, as the latter
+        // does not update the pixels we read back when locking the texture.
+        lock(NULL);
+
+        int pitch = l * (alpha ? 4 : 3);
+        const u_int8 *src = (const u_int8*) pixels;
+
+        while (h-- > 0)
+        {
+            SDL_memcpy (Info->Pixels, src, pitch);
+            src += pitch;
+            Info->Pixels = (u_int8*) Info->Pixels + Info->Pitch;
+        }
+
+        unlock();
+    }
+
+    void surface_sdl::put_rgba (const u_int8 *rgba)
+    {
+        put_rgba_rows (rgba, 0, height());
+    }
+
+    void surface_sdl::put_rgba_rows (const u_int8 *rgba, const u_int16 & y, const u_int16 & h)
+    {
+        if (!Surface || !length() || !h || y + h > height()) return;
+
+        // convert straight into the texture, or its software copy,
+        // locking only the rows that change
+        SDL_Rect rect = { 0, y, length(), h };
+        lock(&rect);
+
+        u_int32 src_format = SDL_MasksToPixelFormatEnum (32, R_MASK, G_MASK, B_MASK, A_MASK);
+        if (src_format != Info->Format)
+        {
+            SDL_ConvertPixels (length(), h, src_format, rgba, length() * 4, Info->Format, Info->Pixels, Info->Pitch);
+        }
+        else
+        {
+            copy_rows (Info->Pixels, Info->Pitch, rgba, length() * 4, length() * 4, h);
+        }
+
+        unlock();
+    }
+
     void * surface_sdl::get_data (u_int8 bytes_per_pixel,
                                   u_int32 red_mask, u_int32 green_mask,
                                   u_int32 blue_mask, u_int32 alpha_mask) const
@@ -627,17 +846,168 @@ namespace gfx
         }
         else
         {
-            u_int8 *dest = (u_int8*) dst_pixels;
-            int h = height();
-            while (h-- > 0)
+            // the texture pitch may be larger, especially on an atlas page
+            copy_rows (dst_pixels, dst_pitch, Info->Pixels, Info->Pitch, dst_pitch, height());
+        }
+
+        unlock();
+        return dst_pixels;
+    }
+
+    bool surface_sdl::pack_into_atlas ()
+    {
+        if (Atlas) return true;
+        if (!Surface) return false;
+
+        std::map<u_int32, atlas*>::iterator i = Atlases.find (Info->Format);
+        if (i == Atlases.end ())
+        {
+            i = Atlases.insert (std::pair<u_int32, atlas*> (Info->Format, new atlas ())).first;
+        }
+
+        atlas *a = i->second;
+        atlas_region region;
+
+        if (!a->Pages.accepts (length(), height()) || !a->Pages.allocate (length(), height(), region))
+        {
+            return false;
+        }
+
+        // a new page has been started
+        if (region.page == a->Textures.size())
+        {
+            u_int16 size = a->Pages.page_size();
+            SDL_Texture *page = SDL_CreateTexture (display->get_renderer(), Info->Format, SDL_TEXTUREACCESS_STREAMING, size, size);
+            if (!page)
             {
-                SDL_memcpy (dest, (u_int8*) Info->Pixels, Info->Pitch);
-                Info->Pixels = (u_int8*) Info->Pixels + Info->Pitch;
-                dest = dest + dst_pitch;
+                LOG(ERROR) << "*** surface_sdl::pack_into_atlas: " << SDL_GetError();
+                a->Pages.release (region);
+                return false;
             }
+
+            a->Textures.push_back (page);
         }
 
-        return dst_pixels;
+        // copy image onto its page
+        int pitch;
+        void *dst_pixels;
+        SDL_Rect area = { region.x, region.y, region.length, region.height };
+
+        lock(NULL);
+        SDL_LockTexture (a->Textures[region.page], &area, &dst_pixels, &pitch);
+        copy_rows (dst_pixels, pitch, Info->Pixels, Info->Pitch, length() * Info->BytesPerPixel, height());
+        SDL_UnlockTexture (a->Textures[region.page]);
+        unlock();
+
+        release_texture();
+
+        Surface = a->Textures[region.page];
+        Atlas = a;
+        Region = region;
+        return true;
+    }
+
+    // report software copy and texture separately
+    void surface_sdl::memory_usage (u_int32 & pixels, u_int32 & texture) const
+    {
+        pixels = Buffer ? Buffer->pitch * Buffer->h : 0;
+        texture = Surface ? length () * height () * SDL_BYTESPERPIXEL(Info->Format) : 0;
+    }
+
+    // drop software copy, it can be fetched from the texture again
+    void surface_sdl::release_pixels () const
+    {
+        // not while somebody is working on the pixels
+        if (!Buffer || Info->Pixels) return;
+
+        upload ();
+        SDL_FreeSurface (Buffer);
+        Buffer = NULL;
+    }
+
+    void surface_sdl::release_texture ()
+    {
+        if (Atlas)
+        {
+            Atlas->Pages.release (Region);
+            Atlas = NULL;
+        }
+        else if (Surface)
+        {
+            SDL_DestroyTexture (Surface);
+        }
+
+        if (Buffer)
+        {
+            SDL_FreeSurface (Buffer);
+            Buffer = NULL;
+        }
+
+        Surface = NULL;
+        Dirty = false;
+
+        // no longer mirroring another surface, if we did
+        Original = NULL;
+        Mirrored = false;
+        Flip = SDL_FLIP_NONE;
+    }
+
+    // draw texture of other surface flipped
+    void surface_sdl::set_mirror_of (const surface *original, const bool & x, const bool & y)
+    {
+        const surface_sdl *src = (const surface_sdl *) original;
+
+        // a mirror image of a mirror image is the original flipped the other way
+        while (src->Original) 
+        {
+            src = src->Original;
+        }
+
+        release_texture ();
+
+        (drawable&) (*this) = (drawable&) *original;
+        alpha_channel_ = original->has_alpha_channel();
+        is_masked_ = original->is_masked();
+        alpha_ = original->alpha();
+        is_mirrored_x_ = original->is_mirrored_x() != x;
+        is_mirrored_y_ = original->is_mirrored_y() != y;
+        filename_ = original->filename();
+
+        Info->Format = src->Info->Format;
+        Original = src;
+        src->Mirrored = true;
+        Flip = (SDL_RendererFlip) ((is_mirrored_x_ != src->is_mirrored_x() ? SDL_FLIP_HORIZONTAL : 0) |
+                                   (is_mirrored_y_ != src->is_mirrored_y() ? SDL_FLIP_VERTICAL : 0));
+    }
+
+    void surface_sdl::cleanup_atlas ()
+    {
+        std::map<u_int32, atlas*>::iterator i = Atlases.begin ();
+        while (i != Atlases.end ())
+        {
+            atlas *a = i->second;
+            bool in_use = false;
+
+            for (u_int32 page = 0; page < a->Pages.num_pages(); page++)
+            {
+                in_use |= a->Pages.num_images (page) > 0;
+            }
+
+            // surfaces still referring to the atlas must be able to release it
+            if (in_use)
+            {
+                i++;
+                continue;
+            }
+
+            for (std::vector<SDL_Texture*>::iterator t = a->Textures.begin (); t != a->Textures.end (); t++)
+            {
+                SDL_DestroyTexture (*t);
+            }
+
+            delete a;
+            Atlases.erase (i++);
+        }
     }
 
     void surface_sdl::setup_rects (s_int16 x, s_int16 y, s_int16 sx, s_int16 sy,
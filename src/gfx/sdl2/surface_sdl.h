@@ -24,6 +24,7 @@
 #define SDL_NO_COMPAT 1
 
 #include "../surface_ext.h"
+#include "../texture_atlas.h"
 #include "SDL.h"
 
 namespace gfx
@@ -78,6 +79,29 @@ namespace gfx
 
         void clear ();
 
+        void set_pixels (const void *pixels, u_int16 l, u_int16 h, bool alpha);
+
+        void put_rgba (const u_int8 *rgba);
+
+        void put_rgba_rows (const u_int8 *rgba, const u_int16 & y, const u_int16 & h);
+
+        bool pack_into_atlas ();
+
+        void memory_usage (u_int32 & pixels, u_int32 & texture) const;
+
+        void release_pixels () const;
+
+        /**
+         * Share the texture of the original and flip it while drawing,
+         * so a mirrored image costs neither memory nor loading time.
+         * A software copy is only created when blitting to another
+         * surface or reading pixels.
+         */
+        void set_mirror_of (const surface *original, const bool & x, const bool & y);
+
+        /// destroy the textures of all atlas pages
+        static void cleanup_atlas ();
+
     protected:
         void set_data (void * data, u_int16 l, u_int16 h,
                        u_int8 bytes_per_pixel = BYTES_PER_PIXEL,
@@ -89,19 +113,52 @@ namespace gfx
                          u_int32 blue_mask, u_int32 alpha_mask) const;
 
 
-        /// Create a software surface backed by the (streaming) texture data.
-        SDL_Surface *to_sw_surface(SDL_Rect *rect = NULL) const;
+        /**
+         * Get the software copy of the surface, used for blitting to
+         * other surfaces. It is created from the texture on first use
+         * and kept for the lifetime of the texture. From then on, the
+         * software copy is authoritative: lock() hands out its pixels
+         * and the texture is only updated before drawing to screen.
+         * The returned surface is owned by this surface.
+         */
+        SDL_Surface *to_sw_surface() const;
+
+        /// copy a modified software copy back into the texture
+        void upload () const;
 
         /// lock part of the surface specified by rect
         void lock (SDL_Rect *rect) const;
 
     private:
-        /// the surface
+        /// shared textures for images of one pixel format
+        struct atlas;
+
+        /// destroy the texture, or release its space in the atlas page
+        void release_texture ();
+
+        /// the surface, or the atlas page containing it
         SDL_Texture *Surface;
 
+        /// the atlas the surface is located in, or NULL
+        atlas *Atlas;
+        /// location of the surface on its atlas page
+        atlas_region Region;
+
+        /// software copy of the surface, if used in software blits
+        mutable SDL_Surface *Buffer;
+        /// whether the software copy has changes not yet in the texture
+        mutable bool Dirty;
+
         /// some meta-information about the surface
         pixel_info *Info;
 
+        /// surface whose texture is drawn mirrored, or NULL
+        const surface_sdl *Original;
+        /// whether other surfaces draw the texture of this one
+        mutable bool Mirrored;
+        /// how to flip the texture of the original
+        SDL_RendererFlip Flip;
+
         /// Has the mask setting changed?
         bool mask_changed; 
 
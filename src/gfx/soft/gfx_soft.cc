@@ -0,0 +1,63 @@
+/*
+   Copyright (C) 2011 Kai Sterker <kai.sterker@gmail.com>
+   Part of the Adonthell Project http://adonthell.linuxgames.com
+
+   Adonthell is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 2 of the License, or
+   (at your option) any later version.
+
+   Adonthell is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with Adonthell; if not, write to the Free Software
+   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+*/
+
+#ifdef USE_LIBTOOL
+/* exported names for libltdl */
+#define gfx_init _soft_LTX_gfx_init
+#define gfx_cleanup _soft_LTX_gfx_cleanup
+#define gfx_create_surface _soft_LTX_gfx_create_surface
+#endif
+
+#include "surface_soft.h"
+#include "screen_soft.h"
+
+extern "C"
+{
+    bool gfx_init();
+    void gfx_cleanup();
+
+    gfx::surface * gfx_create_surface();
+}
+
+/// the screen surface
+gfx::screen_surface_soft *display = NULL;
+
+/// surface to draw on when scaling is active
+gfx::surface_soft *shadow_surface = NULL;
+
+bool gfx_init()
+{
+    // no display to open, just memory
+    display = new gfx::screen_surface_soft ();
+    return true;
+}
+
+void gfx_cleanup()
+{
+    delete display;
+    delete shadow_surface;
+
+    display = NULL;
+    shadow_surface = NULL;
+}
+
+gfx::surface * gfx_create_surface()
+{
+    return new gfx::surface_soft();
+}
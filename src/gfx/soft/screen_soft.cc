@@ -0,0 +1,130 @@
+/*
+   Copyright (C) 2011 Kai Sterker <kai.sterker@gmail.com>
+   Part of the Adonthell Project http://adonthell.linuxgames.com
+
+   Adonthell is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 2 of the License, or
+   (at your option) any later version.
+
+   Adonthell is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with Adonthell; if not, write to the Free Software
+   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+*/
+
+#ifdef USE_LIBTOOL
+/* exported names for libltdl */
+#define gfx_screen_get_video_mode _soft_LTX_gfx_screen_get_video_mode
+#define gfx_screen_set_video_mode _soft_LTX_gfx_screen_set_video_mode
+#define gfx_screen_update _soft_LTX_gfx_screen_update
+#define gfx_screen_trans_color _soft_LTX_gfx_screen_trans_color
+#define gfx_screen_clear _soft_LTX_gfx_screen_clear
+#define gfx_screen_get_surface _soft_LTX_gfx_screen_get_surface
+#define gfx_screen_info _soft_LTX_gfx_screen_info
+#define gfx_screen_set_damage_tracking _soft_LTX_gfx_screen_set_damage_tracking
+#endif
+
+#include <sstream>
+#include "screen_soft.h"
+#include "../pixel_ops.h"
+
+/// size of the pretend desktop, used for fullscreen mode
+#define DESKTOP_LENGTH 640
+#define DESKTOP_HEIGHT 480
+
+/// color mask for transparency
+u_int32 trans_color = 0;
+
+/// number of frames rendered so far
+static u_int32 frames = 0;
+
+extern "C"
+{
+    void gfx_screen_get_video_mode(u_int16 *l, u_int16 *h, u_int8 *depth);
+    bool gfx_screen_set_video_mode(u_int16 nl, u_int16 nh, u_int8 depth);
+    void gfx_screen_update();
+    u_int32 gfx_screen_trans_color();
+    void gfx_screen_clear();
+    gfx::surface *gfx_screen_get_surface();
+    std::string gfx_screen_info();
+    bool gfx_screen_set_damage_tracking(bool enable);
+}
+
+void gfx_screen_get_video_mode(u_int16 *l, u_int16 *h, u_int8 *depth)
+{
+    *l = DESKTOP_LENGTH;
+    *h = DESKTOP_HEIGHT;
+    *depth = 4;
+}
+
+bool gfx_screen_set_video_mode(u_int16 nl, u_int16 nh, u_int8 depth)
+{
+    if (!display->set_video_mode (nl, nh)) return false;
+
+    // Create shadow surface if scaling is used
+    delete shadow_surface;
+    shadow_surface = NULL;
+
+    if (gfx::screen::scale() > 1)
+    {
+        shadow_surface = new gfx::surface_soft();
+        shadow_surface->set_alpha(255, 0);
+        shadow_surface->resize (nl / gfx::screen::scale(), nh / gfx::screen::scale());
+    }
+
+    // Setting up transparency color
+    trans_color = display->map_color (gfx::screen::TRANS_RED, gfx::screen::TRANS_GREEN, gfx::screen::TRANS_BLUE);
+    return true;
+}
+
+void gfx_screen_update()
+{
+    if (shadow_surface)
+    {
+        shadow_surface->scale_up (display, gfx::screen::scale());
+    }
+
+    frames++;
+}
+
+u_int32 gfx_screen_trans_color()
+{
+    return trans_color;
+}
+
+void gfx_screen_clear()
+{
+    gfx::surface *s = gfx_screen_get_surface();
+    s->fillrect (0, 0, s->length(), s->height(), 0);
+}
+
+gfx::surface * gfx_screen_get_surface()
+{
+    return shadow_surface ? (gfx::surface *) shadow_surface : (gfx::surface *) display;
+}
+
+std::string gfx_screen_info()
+{
+    static const char *instruction_sets[] = { "None", "SSE2", "AVX2" };
+    std::ostringstream temp;
+
+    temp << "Video information: " << std::endl
+         << "Backend:           " << "Software (no display)" << std::endl
+         << "Display size:      " << display->length() << " x " << display->height() << std::endl
+         << "SIMD kernels:      " << instruction_sets[gfx::pixel_ops::current_instruction_set()] << std::endl
+         << "Frames rendered:   " << frames << std::endl
+         << std::ends;
+
+    return temp.str ();
+}
+
+bool gfx_screen_set_damage_tracking(bool enable)
+{
+    // frames are kept in memory anyway
+    return true;
+}
@@ -0,0 +1,63 @@
+/*
+   Copyright (C) 2011 Kai Sterker <kai.sterker@gmail.com>
+   Part of the Adonthell Project http://adonthell.linuxgames.com
+
+   Adonthell is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 2 of the License, or
+   (at your option) any later version.
+
+   Adonthell is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with Adonthell; if not, write to the Free Software
+   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+*/
+
+/**
+ * @file   gfx/soft/screen_soft.h
+ * @author Kai Sterker <kai.sterker@gmail.com>
+ *
+ * @brief  Declares the screen surface of the software backend.
+ *
+ *
+ */
+
+#ifndef GFX_SOFT_SCREEN_H_
+#define GFX_SOFT_SCREEN_H_
+
+#include <adonthell/base/logging.h>
+#include "../screen.h"
+#include "surface_soft.h"
+
+extern u_int32 trans_color;
+
+namespace gfx
+{
+    /**
+     * The screen of the software backend is just an image in memory.
+     * Nothing is ever shown, but the frame can be read back or saved
+     * like any other surface.
+     */
+    class screen_surface_soft : public surface_soft
+    {
+    public:
+        ~screen_surface_soft() { }
+        void resize (u_int16 l, u_int16 h) { LOG(ERROR) << logging::indent() << "Invalid operation: Can't resize the screen surface!"; }
+        void clear () { LOG(ERROR) << logging::indent() << "Invalid operation: Can't clear the screen surface!"; }
+        bool set_video_mode (u_int16 nl, u_int16 nh)
+        {
+            surface_soft::resize (nl, nh);
+            return length () == nl && height () == nh;
+        }
+    };
+}
+
+extern gfx::screen_surface_soft *display;
+
+extern gfx::surface_soft *shadow_surface;
+
+#endif // GFX_SOFT_SCREEN_H_
@@ -0,0 +1,377 @@
+/*
+   Copyright (C) 2011 Kai Sterker <kai.sterker@gmail.com>
+   Part of the Adonthell Project http://adonthell.linuxgames.com
+
+   Adonthell is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 2 of the License, or
+   (at your option) any later version.
+
+   Adonthell is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with Adonthell; if not, write to the Free Software
+   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+*/
+
+/**
+ * @file   gfx/soft/surface_soft.cc
+ * @author Kai Sterker <kai.sterker@gmail.com>
+ *
+ * @brief  Defines the surface_soft class.
+ *
+ *
+ */
+
+#include <cstdlib>
+#include <cstring>
+#include <algorithm>
+
+#include "surface_soft.h"
+#include "screen_soft.h"
+#include "../pixel_ops.h"
+
+/// rows start at multiples of this many bytes
+#define ROW_ALIGNMENT 32
+
+/// position of the lowest bit set in the given mask
+static u_int32 mask_shift (u_int32 mask)
+{
+    u_int32 shift = 0;
+    if (mask == 0) return 0;
+
+    while ((mask & 1) == 0)
+    {
+        mask >>= 1;
+        shift++;
+    }
+
+    return shift;
+}
+
+/// extract the channel with the given mask from a pixel
+static u_int8 get_channel (const u_int32 & px, const u_int32 & mask)
+{
+    return (px & mask) >> mask_shift (mask);
+}
+
+/// put the channel with the given mask into a pixel
+static u_int32 put_channel (const u_int8 & value, const u_int32 & mask)
+{
+    return (((u_int32) value) << mask_shift (mask)) & mask;
+}
+
+namespace gfx
+{
+    surface_soft::surface_soft () : surface_ext ()
+    {
+        Pixels = NULL;
+        Pitch = 0;
+    }
+
+    surface_soft::~surface_soft ()
+    {
+        free (Pixels);
+    }
+
+    void surface_soft::set_mask (bool m)
+    {
+        is_masked_ = m;
+    }
+
+    void surface_soft::set_alpha (const u_int8 & t, const bool & alpha_channel)
+    {
+        alpha_ = t;
+        alpha_channel_ = alpha_channel;
+    }
+
+    void surface_soft::draw (s_int16 x, s_int16 y, s_int16 sx, s_int16 sy, u_int16 sl,
+                             u_int16 sh, const drawing_area * da_opt,
+                             surface * target) const
+    {
+        surface_soft *dst = (surface_soft *) (target == NULL ? screen::get_surface () : target);
+
+        drawing_area da = clip (x, y, sx, sy, sl, sh, da_opt, dst);
+        if (!da.length () || !da.height ()) return;
+
+        if (dst == display || dst == shadow_surface)
+        {
+            screen::count_draw_call (this);
+        }
+
+        const bool blend = alpha_channel_ || alpha_ != 255;
+        u_int32 *tmp = NULL;
+
+        if (is_masked_ && blend)
+        {
+            tmp = new u_int32[da.length ()];
+        }
+
+        for (u_int16 j = 0; j < da.height (); j++)
+        {
+            const u_int32 *src = row (sy + j) + sx;
+            u_int32 *line = dst->row (da.y () + j) + da.x ();
+
+            if (tmp)
+            {
+                // make masked pixels transparent, then blend
+                for (u_int16 i = 0; i < da.length (); i++)
+                {
+                    if ((src[i] & ~A_MASK) == (trans_color & ~A_MASK)) tmp[i] = 0;
+                    else tmp[i] = alpha_channel_ ? src[i] : src[i] | A_MASK;
+                }
+
+                pixel_ops::blend ((u_int8*) line, (const u_int8*) tmp, da.length (), alpha_, true);
+            }
+            else if (blend)
+            {
+                pixel_ops::blend ((u_int8*) line, (const u_int8*) src, da.length (), alpha_, alpha_channel_);
+            }
+            else if (is_masked_)
+            {
+                pixel_ops::copy_keyed ((u_int8*) line, (const u_int8*) src, da.length (), trans_color);
+            }
+            else
+            {
+                memcpy (line, src, da.length () * 4);
+            }
+        }
+
+        delete[] tmp;
+    }
+
+    void surface_soft::fillrect (s_int16 x, s_int16 y, u_int16 l, u_int16 h, u_int32 col,
+                                 drawing_area * da_opt)
+    {
+        drawing_area bounds (0, 0, length (), height ());
+        drawing_area zone = da_opt ? da_opt->setup_rects () : drawing_area (x, y, l, h);
+        zone.assign_drawing_area (&bounds);
+
+        drawing_area da = zone.setup_rects ();
+        for (u_int16 j = 0; j < da.height (); j++)
+        {
+            u_int32 *line = row (da.y () + j) + da.x ();
+            std::fill (line, line + da.length (), col);
+        }
+    }
+
+    void surface_soft::scale_up (surface *target, const u_int32 & factor) const
+    {
+        if (length () * factor > target->length () ||
+            height () * factor > target->height ())
+            return;
+
+        const surface_soft *dst = (const surface_soft *) target;
+        pixel_ops::scale_up ((u_int8*) dst->Pixels, dst->Pitch * 4, (const u_int8*) Pixels, Pitch * 4,
+            length (), height (), 4, factor);
+    }
+
+    void surface_soft::scale_down (surface *target, const u_int32 & factor) const
+    {
+        if (length () * factor > target->length () ||
+            height () * factor > target->height ())
+            return;
+
+        const surface_soft *dst = (const surface_soft *) target;
+        pixel_ops::scale_down ((u_int8*) dst->Pixels, dst->Pitch * 4, (const u_int8*) Pixels, Pitch * 4,
+            length (), height (), 4, factor);
+    }
+
+    // convert RGBA color to surface format
+    u_int32 surface_soft::map_color (const u_int8 & r, const u_int8 & g, const u_int8 & b, const u_int8 & a) const
+    {
+        return put_channel (r, R_MASK) | put_channel (g, G_MASK) | put_channel (b, B_MASK) | put_channel (a, A_MASK);
+    }
+
+    // convert surface color format into RGBA
+    void surface_soft::unmap_color (u_int32 col, u_int8 & r, u_int8 & g, u_int8 & b, u_int8 & a) const
+    {
+        r = get_channel (col, R_MASK);
+        g = get_channel (col, G_MASK);
+        b = get_channel (col, B_MASK);
+        a = get_channel (col, A_MASK);
+    }
+
+    void surface_soft::put_pix (u_int16 x, u_int16 y, u_int32 col)
+    {
+        row (y)[x] = col;
+    }
+
+    u_int32 surface_soft::get_pix (u_int16 x, u_int16 y) const
+    {
+        return row (y)[x];
+    }
+
+    surface & surface_soft::operator = (const surface& src)
+    {
+        const surface_soft & src_soft = (const surface_soft &) src;
+
+        (drawable&) (*this) = (drawable&) src;
+        alpha_channel_ = src.has_alpha_channel ();
+        is_masked_ = src.is_masked ();
+        alpha_ = src.alpha ();
+
+        allocate (src.length (), src.height ());
+        if (Pixels)
+        {
+            memcpy (Pixels, src_soft.Pixels, Pitch * height () * 4);
+        }
+
+        return *this;
+    }
+
+    void surface_soft::resize (u_int16 l, u_int16 h)
+    {
+        if (l == length () && h == height ()) return;
+
+        allocate (l, h);
+    }
+
+    void surface_soft::clear ()
+    {
+        if (Pixels)
+        {
+            allocate (0, 0);
+            set_alpha (255);
+            set_mask (false);
+        }
+    }
+
+    // get copy of image as RGBA data
+    u_int8 *surface_soft::get_rgba () const
+    {
+        u_int8 *rgba = (u_int8*) calloc (4, length () * height ());
+        for (u_int16 j = 0; j < height (); j++)
+        {
+            memcpy (rgba + j * length () * 4, row (j), length () * 4);
+        }
+
+        return rgba;
+    }
+
+    // update image from RGBA data
+    void surface_soft::put_rgba (const u_int8 *rgba)
+    {
+        put_rgba_rows (rgba, 0, height ());
+    }
+
+    // update part of image from RGBA data
+    void surface_soft::put_rgba_rows (const u_int8 *rgba, const u_int16 & y, const u_int16 & h)
+    {
+        if (y + h > height ()) return;
+
+        for (u_int16 j = 0; j < h; j++)
+        {
+            memcpy (row (y + j), rgba + j * length () * 4, length () * 4);
+        }
+    }
+
+    void surface_soft::set_data (void * data, u_int16 l, u_int16 h, u_int8 bytes_per_pixel, u_int32 red_mask,
+                                 u_int32 green_mask, u_int32 blue_mask, u_int32 alpha_mask)
+    {
+        allocate (l, h);
+
+        const u_int8 *src = (const u_int8 *) data;
+        for (u_int16 j = 0; j < h; j++)
+        {
+            u_int32 *line = row (j);
+
+            // no conversion necessary
+            if (bytes_per_pixel == 4 && red_mask == R_MASK && green_mask == G_MASK &&
+                blue_mask == B_MASK && alpha_mask == A_MASK)
+            {
+                memcpy (line, src, l * 4);
+                src += l * 4;
+                continue;
+            }
+
+            for (u_int16 i = 0; i < l; i++, src += bytes_per_pixel)
+            {
+                u_int32 px = 0;
+                memcpy (&px, src, bytes_per_pixel);
+
+                line[i] = map_color (get_channel (px, red_mask), get_channel (px, green_mask),
+                    get_channel (px, blue_mask), alpha_mask ? get_channel (px, alpha_mask) : 255);
+            }
+        }
+
+        if (alpha_mask) alpha_channel_ = true;
+
+        // we own the given data
+        free (data);
+    }
+
+    void * surface_soft::get_data (u_int8 bytes_per_pixel,
+                                   u_int32 red_mask, u_int32 green_mask,
+                                   u_int32 blue_mask, u_int32 alpha_mask) const
+    {
+        u_int8 *data = (u_int8 *) calloc (bytes_per_pixel, length () * height ());
+
+        u_int8 *dst = data;
+        for (u_int16 j = 0; j < height (); j++)
+        {
+            const u_int32 *line = row (j);
+            for (u_int16 i = 0; i < length (); i++, dst += bytes_per_pixel)
+            {
+                u_int8 r, g, b, a;
+                unmap_color (line[i], r, g, b, a);
+
+                u_int32 px = put_channel (r, red_mask) | put_channel (g, green_mask) |
+                    put_channel (b, blue_mask) | put_channel (a, alpha_mask);
+                memcpy (dst, &px, bytes_per_pixel);
+            }
+        }
+
+        return data;
+    }
+
+    // get memory for the image
+    void surface_soft::allocate (const u_int16 & l, const u_int16 & h)
+    {
+        free (Pixels);
+        Pixels = NULL;
+
+        set_length (l);
+        set_height (h);
+
+        // pad rows, so each one starts aligned
+        Pitch = (l + ROW_ALIGNMENT / 4 - 1) & ~(ROW_ALIGNMENT / 4 - 1);
+        if (Pitch * h == 0) return;
+
+        if (posix_memalign ((void **) &Pixels, ROW_ALIGNMENT, Pitch * h * 4) != 0)
+        {
+            LOG(ERROR) << "*** surface_soft: failed allocating " << l << "x" << h << " pixels";
+            Pixels = NULL;
+            set_length (0);
+            set_height (0);
+            return;
+        }
+
+        memset (Pixels, 0, Pitch * h * 4);
+    }
+
+    // limit drawing to what is inside both images
+    drawing_area surface_soft::clip (const s_int16 & x, const s_int16 & y, s_int16 & sx, s_int16 & sy, const u_int16 & sl,
+                                     const u_int16 & sh, const drawing_area * da_opt, const surface *target) const
+    {
+        // never write outside the target ...
+        drawing_area dst_bounds (0, 0, target->length (), target->height ());
+        dst_bounds.assign_drawing_area (da_opt);
+
+        // ... nor read outside this image
+        drawing_area src_bounds (x - sx, y - sy, length (), height ());
+        src_bounds.assign_drawing_area (&dst_bounds);
+
+        drawing_area im_zone (x, y, sl, sh);
+        im_zone.assign_drawing_area (&src_bounds);
+
+        drawing_area da = im_zone.setup_rects ();
+        sx += da.x () - x;
+        sy += da.y () - y;
+
+        return da;
+    }
+}
@@ -0,0 +1,144 @@
+/*
+   Copyright (C) 2011 Kai Sterker <kai.sterker@gmail.com>
+   Part of the Adonthell Project http://adonthell.linuxgames.com
+
+   Adonthell is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 2 of the License, or
+   (at your option) any later version.
+
+   Adonthell is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with Adonthell; if not, write to the Free Software
+   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+*/
+
+/**
+ * @file   gfx/soft/surface_soft.h
+ * @author Kai Sterker <kai.sterker@gmail.com>
+ *
+ * @brief  Declares the surface_soft class.
+ *
+ *
+ */
+
+#ifndef SURFACE_SOFT_H_
+#define SURFACE_SOFT_H_
+
+#include "../surface_ext.h"
+
+namespace gfx
+{
+    /**
+     * A surface that lives in plain memory and is drawn in software,
+     * without the need for a display. Pixels are always stored as
+     * 32 bit values with the R_MASK, G_MASK, B_MASK and A_MASK layout.
+     * Each row starts on a 32 byte boundary, so the blending kernels
+     * of pixel_ops run on aligned data.
+     */
+    class surface_soft : public surface_ext
+    {
+    public:
+        surface_soft ();
+
+        virtual ~surface_soft ();
+
+        void set_mask (bool m);
+
+        void set_alpha (const u_int8 & surface_alpha, const bool & alpha_channel = false);
+
+        void draw (s_int16 x, s_int16 y, s_int16 sx, s_int16 sy, u_int16 sl,
+                   u_int16 sh, const drawing_area * da_opt = NULL,
+                   surface * target = NULL) const;
+
+        void fillrect (s_int16 x, s_int16 y, u_int16 l, u_int16 h,
+                       u_int32 col, drawing_area * da_opt = NULL);
+
+        void scale_up (surface *target, const u_int32 & factor) const;
+        void scale_down (surface *target, const u_int32 & factor) const;
+
+        u_int32 map_color (const u_int8 & r, const u_int8 & g, const u_int8 & b, const u_int8 & a = 255) const;
+        void unmap_color (u_int32 col, u_int8 & r, u_int8 & g, u_int8 & b, u_int8 & a) const;
+        void lock () const { }
+        void unlock () const { }
+        void put_pix (u_int16 x, u_int16 y, u_int32 col);
+        u_int32 get_pix (u_int16 x, u_int16 y) const;
+
+        surface& operator = (const surface& src);
+
+        void resize (u_int16 l, u_int16 h);
+
+        void clear ();
+
+        u_int8 *get_rgba () const;
+
+        void put_rgba (const u_int8 *rgba);
+
+        void put_rgba_rows (const u_int8 *rgba, const u_int16 & y, const u_int16 & h);
+
+        void memory_usage (u_int32 & pixels, u_int32 & texture) const
+        {
+            pixels = Pitch * height () * 4;
+            texture = 0;
+        }
+
+        /**
+         * Get the start of the given row of pixels.
+         * @param y the row.
+         * @return pointer to the first pixel of the row.
+         */
+        u_int32 *row (const u_int16 & y) const
+        {
+            return Pixels + y * Pitch;
+        }
+
+    protected:
+        void set_data (void * data, u_int16 l, u_int16 h,
+                       u_int8 bytes_per_pixel = BYTES_PER_PIXEL,
+                       u_int32 red_mask = R_MASK, u_int32 green_mask = G_MASK,
+                       u_int32 blue_mask = B_MASK, u_int32 alpha_mask = 0);
+
+        void * get_data (u_int8 bytes_per_pixel,
+                         u_int32 red_mask, u_int32 green_mask,
+                         u_int32 blue_mask, u_int32 alpha_mask) const;
+
+    private:
+        /**
+         * Allocate memory for an image of the given size. Previous
+         * contents are lost.
+         * @param l length of the image.
+         * @param h height of the image.
+         */
+        void allocate (const u_int16 & l, const u_int16 & h);
+
+        /**
+         * Clip a rectangle of this image to the given target and
+         * optional clipping rectangle.
+         * @param x X position where to draw.
+         * @param y Y position where to draw.
+         * @param sx X position where to start drawing from this image.
+         *      Updated to the first pixel that is actually drawn.
+         * @param sy Y position where to start drawing from this image.
+         *      Updated to the first pixel that is actually drawn.
+         * @param sl length of the part of this image to draw.
+         * @param sh height of the part of this image to draw.
+         * @param da_opt optional clipping rectangle.
+         * @param target the surface to draw on.
+         * @return area of the target to draw, empty if nothing to draw.
+         */
+        drawing_area clip (const s_int16 & x, const s_int16 & y, s_int16 & sx, s_int16 & sy, const u_int16 & sl,
+                           const u_int16 & sh, const drawing_area * da_opt, const surface *target) const;
+
+        /// the pixel data
+        u_int32 *Pixels;
+
+        /// number of pixels from one row to the next
+        u_int32 Pitch;
+    };
+}
+
+#endif // SURFACE_SOFT_H_
@@ -97,6 +97,9 @@ namespace gfx
         set_length ((*m_surface)->image->s->length());
         set_height ((*m_surface)->image->s->height());
 
+        // the new animation needs to be drawn
+        invalidate ();
+
         // set delay until next frame
         events::time_event *evt = (events::time_event *) m_listener->get_event ();
         evt->set_time (events::date::convert_millis ((*m_surface)->delay) + events::date::time ());
@@ -123,6 +126,9 @@ namespace gfx
             m_surface++;
             if (m_surface == m_animation->second.end())
                 m_surface = m_animation->second.begin();
+
+            // the next frame needs to be drawn
+            invalidate ();
         
             // set delay until next frame
             events::time_event *evt = (events::time_event *) m_listener->get_event ();
@@ -152,7 +158,10 @@ namespace gfx
     void sprite::rewind ()
     {
         if (m_valid)
+        {
             m_surface = m_animation->second.begin();
+            invalidate ();
+        }
     }
     
     // load from stream
@@ -171,7 +180,7 @@ namespace gfx
             while (anim.next (&value, &size, &id) == base::flat::T_FLAT) 
             {
                 base::flat frame ((const char*) value, size);
-                cur_animation.push_back(new animation_frame(surfaces->get_surface(id, frame.get_bool("mask"), frame.get_bool("mirrored_x"), frame.get_bool("mirrored_y")), frame.get_uint32("delay")));
+                cur_animation.push_back(new animation_frame(surfaces->get_surface_async(id, frame.get_bool("mask"), frame.get_bool("mirrored_x"), frame.get_bool("mirrored_y")), frame.get_uint32("delay")));
             }
             
             m_states[animation_name] = cur_animation;
@@ -193,7 +202,7 @@ namespace gfx
             if (base::Paths().find_in_path (full_path))
             {
                 animation_list cur_animation;
-                cur_animation.push_back (new animation_frame (surfaces->get_surface (full_path, false, false), 0));
+                cur_animation.push_back (new animation_frame (surfaces->get_surface_async (full_path, false, false), 0));
                 m_states["default"] = cur_animation;
                 retval = true;
             }
@@ -284,4 +293,37 @@ namespace gfx
     {
   		return m_filename;
     }
+
+    // load images of sprite in advance
+    bool sprite::prefetch (const std::string & filename)
+    {
+        // raw png, as in load ()
+        if (filename.find (".png", filename.size() - 4) != std::string::npos)
+        {
+            std::string full_path (filename);
+            if (!base::Paths().find_in_path (full_path)) return false;
+
+            surfaces->prefetch (full_path, false, false);
+            return true;
+        }
+
+        base::diskio animation (base::diskio::XML_FILE);
+        if (!animation.get_record (filename)) return false;
+
+        u_int32 size;
+        void *value;
+        char *id;
+
+        while (animation.next (&value, &size, &id) == base::flat::T_FLAT)
+        {
+            base::flat anim = base::flat ((const char*) value, size);
+            while (anim.next (&value, &size, &id) == base::flat::T_FLAT)
+            {
+                base::flat frame ((const char*) value, size);
+                surfaces->prefetch (id, frame.get_bool("mask"), frame.get_bool("mirrored_x"), frame.get_bool("mirrored_y"));
+            }
+        }
+
+        return animation.success ();
+    }
 }
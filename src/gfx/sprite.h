@@ -218,7 +218,11 @@ namespace gfx
                            u_int16 sh, const drawing_area * da_opt = NULL,
                            surface * target = NULL) const
         {
-            if (m_valid) (*m_surface)->image->s->draw(x, y, sx, sy, sl, sh, da_opt, target);
+            if (m_valid)
+            {
+                (*m_surface)->image->s->draw(x, y, sx, sy, sl, sh, da_opt, target);
+                drawn_at (x - sx, y - sy, target);
+            }
         }
         //@}
         
@@ -270,6 +274,16 @@ namespace gfx
          * @return true if successful
          */
         bool save (const std::string & filename) const;
+
+        /**
+         * Start loading the images of a %sprite that will be needed
+         * soon, without creating the %sprite itself. With background
+         * loading enabled, this returns before images are decoded.
+         *
+         * @param filename xml or png file to prefetch
+         * @return true if the %sprite file could be read
+         */
+        static bool prefetch (const std::string & filename);
         //@}
         
 #ifndef SWIG
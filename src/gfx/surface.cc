@@ -33,6 +33,8 @@
 #include <adonthell/base/base.h>
 #include <adonthell/base/logging.h>
 #include "screen.h"
+#include "image_pack.h"
+#include "pixel_ops.h"
 
 namespace gfx
 {
@@ -156,153 +158,39 @@ namespace gfx
                 draw (da.x() + posx, da.y() + posy, &da, target);
     }
 
+    // copy and mirror other surface
+    void surface::set_mirror_of (const surface *original, const bool & x, const bool & y)
+    {
+        *this = *original;
+        mirror (x, y);
+
+        is_mirrored_x_ = original->is_mirrored_x () != x;
+        is_mirrored_y_ = original->is_mirrored_y () != y;
+        filename_ = original->filename ();
+    }
+
     // adjust brightness
     void surface::set_brightness (const u_int8 & level)
     {
-        const s_int32 trans_col = screen::trans_color ();
+        // fully transparent pixels and the mask color remain untouched
         const s_int8 mod = level - 127;
-        u_int8 ir, ig, ib, ia;
-        
-        lock();
-        
-        if (mod > 0)
-        {
-            for (int l = 0; l < length(); l++)
-            {
-                for (int h = 0; h < height(); h++)
-                {
-                    u_int32 pix = get_pix (l, h);
-                    if (!is_masked() || pix != (u_int32)trans_col)
-                    {
-                        unmap_color (pix, ir, ig, ib, ia);
-                        if (ia != 0)
-                        {
-                            ir = (ir + mod) > 255 ? 255 : ir + mod;
-                            ig = (ig + mod) > 255 ? 255 : ig + mod;
-                            ib = (ib + mod) > 255 ? 255 : ib + mod;
-                            put_pix (l, h, map_color (ir, ig, ib, ia));
-                        }
-                    }
-                }
-            }
-        }
-        else
-        {
-            for (int l = 0; l < length(); l++)
-            {
-                for (int h = 0; h < height(); h++)
-                {
-                    u_int32 pix = get_pix (l, h);
-                    if (!is_masked() || pix != (u_int32)trans_col)
-                    {
-                        unmap_color (pix, ir, ig, ib, ia);
-                        if (ia != 0)
-                        {
-                            ir = (ir + mod) < 0 ? 0 : ir + mod;
-                            ig = (ig + mod) < 0 ? 0 : ig + mod;
-                            ib = (ib + mod) < 0 ? 0 : ib + mod;
-                            put_pix (l, h, map_color (ir, ig, ib, ia));
-                        }
-                    }
-                }
-            }
-        }
-        
-        unlock();        
-    }
+        if (mod == 0 || !length() || !height()) return;
 
-    /// values for blurring R, G and B channels
-    const float kernel_rgb[] = { .056, .126, .201, .235, .201, .126, .056 };
-    /// values for blurring alpha channel
-    const float kernel_a[]   = { .075, .18,  .3,   .35,  .3,   .18,  .075 };
+        u_int8 *data = get_rgba ();
+        pixel_ops::brighten (data, length() * height(), mod, is_masked(), screen::trans_color ());
+        put_rgba (data);
+        free (data);
+    }
 
     // gaussian blur
     void surface::blur ()
     {
-        u_int8 r, g, b, a;
-        int i, j, k, l;
-
-        lock();
-
-        // make a copy of the data
-        u_int8* data = new u_int8[length() * height() * 4];
-        k = 0;
-        for (j = 0; j < height(); j++)
-        {
-            for (i = 0; i < length(); i++)
-            {
-                unmap_color (get_pix(i, j), r, g, b, a);
-
-                data[k++] = r;
-                data[k++] = g;
-                data[k++] = b;
-                data[k++] = a;
-            }
-        }
-
-        // smear horizontally
-        for (j = 0; j < height(); j++)
-        {
-            for (i = 0; i < length(); i++)
-            {
-                int kmin = i < 4 ? 3 - i : 0;
-                int kmax = i > length() - 4 ? length() - i + 3 : 7;
-
-                r = g = b = a = 0;
-                l = (j * length() + i) * 4;
-
-                for (k = kmin; k < kmax; k++)
-                {
-                    r += data[l + ((k - 3) << 2)]     * kernel_rgb[k];
-                    g += data[l + ((k - 3) << 2) + 1] * kernel_rgb[k];
-                    b += data[l + ((k - 3) << 2) + 2] * kernel_rgb[k];
-                    a = std::min ((int) (a + data[l + ((k - 3) << 2) + 3] * kernel_a[k]), 0xFF);
-                }
-
-                put_pix (i, j, map_color (r, g, b, a));
-            }
-        }
-
-        // make another copy
-        k = 0;
-        for (j = 0; j < height(); j++)
-        {
-            for (i = 0; i < length(); i++)
-            {
-                unmap_color (get_pix(i, j), r, g, b, a);
-
-                data[k++] = r;
-                data[k++] = g;
-                data[k++] = b;
-                data[k++] = a;
-            }
-        }
-
-        // smear vertically
-        for (j = 0; j < height(); j++)
-        {
-            for (i = 0; i < length(); i++)
-            {
-                int kmin = j < 4 ? 3 - j : 0;
-                int kmax = j > height() - 4 ? height() - j + 3 : 7;
-
-                r = g = b = a = 0;
-                l = (j * length() + i) * 4;
-
-                for (k = kmin; k < kmax; k++)
-                {
-                    r += data[l + (((k - 3) * length()) << 2)]     * kernel_rgb[k];
-                    g += data[l + (((k - 3) * length()) << 2) + 1] * kernel_rgb[k];
-                    b += data[l + (((k - 3) * length()) << 2) + 2] * kernel_rgb[k];
-                    a = std::min ((int) (a + data[l + (((k - 3) * length()) << 2) + 3] * kernel_a[k]), 0xFF);
-                }
-
-                put_pix (i, j, map_color (r, g, b, a));
-            }
-        }
+        if (!length() || !height()) return;
 
-        delete[] data;
-        unlock();
+        u_int8 *data = get_rgba ();
+        pixel_ops::blur (data, length(), height(), has_alpha_channel());
+        put_rgba (data);
+        free (data);
     }
 
     // save meta data to stream
@@ -332,7 +220,19 @@ namespace gfx
     {
         // find file in adonthell's search path
         std::string path = fname;
-        if (!base::Paths().find_in_path (path))
+        bool found = base::Paths().find_in_path (path, false);
+
+        // prefer pre-decoded image, unless overridden by user or saved game
+        if (!found || path.compare (0, base::Paths().game_data_dir().length(), base::Paths().game_data_dir()) == 0)
+        {
+            if (image_pack::load_image (fname, this))
+            {
+                filename_ = path;
+                return true;
+            }
+        }
+
+        if (!found)
         {
             LOG(ERROR) << logging::indent()
                        << "*** surface::load_png: unable to open '" << fname << "'";
@@ -260,6 +260,18 @@ namespace gfx
          */
         virtual void mirror (bool x, bool y) = 0;
 
+        /**
+         * Turn this %surface into a mirror image of another one. Backends
+         * that can mirror while drawing share the pixels of the original,
+         * which must therefore outlive this %surface. Others copy them.
+         * Call again whenever the original has changed.
+         *
+         * @param original the %surface to mirror.
+         * @param x  Invert x axis
+         * @param y  Invert y axis
+         */
+        virtual void set_mirror_of (const surface *original, const bool & x, const bool & y);
+
         /**
          * Tile this %surface onto the given %surface. The location
          * tiled can be constrained by an optional drawing_area. If
@@ -477,6 +489,69 @@ namespace gfx
          */
         bool load_png (const std::string & fname);
 
+#ifndef SWIG
+        /** Replaces the image with the given pixel data, in the format
+         *  returned by png::get. The data is copied, so the caller
+         *  remains responsible for freeing it.
+         *  @param pixels RGB or RGBA data of the new image.
+         *  @param l length of the new image.
+         *  @param h height of the new image.
+         *  @param alpha whether the data contains an alpha channel.
+         */
+        virtual void set_pixels (const void *pixels, u_int16 l, u_int16 h, bool alpha) = 0;
+
+        /** Hint that the image is complete and unlikely to change, so
+         *  that the backend may move it into a texture shared with other
+         *  small images. Drawing images that share a texture is cheaper,
+         *  as the renderer can batch them. The surface remains fully
+         *  usable afterwards. Default implementation does nothing.
+         *  @return \e true if the image has been moved into a shared texture.
+         */
+        virtual bool pack_into_atlas () { return false; }
+
+        /** Returns a copy of the image as 32 bit RGBA data, in the
+         *  format returned by png::get, for processing it in bulk.
+         *  @attention The returned value has been allocated with malloc() -
+         *  it's up to you to free() it when you no longer need it.
+         *  @return the pixels of the image, row by row.
+         */
+        virtual u_int8 *get_rgba () const = 0;
+
+        /** Replaces the pixels of the image with the given 32 bit RGBA
+         *  data, as returned by get_rgba. Unlike set_pixels, the size,
+         *  format and settings of the surface remain unchanged.
+         *  @param rgba length() * height() pixels of RGBA data.
+         */
+        virtual void put_rgba (const u_int8 *rgba) = 0;
+
+        /** Replaces some rows of the image with the given 32 bit RGBA
+         *  data, for updating part of a large image without converting
+         *  or uploading all of it.
+         *  @param rgba length() * h pixels of RGBA data.
+         *  @param y first row to replace.
+         *  @param h number of rows to replace.
+         */
+        virtual void put_rgba_rows (const u_int8 *rgba, const u_int16 & y, const u_int16 & h) = 0;
+
+        /** Get the memory used by the image, split into pixel data kept
+         *  in system memory and texture memory. Default implementation
+         *  reports size() as pixel data.
+         *  @param pixels bytes of pixel data in system memory.
+         *  @param texture bytes of texture memory.
+         */
+        virtual void memory_usage (u_int32 & pixels, u_int32 & texture) const
+        {
+            pixels = size ();
+            texture = 0;
+        }
+
+        /** Free pixel data kept in system memory that the surface
+         *  can restore on demand, such as a software copy of its
+         *  texture. Default implementation does nothing.
+         */
+        virtual void release_pixels () const { }
+#endif
+
         /** Saves an image into an opened file, in PNG format, without
          *  alpha and mask values.
          *
@@ -525,6 +600,9 @@ namespace gfx
          *
          */
         surface (const surface & src);
+
+        /// sets up images decoded in the background
+        friend class surface_cacher;
     };
 }
 
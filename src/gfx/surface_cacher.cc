@@ -30,138 +30,150 @@
  */
 
 #include <cstdio>
-#include <sstream>
+#include <cstdlib>
+#include <fstream>
+#include <thread>
+#include <adonthell/base/logging.h>
+#include <adonthell/base/paths.h>
 #include "gfx.h"
 #include "surface_cacher.h"
+#include "image_loader.h"
+#include "image_pack.h"
+#include "png_wrapper.h"
+
+/// bits of the cache key used for image settings
+#define FLAG_BITS 4
+/// image is masked
+#define FLAG_MASK 1
+/// image was added from memory, not loaded from file
+#define FLAG_MEMORY 8
+/// position of blend mode in the key
+#define BLEND_SHIFT 1
 
 namespace gfx 
 {
-    // ctor
+    // dtor
 	surface_ref::~surface_ref()
 	{
-		surfaces->free_surface(s);
+		if (surfaces) surfaces->free_surface(s);
 	}
 	
+    // ctor
+    surface_cacher::surface_cacher (const u_int32 & max, const u_int32 & max_texture)
+        : NextPathId(1), Oldest(NULL), Newest(NULL), MemUsed(0), MemMax(max), TextureUsed(0), TextureMax(max_texture),
+          Hits(0), Misses(0), Evictions(0), Loader(NULL), UploadRate(DEFAULT_UPLOAD_SIZE)
+    {
+    }
+
     // dtor
 	surface_cacher::~surface_cacher()
 	{
+	    // no need to wait for images that will be deleted anyway
+	    delete Loader;
+	    Loader = NULL;
+	    Pending.clear();
+
 	    purge();
 	}
     
 	// return surface reference for a dynamic image
 	const surface_ref* surface_cacher::get_surface_mem (const string & name)
 	{
-        map<string, surface_ref>::iterator idx = Cache.find(name);
+        std::hash_map<u_int32, entry>::iterator idx = Cache.find(make_key(name, FLAG_MEMORY, false));
         if (idx != Cache.end())
         {
             //We already found it in the cache. Increment the reference
-            idx->second.newref();
-            return new surface_ref(&(idx->second));
+            Hits++;
+            add_ref(&(idx->second));
+            return new surface_ref(idx->second.s);
         }
 
         // that surface does not exist in the cache
+        Misses++;
         return NULL;
 	}
 
     // add existing surface to the cache
 	const surface_ref* surface_cacher::add_surface_mem (const string & name, gfx::surface *surf)
     {
-        surface_ref ret = surface_ref(surf);
-        ret.newref();
-        Cache[name] = ret;
-        SurfToString[surf] = name;
-        ret.newref();
+        // cached surfaces are final, so they may share a texture
+        surf->pack_into_atlas();
 
-        // remove any extra surfaces we have
-        conditional_purge();
-        return new surface_ref(&ret);
+        return new surface_ref(insert(make_key(name, FLAG_MEMORY), surf));
     }
 
     // return surface reference for a given file
 	const surface_ref* surface_cacher::get_surface(const string & file, bool set_mask, bool invert_x, bool invert_y, blend_mode alpha)
 	{
-		// create a unique name based on all parameters
-        std::stringstream cache_name (std::ios::out);
-        cache_name << file << "_" << set_mask << "_" << invert_x << "_" << invert_y << "_" << alpha;
-
-		map<string, surface_ref>::iterator idx = Cache.find(cache_name.str());
-		if (idx != Cache.end())
-		{
-			//We already found it in the cache. Increment the reference
-			idx->second.newref();
-			return new surface_ref(&(idx->second));
-		}
-
-		//Cache miss, try to load the file
-		surface *cur = create_surface();
-		cur->load_png(file);
-		cur->set_mask(set_mask);
-		cur->mirror(invert_x, invert_y);
-        
-        // either use alpha setting of image, or set to user specified value
-        if (alpha != AUTOMATIC)
-        {
-            cur->set_alpha(255, alpha == BLEND);
-        }
-		MemUsed += cur->size();
-        
-		//Add it to the cache
-		surface_ref ret = surface_ref(cur);
-		ret.newref();
-		Cache[cache_name.str()] = ret;
-		SurfToString[cur] = cache_name.str();
-		ret.newref();
-		
-        //Remove any extra surfaces we have
-		conditional_purge();
-		return new surface_ref(&ret);
+		return new surface_ref(get_surface_only(file, set_mask, invert_x, invert_y, alpha));
 	}
 
     // return pointer to surface
     const surface* surface_cacher::get_surface_only(const string& file, bool set_mask, bool invert_x, bool invert_y, blend_mode alpha)
     {
-        const surface_ref * sref = get_surface(file, set_mask, invert_x, invert_y, alpha);
-        const surface* ret = sref->s;
-        Cache[SurfToString[ret]].newref();
-        delete sref;
-        return ret;
+		const u_int32 key = file_key(file, set_mask, alpha);
+
+		if (find(key) == NULL)
+		{
+			//Cache miss, try to load the file
+			Misses++;
+			insert(key, load(file, set_mask, alpha));
+		}
+
+		return mirror(&(Cache[key]), invert_x, invert_y);
     }
 
-    // release reference of named surface
-	void surface_cacher::free_by_name(const string & s)
-	{
-		map<string, surface_ref>::iterator idx = Cache.find(s);
+    // return surface reference, loading it in the background if necessary
+    const surface_ref* surface_cacher::get_surface_async(const string & file, bool set_mask, bool invert_x, bool invert_y, blend_mode alpha)
+    {
+		const u_int32 key = file_key(file, set_mask, alpha);
 
-		if (idx != Cache.end())
+		if (find(key) == NULL)
 		{
-			idx->second.delref();
-	        conditional_purge();
+			Misses++;
+			load_async(key, file, set_mask, alpha);
 		}
-	}
-    
+
+		return new surface_ref(mirror(&(Cache[key]), invert_x, invert_y));
+    }
+
+    // load image that will be needed soon
+    void surface_cacher::prefetch(const string & file, bool set_mask, bool invert_x, bool invert_y, blend_mode alpha)
+    {
+		const u_int32 key = file_key(file, set_mask, alpha);
+		if (Cache.find(key) != Cache.end()) return;
+
+		// keep it in cache without a reference. Mirror images are
+		// cheap to create on demand, so only load the original.
+		free_surface(load_async(key, file, set_mask, alpha));
+    }
+
     // release reference
 	void surface_cacher::free_surface(const string & file, bool set_mask, bool invert_x, bool invert_y, blend_mode alpha)
 	{
-        std::stringstream cache_name (std::ios::out);
-        cache_name << file << "_" << set_mask << "_" << invert_x << "_" << invert_y << "_" << alpha;
-		free_by_name(cache_name.str());
+		std::hash_map<u_int32, entry>::iterator idx = Cache.find(file_key(file, set_mask, alpha, false));
+		if (idx != Cache.end())
+		{
+			del_ref(&(idx->second));
+		}
 	}
     
     // release reference
 	void surface_cacher::free_surface(const surface* surf)
 	{
-        if (surf != NULL)
+        if (surf == NULL) return;
+
+        std::map<const surface*, u_int32>::iterator key = SurfToKey.find(surf);
+        if (key != SurfToKey.end())
         {
-            free_by_name(SurfToString[surf]);
+            del_ref(&(Cache[key->second]));
         }
 	}
     
     // get refcount for given surface
 	unsigned int surface_cacher::count_surface(const string & file, bool set_mask, bool invert_x, bool invert_y, blend_mode alpha)
 	{
-        std::stringstream cache_name (std::ios::out);
-        cache_name << file << "_" << set_mask << "_" << invert_x << "_" << invert_y << "_" << alpha;
-		map<string, surface_ref>::iterator idx = Cache.find(cache_name.str());
+		std::hash_map<u_int32, entry>::iterator idx = Cache.find(file_key(file, set_mask, alpha, false));
 		if (idx != Cache.end())
         {
             return idx->second.RefCount;
@@ -172,36 +184,420 @@ namespace gfx
     // remove all items no longer referenced
 	void surface_cacher::purge()
 	{
-		unsigned int tmp = MemMax;
-		set_max_mem(0);
-		set_max_mem(tmp);
+		while (Oldest)
+		{
+			const u_int32 key = Oldest->Key;
+			evict(Oldest);
+			forget_name(key);
+		}
 	}
     
     // remove items as long as cache size is over limit 
 	void surface_cacher::conditional_purge()
 	{
-		if (MemUsed >= MemMax) 
+		// first drop pixel data the backend can restore on its own
+		for (entry *e = Oldest; e != NULL && MemUsed > MemMax; e = e->Next)
 		{
-			map<string, surface_ref>::iterator idx = Cache.begin();
-			while (idx!=Cache.end() && MemUsed >= MemMax)
+			e->s->release_pixels();
+			for (u_int32 i = 0; i < NUM_MIRRORS; i++)
 			{
-				if (idx->second.RefCount == 0)
-				{
-					if (idx->second.s)
-					{
-						SurfToString.erase(idx->second.s);
-						MemUsed -= idx->second.s->size();
-						delete idx->second.s;
-					}
-					map<string, surface_ref>::iterator deleteme = idx;
-					idx++;
-					Cache.erase(deleteme);
-				}
-				else
-                {
-					idx++;
-                }
+				if (e->Mirrors[i]) e->Mirrors[i]->release_pixels();
 			}
+			account(e);
+		}
+
+		// then drop whole images, least recently used first
+		while (Oldest && (MemUsed > MemMax || TextureUsed > TextureMax))
+		{
+			const u_int32 key = Oldest->Key;
+			evict(Oldest);
+			forget_name(key);
+			Evictions++;
 		}
 	}
+
+    // toggle background loading
+    void surface_cacher::set_async_loading (const bool & async)
+    {
+        if (async && Loader == NULL)
+        {
+            Loader = new image_loader();
+        }
+        else if (!async && Loader != NULL)
+        {
+            finish_loading();
+
+            delete Loader;
+            Loader = NULL;
+        }
+    }
+
+    // replace placeholders with decoded images
+    bool surface_cacher::upload ()
+    {
+        if (Loader == NULL) return false;
+
+        image_loader::job j;
+        u_int32 bytes = 0;
+        bool changed = false;
+
+        while (bytes < UploadRate && Loader->get_finished(j))
+        {
+            std::hash_map<u_int32, u_int32>::iterator key = Pending.find(j.Ticket);
+            if (key != Pending.end() && j.Pixels != NULL)
+            {
+                entry *e = &(Cache[key->second]);
+                complete(e, j.Pixels, j.Length, j.Height, j.Alpha);
+
+                bytes += j.Length * j.Height * (j.Alpha ? 4 : 3);
+                changed = true;
+            }
+
+            // image failed to load or was evicted in the meantime
+            if (key != Pending.end())
+            {
+                Cache[key->second].Ticket = 0;
+                Pending.erase(key);
+            }
+
+            free(j.Pixels);
+        }
+
+        return changed;
+    }
+
+    // wait for background loading to complete
+    void surface_cacher::finish_loading ()
+    {
+        if (Loader == NULL) return;
+
+        const u_int32 rate = UploadRate;
+        UploadRate = 0xFFFFFFFF;
+
+        while (Loader->pending() > 0)
+        {
+            if (!upload()) std::this_thread::yield();
+        }
+
+        UploadRate = rate;
+    }
+
+    // get global cache
+    surface_cacher *get_surface_cacher ()
+    {
+        return surfaces;
+    }
+
+    // build key from name and settings
+    u_int32 surface_cacher::make_key (const std::string & name, const u_int32 & flags, const bool & add)
+    {
+        std::hash_map<std::string, u_int32>::iterator id = PathIds.find(name);
+        if (id == PathIds.end())
+        {
+            // no image of that name in cache, so no need to remember it
+            if (!add) return 0;
+
+            u_int32 next;
+            if (FreePathIds.empty())
+            {
+                next = NextPathId++;
+            }
+            else
+            {
+                next = FreePathIds.back();
+                FreePathIds.pop_back();
+            }
+
+            id = PathIds.insert(std::make_pair(name, next)).first;
+            PathNames[next] = name;
+        }
+
+        return (id->second << FLAG_BITS) | flags;
+    }
+
+    // build key for image from file
+    u_int32 surface_cacher::file_key (const std::string & file, bool set_mask, blend_mode alpha, const bool & add)
+    {
+        u_int32 flags = (set_mask ? FLAG_MASK : 0) | (alpha << BLEND_SHIFT);
+
+        return make_key(file, flags, add);
+    }
+
+    // look up image in cache
+    const surface* surface_cacher::find (const u_int32 & key)
+    {
+		std::hash_map<u_int32, entry>::iterator idx = Cache.find(key);
+		if (idx == Cache.end()) return NULL;
+
+		//We already found it in the cache. Increment the reference
+		Hits++;
+		add_ref(&(idx->second));
+		return idx->second.s;
+    }
+
+    // load image on calling thread
+    surface* surface_cacher::load (const string & file, bool set_mask, blend_mode alpha)
+    {
+		surface *cur = create_surface();
+		cur->load_png(file);
+		cur->set_mask(set_mask);
+        
+        // either use alpha setting of image, or set to user specified value
+        if (alpha != AUTOMATIC)
+        {
+            cur->set_alpha(255, alpha == BLEND);
+        }
+        cur->pack_into_atlas();
+
+        return cur;
+    }
+
+    // add image to cache, decoding it in the background
+    const surface* surface_cacher::load_async (const u_int32 & key, const string & file, bool set_mask, blend_mode alpha)
+    {
+        u_int32 ticket = 0;
+        surface *cur = Loader ? placeholder(file, ticket) : NULL;
+        if (cur == NULL)
+        {
+            return insert(key, load(file, set_mask, alpha));
+        }
+
+        // settings are reported correctly before the pixels arrive
+        cur->set_mask(set_mask);
+
+        const surface *s = insert(key, cur);
+        Cache[key].Ticket = ticket;
+        Pending[ticket] = key;
+        return s;
+    }
+
+    // create stand-in for image decoded in the background
+    surface* surface_cacher::placeholder (const string & file, u_int32 & ticket)
+    {
+        std::string path = file;
+        if (!base::Paths().find_in_path(path, false)) return NULL;
+
+        // pre-decoded images are loaded right away, as in surface::load_png
+        const std::string & data_dir = base::Paths().game_data_dir();
+        if (path.compare(0, data_dir.length(), data_dir) == 0 && image_pack::is_packed(file))
+        {
+            return NULL;
+        }
+
+        u_int16 l, h;
+        std::ifstream png_file(path.c_str(), std::ifstream::binary);
+        if (!png_file.is_open() || !png::get_size(png_file, l, h) || l * h == 0)
+        {
+            return NULL;
+        }
+        png_file.close();
+
+        u_int8 *blank = (u_int8*) calloc(4, l * h);
+        surface *cur = create_surface();
+        cur->set_pixels(blank, l, h, true);
+        cur->filename_ = path;
+        free(blank);
+
+        ticket = Loader->add(path);
+        return cur;
+    }
+
+    // apply decoded image to its placeholder
+    void surface_cacher::complete (entry *e, const void *pixels, const u_int16 & l, const u_int16 & h, const bool & alpha)
+    {
+        // the cache owns the image, and nobody else modifies it
+        surface *cur = (surface*) e->s;
+        cur->set_pixels(pixels, l, h, alpha);
+
+        // masking may be applied to the actual pixels, so must happen again
+        cur->is_masked_ = false;
+        cur->set_mask((e->Key & FLAG_MASK) != 0);
+
+        blend_mode mode = (blend_mode) ((e->Key >> BLEND_SHIFT) & 3);
+        if (mode != AUTOMATIC)
+        {
+            cur->set_alpha(255, mode == BLEND);
+        }
+        cur->pack_into_atlas();
+
+        // mirror images must pick up the changes
+        for (u_int32 i = 0; i < NUM_MIRRORS; i++)
+        {
+            if (e->Mirrors[i])
+            {
+                ((surface*) e->Mirrors[i])->set_mirror_of(cur, (i + 1) & 1, (i + 1) & 2);
+            }
+        }
+
+        account(e);
+    }
+
+    // get mirror image of cached image
+    const surface* surface_cacher::mirror (entry *e, bool invert_x, bool invert_y)
+    {
+        const u_int32 index = (invert_x ? 1 : 0) | (invert_y ? 2 : 0);
+        if (index == 0) return e->s;
+
+        // the backend may share pixels with the original
+        if (e->Mirrors[index - 1] == NULL)
+        {
+            surface *m = create_surface();
+            m->set_mirror_of(e->s, invert_x, invert_y);
+
+            e->Mirrors[index - 1] = m;
+            SurfToKey[m] = e->Key;
+            account(e);
+        }
+
+        return e->Mirrors[index - 1];
+    }
+
+    // add new image to cache
+    const surface* surface_cacher::insert (const u_int32 & key, surface *surf)
+    {
+        std::hash_map<u_int32, entry>::iterator idx = Cache.find(key);
+        if (idx != Cache.end() && idx->second.s != surf)
+        {
+            if (idx->second.RefCount > 0)
+            {
+                // the old image is still in use, so it has to stay
+                LOG(WARNING) << "*** surface_cacher::insert: image '" << surf->filename() << "' is in use and cannot be replaced";
+                delete surf;
+
+                add_ref(&(idx->second));
+                return idx->second.s;
+            }
+
+            // also takes it off the list of unreferenced images
+            evict(&(idx->second));
+        }
+
+        entry & e = Cache[key];
+        e.s = surf;
+        e.RefCount = 1;
+        e.Pixels = 0;
+        e.Texture = 0;
+        e.Key = key;
+        e.Ticket = 0;
+        for (u_int32 i = 0; i < NUM_MIRRORS; i++)
+        {
+            e.Mirrors[i] = NULL;
+        }
+        e.Prev = NULL;
+        e.Next = NULL;
+
+        SurfToKey[surf] = key;
+        account(&e);
+
+        //Remove any extra surfaces we have
+        conditional_purge();
+        return surf;
+    }
+
+    // increment reference count
+    void surface_cacher::add_ref (entry *e)
+    {
+        if (e->RefCount++ > 0) return;
+
+        // no longer a candidate for eviction
+        if (e->Prev) e->Prev->Next = e->Next;
+        else Oldest = e->Next;
+
+        if (e->Next) e->Next->Prev = e->Prev;
+        else Newest = e->Prev;
+
+        e->Prev = e->Next = NULL;
+    }
+
+    // decrement reference count
+    void surface_cacher::del_ref (entry *e)
+    {
+        if (e->RefCount == 0 || --e->RefCount > 0) return;
+
+        // unused from now on, so it is the most recently used candidate for eviction
+        e->Prev = Newest;
+        e->Next = NULL;
+
+        if (Newest) Newest->Next = e;
+        else Oldest = e;
+        Newest = e;
+
+        // memory use may have changed while in use
+        account(e);
+        conditional_purge();
+    }
+
+    // update memory statistics
+    void surface_cacher::account (entry *e)
+    {
+        u_int32 pixels, texture;
+        e->s->memory_usage(pixels, texture);
+
+        for (u_int32 i = 0; i < NUM_MIRRORS; i++)
+        {
+            if (e->Mirrors[i] == NULL) continue;
+
+            u_int32 mirror_pixels, mirror_texture;
+            e->Mirrors[i]->memory_usage(mirror_pixels, mirror_texture);
+            pixels += mirror_pixels;
+            texture += mirror_texture;
+        }
+
+        MemUsed += pixels - e->Pixels;
+        TextureUsed += texture - e->Texture;
+
+        e->Pixels = pixels;
+        e->Texture = texture;
+    }
+
+    // delete unreferenced image
+    void surface_cacher::evict (entry *e)
+    {
+        if (e->Next) e->Next->Prev = e->Prev;
+        else Newest = e->Prev;
+
+        if (e->Prev) e->Prev->Next = e->Next;
+        else Oldest = e->Next;
+
+        MemUsed -= e->Pixels;
+        TextureUsed -= e->Texture;
+
+        // no need to decode image any longer
+        if (e->Ticket != 0)
+        {
+            if (Loader) Loader->cancel(e->Ticket);
+            Pending.erase(e->Ticket);
+        }
+
+        // mirror images may depend on the original
+        for (u_int32 i = 0; i < NUM_MIRRORS; i++)
+        {
+            SurfToKey.erase(e->Mirrors[i]);
+            delete e->Mirrors[i];
+        }
+
+        SurfToKey.erase(e->s);
+        delete e->s;
+
+        // invalidates e
+        Cache.erase(e->Key);
+    }
+
+    // drop id of image name no longer in use
+    void surface_cacher::forget_name (const u_int32 & key)
+    {
+        const u_int32 id = key >> FLAG_BITS;
+        for (u_int32 flags = 0; flags < (1 << FLAG_BITS); flags++)
+        {
+            if (Cache.find((id << FLAG_BITS) | flags) != Cache.end()) return;
+        }
+
+        std::hash_map<u_int32, std::string>::iterator name = PathNames.find(id);
+        if (name != PathNames.end())
+        {
+            PathIds.erase(name->second);
+            PathNames.erase(name);
+            FreePathIds.push_back(id);
+        }
+    }
 }
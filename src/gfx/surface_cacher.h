@@ -33,40 +33,57 @@
 #define SURFACECACHER_INCLUDED
 
 #include <adonthell/base/types.h>
-#include <ctime>
+#include <adonthell/base/hash_map.h>
 #include <string>
 #include <map>
+#include <vector>
 
+/// default budget for pixel data in system memory
 #define DEFAULT_CACHE_SIZE 10000000
+/// default budget for texture memory
+#define DEFAULT_TEXTURE_CACHE_SIZE 64000000
+/// number of ways to mirror an image
+#define NUM_MIRRORS 3
+/// default amount of decoded pixels turned into images per frame
+#define DEFAULT_UPLOAD_SIZE 2000000
 
 namespace gfx
 {
 	class surface;
+	class image_loader;
 
+	/**
+	 * Handle to a surface in the cache. Deleting the handle releases
+	 * the reference to the surface.
+	 */
 	class surface_ref 
 	{
 	public:
+		/// the cached surface
 		const surface* s;
-		surface_ref(surface* surf=NULL):s(surf),RefCount(1),TimeStamp(0) {}
-		surface_ref(surface_ref* olds ):s(olds->s),RefCount(olds->RefCount),TimeStamp(olds->TimeStamp) {}
+		surface_ref(const surface* surf = NULL) : s(surf) {}
 		~surface_ref();
-        
-    private:
-        friend class surface_cacher;
-		u_int32 RefCount;
-		u_int32 TimeStamp;
-		void newref() {TimeStamp=time(0); RefCount++;}
-		void delref() {if (RefCount) RefCount--;}
 	};
 
 	/**
 	 * Allows us to keep track of cached image instances so that they can be deleted if necessary.
-     * The cache has a maximum size that it will fill up with images. Once that limit is exceeded,
-     * it will try to discard unreferenced images until memory usage drops below the limit again.
+     * The cache has separate limits for pixel data in system memory and for texture memory that
+     * it will fill up with images. Once a limit is exceeded, it will first drop software copies of
+     * unreferenced images that the backend can restore from their texture, then discard
+     * unreferenced images, least recently used first, until memory usage drops below both limits.
      *
      * It may stay permanently over the limit if too many images are referenced. For best performance,
-     * the size should allow to keep at least some images in cache, even if they are not referred to
-     * right now. Default cache size is 10,000,000 bytes.
+     * the limits should allow to keep at least some images in cache, even if they are not referred to
+     * right now. That way, images released when leaving an area are still at hand when returning.
+     * Default limits are 10,000,000 bytes of pixel data and 64,000,000 bytes of texture memory.
+     *
+     * Mirrored images are not cached separately, but derived from the unmirrored image. Backends
+     * that can flip images while drawing share the pixels between both.
+     *
+     * With background loading enabled, get_surface_async and prefetch decode images on a worker
+     * thread. Until an image is decoded, a transparent placeholder of the right size stands in for
+     * it. Decoded pixels replace the placeholders in upload(), which gfx::screen calls once per
+     * frame, with a limit on the amount of pixels handled each time.
 	 */
 	class surface_cacher
 	{
@@ -76,9 +93,10 @@ namespace gfx
         
         /**
          * Create surface cache with a maximum cache size.
-         * @param max maximum cache size.
+         * @param max maximum size of pixel data in system memory.
+         * @param max_texture maximum size of texture memory.
          */
-		surface_cacher (const u_int32 & max = DEFAULT_CACHE_SIZE) : MemUsed(0), MemMax(max) { }
+		surface_cacher (const u_int32 & max = DEFAULT_CACHE_SIZE, const u_int32 & max_texture = DEFAULT_TEXTURE_CACHE_SIZE);
 		
         /**
          * Delete surface cache and its contents.
@@ -119,6 +137,36 @@ namespace gfx
          */
         const surface* get_surface_only(const std::string & file, bool set_mask=true, bool invert_x = false, bool invert_y = false, blend_mode alpha = AUTOMATIC);
 
+        /**
+         * Like get_surface, but if background loading is enabled and the image
+         * is not in the cache yet, a transparent placeholder is returned at once
+         * and the image is decoded on the worker thread. The placeholder will
+         * receive the actual image during one of the following frames, so use
+         * this only where the image is drawn, not where its pixels are read.
+         *
+         * @param file which file to return a cached version of
+         * @param set_mask whether to enable image masking
+         * @param invert_x whether to mirror image on vertical axis
+         * @param invert_y whether to mirror image on horizontal axis
+         * @param alpha whether to enable alpha blending or not
+         *
+         * @return a pointer to a drawable object
+         */
+        const surface_ref* get_surface_async(const std::string & file, bool set_mask=true, bool invert_x = false, bool invert_y = false, blend_mode alpha = AUTOMATIC);
+
+        /**
+         * Start loading an image that will be needed soon, for example when
+         * entering a new area. The image is loaded in the background if possible,
+         * but not referenced, so it may be evicted again if the cache is full.
+         *
+         * @param file which file to load
+         * @param set_mask whether to enable image masking
+         * @param invert_x whether to mirror image on vertical axis
+         * @param invert_y whether to mirror image on horizontal axis
+         * @param alpha whether to enable alpha blending or not
+         */
+        void prefetch(const std::string & file, bool set_mask=true, bool invert_x = false, bool invert_y = false, blend_mode alpha = AUTOMATIC);
+
 		/**
 		 * Finds a surface object and increments the reference count, or
 		 * returns NULL if no such surface exists in the cache. In that case,
@@ -183,7 +231,7 @@ namespace gfx
 		void purge();
 		
         /**
-		 * deletes surfaces with zero references until we are under our memory limit
+		 * deletes surfaces with zero references until we are under our memory limits
 		 */
 		void conditional_purge();
         //@}
@@ -193,7 +241,7 @@ namespace gfx
          */
         //@{
 		/**
-         * Get current memory utilization.
+         * Get pixel data in system memory used by cached images.
 		 * @return how much memory the cacher is using
 		 */
 		u_int32 used_mem() const 
@@ -202,7 +250,7 @@ namespace gfx
         }
         
         /**
-         * Get amount allowed for the cacher to use.
+         * Get amount of pixel data in system memory allowed for the cacher to use.
 		 * @return the maximum amount of memory the cacher should try to use
 		 */
 		u_int32 max_mem() const 
@@ -211,8 +259,8 @@ namespace gfx
         }
         
 		/**
-		 * Allows you to set the new maximum memory. 
-         * Will delete zero-referenced surfaces to fit the new limit.
+		 * Allows you to set the new maximum of pixel data in system memory. 
+         * Will free memory of zero-referenced surfaces to fit the new limit.
 		 *
 		 * @param mm the new maximum memory. 
 		 */
@@ -221,25 +269,315 @@ namespace gfx
             MemMax = mm; 
             conditional_purge();
         }	
+
+		/**
+         * Get texture memory used by cached images.
+		 * @return how much texture memory the cacher is using
+		 */
+		u_int32 used_texture_mem() const 
+        {
+            return TextureUsed;
+        }
+        
+        /**
+         * Get amount of texture memory allowed for the cacher to use.
+		 * @return the maximum amount of texture memory the cacher should try to use
+		 */
+		u_int32 max_texture_mem() const 
+        {
+            return TextureMax;
+        }
+        
+		/**
+		 * Allows you to set the new maximum of texture memory. 
+         * Will delete zero-referenced surfaces to fit the new limit.
+		 *
+		 * @param mm the new maximum texture memory. 
+		 */
+		void set_max_texture_mem (u_int32 mm) 
+        { 
+            TextureMax = mm; 
+            conditional_purge();
+        }	
 		//@}
+
+        /**
+         * @name Background loading.
+         */
+        //@{
+        /**
+         * Enable or disable decoding images on a worker thread. When
+         * disabling, images still being decoded are loaded first.
+         * @param async whether to load images in the background.
+         */
+        void set_async_loading (const bool & async);
+
+        /**
+         * Check whether images are decoded on a worker thread.
+         * @return \b true if background loading is enabled.
+         */
+        bool async_loading () const
+        {
+            return Loader != NULL;
+        }
+
+        /**
+         * Set amount of decoded pixels turned into images per call to upload().
+         * @param bytes pixel data handled per frame.
+         */
+        void set_upload_rate (const u_int32 & bytes)
+        {
+            UploadRate = bytes;
+        }
+
+        /**
+         * Replace placeholders with images decoded in the meantime, until
+         * the upload rate is exceeded. Called by gfx::screen once per frame.
+         * @return \b true if any image has changed, \b false otherwise.
+         */
+        bool upload ();
+
+        /**
+         * Block until all images requested so far have been loaded.
+         */
+        void finish_loading ();
+
+        /**
+         * Get number of images still waiting for their pixels.
+         * @return number of placeholders in the cache.
+         */
+        u_int32 pending () const
+        {
+            return Pending.size ();
+        }
+        //@}
+
+        /**
+         * @name Cache statistics.
+         */
+        //@{
+        /**
+         * Get number of requests for images already in the cache.
+         * @return number of cache hits.
+         */
+        u_int32 hits () const
+        {
+            return Hits;
+        }
+
+        /**
+         * Get number of requests for images not yet in the cache.
+         * @return number of cache misses.
+         */
+        u_int32 misses () const
+        {
+            return Misses;
+        }
+
+        /**
+         * Get number of images removed from the cache to free memory.
+         * @return number of evicted images.
+         */
+        u_int32 evictions () const
+        {
+            return Evictions;
+        }
+
+        /**
+         * Get number of images in the cache, referenced or not.
+         * @return number of cached images.
+         */
+        u_int32 count () const
+        {
+            return Cache.size ();
+        }
+
+        /**
+         * Reset hit, miss and eviction counters to zero.
+         */
+        void reset_stats ()
+        {
+            Hits = Misses = Evictions = 0;
+        }
+        //@}
         
     private:
-        /// list of surfaces by name
-        std::map<std::string, surface_ref> Cache;
-        /// mapping of surface to name
-		std::map<const surface*, std::string> SurfToString;
-        /// memory used by cache
-		u_int32 MemUsed;
-        /// memory allowed to use
-		u_int32 MemMax;
-        
+        /// a cached image
+        struct entry
+        {
+            /// the image
+            const surface *s;
+            /// number of references to the image
+            u_int32 RefCount;
+            /// pixel data in system memory, as last accounted for
+            u_int32 Pixels;
+            /// texture memory, as last accounted for
+            u_int32 Texture;
+            /// cache key of the image
+            u_int32 Key;
+            /// background loading request, or 0 if image is complete
+            u_int32 Ticket;
+            /// mirror images, on vertical, horizontal and both axes
+            const surface *Mirrors[NUM_MIRRORS];
+            /// unreferenced image used just before this one
+            entry *Prev;
+            /// unreferenced image used just after this one
+            entry *Next;
+        };
+
+        /**
+         * Build the cache key from an image name and its settings.
+         * @param name file or name of the image.
+         * @param flags settings of the image.
+         * @param add whether to assign an id to a name not yet in use.
+         * @return key uniquely identifying the image, or 0 if the name
+         *      is unknown and not to be added.
+         */
+        u_int32 make_key (const std::string & name, const u_int32 & flags, const bool & add = true);
+
         /**
-         * Decrease reference of named surface.
-         * @param surfname name of surface to decref.
+         * Build the cache key of an image loaded from file. Mirror
+         * images share the key of their original.
+         * @param add whether to assign an id to a file not yet in use.
+         * @return key uniquely identifying the image, or 0 if unknown.
          */
-		void free_by_name(const std::string& surfname);
+        u_int32 file_key (const std::string & file, bool set_mask, blend_mode alpha, const bool & add = true);
+
+        /**
+         * Look up image in the cache and add a reference on success.
+         * @param key cache key of the image.
+         * @return the image, or NULL if not in cache.
+         */
+        const surface* find (const u_int32 & key);
+
+        /**
+         * Load an image on the calling thread.
+         * @return the loaded image.
+         */
+        surface* load (const std::string & file, bool set_mask, blend_mode alpha);
+
+        /**
+         * Add an image to the cache, decoding it in the background if possible.
+         * @param key cache key of the image.
+         * @return the image or its placeholder, with one reference.
+         */
+        const surface* load_async (const u_int32 & key, const std::string & file, bool set_mask, blend_mode alpha);
+
+        /**
+         * Create a placeholder for an image and request decoding of the
+         * image from the worker thread.
+         * @param ticket receives the request id.
+         * @return the placeholder, or NULL if image must be loaded right away.
+         */
+        surface* placeholder (const std::string & file, u_int32 & ticket);
+
+        /**
+         * Copy decoded pixels into a placeholder and apply image settings.
+         * @param e the cache entry of the placeholder.
+         * @param pixels decoded pixels.
+         * @param l length of the image.
+         * @param h height of the image.
+         * @param alpha whether pixels have an alpha channel.
+         */
+        void complete (entry *e, const void *pixels, const u_int16 & l, const u_int16 & h, const bool & alpha);
+
+        /**
+         * Get cached image, mirrored as requested. Mirror images are
+         * created on first use and live as long as the original.
+         * @param e the cache entry of the original.
+         * @param invert_x whether to mirror image on vertical axis.
+         * @param invert_y whether to mirror image on horizontal axis.
+         * @return the original or its mirror image.
+         */
+        const surface* mirror (entry *e, bool invert_x, bool invert_y);
+
+        /**
+         * Add a newly created image to the cache, with one reference.
+         * An unreferenced image with the same key is replaced, while
+         * one still in use is kept and the new image discarded.
+         * @param key cache key of the image.
+         * @param surf the image.
+         * @return the image.
+         */
+        const surface* insert (const u_int32 & key, surface *surf);
+
+        /**
+         * Increase reference count of cached image, removing it from the
+         * list of unreferenced images if necessary.
+         * @param e the cache entry.
+         */
+        void add_ref (entry *e);
+
+        /**
+         * Decrease reference count of cached image, adding it to the list
+         * of unreferenced images once it drops to zero.
+         * @param e the cache entry.
+         */
+        void del_ref (entry *e);
+
+        /**
+         * Update memory statistics with the current memory use of an image.
+         * @param e the cache entry.
+         */
+        void account (entry *e);
+
+        /**
+         * Delete an unreferenced image.
+         * @param e the cache entry.
+         */
+        void evict (entry *e);
+
+        /**
+         * Forget the id of an image name once no image with that name
+         * is left in the cache, so that the id can be reused.
+         * @param key cache key of an evicted image.
+         */
+        void forget_name (const u_int32 & key);
+
+        /// list of surfaces by key
+        std::hash_map<u_int32, entry> Cache;
+        /// ids of image names, used to build keys
+        std::hash_map<std::string, u_int32> PathIds;
+        /// image names by id, to forget names no longer cached
+        std::hash_map<u_int32, std::string> PathNames;
+        /// ids of evicted image names, for reuse
+        std::vector<u_int32> FreePathIds;
+        /// next id to assign, starting at 1 so that key 0 is never used
+        u_int32 NextPathId;
+        /// mapping of surface to key
+		std::map<const surface*, u_int32> SurfToKey;
+        /// least recently used unreferenced image
+        entry *Oldest;
+        /// most recently used unreferenced image
+        entry *Newest;
+        /// pixel data in system memory used by cache
+		u_int32 MemUsed;
+        /// pixel data in system memory allowed to use
+		u_int32 MemMax;
+        /// texture memory used by cache
+        u_int32 TextureUsed;
+        /// texture memory allowed to use
+        u_int32 TextureMax;
+        /// number of cache hits
+        u_int32 Hits;
+        /// number of cache misses
+        u_int32 Misses;
+        /// number of evicted images
+        u_int32 Evictions;
+        /// decodes images in the background, if enabled
+        image_loader *Loader;
+        /// keys of images waiting for the worker thread, by request
+        std::hash_map<u_int32, u_int32> Pending;
+        /// decoded pixels to handle per call to upload
+        u_int32 UploadRate;
 	};
 
+	/**
+	 * Get the global surface cache, for example to query its
+	 * statistics from Python.
+	 * @return the surface cache, or NULL if gfx is not set up.
+	 */
+	surface_cacher *get_surface_cacher ();
 
 	/**
 	 * A singleton surface_cacher
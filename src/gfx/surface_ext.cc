@@ -30,27 +30,14 @@
  */
 
 #include <cstdio>
+#include <cstdlib>
+#include <cstring>
 #include <adonthell/base/logging.h>
 #include "surface_ext.h"
 #include "png_wrapper.h"
 
 using gfx::surface_ext;
 
-// This should probably be somewhere else... like a utils in base or something...
-template <class type>
-void reverseArray (type *orig, size_t len)
-{
-    size_t start=0;
-    type swap;
-    
-    for(;start<--len;start++) //increment a and decrement b until they meet eachother
-    {
-        swap=orig[start];       //put what's in a into swap space
-        orig[start]=orig[len];    //put what's in b into a
-        orig[len]=swap;       //put what's in the swap (a) into b
-    }
-}
-
 void surface_ext::mirror (bool x, bool y)
 {
     if (x || y)
@@ -62,9 +49,19 @@ void surface_ext::mirror (bool x, bool y)
 
         if (x)
         {
+            // swap whole pixels, so the format does not change
+            u_int8 swap[4];
             for (int idx = 0; idx < height(); idx++)
             {
-                reverseArray (&rawdata[idx*pitch], pitch);
+                u_int8 *left = rawdata + idx * pitch;
+                u_int8 *right = left + pitch - bpp;
+
+                for (; left < right; left += bpp, right -= bpp)
+                {
+                    memcpy (swap, left, bpp);
+                    memcpy (left, right, bpp);
+                    memcpy (right, swap, bpp);
+                }
             }
 
             is_mirrored_x_ = !is_mirrored_x_;
@@ -86,28 +83,7 @@ void surface_ext::mirror (bool x, bool y)
             is_mirrored_y_ = !is_mirrored_y_;
         }
 
-        if (x)
-        {
-            if (!alpha_channel_)
-            {
-                // This is swapped (BGR) because we swapped at a byte level, not at a pixel level
-                set_data(rawdata, length(), height(), 3, B_MASK, G_MASK, R_MASK, 0);
-            }
-            else
-            {
-                // This is swapped (BGRA) because we swapped at a byte level, not at a pixel level
-#ifdef __BIG_ENDIAN__
-                set_data(rawdata, length(), height(), 4, G_MASK, R_MASK, A_MASK, B_MASK);
-#else
-                set_data(rawdata, length(), height(), 4, A_MASK, B_MASK, G_MASK, R_MASK);
-#endif
-            }
-        }
-        else
-        {
-            // swapping in y only does not change the format
-            set_data (rawdata, length(), height(), bpp, R_MASK, G_MASK, B_MASK, alpha_mask);
-        }
+        set_data (rawdata, length(), height(), bpp, R_MASK, G_MASK, B_MASK, alpha_mask);
     }
 }
 
@@ -130,6 +106,46 @@ bool surface_ext::get_png (std::ifstream & file)
     return true;
 }
 
+// replace image with copy of given pixels
+void surface_ext::set_pixels (const void *pixels, u_int16 l, u_int16 h, bool alpha)
+{
+    u_int32 size = l * h * (alpha ? 4 : 3);
+    void *rawdata = malloc (size);
+    memcpy (rawdata, pixels, size);
+
+    set_data(rawdata, l, h, alpha ? 4 : 3,
+             R_MASK, G_MASK, B_MASK, alpha ? A_MASK : 0);
+}
+
+// get copy of image as RGBA data
+u_int8 *surface_ext::get_rgba () const
+{
+    return (u_int8*) get_data (4, R_MASK, G_MASK, B_MASK, A_MASK);
+}
+
+// update image from RGBA data
+void surface_ext::put_rgba (const u_int8 *rgba)
+{
+    put_rgba_rows (rgba, 0, height ());
+}
+
+// update part of image from RGBA data
+void surface_ext::put_rgba_rows (const u_int8 *rgba, const u_int16 & y, const u_int16 & h)
+{
+    if (y + h > height ()) return;
+
+    lock ();
+
+    for (u_int16 j = y; j < y + h; j++)
+    {
+        for (u_int16 x = 0; x < length (); x++, rgba += 4)
+        {
+            put_pix (x, j, map_color (rgba[0], rgba[1], rgba[2], rgba[3]));
+        }
+    }
+
+    unlock ();
+}
 
 // save image data as png
 bool surface_ext::put_png (std::ofstream & file) const
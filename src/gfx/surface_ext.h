@@ -86,6 +86,16 @@ public:
     virtual bool put_png (std::ofstream & file) const;
     //@}
 
+#ifndef SWIG
+    virtual void set_pixels (const void *pixels, u_int16 l, u_int16 h, bool alpha);
+
+    virtual u_int8 *get_rgba () const;
+
+    virtual void put_rgba (const u_int8 *rgba);
+
+    virtual void put_rgba_rows (const u_int8 *rgba, const u_int16 & y, const u_int16 & h);
+#endif
+
 #ifndef SWIG
     GET_TYPE_NAME_VIRTUAL(gfx::surface_ext);
 #endif // SWIG
@@ -0,0 +1,264 @@
+/*
+   Copyright (C) 2011 Kai Sterker <kai.sterker@gmail.com>
+   Part of the Adonthell Project http://adonthell.linuxgames.com
+
+   Adonthell is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 2 of the License, or
+   (at your option) any later version.
+
+   Adonthell is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with Adonthell; if not, write to the Free Software
+   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+*/
+
+/**
+ * @file   gfx/test_pixel_ops.cc
+ * @author Kai Sterker <kai.sterker@gmail.com>
+ *
+ * @brief  Unit tests for the pixel_ops class.
+ *
+ *
+ */
+
+
+#include "pixel_ops.h"
+
+#include <gtest/gtest.h>
+
+#include <cstring>
+#include <vector>
+
+namespace gfx
+{
+    /**
+     * Expected results of the per pixel code that pixel_ops replaced, on
+     * the images created by RandomImage and MaskedImage. They have been
+     * recorded by running surface::set_brightness, surface::blur and
+     * surface_sdl::scale_up/scale_down as of before pixel_ops existed.
+     */
+    //@{
+    /// surface::set_brightness on an image with alpha channel, per level
+    const u_int32 old_brighten[] = { 0x395154ab, 0x47f27396, 0xe43db372, 0x49c5432d, 0xc249c0c1, 0xdf617eb7, 0xadff9247 };
+    /// surface::set_brightness on a masked image without alpha channel, per level
+    const u_int32 old_brighten_masked[] = { 0x8c29c492, 0x77402ba3, 0xcc23f684, 0xe8d8d52c, 0x4c8ef660, 0xc7e34c5e, 0x8b23b205 };
+    /// surface::blur, per size, without and with alpha channel
+    const u_int32 old_blur[] = { 0x8da3eaba, 0xfa116bd8, 0x41f8bd53, 0xb6b474bf, 0x48a5f05e, 0xcdbbd01e,
+                                 0x404f4ee0, 0x09258386, 0xd8736ab2, 0x244ea494, 0xd4a55a01, 0x295dfc44 };
+    /// surface_sdl::scale_up and scale_down, per bytes per pixel and factor
+    const u_int32 old_scale[] = { 0xe0cc338c, 0xe0cc338c, 0x7c28525d, 0x00a6b02c, 0x73deac59, 0xe722e048, 0x86ef8e05, 0xd5b190ba,
+                                  0x876c576a, 0x876c576a, 0x4151a605, 0xe37c5628, 0x1d61f305, 0x4bfdba5f, 0x985d5dc5, 0x70ace672 };
+    //@}
+
+    class pixel_ops_Test : public ::testing::Test {
+
+    protected:
+        pixel_ops_Test() {
+        }
+
+        virtual ~pixel_ops_Test() {
+        }
+
+        virtual void SetUp() {
+            Seed = 42;
+        }
+
+        virtual void TearDown() {
+            pixel_ops::use_instruction_set (pixel_ops::best_instruction_set ());
+        }
+
+        /// pseudo random numbers that are the same on every platform
+        u_int8 Random () {
+            Seed = Seed * 1103515245 + 12345;
+            return (Seed >> 16) & 0xFF;
+        }
+
+        /// create an image with random pixels, some of them transparent
+        std::vector<u_int8> RandomImage (const int & l, const int & h) {
+            std::vector<u_int8> image (l * h * 4);
+            for (u_int32 i = 0; i < image.size (); i++) {
+                image[i] = Random ();
+            }
+            for (u_int32 i = 3; i < image.size (); i += 16) {
+                image[i] = 0;
+            }
+            return image;
+        }
+
+        /// create an opaque image with random pixels, some of them in the mask color
+        std::vector<u_int8> MaskedImage (const int & l, const int & h) {
+            std::vector<u_int8> image = RandomImage (l, h);
+            for (u_int32 i = 0; i < image.size (); i += 4) {
+                image[i+3] = 255;
+            }
+            for (u_int32 i = 0; i < image.size (); i += 20) {
+                image[i] = 255; image[i+1] = 0; image[i+2] = 255;
+            }
+            return image;
+        }
+
+        /// FNV-1a hash of the given pixels
+        u_int32 Hash (const std::vector<u_int8> & data) {
+            u_int32 hash = 2166136261u;
+            for (u_int32 i = 0; i < data.size (); i++) {
+                hash = (hash ^ data[i]) * 16777619u;
+            }
+            return hash;
+        }
+
+        /// per pixel alpha blending, in floating point
+        void GoldenBlend (std::vector<u_int8> & dst, const std::vector<u_int8> & src, const u_int8 & alpha, const bool & alpha_channel) {
+            for (u_int32 i = 0; i < dst.size (); i += 4) {
+                double a = alpha_channel ? src[i+3] * alpha / 255.0 : alpha;
+                a = (int) (a + 0.5);
+                for (int c = 0; c < 4; c++) {
+                    double s = c == 3 ? 255 : src[i+c];
+                    dst[i+c] = (u_int8) ((s * a + dst[i+c] * (255 - a)) / 255.0 + 0.5);
+                }
+            }
+        }
+
+        /// all instruction sets supported by this CPU
+        std::vector<pixel_ops::instruction_set> InstructionSets () {
+            std::vector<pixel_ops::instruction_set> sets;
+            for (int i = pixel_ops::SCALAR; i <= pixel_ops::best_instruction_set (); i++) {
+                sets.push_back ((pixel_ops::instruction_set) i);
+            }
+            return sets;
+        }
+
+        /// state of the random number generator
+        u_int32 Seed;
+    }; // class{}
+
+    TEST_F(pixel_ops_Test, brighten_MatchesOldCode) {
+        const u_int8 levels[] = { 0, 50, 126, 127, 128, 200, 255 };
+        std::vector<pixel_ops::instruction_set> sets = InstructionSets ();
+
+        for (u_int32 s = 0; s < sets.size (); s++) {
+            ASSERT_TRUE(pixel_ops::use_instruction_set (sets[s]));
+
+            Seed = 42;
+            for (u_int32 i = 0; i < sizeof (levels); i++) {
+                std::vector<u_int8> image = RandomImage (37, 5);
+                pixel_ops::brighten (&image[0], 37 * 5, levels[i] - 127);
+                EXPECT_EQ(old_brighten[i], Hash (image)) << "instruction set " << sets[s] << ", level " << (int) levels[i];
+            }
+
+            Seed = 42;
+            for (u_int32 i = 0; i < sizeof (levels); i++) {
+                std::vector<u_int8> image = MaskedImage (37, 5);
+                pixel_ops::brighten (&image[0], 37 * 5, levels[i] - 127, true, 0xFF00FF);
+                EXPECT_EQ(old_brighten_masked[i], Hash (image)) << "instruction set " << sets[s] << ", masked, level " << (int) levels[i];
+            }
+        }
+    }
+
+    TEST_F(pixel_ops_Test, blur_MatchesOldCode) {
+        const int sizes[][2] = { { 1, 1 }, { 2, 9 }, { 7, 7 }, { 8, 3 }, { 33, 17 }, { 64, 64 } };
+        std::vector<pixel_ops::instruction_set> sets = InstructionSets ();
+
+        for (u_int32 s = 0; s < sets.size (); s++) {
+            ASSERT_TRUE(pixel_ops::use_instruction_set (sets[s]));
+
+            Seed = 42;
+            for (u_int32 i = 0; i < sizeof (sizes) / sizeof (sizes[0]); i++) {
+                for (int alpha = 0; alpha < 2; alpha++) {
+                    int l = sizes[i][0], h = sizes[i][1];
+                    std::vector<u_int8> image = RandomImage (l, h);
+                    pixel_ops::blur (&image[0], l, h, alpha);
+
+                    // a surface without alpha channel reads back as opaque
+                    for (u_int32 p = 3; !alpha && p < image.size (); p += 4) {
+                        image[p] = 255;
+                    }
+
+                    EXPECT_EQ(old_blur[i * 2 + alpha], Hash (image)) << "instruction set " << sets[s] << ", size " << l << "x" << h;
+                }
+            }
+        }
+    }
+
+    TEST_F(pixel_ops_Test, scale_MatchesOldCode) {
+        std::vector<pixel_ops::instruction_set> sets = InstructionSets ();
+        const int l = 19, h = 11;
+
+        for (u_int32 s = 0; s < sets.size (); s++) {
+            ASSERT_TRUE(pixel_ops::use_instruction_set (sets[s]));
+
+            Seed = 42;
+            for (int bpp = 3; bpp <= 4; bpp++) {
+                for (int factor = 1; factor <= 4; factor++) {
+                    const int n = ((bpp - 3) * 4 + factor - 1) * 2;
+                    std::vector<u_int8> image = RandomImage (l, h);
+                    image.resize (l * h * bpp);
+
+                    std::vector<u_int8> up (l * factor * h * factor * bpp);
+                    pixel_ops::scale_up (&up[0], l * factor * bpp, &image[0], l * bpp, l, h, bpp, factor);
+                    EXPECT_EQ(old_scale[n], Hash (up)) << "instruction set " << sets[s] << ", factor " << factor;
+
+                    const int pitch = l * bpp;
+                    std::vector<u_int8> down (pitch * h, 0);
+                    pixel_ops::scale_down (&down[0], pitch, &image[0], l * bpp, l, h, bpp, factor);
+                    EXPECT_EQ(old_scale[n + 1], Hash (down)) << "instruction set " << sets[s] << ", factor " << factor;
+                }
+            }
+        }
+    }
+
+    TEST_F(pixel_ops_Test, blend_MatchesGolden) {
+        const u_int8 alphas[] = { 0, 1, 77, 128, 254, 255 };
+        std::vector<pixel_ops::instruction_set> sets = InstructionSets ();
+
+        for (u_int32 s = 0; s < sets.size (); s++) {
+            ASSERT_TRUE(pixel_ops::use_instruction_set (sets[s]));
+            for (u_int32 i = 0; i < sizeof (alphas); i++) {
+                for (int alpha_channel = 0; alpha_channel < 2; alpha_channel++) {
+                    std::vector<u_int8> src = RandomImage (37, 3);
+                    std::vector<u_int8> dst = RandomImage (37, 3);
+                    std::vector<u_int8> golden (dst);
+
+                    GoldenBlend (golden, src, alphas[i], alpha_channel);
+                    pixel_ops::blend (&dst[0], &src[0], 37 * 3, alphas[i], alpha_channel);
+                    EXPECT_TRUE(golden == dst) << "instruction set " << sets[s] << ", alpha " << (int) alphas[i];
+                }
+            }
+        }
+    }
+
+    TEST_F(pixel_ops_Test, copy_keyed_SkipsKey) {
+        std::vector<pixel_ops::instruction_set> sets = InstructionSets ();
+        const u_int32 key = 0xFFFF00FF;
+
+        for (u_int32 s = 0; s < sets.size (); s++) {
+            ASSERT_TRUE(pixel_ops::use_instruction_set (sets[s]));
+
+            std::vector<u_int8> src = RandomImage (29, 1);
+            std::vector<u_int8> dst = RandomImage (29, 1);
+            std::vector<u_int8> golden (src);
+
+            // mask some pixels, with varying alpha
+            for (u_int32 i = 0; i < src.size (); i += 12) {
+                memcpy (&src[i], &key, 4);
+                src[i+3] = i;
+                memcpy (&golden[i], &dst[i], 4);
+            }
+
+            pixel_ops::copy_keyed (&dst[0], &src[0], 29, key);
+            EXPECT_TRUE(golden == dst) << "instruction set " << sets[s];
+        }
+    }
+
+} // namespace{}
+
+
+int main(int argc, char **argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+
+    return RUN_ALL_TESTS();
+}
@@ -0,0 +1,171 @@
+/*
+ Copyright (C) 2011 Kai Sterker <kai.sterker@gmail.com>
+ Part of the Adonthell Project http://adonthell.linuxgames.com
+
+ Adonthell is free software; you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation; either version 2 of the License, or
+ (at your option) any later version.
+
+ Adonthell is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with Adonthell; if not, write to the Free Software
+ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+/**
+ * @file   gfx/texture_atlas.cc
+ * @author Kai Sterker <kai.sterker@gmail.com>
+ *
+ * @brief  Defines the texture_atlas class.
+ *
+ *
+ */
+
+#include <cstddef>
+#include "texture_atlas.h"
+
+using gfx::texture_atlas;
+
+// ctor
+texture_atlas::texture_atlas (const u_int16 & page_size) : PageSize (page_size)
+{
+}
+
+// reserve space for an image
+bool texture_atlas::allocate (const u_int16 & l, const u_int16 & h, atlas_region & region)
+{
+    if (!accepts (l, h) || l + ATLAS_PADDING > PageSize || h + ATLAS_PADDING > PageSize)
+    {
+        return false;
+    }
+
+    for (u_int32 i = 0; i < Pages.size (); i++)
+    {
+        if (allocate (Pages[i], l + ATLAS_PADDING, h + ATLAS_PADDING, region))
+        {
+            region.page = i;
+            region.length = l;
+            region.height = h;
+            return true;
+        }
+    }
+
+    // no room left, so start a new page
+    Pages.push_back (page ());
+    Pages.back ().Images = 0;
+
+    allocate (Pages.back (), l + ATLAS_PADDING, h + ATLAS_PADDING, region);
+    region.page = Pages.size () - 1;
+    region.length = l;
+    region.height = h;
+    return true;
+}
+
+// place image on given page
+bool texture_atlas::allocate (page & p, const u_int16 & l, const u_int16 & h, atlas_region & region)
+{
+    shelf *best = NULL;
+    std::list<span>::iterator best_span;
+
+    // find the lowest shelf with enough room, without wasting too much height
+    for (std::vector<shelf>::iterator s = p.Shelves.begin (); s != p.Shelves.end (); s++)
+    {
+        if (s->height < h || s->height > h + h / 2) continue;
+        if (best != NULL && best->height <= s->height) continue;
+
+        for (std::list<span>::iterator i = s->Free.begin (); i != s->Free.end (); i++)
+        {
+            if (i->length >= l)
+            {
+                best = &(*s);
+                best_span = i;
+                break;
+            }
+        }
+    }
+
+    if (best == NULL)
+    {
+        // open a new shelf below the existing ones
+        u_int16 y = p.Shelves.empty () ? 0 : p.Shelves.back ().y + p.Shelves.back ().height;
+        if (y + h > PageSize) return false;
+
+        shelf s;
+        s.y = y;
+        s.height = h;
+
+        span free_space;
+        free_space.x = 0;
+        free_space.length = PageSize;
+        s.Free.push_back (free_space);
+
+        p.Shelves.push_back (s);
+        best = &p.Shelves.back ();
+        best_span = best->Free.begin ();
+    }
+
+    region.x = best_span->x;
+    region.y = best->y;
+
+    best_span->x += l;
+    best_span->length -= l;
+    if (best_span->length == 0)
+    {
+        best->Free.erase (best_span);
+    }
+
+    p.Images++;
+    return true;
+}
+
+// release space of an image
+void texture_atlas::release (const atlas_region & region)
+{
+    if (region.page >= Pages.size ()) return;
+
+    page & p = Pages[region.page];
+    if (p.Images == 0) return;
+
+    // once the page is empty, start over with no shelves
+    if (--p.Images == 0)
+    {
+        p.Shelves.clear ();
+        return;
+    }
+
+    for (std::vector<shelf>::iterator s = p.Shelves.begin (); s != p.Shelves.end (); s++)
+    {
+        if (s->y != region.y) continue;
+
+        span released;
+        released.x = region.x;
+        released.length = region.length + ATLAS_PADDING;
+
+        // keep free spans sorted and merge adjacent ones
+        std::list<span>::iterator next = s->Free.begin ();
+        while (next != s->Free.end () && next->x < released.x) next++;
+
+        std::list<span>::iterator i = s->Free.insert (next, released);
+        if (next != s->Free.end () && i->x + i->length == next->x)
+        {
+            i->length += next->length;
+            s->Free.erase (next);
+        }
+        if (i != s->Free.begin ())
+        {
+            std::list<span>::iterator prev = i;
+            prev--;
+            if (prev->x + prev->length == i->x)
+            {
+                prev->length += i->length;
+                s->Free.erase (i);
+            }
+        }
+        return;
+    }
+}
@@ -0,0 +1,191 @@
+/*
+ Copyright (C) 2011 Kai Sterker <kai.sterker@gmail.com>
+ Part of the Adonthell Project http://adonthell.linuxgames.com
+
+ Adonthell is free software; you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation; either version 2 of the License, or
+ (at your option) any later version.
+
+ Adonthell is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with Adonthell; if not, write to the Free Software
+ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+/**
+ * @file   gfx/texture_atlas.h
+ * @author Kai Sterker <kai.sterker@gmail.com>
+ *
+ * @brief  Declares the texture_atlas class.
+ *
+ *
+ */
+
+#ifndef GFX_TEXTURE_ATLAS_H
+#define GFX_TEXTURE_ATLAS_H
+
+#include <list>
+#include <vector>
+#include <adonthell/base/types.h>
+
+/// default length and height of an atlas page
+#define ATLAS_PAGE_SIZE 1024
+/// images larger than this in either dimension get their own texture
+#define ATLAS_MAX_IMAGE_SIZE 256
+/// empty space kept around each image, to avoid bleeding when scaling
+#define ATLAS_PADDING 1
+
+namespace gfx
+{
+    /**
+     * Location of an image inside a texture_atlas.
+     */
+    struct atlas_region
+    {
+        /// index of the page the image is located on
+        u_int32 page;
+        /// x offset of the image on the page
+        u_int16 x;
+        /// y offset of the image on the page
+        u_int16 y;
+        /// length of the image
+        u_int16 length;
+        /// height of the image
+        u_int16 height;
+    };
+
+    /**
+     * Allocates space for many small images on a few large pages,
+     * so that renderer backends can keep them in shared textures.
+     * Drawing images that are located on the same page does not
+     * require switching textures and can be batched by the renderer.
+     *
+     * Space is allocated with a shelf packing strategy: each page is
+     * divided into horizontal shelves, and images are placed next to
+     * each other on the shelf that matches their height best. Space
+     * released by an image can be reused by another image of similar
+     * height placed on the same shelf.
+     *
+     * The atlas only manages space. Creating and filling the actual
+     * textures is up to the backend, which is notified of new pages
+     * through the return value of num_pages().
+     */
+    class texture_atlas
+    {
+    public:
+        /**
+         * Create an empty atlas.
+         * @param page_size length and height of a single page.
+         */
+        texture_atlas (const u_int16 & page_size = ATLAS_PAGE_SIZE);
+
+        /**
+         * Check whether an image of the given size should be placed in
+         * the atlas. Large images do not profit from sharing a texture.
+         * @param l length of the image.
+         * @param h height of the image.
+         * @return \b true if the image can be placed in the atlas.
+         */
+        bool accepts (const u_int16 & l, const u_int16 & h) const
+        {
+            return l > 0 && h > 0 && l <= ATLAS_MAX_IMAGE_SIZE && h <= ATLAS_MAX_IMAGE_SIZE;
+        }
+
+        /**
+         * Reserve space for an image. A new page is added if the image
+         * does not fit on any of the existing pages.
+         * @param l length of the image.
+         * @param h height of the image.
+         * @param region receives the location of the image.
+         * @return \b true on success, \b false if the image is too large.
+         */
+        bool allocate (const u_int16 & l, const u_int16 & h, atlas_region & region);
+
+        /**
+         * Release space previously reserved for an image.
+         * @param region the location of the image.
+         */
+        void release (const atlas_region & region);
+
+        /**
+         * Get number of pages in use. Pages are never removed, so the
+         * backend can keep their textures once created.
+         * @return number of pages.
+         */
+        u_int32 num_pages () const { return Pages.size (); }
+
+        /**
+         * Get the length and height of a page.
+         * @return size of a page in pixels.
+         */
+        u_int16 page_size () const { return PageSize; }
+
+        /**
+         * Get number of images located on the given page.
+         * @param page index of the page.
+         * @return number of images on the page.
+         */
+        u_int32 num_images (const u_int32 & page) const { return Pages[page].Images; }
+
+    private:
+        /// forbid copy construction
+        texture_atlas (const texture_atlas & a);
+
+        /**
+         * A horizontal span of free space on a shelf.
+         */
+        struct span
+        {
+            /// start of the free space
+            u_int16 x;
+            /// length of the free space
+            u_int16 length;
+        };
+
+        /**
+         * A row of images of similar height.
+         */
+        struct shelf
+        {
+            /// y offset of the shelf on the page
+            u_int16 y;
+            /// height of the shelf
+            u_int16 height;
+            /// free space on the shelf, sorted by position
+            std::list<span> Free;
+        };
+
+        /**
+         * A single atlas page.
+         */
+        struct page
+        {
+            /// the shelves, from top to bottom
+            std::vector<shelf> Shelves;
+            /// number of images on the page
+            u_int32 Images;
+        };
+
+        /**
+         * Try placing an image on the given page.
+         * @param p the page.
+         * @param l padded length of the image.
+         * @param h padded height of the image.
+         * @param region receives the location of the image.
+         * @return \b true on success, \b false if the image does not fit.
+         */
+        bool allocate (page & p, const u_int16 & l, const u_int16 & h, atlas_region & region);
+
+        /// length and height of each page
+        u_int16 PageSize;
+        /// the pages of the atlas
+        std::vector<page> Pages;
+    };
+}
+
+#endif
@@ -57,6 +57,7 @@ namespace gui
 		{
 			DownKey = k.key();
 			Clicked = true;
+			invalidate();
 			return true;
 		}
 
@@ -70,6 +71,7 @@ namespace gui
 		{
 			activate();
 			Clicked = false;
+			invalidate();
 			return true;
 		}
 
@@ -144,7 +144,7 @@ namespace gui
          * Notification that the object will no longer receive keyboard
          * events
          */
-		virtual void unfocus() { Clicked = false; }
+		virtual void unfocus() { Clicked = false; invalidate(); }
 		//@}
 
 		//not till we get a mouse_event class
@@ -161,6 +161,7 @@ public:
 	void set_drawable (const gfx::drawable & drawable)
 	{
 		Drawable = &drawable;
+		invalidate ();
 	}
 
 #ifndef SWIG
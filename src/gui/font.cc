@@ -26,7 +26,6 @@
  */
 
 #include <string>
-#include <sstream>
 #include <ctype.h>
 
 #include "font.h"
@@ -48,6 +47,7 @@ namespace gui
 	font::font(const char* path, int size)
 	{
 	    Face = NULL;
+	    Atlas = NULL;
 
 		//check for the path
 		const char* defont = "gfx/gui/Vera.ttf";
@@ -115,6 +115,7 @@ namespace gui
 	void font::set_size(int size)
 	{
 		FontSize = size;
+		Atlas = NULL;
 		if ((Error = FT_Set_Pixel_Sizes (Face, 0, FontSize)))
 		{
 			LOG(ERROR) << logging::indent() << "Unable to set the size of the font";
@@ -140,7 +141,7 @@ namespace gui
                 ox += kerning.x >> 6;
             }
 
-            gi->Foreground->s->draw(ox + gi->x, y + gi->y, da, target);
+            gi->draw(ox, y, da, target);
             ox += gi->length;
 
             prev = current;
@@ -166,124 +167,77 @@ namespace gui
                 ox += kerning.x >> 6;
             }
 
-            gi->Background->s->draw(ox + gi->x - 3, y + gi->y - 3, da, target);
+            gi->draw_shadow(ox, y, da, target);
             ox += gi->length;
 
             prev = current;
         }
     }
 
-    gui::glyph_info *font::create_glyph (const u_int32 & chr)
+    // render glyph with freetype
+    FT_GlyphSlot font::load_glyph (const u_int32 & chr)
     {
-        // new glyph structure
-        glyph_info *gi = new glyph_info();
-
         if ((Error = FT_Load_Char(Face, chr, FT_LOAD_RENDER)))
         {
             LOG(ERROR) << logging::indent() << "Unable to load the glyph for character '" << chr << "'";
-
-            gi->length = 0;
-            gi->height = 0;
-            gi->x = 0;
-            gi->y = 0;
+            return NULL;
         }
-        else
-        {
-            std::stringstream name (std::ios::out);
-            gui::color fg_color, bg_color;
-            bg_color.i = 0;
-
-            // the foreground glyph is always unique, so just create it
-            gfx::surface *foreground = gfx::create_surface();
-
-            foreground->set_alpha (255, true);
-            foreground->resize (Face->glyph->bitmap.width, Face->glyph->bitmap.rows);
-
-            if (foreground->length() > 0 && foreground->height() > 0)
-            {
-                foreground->unmap_color (Color, fg_color.b[2], fg_color.b[1], fg_color.b[0], fg_color.b[3]);
-                // TODO: big endian? foreground->unmap_color (Color, fg_color.b[0], fg_color.b[1], fg_color.b[2], fg_color.b[3]);
-                foreground->fillrect (0, 0, foreground->length(), foreground->height(), foreground->map_color (fg_color.b[0], fg_color.b[1], fg_color.b[2], 0));
-
-                // render foreground image
-                render_glyph(0, 0, &Face->glyph->bitmap, foreground, fg_color);
-            }
-
-            // add it to surface cache
-            name << std::hex << chr << "_" << fg_color.i << "_" << std::dec << Name << "_" << FontSize;
-            gi->Foreground = gfx::surfaces->add_surface_mem (name.str(), foreground);
-
-            // determine color to use for the background
-            float intensity = fg_color.b[0]*.3 + fg_color.b[1]*0.59 + fg_color.b[2]*0.11;
-            bg_color.b[0] = bg_color.b[1] = bg_color.b[2] = intensity < 128.0 ? 0xff : 0x00;
-
-            // a suitable background glyph may already exist, so try to get it
-            name.str("b_");
-            name << std::hex << chr << "_" << bg_color.i << "_" << std::dec << Name << "_" << FontSize;
-
-            gi->Background = gfx::surfaces->get_surface_mem (name.str());
-            if (gi->Background == NULL)
-            {
-                gfx::surface *background = gfx::create_surface();
-
-                background->set_alpha (255, true);
-                background->resize (Face->glyph->bitmap.width + 6, Face->glyph->bitmap.rows + 6);
-                background->fillrect(0, 0, background->length(), background->height(), background->map_color (bg_color.b[0], bg_color.b[1], bg_color.b[2], 0));
-
-                // render background image
-                render_glyph(3, 3, &Face->glyph->bitmap, background, bg_color);
-
-                // apply gaussian blur
-                background->blur();
 
-                // store in cache
-                gi->Background = gfx::surfaces->add_surface_mem (name.str(), background);
-            }
-
-            // make sure font is rendered on its proper  base line
-            int drop = (Face->size->metrics.height >> 6) - FontSize;
+        return Face->glyph;
+    }
 
-            gi->length = Face->glyph->advance.x >> 6;
-            gi->height = Face->glyph->advance.y >> 6;
-            gi->x = Face->glyph->bitmap_left;
-            gi->y = -Face->glyph->bitmap_top - drop;
+    // get glyphs of text in UTF-32 format
+    static void decode (const string & text, std::vector<u_int32> & chars)
+    {
+        for (string::const_iterator i = text.begin(); i != text.end(); /* nothing */)
+        {
+            chars.push_back (base::utf8::to_utf32 (text, i));
         }
-
-        return gi;
     }
 
-    // render a single glyph to a surface
-    void font::render_glyph(int x, int y, FT_Bitmap* bmp, gfx::surface *surf, gui::color & col)
+    // render glyphs of text in the background
+    void font::prewarm (const string & text)
     {
-        gui::color p1;
+        if (Error || !FontCache) return;
 
-        surf->lock();
+        std::vector<u_int32> chars;
+        decode (text, chars);
+        FontCache->preload (Name, FontSize, Color, chars);
+    }
 
-        unsigned char* data = bmp->buffer;
-        for (int j = 0; j < bmp->rows; j++)
-        {
-            for (int i = 0; i < bmp->width; i++)
-            {
-                if (*data)
-                {
-                    float a2 = *data / 255.0;
+    // render range of glyphs in the background
+    void font::prewarm_range (const u_int32 & first, const u_int32 & last)
+    {
+        if (Error || !FontCache) return;
 
-                    p1.b[0] = (u_int8) (col.b[0] * a2);
-                    p1.b[1] = (u_int8) (col.b[1] * a2);
-                    p1.b[2] = (u_int8) (col.b[2] * a2);
-                    p1.b[3] = *data;
+        std::vector<u_int32> chars;
+        for (u_int32 chr = first; chr <= last && chr < 0x110000; chr++)
+        {
+            chars.push_back (chr);
+        }
+        FontCache->preload (Name, FontSize, Color, chars);
+    }
 
-                    surf->put_pix (x + i, y + j, surf->map_color (p1.b[0], p1.b[1], p1.b[2], p1.b[3]));
-                }
+    // load font in the background
+    void font::preload (const string & path, const int & size, const u_int32 & color, const string & text)
+    {
+        if (!FontCache) return;
 
-                data++;
-            }
+        std::vector<u_int32> chars;
+        decode (text, chars);
+        FontCache->preload (path, size, color, chars);
+    }
 
-            data += bmp->pitch;
-            data -= bmp->width;
-        }
+    // memory used by glyphs of font
+    u_int32 font::memory_used () const
+    {
+        return FontCache ? FontCache->memory_used (this) : 0;
+    }
 
-        surf->unlock();
+    // memory used by glyphs of all fonts
+    std::string font::memory_report ()
+    {
+        return FontCache ? FontCache->summary () : "";
     }
 
     // get text size with line wrapping enabled
@@ -341,6 +295,155 @@ namespace gui
 		w = max_width > w ? max_width : w;
 	}
 
+	// place glyphs of text for drawing
+	void font::layout (const string& s, const u_int16 & max_line_width, text_layout & l)
+	{
+	    l.Glyphs.clear ();
+	    l.Lines.clear ();
+	    l.Font = this;
+	    l.FontSize = FontSize;
+	    l.Color = Color;
+	    l.MaxWidth = max_line_width;
+	    l.Valid = true;
+	    l.Width = 0;
+
+	    text_layout::line current = { 0, 0, 0 };
+	    text_layout::placed_glyph pg;
+	    FT_Vector kerning;
+
+	    u_int32 prev = 0, index = 0;
+	    s_int16 ox = 0;
+	    // glyph and pen position of the last whitespace on the line
+	    s_int32 last_space = -1;
+	    s_int16 space_x = 0;
+
+	    for (string::const_iterator i = s.begin(); i != s.end(); /* nothing */)
+	    {
+	        pg.Pos = i - s.begin ();
+	        u_int32 chr = base::utf8::to_utf32 (s, i);
+
+	        // manual line break, unless all text goes on a single line
+	        if (chr == '\n' && max_line_width)
+	        {
+	            current.Count = l.Glyphs.size () - current.First;
+	            current.Width = ox;
+	            l.Lines.push_back (current);
+
+	            current.First = l.Glyphs.size ();
+	            last_space = -1;
+	            ox = 0;
+	            prev = 0;
+	            continue;
+	        }
+
+	        pg.Glyph = FontCache->get (chr, this);
+
+	        if (FT_HAS_KERNING (Face))
+	        {
+	            index = FT_Get_Char_Index (Face, chr);
+	            if (prev)
+	            {
+	                FT_Get_Kerning (Face, prev, index, FT_KERNING_DEFAULT, &kerning);
+	                ox += kerning.x >> 6;
+	            }
+	        }
+
+	        // wrap at last whitespace, if the glyph exceeds the line
+	        if (max_line_width && ox + pg.Glyph->length > max_line_width && last_space >= 0)
+	        {
+	            current.Count = last_space - current.First;
+	            current.Width = space_x;
+	            l.Lines.push_back (current);
+
+	            // move the rest of the line to the start of the next
+	            current.First = last_space + 1;
+	            s_int16 shift = current.First < l.Glyphs.size () ? l.Glyphs[current.First].X : ox;
+	            for (u_int32 j = current.First; j < l.Glyphs.size (); j++)
+	            {
+	                l.Glyphs[j].X -= shift;
+	            }
+
+	            ox -= shift;
+	            last_space = -1;
+	        }
+
+	        if (chr < 128 && isspace (chr))
+	        {
+	            last_space = l.Glyphs.size ();
+	            space_x = ox;
+	        }
+
+	        pg.X = ox;
+	        l.Glyphs.push_back (pg);
+
+	        ox += pg.Glyph->length;
+	        prev = index;
+	    }
+
+	    // add last line
+	    current.Count = l.Glyphs.size () - current.First;
+	    current.Width = ox;
+	    l.Lines.push_back (current);
+
+	    for (std::vector<text_layout::line>::const_iterator i = l.Lines.begin (); i != l.Lines.end (); i++)
+	    {
+	        if (i->Width > l.Width) l.Width = i->Width;
+	    }
+
+        // how much the font extends below the base line
+        int drop = (Face->size->metrics.height >> 6) - FontSize;
+	    l.Height = l.Lines.size () * FontSize + drop;
+	}
+
+    // draw a line of laid out text
+    void font::draw_text (const text_layout & l, const u_int32 & line, const s_int16 & x, const s_int16 & y, const gfx::drawing_area *da, gfx::surface* target) const
+    {
+        const text_layout::line & ln = l.Lines[line];
+        for (u_int32 i = ln.First; i < ln.First + ln.Count; i++)
+        {
+            const text_layout::placed_glyph & pg = l.Glyphs[i];
+            pg.Glyph->draw (x + pg.X, y, da, target);
+        }
+    }
+
+    // draw background of a line of laid out text
+    void font::draw_shadow (const text_layout & l, const u_int32 & line, const s_int16 & x, const s_int16 & y, const gfx::drawing_area *da, gfx::surface* target) const
+    {
+        const text_layout::line & ln = l.Lines[line];
+        for (u_int32 i = ln.First; i < ln.First + ln.Count; i++)
+        {
+            const text_layout::placed_glyph & pg = l.Glyphs[i];
+            pg.Glyph->draw_shadow (x + pg.X, y, da, target);
+        }
+    }
+
+    // check whether layout is up to date
+    bool text_layout::matches (const font *f, const u_int16 & max_line_width) const
+    {
+        return Valid && Font == f && FontSize == f->size () && Color == f->color () && MaxWidth == max_line_width;
+    }
+
+    // offset of given text position from start of its line
+    s_int16 text_layout::offset (const u_int32 & pos) const
+    {
+        for (std::vector<line>::const_iterator ln = Lines.begin (); ln != Lines.end (); ln++)
+        {
+            for (u_int32 i = ln->First; i < ln->First + ln->Count; i++)
+            {
+                if (Glyphs[i].Pos >= pos) return Glyphs[i].X;
+            }
+
+            // at end of line
+            std::vector<line>::const_iterator next = ln + 1;
+            if (next == Lines.end () || next->First >= Glyphs.size () || Glyphs[next->First].Pos > pos)
+            {
+                return ln->Width;
+            }
+        }
+
+        return 0;
+    }
+
 	//get text size without line wrapping
 	void font::get_text_size(const string& s, u_int32 & w, u_int32 & h)
 	{
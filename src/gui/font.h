@@ -34,7 +34,7 @@
 #include FT_FREETYPE_H
 
 #include <adonthell/gfx/drawing_area.h>
-#include <adonthell/gfx/surface_cacher.h>
+#include <adonthell/gfx/surface.h>
 
 #ifndef SWIG
 using std::vector;
@@ -52,9 +52,11 @@ namespace gui
         u_int32 i;
     } color;
 
+    class glyph_atlas;
+
     /**
-     * Data for a single glyph, including graphical representations
-     * for background (shadow) and actual character.
+     * Data for a single glyph, including where to find its graphical
+     * representations for background (shadow) and actual character.
      */
     class glyph_info
     {
@@ -62,23 +64,40 @@ namespace gui
         /**
          * Constructor.
          */
-        glyph_info() : Foreground(NULL), Background(NULL)
+        glyph_info() : Atlas(NULL), Page(0), sx(0), sy(0), w(0), h(0), x(0), y(0), length(0), height(0)
         {
         }
 
         /**
-         * Destructor.
+         * Draw the glyph.
+         * @param ox the x offset.
+         * @param oy the y offset
+         * @param da the clipping rectangle
+         * @param target the render target.
          */
-        ~glyph_info()
-        {
-            delete Foreground;
-            delete Background;
-        }
+        void draw (const s_int16 & ox, const s_int16 & oy, const gfx::drawing_area *da, gfx::surface *target) const;
 
-        /// foreground of the glyph
-        const gfx::surface_ref *Foreground;
-        /// background of the glyph, for contrast
-        const gfx::surface_ref *Background;
+        /**
+         * Draw the background of the glyph.
+         * @param ox the x offset.
+         * @param oy the y offset
+         * @param da the clipping rectangle
+         * @param target the render target.
+         */
+        void draw_shadow (const s_int16 & ox, const s_int16 & oy, const gfx::drawing_area *da, gfx::surface *target) const;
+
+        /// atlas containing the glyph
+        const glyph_atlas *Atlas;
+        /// page of the atlas containing the glyph
+        u_int32 Page;
+        /// position of the glyph, including background, in the atlas
+        u_int16 sx;
+        /// position of the glyph, including background, in the atlas
+        u_int16 sy;
+        /// size of the glyph bitmap
+        u_int16 w;
+        /// size of the glyph bitmap
+        u_int16 h;
 
         /// start position of the glyph
         s_int32 x;
@@ -107,6 +126,121 @@ namespace gui
 		int cpos;
 	};
 
+	class font;
+
+	/**
+	 * Text laid out by font::layout, ready for drawing. It keeps
+	 * the position of each glyph and where lines are broken, so that
+	 * text that does not change need not be measured again each time
+	 * it is drawn. It also remembers the font attributes and width it
+	 * was laid out with, to tell whether it is still up to date.
+	 */
+	class text_layout
+	{
+	public:
+	    /**
+	     * Create an empty layout that needs updating.
+	     */
+	    text_layout () : Font (NULL), FontSize (0), Color (0), MaxWidth (0), Valid (false), Width (0), Height (0)
+	    {
+	    }
+
+	    /**
+	     * A glyph placed on a line.
+	     */
+	    struct placed_glyph
+	    {
+	        /// the glyph
+	        const glyph_info *Glyph;
+	        /// offset of the glyph from the start of its line
+	        s_int16 X;
+	        /// index of the glyph's first byte in the text
+	        u_int32 Pos;
+	    };
+
+	    /**
+	     * A single line of text.
+	     */
+	    struct line
+	    {
+	        /// index of the first glyph of the line
+	        u_int32 First;
+	        /// number of glyphs on the line
+	        u_int32 Count;
+	        /// width of the line when rendered
+	        u_int16 Width;
+	    };
+
+	    /**
+	     * Check whether the layout can be drawn with the given
+	     * font and width.
+	     * @param f the font to draw with.
+	     * @param max_line_width the maximum line width, 0 for a single line.
+	     * @return true if the layout is up to date.
+	     */
+	    bool matches (const font *f, const u_int16 & max_line_width) const;
+
+	    /**
+	     * Mark the layout as outdated, e.g. after the text changed.
+	     */
+	    void invalidate () { Valid = false; }
+
+	    /**
+	     * Get offset of the given position of the text from the
+	     * start of its line, e.g. for placing a cursor.
+	     * @param pos index of a byte in the text.
+	     * @return offset of the glyph at that position in pixels.
+	     */
+	    s_int16 offset (const u_int32 & pos) const;
+
+	    /**
+	     * Get width of the widest line.
+	     * @return width of the text in pixels.
+	     */
+	    u_int16 width () const { return Width; }
+
+	    /**
+	     * Get height of all lines.
+	     * @return height of the text in pixels.
+	     */
+	    u_int16 height () const { return Height; }
+
+	    /**
+	     * Get number of lines.
+	     * @return number of lines of text.
+	     */
+	    u_int32 num_lines () const { return Lines.size (); }
+
+	    /**
+	     * Get width of the given line.
+	     * @param l index of a line.
+	     * @return width of that line in pixels.
+	     */
+	    u_int16 line_width (const u_int32 & l) const { return Lines[l].Width; }
+
+	private:
+	    friend class font;
+
+	    /// the font the text was laid out with
+	    const font *Font;
+	    /// size of that font
+	    int FontSize;
+	    /// color of that font
+	    u_int32 Color;
+	    /// maximum line width the text was laid out for
+	    u_int16 MaxWidth;
+	    /// whether the text has not changed since
+	    bool Valid;
+	    /// width of the widest line
+	    u_int16 Width;
+	    /// height of all lines
+	    u_int16 Height;
+	    /// glyphs of all lines
+	    std::vector<placed_glyph> Glyphs;
+	    /// the lines of text
+	    std::vector<line> Lines;
+	};
+
 	/**
 	 * Represents a font with a certain size and color that can be used
 	 * to render text onto surfaces.
@@ -182,6 +316,39 @@ namespace gui
          */
         void get_text_size(const string& s, const u_int16 & max_line_width, vector<textsize>& ts, u_int16 & w, u_int16 & h);
 
+        /**
+         * Place the glyphs of the given string for drawing it with
+         * this font, including word wrapping at whitespace.
+         * @param s the text to lay out.
+         * @param max_line_width the maximum line width in pixels, or
+         *      0 to keep all text on a single line, including line breaks.
+         * @param l receives the text layout.
+         */
+        void layout (const string& s, const u_int16 & max_line_width, text_layout & l);
+
+        /**
+         * Draw a line of previously laid out text.
+         * @param l the text layout.
+         * @param line the index of the line to draw.
+         * @param x the x offset.
+         * @param y the y offset
+         * @param da the clipping rectangle
+         * @param target the render target.
+         */
+        void draw_text (const text_layout & l, const u_int32 & line, const s_int16 & x, const s_int16 & y, const gfx::drawing_area *da = NULL, gfx::surface* target = NULL) const;
+
+        /**
+         * Draw the background of a line of previously laid out
+         * text. Call before draw_text.
+         * @param l the text layout.
+         * @param line the index of the line to draw.
+         * @param x the x offset.
+         * @param y the y offset
+         * @param da the clipping rectangle
+         * @param target the render target.
+         */
+        void draw_shadow (const text_layout & l, const u_int32 & line, const s_int16 & x, const s_int16 & y, const gfx::drawing_area *da = NULL, gfx::surface* target = NULL) const;
+
         /**
          * Check whether the font is ready for use.
          * @return false if any kind of error occurred.
@@ -204,7 +371,7 @@ namespace gui
 		 * Set the font color.
 		 * @param the new color in RGBA format.
 		 */
-        void set_color(u_int32 c) {Color = c;}
+        void set_color(u_int32 c) {Color = c; Atlas = NULL;}
 
         /**
          * Get the font color.
@@ -218,29 +385,75 @@ namespace gui
 		 */
 		std::string name() const { return Name; }
 
+        /**
+         * @name Preloading
+         */
+        //@{
+        /**
+         * Render the glyphs of the given text in the background, so
+         * that they are ready when the text is first displayed.
+         * Useful for characters outside of ASCII, like those of
+         * the next dialogue or the current language.
+         * @param text the text in UTF-8 format.
+         */
+        void prewarm (const string & text);
+
+        /**
+         * Render a range of glyphs in the background, so that they
+         * are ready when first displayed. For example, use 0xA0 to
+         * 0xFF for the Latin-1 characters not covered by ASCII.
+         * @param first the first glyph in UTF-32 format.
+         * @param last the last glyph in UTF-32 format.
+         */
+        void prewarm_range (const u_int32 & first, const u_int32 & last);
+
+        /**
+         * Load a font and render its glyphs in the background, before
+         * the font is used. Fonts of the same name, size and color
+         * created later on will find the glyphs ready.
+         * @param path path to a true type font.
+         * @param size the font size.
+         * @param color the font color in RGBA format.
+         * @param text additional glyphs to render, besides ASCII, in UTF-8 format.
+         */
+        static void preload (const string & path, const int & size, const u_int32 & color = 0xffffffff, const string & text = "");
+        //@}
+
+        /**
+         * @name Statistics
+         */
+        //@{
+        /**
+         * Get the memory used by the glyphs of this font
+         * in its current size and color.
+         * @return memory used in bytes.
+         */
+        u_int32 memory_used () const;
+
+        /**
+         * Get number of glyphs and memory used by all fonts
+         * in any size and color, one font per line.
+         * @return the statistics in human readable form.
+         */
+        static std::string memory_report ();
+        //@}
+
 		/**
-		 * Create information for the given glyph.
+		 * Render the given glyph with freetype.
 		 * @param chr the character in UTF32 format.
+		 * @return the rendered glyph, or NULL on error.
 		 */
-        gui::glyph_info* create_glyph (const u_int32 & chr);
+        FT_GlyphSlot load_glyph (const u_int32 & chr);
 
 	private:
+        friend class font_cache;
+
         /**
          * Update reference count for freetype library usage.
          * @param addref true to increase refcount, false to decrease.
          */
         void ref(bool addref);
 
-        /**
-         * Renders the given glyph in the given color onto the given surface.
-         * @param x offset in x direction
-         * @param y offset in y direction
-         * @param bmp the glyph bitmap
-         * @param surf the surface to render on
-         * @param c the color to use for rendering.
-         */
-        void render_glyph(int x, int y, FT_Bitmap* bmp, gfx::surface* surf, gui::color & c);
-
         /// a freetype font face
         FT_Face Face;
         /// state of the font
@@ -251,6 +464,8 @@ namespace gui
         int FontSize;
         /// name of the font
         std::string Name;
+        /// glyphs of the font in its current size and color
+        glyph_atlas *Atlas;
 	};
 }
 
@@ -24,44 +24,527 @@
  * @brief Handles caching of glyphs.
  */
 
-#include <sstream>
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
 
 #include "fontcache.h"
 #include "font.h"
+#include <adonthell/base/base.h>
+#include <adonthell/base/logging.h>
+#include <adonthell/base/profiler.h>
+#include <adonthell/gfx/gfx.h>
+#include <adonthell/gfx/pixel_ops.h>
 
 using gui::glyph_info;
+using gui::glyph_atlas;
 using gui::font_cache;
 
-font_cache::font_cache()
+// create atlas for given font
+glyph_atlas::glyph_atlas (gui::font *f)
+{
+    Name = f->name();
+    FontSize = f->size();
+    Color = f->color();
+    Shadow = shadow_color (Color);
+    Glyphs = 0;
+
+    memset (Table, 0, sizeof (Table));
+
+    // printable ASCII characters are uploaded together
+    for (u_int32 chr = 32; chr < 127; chr++)
+    {
+        add (chr, f);
+    }
+}
+
+// create atlas for preloading
+glyph_atlas::glyph_atlas (const std::string & name, const int & size, const u_int32 & color)
+{
+    Name = name;
+    FontSize = size;
+    Color = color;
+    Shadow = shadow_color (Color);
+    Glyphs = 0;
+
+    memset (Table, 0, sizeof (Table));
+}
+
+// delete atlas
+glyph_atlas::~glyph_atlas ()
+{
+    for (u_int32 i = 0; i < GLYPH_BLOCKS; i++)
+    {
+        if (Table[i] == NULL) continue;
+        for (u_int32 j = 0; j < GLYPH_BLOCK_SIZE; j++)
+        {
+            delete Table[i][j];
+        }
+        delete[] Table[i];
+    }
+
+    for (std::vector<page*>::iterator p = Pages.begin(); p != Pages.end(); p++)
+    {
+        delete (*p)->Foreground;
+        delete (*p)->Background;
+        free ((*p)->Fg);
+        free ((*p)->Bg);
+        delete *p;
+    }
+}
+
+// check whether atlas is meant for given font
+bool glyph_atlas::matches (const gui::font *f) const
+{
+    return FontSize == f->size() && Color == f->color() && Name == f->name();
+}
+
+// color of text background
+u_int32 glyph_atlas::shadow_color (const u_int32 & color)
+{
+    // dark text gets a bright background and vice versa
+    gui::color fg;
+    fg.i = color;
+    float intensity = fg.b[0]*.3 + fg.b[1]*0.59 + fg.b[2]*0.11;
+    return intensity < 128.0 ? 0x00ffffff : 0x00000000;
+}
+
+// copy coverage of a glyph into foreground and background
+void glyph_atlas::copy_coverage (const FT_Bitmap & bitmap, const u_int32 & fg_color, const u_int32 & bg_color,
+    u_int8 *fp, const u_int32 & fg_stride, u_int8 *bp, const u_int32 & bg_stride)
+{
+    gui::color fg, bg;
+    fg.i = fg_color;
+    bg.i = bg_color;
+
+    const unsigned char *src = bitmap.buffer;
+    for (u_int32 j = 0; j < bitmap.rows; j++, src += bitmap.pitch)
+    {
+        u_int8 *f = fp + j * fg_stride * 4;
+        u_int8 *b = bp + j * bg_stride * 4;
+
+        for (u_int32 i = 0; i < bitmap.width; i++, f += 4, b += 4)
+        {
+            u_int8 a = src[i];
+            if (!a) continue;
+
+            f[0] = fg.b[0] * a / 255;
+            f[1] = fg.b[1] * a / 255;
+            f[2] = fg.b[2] * a / 255;
+            f[3] = a;
+
+            b[0] = bg.b[0] * a / 255;
+            b[1] = bg.b[1] * a / 255;
+            b[2] = bg.b[2] * a / 255;
+            b[3] = a;
+        }
+    }
+}
+
+// get table entry for glyph
+glyph_info *& glyph_atlas::slot (const u_int32 & chr)
+{
+    glyph_info **& block = Table[chr / GLYPH_BLOCK_SIZE];
+    if (block == NULL)
+    {
+        block = new glyph_info*[GLYPH_BLOCK_SIZE];
+        memset (block, 0, GLYPH_BLOCK_SIZE * sizeof (glyph_info*));
+    }
+
+    return block[chr % GLYPH_BLOCK_SIZE];
+}
+
+// render glyph into the atlas
+const glyph_info *glyph_atlas::add (const u_int32 & chr, gui::font *f)
+{
+    if (chr >= 0x110000) return get ('?', f);
+
+    glyph_info *gi = new glyph_info();
+    slot (chr) = gi;
+    Glyphs++;
+
+    FT_GlyphSlot slot = f->load_glyph (chr);
+    if (slot == NULL) return gi;
+
+    // make sure font is rendered on its proper  base line
+    int drop = f->get_line_height() - FontSize;
+
+    gi->length = slot->advance.x >> 6;
+    gi->height = slot->advance.y >> 6;
+    gi->x = slot->bitmap_left;
+    gi->y = -slot->bitmap_top - drop;
+    gi->w = slot->bitmap.width;
+    gi->h = slot->bitmap.rows;
+
+    // nothing to draw, e.g. whitespace
+    if (gi->w == 0 || gi->h == 0) return gi;
+
+    page *p = place (gi);
+    if (p == NULL)
+    {
+        gi->w = gi->h = 0;
+        return gi;
+    }
+
+    // copy coverage of the glyph into both pages
+    u_int32 row = (gi->sy + GLYPH_PADDING) * GLYPH_ATLAS_WIDTH + gi->sx + GLYPH_PADDING;
+    copy_coverage (slot->bitmap, Color, Shadow, p->Fg + row * 4, GLYPH_ATLAS_WIDTH, p->Bg + row * 4, GLYPH_ATLAS_WIDTH);
+
+    p->Fresh.push_back (gi);
+    p->Modified = true;
+    return gi;
+}
+
+// add glyph rendered in the background
+void glyph_atlas::insert (const glyph_loader::glyph & g)
+{
+    if (g.Chr >= 0x110000) return;
+
+    // glyph was required before it was ready
+    glyph_info *& entry = slot (g.Chr);
+    if (entry != NULL) return;
+
+    glyph_info *gi = new glyph_info();
+    entry = gi;
+    Glyphs++;
+
+    gi->length = g.length;
+    gi->height = g.height;
+    gi->x = g.x;
+    gi->y = g.y;
+
+    // nothing to draw, e.g. whitespace
+    if (g.Fg == NULL) return;
+
+    gi->w = g.w;
+    gi->h = g.h;
+
+    page *p = place (gi);
+    if (p == NULL)
+    {
+        gi->w = gi->h = 0;
+        return;
+    }
+
+    // copy foreground ...
+    for (u_int32 j = 0; j < gi->h; j++)
+    {
+        memcpy (p->Fg + ((gi->sy + GLYPH_PADDING + j) * GLYPH_ATLAS_WIDTH + gi->sx + GLYPH_PADDING) * 4, g.Fg + j * gi->w * 4, gi->w * 4);
+    }
+
+    // ... and the background, which has been blurred already
+    u_int16 w = gi->w + 2 * GLYPH_PADDING;
+    u_int16 h = gi->h + 2 * GLYPH_PADDING;
+    for (u_int32 j = 0; j < h; j++)
+    {
+        memcpy (p->Bg + ((gi->sy + j) * GLYPH_ATLAS_WIDTH + gi->sx) * 4, g.Bg + j * w * 4, w * 4);
+    }
+
+    p->Prerendered = true;
+    p->Modified = true;
+}
+
+// find room for a glyph
+glyph_atlas::page *glyph_atlas::place (glyph_info *gi)
+{
+    u_int16 w = gi->w + 2 * GLYPH_PADDING;
+    u_int16 h = gi->h + 2 * GLYPH_PADDING;
+    if (w > GLYPH_ATLAS_WIDTH || h > GLYPH_ATLAS_MAX_HEIGHT) return NULL;
+
+    page *p = Pages.empty() ? NULL : Pages.back();
+    if (p != NULL && p->PenX + w > GLYPH_ATLAS_WIDTH)
+    {
+        // start a new row
+        p->PenX = 0;
+        p->PenY += p->ShelfHeight;
+        p->ShelfHeight = 0;
+    }
+
+    if (p == NULL || p->PenY + h > GLYPH_ATLAS_MAX_HEIGHT)
+    {
+        p = new page();
+        p->Foreground = NULL;
+        p->Background = NULL;
+        p->Fg = NULL;
+        p->Bg = NULL;
+        p->Height = 0;
+        p->PenX = p->PenY = p->ShelfHeight = 0;
+        p->Uploaded = false;
+        p->Modified = false;
+        p->Prerendered = false;
+        p->DirtyTop = p->DirtyBottom = 0;
+        Pages.push_back (p);
+    }
+
+    // grow page as required
+    if (p->PenY + h > p->Height)
+    {
+        u_int16 height = p->Height ? p->Height : h * 4;
+        while (height < p->PenY + h) height *= 2;
+        if (height > GLYPH_ATLAS_MAX_HEIGHT) height = GLYPH_ATLAS_MAX_HEIGHT;
+
+        u_int32 old_size = p->Height * GLYPH_ATLAS_WIDTH * 4;
+        u_int32 new_size = height * GLYPH_ATLAS_WIDTH * 4;
+        p->Fg = (u_int8*) realloc (p->Fg, new_size);
+        p->Bg = (u_int8*) realloc (p->Bg, new_size);
+        memset (p->Fg + old_size, 0, new_size - old_size);
+        memset (p->Bg + old_size, 0, new_size - old_size);
+        p->Height = height;
+    }
+
+    gi->Atlas = this;
+    gi->Page = Pages.size() - 1;
+    gi->sx = p->PenX;
+    gi->sy = p->PenY;
+
+    p->PenX += w;
+    if (h > p->ShelfHeight) p->ShelfHeight = h;
+
+    // rows to upload next time
+    if (p->DirtyTop == p->DirtyBottom)
+    {
+        p->DirtyTop = gi->sy;
+        p->DirtyBottom = gi->sy + h;
+    }
+    else
+    {
+        p->DirtyTop = std::min (p->DirtyTop, gi->sy);
+        p->DirtyBottom = std::max (p->DirtyBottom, (u_int16) (gi->sy + h));
+    }
+
+    return p;
+}
+
+// update surfaces of a page
+void glyph_atlas::upload (page *p) const
+{
+    if (!p->Uploaded && !p->Prerendered)
+    {
+        // nothing has been blurred yet, so do it all at once
+        gfx::pixel_ops::blur (p->Bg, GLYPH_ATLAS_WIDTH, p->Height, true);
+    }
+    else
+    {
+        // only blur the backgrounds of new glyphs
+        for (std::vector<glyph_info*>::const_iterator gi = p->Fresh.begin(); gi != p->Fresh.end(); gi++)
+        {
+            u_int16 w = (*gi)->w + 2 * GLYPH_PADDING;
+            u_int16 h = (*gi)->h + 2 * GLYPH_PADDING;
+            u_int8 *area = (u_int8*) malloc (w * h * 4);
+
+            for (u_int16 j = 0; j < h; j++)
+            {
+                memcpy (area + j * w * 4, p->Bg + (((*gi)->sy + j) * GLYPH_ATLAS_WIDTH + (*gi)->sx) * 4, w * 4);
+            }
+
+            gfx::pixel_ops::blur (area, w, h, true);
+
+            for (u_int16 j = 0; j < h; j++)
+            {
+                memcpy (p->Bg + (((*gi)->sy + j) * GLYPH_ATLAS_WIDTH + (*gi)->sx) * 4, area + j * w * 4, w * 4);
+            }
+
+            free (area);
+        }
+    }
+
+    if (!p->Uploaded)
+    {
+        p->Foreground = gfx::create_surface();
+        p->Background = gfx::create_surface();
+        p->Uploaded = true;
+    }
+
+    if (p->Foreground->height() != p->Height)
+    {
+        // new or grown page, so textures have to be created anew
+        p->Foreground->set_alpha (255, true);
+        p->Foreground->set_pixels (p->Fg, GLYPH_ATLAS_WIDTH, p->Height, true);
+        p->Background->set_alpha (255, true);
+        p->Background->set_pixels (p->Bg, GLYPH_ATLAS_WIDTH, p->Height, true);
+    }
+    else if (p->DirtyTop < p->DirtyBottom)
+    {
+        // only the rows of glyphs added since the last upload
+        u_int32 offset = p->DirtyTop * GLYPH_ATLAS_WIDTH * 4;
+        u_int16 rows = p->DirtyBottom - p->DirtyTop;
+        p->Foreground->put_rgba_rows (p->Fg + offset, p->DirtyTop, rows);
+        p->Background->put_rgba_rows (p->Bg + offset, p->DirtyTop, rows);
+    }
+
+    p->DirtyTop = p->DirtyBottom = 0;
+    p->Fresh.clear();
+    p->Modified = false;
+}
+
+// size of atlas in memory
+u_int32 glyph_atlas::memory_used () const
+{
+    u_int32 size = Glyphs * sizeof (glyph_info);
+
+    for (u_int32 i = 0; i < GLYPH_BLOCKS; i++)
+    {
+        if (Table[i] != NULL) size += GLYPH_BLOCK_SIZE * sizeof (glyph_info*);
+    }
+
+    for (std::vector<page*>::const_iterator p = Pages.begin(); p != Pages.end(); p++)
+    {
+        // pixels in system memory, for foreground and background ...
+        u_int32 pixels = (*p)->Height * GLYPH_ATLAS_WIDTH * 4 * 2;
+
+        // ... and the same again once uploaded
+        size += (*p)->Uploaded ? pixels * 2 : pixels;
+    }
+
+    return size;
+}
+
+// draw foreground of glyph
+void glyph_info::draw (const s_int16 & ox, const s_int16 & oy, const gfx::drawing_area *da, gfx::surface *target) const
+{
+    if (w == 0) return;
+    Atlas->foreground (Page)->draw (ox + x, oy + y, sx + GLYPH_PADDING, sy + GLYPH_PADDING, w, h, da, target);
+}
+
+// draw background of glyph
+void glyph_info::draw_shadow (const s_int16 & ox, const s_int16 & oy, const gfx::drawing_area *da, gfx::surface *target) const
+{
+    if (w == 0) return;
+    Atlas->background (Page)->draw (ox + x - GLYPH_PADDING, oy + y - GLYPH_PADDING, sx, sy,
+        w + 2 * GLYPH_PADDING, h + 2 * GLYPH_PADDING, da, target);
+}
+
+font_cache::font_cache() : Loader (NULL)
 {
 }
 
 font_cache::~font_cache()
 {
-    std::hash_map<std::string, glyph_info*>::iterator i;
-    for (i = Cache.begin(); i != Cache.end(); i++)
+    // stop rendering before deleting atlases
+    delete Loader;
+
+    for (std::vector<glyph_atlas*>::iterator i = Atlases.begin(); i != Atlases.end(); i++)
     {
-        delete i->second;
+        delete *i;
     }
 }
 
 const glyph_info* font_cache::get (const u_int32 & glyph, gui::font *f)
 {
-    // create a unique name based on font attributes
-    std::stringstream cache_name (std::ios::out);
-    cache_name << std::hex << glyph << "_" << f->color() << "_" << f->size() << "_" << f->name();
+    return atlas (f)->get (glyph, f);
+}
+
+glyph_atlas *font_cache::atlas (gui::font *f)
+{
+    // font remembers its atlas until size or color change
+    if (f->Atlas != NULL) return f->Atlas;
 
-    // check for glyph in cache
-    std::hash_map<std::string, glyph_info*>::iterator idx = Cache.find(cache_name.str());
-    if (idx != Cache.end())
+    for (std::vector<glyph_atlas*>::iterator i = Atlases.begin(); i != Atlases.end(); i++)
     {
-        return idx->second;
+        if ((*i)->matches (f))
+        {
+            f->Atlas = *i;
+            return *i;
+        }
     }
 
-    // not found, we need to render it
-    glyph_info *gi = f->create_glyph(glyph);
-    Cache[cache_name.str()] = gi;
+    f->Atlas = new glyph_atlas (f);
+    Atlases.push_back (f->Atlas);
+    return f->Atlas;
+}
 
-    return gi;
+// find atlas of font
+glyph_atlas *font_cache::find (const std::string & name, const int & size, const u_int32 & color) const
+{
+    for (std::vector<glyph_atlas*>::const_iterator i = Atlases.begin(); i != Atlases.end(); i++)
+    {
+        if ((*i)->matches (name, size, color)) return *i;
+    }
+
+    return NULL;
 }
 
+// render glyphs in the background
+void font_cache::preload (const std::string & name, const int & size, const u_int32 & color, const std::vector<u_int32> & chars)
+{
+    std::string path (name);
+    if (!base::Paths().find_in_path (path))
+    {
+        LOG(ERROR) << logging::indent() << "Unable to find font '" << name << "'";
+        return;
+    }
+
+    glyph_atlas *a = find (name, size, color);
+    if (a == NULL)
+    {
+        a = new glyph_atlas (name, size, color);
+        Atlases.push_back (a);
+    }
+
+    // skip glyphs that are already available or requested twice
+    std::vector<u_int32> sorted (chars);
+    std::sort (sorted.begin(), sorted.end());
+    sorted.erase (std::unique (sorted.begin(), sorted.end()), sorted.end());
+
+    std::vector<u_int32> missing;
+    for (u_int32 chr = 32; chr < 127; chr++)
+    {
+        if (!a->contains (chr)) missing.push_back (chr);
+    }
+    for (std::vector<u_int32>::const_iterator chr = sorted.begin(); chr != sorted.end(); chr++)
+    {
+        if (*chr >= 127 && !a->contains (*chr)) missing.push_back (*chr);
+    }
+
+    if (missing.empty()) return;
+
+    if (Loader == NULL) Loader = new glyph_loader ();
+    Loader->add (name, path, size, color, missing);
+}
+
+// add glyphs rendered in the background
+void font_cache::update ()
+{
+    if (Loader == NULL) return;
+
+    PROFILE_ZONE ("font_cache::update");
+
+    glyph_loader::glyph g;
+    while (Loader->get_finished (g))
+    {
+        glyph_atlas *a = find (g.Name, g.Size, g.Color);
+        if (a != NULL) a->insert (g);
+
+        free (g.Fg);
+        free (g.Bg);
+    }
+}
+
+// memory used by font
+u_int32 font_cache::memory_used (const gui::font *f) const
+{
+    glyph_atlas *a = f->Atlas ? f->Atlas : find (f->name(), f->size(), f->color());
+    return a ? a->memory_used () : 0;
+}
+
+// memory used by all fonts
+std::string font_cache::summary () const
+{
+    std::string result;
+    u_int32 total = 0;
+
+    for (std::vector<glyph_atlas*>::const_iterator i = Atlases.begin(); i != Atlases.end(); i++)
+    {
+        char line[256];
+        snprintf (line, sizeof (line), "%-24s %3dpx #%08x %5u glyphs %8.1f KB\n", (*i)->name().c_str(),
+            (*i)->size(), (*i)->color(), (*i)->num_glyphs(), (*i)->memory_used() / 1024.0);
+
+        result += line;
+        total += (*i)->memory_used();
+    }
+
+    char line[64];
+    snprintf (line, sizeof (line), "%-24s %36.1f KB\n", "total", total / 1024.0);
+    return result + line;
+}
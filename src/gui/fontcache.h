@@ -28,8 +28,24 @@
 #ifndef GUI_FONTCACHE_H
 #define GUI_FONTCACHE_H
 
-#include <adonthell/base/hash_map.h>
+#include <vector>
+
+#include <ft2build.h>
+#include FT_FREETYPE_H
+
 #include <adonthell/gfx/surface.h>
+#include "glyph_loader.h"
+
+/// width of a glyph atlas page in pixels
+#define GLYPH_ATLAS_WIDTH 512
+/// maximum height of a glyph atlas page in pixels
+#define GLYPH_ATLAS_MAX_HEIGHT 2048
+/// space around each glyph, for its shadow
+#define GLYPH_PADDING 3
+/// number of codepoints per block of the glyph table
+#define GLYPH_BLOCK_SIZE 256
+/// number of blocks covering all of unicode
+#define GLYPH_BLOCKS (0x110000 / GLYPH_BLOCK_SIZE)
 
 namespace gui
 {
@@ -38,7 +54,258 @@ class font;
 class glyph_info;
 
 /**
+ * Keeps the glyphs of one font in a certain size and color. Glyphs
+ * are rendered into a few large surfaces, along with their blurred
+ * background, so that drawing text only blits parts of the same
+ * surfaces. Glyphs are found by their codepoint in a table, without
+ * any string formatting or hashing.
  *
+ * New glyphs are collected in system memory and uploaded in one go
+ * the next time a glyph of the atlas is drawn. Printable ASCII
+ * characters are added right away, unless the atlas has been
+ * created for preloading. Preloaded glyphs are rendered by the
+ * glyph_loader and added with insert.
+ */
+class glyph_atlas
+{
+public:
+    /**
+     * Create atlas for the given font and render the
+     * printable ASCII characters.
+     * @param f the font to render glyphs with.
+     */
+    glyph_atlas (gui::font *f);
+
+    /**
+     * Create empty atlas for a font that has not been loaded yet.
+     * @param name name of the font.
+     * @param size size of the font.
+     * @param color color of the font.
+     */
+    glyph_atlas (const std::string & name, const int & size, const u_int32 & color);
+
+    /**
+     * Delete atlas and all of its glyphs.
+     */
+    ~glyph_atlas ();
+
+    /**
+     * Check whether glyphs of the given font belong into this atlas.
+     * @param f a font.
+     * @return true if font name, size and color match.
+     */
+    bool matches (const gui::font *f) const;
+
+    /**
+     * Check whether glyphs of the given font belong into this atlas.
+     * @param name name of the font.
+     * @param size size of the font.
+     * @param color color of the font.
+     * @return true if font name, size and color match.
+     */
+    bool matches (const std::string & name, const int & size, const u_int32 & color) const
+    {
+        return FontSize == size && Color == color && Name == name;
+    }
+
+    /**
+     * Check whether the given glyph has been added already.
+     * @param chr the glyph in UTF-32 format.
+     * @return true if the glyph is part of the atlas.
+     */
+    bool contains (const u_int32 & chr) const
+    {
+        glyph_info **block = chr < 0x110000 ? Table[chr / GLYPH_BLOCK_SIZE] : NULL;
+        return block && block[chr % GLYPH_BLOCK_SIZE];
+    }
+
+    /**
+     * Get given glyph, rendering it if not done before.
+     * @param chr the glyph in UTF-32 format.
+     * @param f a font matching this atlas, to render new glyphs.
+     * @return the glyph.
+     */
+    const glyph_info *get (const u_int32 & chr, gui::font *f)
+    {
+        // invalid codepoints are replaced by add
+        glyph_info **block = chr < 0x110000 ? Table[chr / GLYPH_BLOCK_SIZE] : NULL;
+        if (block && block[chr % GLYPH_BLOCK_SIZE]) return block[chr % GLYPH_BLOCK_SIZE];
+        return add (chr, f);
+    }
+
+    /**
+     * Get surface containing the foreground of glyphs,
+     * uploading new glyphs first.
+     * @param page index of the surface.
+     * @return the surface.
+     */
+    const gfx::surface *foreground (const u_int32 & page) const
+    {
+        if (Pages[page]->Modified) upload (Pages[page]);
+        return Pages[page]->Foreground;
+    }
+
+    /**
+     * Get surface containing the background of glyphs,
+     * uploading new glyphs first.
+     * @param page index of the surface.
+     * @return the surface.
+     */
+    const gfx::surface *background (const u_int32 & page) const
+    {
+        if (Pages[page]->Modified) upload (Pages[page]);
+        return Pages[page]->Background;
+    }
+
+    /**
+     * Add a glyph rendered by the glyph_loader, unless the
+     * atlas contains it already.
+     * @param g the rendered glyph.
+     */
+    void insert (const glyph_loader::glyph & g);
+
+    /**
+     * @name Statistics
+     */
+    //@{
+    /**
+     * Get the font name of the atlas.
+     * @return name of the font.
+     */
+    const std::string & name () const { return Name; }
+
+    /**
+     * Get the font size of the atlas.
+     * @return size of the font.
+     */
+    int size () const { return FontSize; }
+
+    /**
+     * Get the font color of the atlas.
+     * @return color of the font.
+     */
+    u_int32 color () const { return Color; }
+
+    /**
+     * Get the number of glyphs in the atlas.
+     * @return number of glyphs.
+     */
+    u_int32 num_glyphs () const { return Glyphs; }
+
+    /**
+     * Get the memory used by the atlas, including pixels kept
+     * in system memory and the surfaces they are uploaded to.
+     * @return size of the atlas in bytes.
+     */
+    u_int32 memory_used () const;
+    //@}
+
+    /**
+     * Get the color of the blurred background for text
+     * in the given color.
+     * @param color the text color.
+     * @return the background color.
+     */
+    static u_int32 shadow_color (const u_int32 & color);
+
+    /**
+     * Copy a rendered glyph into RGBA foreground and background pixels.
+     * @param bitmap coverage of the glyph, as rendered by freetype.
+     * @param fg color of the foreground.
+     * @param bg color of the background.
+     * @param fp the first foreground pixel to write.
+     * @param fg_stride length of a row of foreground pixels.
+     * @param bp the first background pixel to write.
+     * @param bg_stride length of a row of background pixels.
+     */
+    static void copy_coverage (const FT_Bitmap & bitmap, const u_int32 & fg, const u_int32 & bg,
+        u_int8 *fp, const u_int32 & fg_stride, u_int8 *bp, const u_int32 & bg_stride);
+
+private:
+    /// forbid copy construction
+    glyph_atlas (const glyph_atlas & a);
+
+    /**
+     * Glyphs sharing the same pair of surfaces.
+     */
+    struct page
+    {
+        /// foreground of the glyphs
+        gfx::surface *Foreground;
+        /// background of the glyphs
+        gfx::surface *Background;
+        /// RGBA pixels of the foreground
+        u_int8 *Fg;
+        /// RGBA pixels of the background, not yet blurred
+        u_int8 *Bg;
+        /// number of rows allocated
+        u_int16 Height;
+        /// position of the next glyph
+        u_int16 PenX, PenY;
+        /// height of the current row of glyphs
+        u_int16 ShelfHeight;
+        /// whether the surfaces have been created
+        bool Uploaded;
+        /// whether pixels changed since the last upload
+        bool Modified;
+        /// whether the page contains glyphs blurred by the glyph_loader
+        bool Prerendered;
+        /// first row changed since the last upload
+        u_int16 DirtyTop;
+        /// row after the last one changed since the last upload
+        u_int16 DirtyBottom;
+        /// glyphs whose background has not been blurred yet
+        std::vector<glyph_info*> Fresh;
+    };
+
+    /**
+     * Get the entry of the glyph table for the given glyph,
+     * allocating its block if required.
+     * @param chr the glyph in UTF-32 format.
+     * @return reference to the table entry.
+     */
+    glyph_info *& slot (const u_int32 & chr);
+
+    /**
+     * Render a glyph and place it on a page.
+     * @param chr the glyph in UTF-32 format.
+     * @param f the font to render it with.
+     * @return the new glyph.
+     */
+    const glyph_info *add (const u_int32 & chr, gui::font *f);
+
+    /**
+     * Find room for a glyph of the given size.
+     * @param gi glyph to place, receiving its position.
+     * @return the page the glyph was placed on.
+     */
+    page *place (glyph_info *gi);
+
+    /**
+     * Blur new backgrounds and update the surfaces of a page.
+     * @param p the page to upload.
+     */
+    void upload (page *p) const;
+
+    /// name of the font
+    std::string Name;
+    /// size of the font
+    int FontSize;
+    /// color of the font
+    u_int32 Color;
+    /// color of the glyph backgrounds
+    u_int32 Shadow;
+    /// glyphs by codepoint, in blocks allocated on demand
+    glyph_info **Table[GLYPH_BLOCKS];
+    /// number of glyphs in the table
+    u_int32 Glyphs;
+    /// the surfaces holding the glyphs
+    std::vector<page*> Pages;
+};
+
+/**
+ * Keeps a glyph atlas for each combination of font,
+ * size and color in use.
  */
 class font_cache
 {
@@ -58,9 +325,69 @@ public:
      */
     const glyph_info* get (const u_int32 & glyph, gui::font *f);
 
+    /**
+     * Get the atlas for the given font, creating it if required.
+     * @param f a font.
+     * @return the atlas for that font.
+     */
+    glyph_atlas *atlas (gui::font *f);
+
+    /**
+     * @name Preloading
+     */
+    //@{
+    /**
+     * Render the given glyphs of a font in the background, so that
+     * they are ready by the time they are first displayed. Glyphs
+     * requested before that are rendered on demand, as usual.
+     * The printable ASCII characters are always included.
+     * @param name name of the font, as passed to gui::font.
+     * @param size size of the font.
+     * @param color color of the font.
+     * @param chars the glyphs to render in UTF-32 format.
+     */
+    void preload (const std::string & name, const int & size, const u_int32 & color, const std::vector<u_int32> & chars);
+
+    /**
+     * Add glyphs rendered in the background to their atlas.
+     * Has to be called regularly from the main thread.
+     */
+    void update ();
+    //@}
+
+    /**
+     * @name Statistics
+     */
+    //@{
+    /**
+     * Get the memory used by the glyphs of the given font.
+     * @param f a font.
+     * @return size of the font's glyphs in bytes.
+     */
+    u_int32 memory_used (const gui::font *f) const;
+
+    /**
+     * Get the number of glyphs and the memory used by
+     * each font, one font per line.
+     * @return the statistics in human readable form.
+     */
+    std::string summary () const;
+    //@}
+
 private:
-    /// the font cache
-    std::hash_map<std::string, glyph_info*> Cache;
+    /**
+     * Find the atlas for the given font.
+     * @param name name of the font.
+     * @param size size of the font.
+     * @param color color of the font.
+     * @return the atlas, or NULL if it does not exist.
+     */
+    glyph_atlas *find (const std::string & name, const int & size, const u_int32 & color) const;
+
+    /// the atlases of all fonts
+    std::vector<glyph_atlas*> Atlases;
+    /// renders glyphs in the background, once required
+    glyph_loader *Loader;
 };
 
 /**
@@ -0,0 +1,219 @@
+/*
+ Copyright (C) 2011 Kai Sterker <kai.sterker@gmail.com>
+ Part of the Adonthell Project http://adonthell.linuxgames.com
+
+ Adonthell is free software; you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation; either version 2 of the License, or
+ (at your option) any later version.
+
+ Adonthell is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with Adonthell; if not, write to the Free Software
+ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+/**
+ * @file   gui/glyph_loader.cc
+ * @author Kai Sterker <kai.sterker@gmail.com>
+ *
+ * @brief  Defines the glyph_loader class.
+ *
+ *
+ */
+
+#include <cstdlib>
+#include <cstring>
+
+#include <adonthell/base/logging.h>
+#include <adonthell/base/profiler.h>
+#include <adonthell/gfx/pixel_ops.h>
+#include "glyph_loader.h"
+#include "fontcache.h"
+
+namespace gui
+{
+    // ctor
+    glyph_loader::glyph_loader () : Stop (false), Busy (0)
+    {
+        Thread = new std::thread (&glyph_loader::run, this);
+    }
+
+    // dtor
+    glyph_loader::~glyph_loader ()
+    {
+        {
+            std::lock_guard<std::mutex> guard (Lock);
+            Stop = true;
+        }
+
+        Wakeup.notify_one ();
+        Thread->join ();
+        delete Thread;
+
+        for (std::list<glyph>::iterator i = Finished.begin (); i != Finished.end (); i++)
+        {
+            free (i->Fg);
+            free (i->Bg);
+        }
+    }
+
+    // queue glyphs for rendering
+    void glyph_loader::add (const std::string & name, const std::string & path, const int & size, const u_int32 & color, const std::vector<u_int32> & chars)
+    {
+        job j;
+        j.Name = name;
+        j.Path = path;
+        j.Size = size;
+        j.Color = color;
+        j.Chars = chars;
+
+        {
+            std::lock_guard<std::mutex> guard (Lock);
+            Queue.push_back (j);
+        }
+
+        Wakeup.notify_one ();
+    }
+
+    // retrieve rendered glyph
+    bool glyph_loader::get_finished (glyph & result)
+    {
+        std::lock_guard<std::mutex> guard (Lock);
+        if (Finished.empty ()) return false;
+
+        result = Finished.front ();
+        Finished.pop_front ();
+        return true;
+    }
+
+    // number of outstanding glyphs
+    u_int32 glyph_loader::pending ()
+    {
+        std::lock_guard<std::mutex> guard (Lock);
+
+        u_int32 count = Finished.size () + Busy;
+        for (std::list<job>::const_iterator i = Queue.begin (); i != Queue.end (); i++)
+        {
+            count += i->Chars.size ();
+        }
+
+        return count;
+    }
+
+    // worker thread
+    void glyph_loader::run ()
+    {
+        // freetype libraries must not be shared between threads
+        FT_Library library;
+        if (FT_Init_FreeType (&library))
+        {
+            LOG(ERROR) << "*** glyph_loader::run: unable to initialize the freetype library";
+            library = NULL;
+        }
+
+        std::unique_lock<std::mutex> guard (Lock);
+        while (true)
+        {
+            while (!Stop && Queue.empty ())
+            {
+                Wakeup.wait (guard);
+            }
+
+            if (Stop) break;
+
+            job j = Queue.front ();
+            Queue.pop_front ();
+            Busy = j.Chars.size ();
+
+            // render without holding the lock
+            guard.unlock ();
+            if (library) render (j, library);
+            guard.lock ();
+
+            Busy = 0;
+        }
+
+        guard.unlock ();
+        if (library) FT_Done_FreeType (library);
+    }
+
+    // render glyphs of a font
+    void glyph_loader::render (const job & j, FT_Library library)
+    {
+        PROFILE_ZONE ("glyph_loader::render");
+
+        FT_Face face;
+        if (FT_New_Face (library, j.Path.c_str (), 0, &face))
+        {
+            LOG(ERROR) << "*** glyph_loader::render: unable to load font '" << j.Path << "'";
+            return;
+        }
+
+        if (FT_Set_Pixel_Sizes (face, 0, j.Size))
+        {
+            LOG(ERROR) << "*** glyph_loader::render: unable to set size " << j.Size << " of font '" << j.Path << "'";
+            FT_Done_Face (face);
+            return;
+        }
+
+        // make sure font is rendered on its proper base line
+        int drop = (face->size->metrics.height >> 6) - j.Size;
+        u_int32 shadow = glyph_atlas::shadow_color (j.Color);
+
+        for (std::vector<u_int32>::const_iterator chr = j.Chars.begin (); chr != j.Chars.end (); chr++)
+        {
+            if (FT_Load_Char (face, *chr, FT_LOAD_RENDER))
+            {
+                // glyph will never arrive, so it is no longer pending
+                std::lock_guard<std::mutex> guard (Lock);
+                if (Busy) Busy--;
+                if (Stop) break;
+                continue;
+            }
+            FT_GlyphSlot slot = face->glyph;
+
+            glyph g;
+            g.Name = j.Name;
+            g.Size = j.Size;
+            g.Color = j.Color;
+            g.Chr = *chr;
+            g.length = slot->advance.x >> 6;
+            g.height = slot->advance.y >> 6;
+            g.x = slot->bitmap_left;
+            g.y = -slot->bitmap_top - drop;
+            g.w = slot->bitmap.width;
+            g.h = slot->bitmap.rows;
+            g.Fg = NULL;
+            g.Bg = NULL;
+
+            u_int32 bw = g.w + 2 * GLYPH_PADDING;
+            u_int32 bh = g.h + 2 * GLYPH_PADDING;
+
+            if (g.w != 0 && g.h != 0 && bw <= GLYPH_ATLAS_WIDTH && bh <= GLYPH_ATLAS_MAX_HEIGHT)
+            {
+                g.Fg = (u_int8*) calloc (g.w * g.h, 4);
+                g.Bg = (u_int8*) calloc (bw * bh, 4);
+
+                glyph_atlas::copy_coverage (slot->bitmap, j.Color, shadow, g.Fg, g.w,
+                    g.Bg + (GLYPH_PADDING * bw + GLYPH_PADDING) * 4, bw);
+
+                // the expensive part the main thread no longer has to do
+                gfx::pixel_ops::blur (g.Bg, bw, bh, true);
+            }
+
+            std::lock_guard<std::mutex> guard (Lock);
+            Finished.push_back (g);
+            if (Busy) Busy--;
+
+            // no need to finish when shutting down
+            if (Stop) break;
+        }
+
+        FT_Done_Face (face);
+    }
+}
@@ -0,0 +1,174 @@
+/*
+ Copyright (C) 2011 Kai Sterker <kai.sterker@gmail.com>
+ Part of the Adonthell Project http://adonthell.linuxgames.com
+
+ Adonthell is free software; you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation; either version 2 of the License, or
+ (at your option) any later version.
+
+ Adonthell is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with Adonthell; if not, write to the Free Software
+ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+/**
+ * @file   gui/glyph_loader.h
+ * @author Kai Sterker <kai.sterker@gmail.com>
+ *
+ * @brief  Declares the glyph_loader class.
+ *
+ *
+ */
+
+#ifndef GUI_GLYPH_LOADER_H
+#define GUI_GLYPH_LOADER_H
+
+#include <list>
+#include <string>
+#include <vector>
+#include <mutex>
+#include <thread>
+#include <condition_variable>
+
+#include <ft2build.h>
+#include FT_FREETYPE_H
+
+#include <adonthell/base/types.h>
+
+namespace gui
+{
+    /**
+     * Renders glyphs on a background thread, before they are first
+     * displayed. The loader opens fonts with a freetype library of
+     * its own and renders into plain memory, including the blurred
+     * background, so that it does not share any state with the game.
+     * Adding the glyphs to their atlas has to happen on the main
+     * thread, see font_cache::update.
+     *
+     * Fonts are rendered in the order they have been requested.
+     */
+    class glyph_loader
+    {
+    public:
+        /**
+         * A rendered glyph.
+         */
+        struct glyph
+        {
+            /// name of the font
+            std::string Name;
+            /// size of the font
+            int Size;
+            /// color of the font
+            u_int32 Color;
+            /// the glyph in UTF-32 format
+            u_int32 Chr;
+            /// start position of the glyph
+            s_int32 x;
+            /// start position of the glyph
+            s_int32 y;
+            /// size of the actual glyph
+            u_int32 length;
+            /// size of the actual glyph
+            u_int32 height;
+            /// size of the glyph bitmap
+            u_int16 w;
+            /// size of the glyph bitmap
+            u_int16 h;
+            /// RGBA foreground, w by h pixels, allocated with malloc
+            u_int8 *Fg;
+            /// blurred RGBA background, including padding, allocated with malloc
+            u_int8 *Bg;
+        };
+
+        /**
+         * Create loader and start its worker thread.
+         */
+        glyph_loader ();
+
+        /**
+         * Stop worker thread and discard pending glyphs.
+         */
+        ~glyph_loader ();
+
+        /**
+         * Request rendering of glyphs.
+         * @param name name of the font, as used by gui::font.
+         * @param path full path of the font file.
+         * @param size size of the font.
+         * @param color color of the font.
+         * @param chars the glyphs to render in UTF-32 format.
+         */
+        void add (const std::string & name, const std::string & path, const int & size, const u_int32 & color, const std::vector<u_int32> & chars);
+
+        /**
+         * Get the next rendered glyph, if any. The caller takes
+         * ownership of the glyph's pixels.
+         * @param result will receive the rendered glyph.
+         * @return \b true if a glyph has been returned, \b false otherwise.
+         */
+        bool get_finished (glyph & result);
+
+        /**
+         * Get number of glyphs not yet retrieved with get_finished.
+         * @return number of outstanding glyphs.
+         */
+        u_int32 pending ();
+
+    private:
+        /// forbid copy construction
+        glyph_loader (const glyph_loader & l);
+
+        /**
+         * Glyphs of a font to render.
+         */
+        struct job
+        {
+            /// name of the font
+            std::string Name;
+            /// full path of the font file
+            std::string Path;
+            /// size of the font
+            int Size;
+            /// color of the font
+            u_int32 Color;
+            /// the glyphs to render
+            std::vector<u_int32> Chars;
+        };
+
+        /**
+         * Render requested glyphs until the loader is destroyed.
+         */
+        void run ();
+
+        /**
+         * Render the glyphs of a single request.
+         * @param j the request.
+         * @param library the freetype library of the worker thread.
+         */
+        void render (const job & j, FT_Library library);
+
+        /// fonts waiting to be rendered
+        std::list<job> Queue;
+        /// glyphs rendered, but not yet retrieved
+        std::list<glyph> Finished;
+        /// protects the queues
+        std::mutex Lock;
+        /// signals new requests to the worker
+        std::condition_variable Wakeup;
+        /// whether the worker thread should terminate
+        bool Stop;
+        /// number of glyphs currently rendered
+        u_int32 Busy;
+        /// the thread rendering glyphs
+        std::thread *Thread;
+    };
+}
+
+#endif
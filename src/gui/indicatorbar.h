@@ -139,7 +139,11 @@ public:
 	 * is VERTICAL.
 	 * @param o the new orientation.
 	 */
-	void set_orientation (const orientation & o) { Orientation = o; }
+	void set_orientation (const orientation & o)
+	{
+		if (Orientation != o) invalidate ();
+		Orientation = o;
+	}
 
 	/**
 	 * Value range.
@@ -149,13 +153,21 @@ public:
 	 * Set the absolute minimum value of the indicator.
 	 * @param min the minimum value.
 	 */
-	void set_min (const u_int32 & min) { Min = min; }
+	void set_min (const u_int32 & min)
+	{
+		if (Min != min) invalidate ();
+		Min = min;
+	}
 
 	/**
 	 * Set the absolute maximum value of the indicator.
 	 * @param max the maximum value.
 	 */
-	void set_max (const u_int32 & max) { Max = max; }
+	void set_max (const u_int32 & max)
+	{
+		if (Max != max) invalidate ();
+		Max = max;
+	}
 	//@}
 
 	/**
@@ -170,11 +182,16 @@ public:
 	 */
 	void set_values (const u_int32 & lower, const u_int32 & upper)
 	{
+		u_int32 old_lower = Lower, old_upper = Upper;
+
 		if (lower < Min) Lower = Min;
 		else Lower = lower;
 
 		if (upper > Max) Upper = Max;
 		else Upper = upper;
+
+		// the scrollview sets its bars on every draw, so only report actual changes
+		if (Lower != old_lower || Upper != old_upper) invalidate ();
 	}
 
 	/**
@@ -184,9 +201,13 @@ public:
 	 */
 	void set_lower_val (const u_int32 & lower)
 	{
+		u_int32 old_lower = Lower;
+
 		if (lower < Min) Lower = Min;
 		else if (lower > Upper) Lower = Upper;
 		else Lower = lower;
+
+		if (Lower != old_lower) invalidate ();
 	}
 
 	/**
@@ -196,9 +217,13 @@ public:
 	 */
 	void set_upper_val (const u_int32 & upper)
 	{
+		u_int32 old_upper = Upper;
+
 		if (upper < Lower) Upper = Lower;
 		else if (upper > Max) Upper = Max;
 		else Upper = upper;
+
+		if (Upper != old_upper) invalidate ();
 	}
 	//@}
 
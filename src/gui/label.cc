@@ -45,75 +45,49 @@ namespace gui
         s_int16 rx = x;
         s_int16 ry = y + Font->size();
 
-        // compute where to render it
-        if (multiline())
-        {
-            // find the needed size of the line of text
-            u_int16 tw, th;
-            std::vector<gui::textsize> ts;
-            Font->get_text_size(Text, length(), ts, tw, th);
-
-            // if required, center text vertically
-            if (center_y())
-            {
-                ry += (height() - th)/2;
-            }
-
-            int p = 0;
+        // the text is only measured again after it changed
+        const text_layout & tl = layout();
 
-            for (size_t i = 0; i < ts.size(); i++)
-            {
-                // if required, center text horizontally
-                if (center_x())
-                {
-                    // center each line of multiline text
-                    rx = x + (length() - ts[i].w)/2;
-                }
-
-                Font->draw_shadow(Text.substr(p, ts[i].cpos-p), rx, ry, da, target);
-                Font->draw_text(Text.substr(p, ts[i].cpos-p), rx, ry, da, target);
-
-                ry += ts[i].h;
-                p = ts[i].cpos + 1;
-            }
-        }
-        else
+        // if required, center text vertically
+        if (center_y())
         {
-            // find the needed size of the line of text
-            u_int32 nw, nh;
-            Font->get_text_size(Text, nw, nh);
+            ry += (height() - tl.height())/2;
+        }
 
+        for (u_int32 i = 0; i < tl.num_lines(); i++)
+        {
             // if required, center text horizontally
-            if (/*!ScrollOffset &&*/ center_x())
+            if (center_x())
             {
-                // if a manual offset has been set, centering doesn't matter
-                rx = x + (length() - nw)/2;
+                // center each line of multiline text
+                rx = x + (length() - tl.line_width(i))/2;
             }
-            // else
-            // {
-            //     rx = -ScrollOffset;
-            // }
 
-            // if required, center text vertically
-            if (center_y())
-            {
-                ry += (height() - nh)/2;
-            }
+            Font->draw_shadow(tl, i, rx, ry, da, target);
+            Font->draw_text(tl, i, rx, ry, da, target);
 
-            Font->draw_shadow(Text, rx, ry, da, target);
-            Font->draw_text(Text, rx, ry, da, target);
+            ry += Font->size();
         }
     }
 
+    // get text layout, updating it if required
+    const text_layout & label::layout () const
+    {
+        u_int16 width = multiline() ? length() : 0;
+        if (!Layout.matches(Font, width))
+        {
+            Font->layout(Text, width, Layout);
+        }
+
+        return Layout;
+    }
+
 	// change the height of the object based on the text
 	void label::reheight()
 	{
 		if (AutoHeight)
 		{
-			std::vector<textsize> ts;
-			u_int16 newwidth = 0, newheight = 0;
-			Font->get_text_size (Text, length(), ts, newwidth, newheight);
-			set_size (length(), newheight);
+			set_size (length(), layout().height());
 		}
 	}
 }
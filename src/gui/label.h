@@ -85,8 +85,10 @@ namespace gui
 		void set_string (const std::string & s)
         { 
             Text = s;
+            Layout.invalidate();
 
             reheight();
+            invalidate();
         }
         
 		/**
@@ -128,6 +130,7 @@ namespace gui
         {
             CenterX = cx;
             CenterY = cy; 
+            invalidate();
         }
         
         /**
@@ -155,7 +158,9 @@ namespace gui
 			else AutoHeight = false;
 
 			// update label size
+			Layout.invalidate();
 			reheight();
+			invalidate();
 		}
         
         /**
@@ -168,7 +173,11 @@ namespace gui
 		 * Set the current text color.
 		 * @param c the text color.
 		 */
-		void set_color(const u_int32 & c) { Font->set_color(c); }
+		void set_color(const u_int32 & c)
+		{
+		    Font->set_color(c);
+		    invalidate();
+		}
 
 		/**
 		 * Get the current text color.
@@ -192,13 +201,24 @@ namespace gui
 		/**
 		 *
 		 */
-	    void set_offset (const u_int32 & x, const u_int32 & y) { Ox = x; Oy = y; }
+	    void set_offset (const u_int32 & x, const u_int32 & y)
+	    {
+	        if (Ox != x || Oy != y) invalidate();
+	        Ox = x; Oy = y;
+	    }
 
 	    /**
 	     *
 	     */
 	    void draw_text (const s_int16 & x, const s_int16 & y, const gfx::drawing_area *da, gfx::surface *target) const;
 
+	    /**
+	     * Get the layout of the label text, updating it if the text,
+	     * font or label size have changed since it was last used.
+	     * @return the layout of the text.
+	     */
+	    const text_layout & layout () const;
+
         /// whether to center the text horizontally
         bool CenterX;
         /// whether to center the text vertically
@@ -211,6 +231,8 @@ namespace gui
         std::string Text;
         /// the font
 		font *Font;
+        /// the text as laid out for drawing
+        mutable text_layout Layout;
 	    /// text draw offset x
 	    u_int32 Ox;
 	    /// text draw offset y
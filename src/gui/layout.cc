@@ -23,10 +23,13 @@
  * @brief  Implements the layout class.
  */
 
+#include <cstdlib>
+
 #include "layout.h"
 #include "ui_event.h"
 #include <adonthell/event/manager.h>
 #include <adonthell/base/logging.h>
+#include <adonthell/gfx/pixel_ops.h>
 
 using gui::layout;
 
@@ -93,6 +96,54 @@ void layout::draw(const s_int16 & x, const s_int16 & y, const gfx::drawing_area
 {
     if (!Visible) return;
 
+    vector_layoutchild::const_iterator i;
+    u_int32 c = 0;
+
+    // indicate selection of widget, if it wants us to. 
+    for (i = Children.begin(); i != Children.end(); ++i, c++)
+    {
+        (*i).Child->enable_focus (c == Selected && Focused);
+    }
+
+    if (Cached)
+    {
+        if (Layer == NULL)
+        {
+            Layer = gfx::create_surface ();
+            Layer->set_alpha (255, true);
+        }
+
+        // only render content again after it changed
+        if (!LayerValid || Layer->length() != length() || Layer->height() != height())
+        {
+            Layer->resize (length(), height());
+            Layer->fillrect (0, 0, length(), height(), Layer->map_color (0, 0, 0, 0));
+
+            draw_content (0, 0, NULL, Layer);
+
+            // blending onto a transparent layer multiplies colors by their
+            // alpha, which drawing the layer would apply a second time
+            u_int8 *data = Layer->get_rgba ();
+            gfx::pixel_ops::unpremultiply (data, Layer->length() * Layer->height());
+            Layer->put_rgba (data);
+            free (data);
+
+            LayerValid = true;
+        }
+
+        Layer->draw (x, y, da, target);
+    }
+    else
+    {
+        draw_content (x, y, da, target);
+    }
+
+    drawn_at (x, y, target);
+}
+
+// render the layout
+void layout::draw_content (const s_int16 & x, const s_int16 & y, const gfx::drawing_area * da, gfx::surface * target) const
+{
     // draw background
     Look->draw (x, y, da, target, decoration::BACKGROUND);
     
@@ -101,16 +152,25 @@ void layout::draw(const s_int16 & x, const s_int16 & y, const gfx::drawing_area
     client_area.shrink (Look->border ());
     client_area.assign_drawing_area (da);
     
+    // the part of the client area that is actually drawn
+    const gfx::drawing_area visible = client_area.setup_rects ();
+
     vector_layoutchild::const_iterator i;
-    u_int32 c = 0;
     
-    for (i = Children.begin(); i != Children.end(); ++i, c++)
+    for (i = Children.begin(); i != Children.end(); ++i)
     {
-        // indicate selection of widget, if it wants us to. 
-        (*i).Child->enable_focus (c == Selected && Focused);
-        
+        s_int16 cx = (*i).Pos.x() + x;
+        s_int16 cy = (*i).Pos.y() + y;
+
+        // skip widgets that are clipped away entirely
+        if (cx >= visible.x() + visible.length() || cx + (*i).Child->length() <= visible.x() ||
+            cy >= visible.y() + visible.height() || cy + (*i).Child->height() <= visible.y())
+        {
+            continue;
+        }
+
         // draw widget at its position
-        (*i).Child->draw((*i).Pos.x() + x, (*i).Pos.y() + y, &client_area, target);
+        (*i).Child->draw(cx, cy, &client_area, target);
     }
 
     // draw border
@@ -225,6 +285,8 @@ void layout::add_child(gui::widget & c, const s_int16 & x, const s_int16 & y)
 
     // add new child
     Children.push_back(layoutchild(&c, a));
+    c.Parent = this;
+    invalidate ();
 }
 
 void layout::remove_child(gui::widget & c)
@@ -235,6 +297,8 @@ void layout::remove_child(gui::widget & c)
         if (&c == (*i).Child)
         {
             Children.erase(i);
+            c.Parent = NULL;
+            invalidate ();
 
             // we are guaranteed that i != Children.end() here, so
             // safe to cast the math
@@ -252,6 +316,49 @@ void layout::remove_child(gui::widget & c)
     }
 }
 
+// drop child being deleted
+void layout::forget_child (const gui::widget *c)
+{
+    for (vector<layoutchild>::iterator i = Children.begin(); i != Children.end(); i++)
+    {
+        if (c == i->Child)
+        {
+            u_int32 index = i - Children.begin();
+            Children.erase (i);
+
+            // keep selection within bounds
+            if (Selected > index || Selected >= Children.size())
+            {
+                Selected = Selected ? Selected - 1 : 0;
+            }
+
+            LayerValid = false;
+            widget::invalidate ();
+            break;
+        }
+    }
+}
+
+// keep content in an offscreen layer
+void layout::set_cached (const bool & cached)
+{
+    Cached = cached;
+    LayerValid = false;
+
+    if (!Cached)
+    {
+        delete Layer;
+        Layer = NULL;
+    }
+}
+
+// report change of appearance
+void layout::invalidate () const
+{
+    LayerValid = false;
+    widget::invalidate ();
+}
+
 // get location of child
 const gfx::drawing_area& layout::get_location (const gui::widget & c) const
 {
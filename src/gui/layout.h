@@ -78,7 +78,8 @@ namespace gui
          * @param l layout length
          * @param h layout height
          */
-		layout(const u_int16 & l, const u_int16 & h) : widget(l, h), Selected(0), Focused(false)
+		layout(const u_int16 & l, const u_int16 & h) : widget(l, h), Selected(0), Focused(false),
+		    Cached(false), LayerValid(false), Layer(NULL)
         {
             Selhilite = false;
             Listener = NULL;
@@ -91,7 +92,8 @@ namespace gui
          * @param style filename of widget decoration.
          */
 		layout (const std::string & style)
-		: widget(style), Selected(0), Focused(false)
+		: widget(style), Selected(0), Focused(false),
+		  Cached(false), LayerValid(false), Layer(NULL)
 		{
             Selhilite = false;
             Listener = NULL;
@@ -103,7 +105,14 @@ namespace gui
 		 */
         virtual ~layout()
         {
+            // children may outlive their layout
+            for (std::vector<layoutchild>::iterator i = Children.begin(); i != Children.end(); i++)
+            {
+                i->Child->Parent = NULL;
+            }
+
             delete Listener;
+            delete Layer;
         }
         
         /**
@@ -157,6 +166,33 @@ namespace gui
          * draw on the screen.
          */
         virtual void draw(const s_int16 & x, const s_int16 & y, const gfx::drawing_area * da = NULL, gfx::surface * target = NULL) const;
+
+        /**
+         * @name Cached drawing
+         */
+        //@{
+        /**
+         * Set whether the layout keeps its content in an offscreen
+         * layer. The layer is only drawn again after the layout or
+         * one of its children has been invalidated, so that drawing
+         * the layout otherwise takes a single blit. Only suitable for
+         * layouts whose children report every change of appearance.
+         * @param cached true to keep content in a layer.
+         */
+        void set_cached (const bool & cached);
+
+        /**
+         * Check whether the layout keeps its content in a layer.
+         * @return true if this is the case, false otherwise.
+         */
+        bool cached () const { return Cached; }
+
+        /**
+         * Report that the appearance of the layout or one of
+         * its children has changed, so that it gets drawn again.
+         */
+        virtual void invalidate () const;
+        //@}
 		
         /**
          * @name Input focus handling
@@ -291,6 +327,17 @@ namespace gui
 //		virtual bool mousedown(SDL_MouseButtonEvent & m);
 //		virtual bool mousemove(SDL_MouseMotionEvent & m) { return false; }
         
+        /**
+         * Drop a child that is being deleted. Unlike remove_child, this
+         * neither resizes the layout nor moves the focus, as both might
+         * involve the child or the layout itself being destroyed.
+         * @param c the child being deleted.
+         */
+        void forget_child (const gui::widget *c);
+
+        /// allow children to forget about their layout
+        friend class gui::widget;
+
         /// widgets kept in the container
         std::vector<layoutchild> Children;
 		/// child which currently is selected
@@ -301,6 +348,21 @@ namespace gui
         input::listener *Listener;
         /// whether to resize the layout when children are added
         resize_mode ResizeMode;
+        /// whether to keep content in an offscreen layer
+        bool Cached;
+        /// whether the layer is up to date
+        mutable bool LayerValid;
+        /// content of the layout, if cached
+        mutable gfx::surface *Layer;
+
+        /**
+         * Draw background, children and border of the layout.
+         * @param x X position where to draw.
+         * @param y Y position where to draw.
+         * @param da optional drawing_area to use during the drawing operation.
+         * @param target pointer to the surface where to draw.
+         */
+        void draw_content (const s_int16 & x, const s_int16 & y, const gfx::drawing_area * da, gfx::surface * target) const;
 
 		/**
          * Called when the user pressed the move right key.
@@ -0,0 +1,367 @@
+/*
+ Copyright (C) 2011 Kai Sterker <kai.sterker@gmail.com>
+ Part of the Adonthell Project http://adonthell.linuxgames.com
+
+ Adonthell is free software; you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation; either version 2 of the License, or
+ (at your option) any later version.
+
+ Adonthell is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with Adonthell; if not, write to the Free Software
+ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+*/
+
+/**
+ * @file   gui/listview.cc
+ * @author Kai Sterker <kai.sterker@gmail.com>
+ * @brief  Implements the list_view and list_source classes.
+ */
+
+#include <algorithm>
+
+#include <adonthell/event/manager.h>
+#include <adonthell/python/python.h>
+#include "listview.h"
+#include "ui_event.h"
+
+using gui::list_view;
+using gui::list_source_python;
+
+// distance between two list elements
+#define SPACING 2
+
+// wrap python object
+list_source_python::list_source_python (PyObject *source) : Source (source)
+{
+    Py_XINCREF (Source);
+}
+
+// release python object
+list_source_python::~list_source_python ()
+{
+    python::gil_lock lock;
+    Py_XDECREF (Source);
+}
+
+// number of items
+u_int32 list_source_python::size ()
+{
+    python::gil_lock lock;
+
+    PyObject *result = PyObject_CallMethod (Source, (char *) "size", NULL);
+    python::show_traceback ();
+
+    long size = 0;
+    if (result)
+    {
+        size = PyInt_AsLong (result);
+        Py_DECREF (result);
+
+        // not an integer
+        if (PyErr_Occurred ())
+        {
+            python::show_traceback ();
+            size = 0;
+        }
+    }
+
+    return size > 0 ? (u_int32) size : 0;
+}
+
+// create a row
+gui::widget *list_source_python::create_row ()
+{
+    python::gil_lock lock;
+
+    PyObject *result = PyObject_CallMethod (Source, (char *) "create_row", NULL);
+    python::show_traceback ();
+
+    gui::widget *row = NULL;
+    if (result)
+    {
+        row = python::retrieve_instance<gui::widget*, gui::widget> (result);
+
+        // the list view owns the row from now on
+        if (row) python::set_ownership (result, python::c_owns);
+        Py_DECREF (result);
+    }
+
+    return row;
+}
+
+// display item in row
+void list_source_python::bind_row (gui::widget & row, const u_int32 & index)
+{
+    python::gil_lock lock;
+
+    PyObject *args = PyTuple_New (2);
+    PyTuple_SET_ITEM (args, 0, python::pass_instance (&row));
+    PyTuple_SET_ITEM (args, 1, PyInt_FromLong (index));
+
+    PyObject *method = PyObject_GetAttrString (Source, (char *) "bind_row");
+    PyObject *result = method ? PyObject_Call (method, args, NULL) : NULL;
+    python::show_traceback ();
+
+    Py_XDECREF (result);
+    Py_XDECREF (method);
+    Py_DECREF (args);
+}
+
+// cleanup
+list_view::~list_view ()
+{
+    // rows must not remove themselves while we iterate over them
+    for (std::vector<layoutchild>::iterator i = Children.begin(); i != Children.end(); i++)
+    {
+        i->Child->Parent = NULL;
+        delete i->Child;
+    }
+    Children.clear ();
+
+    for (std::vector<gui::widget*>::iterator i = Pool.begin(); i != Pool.end(); i++)
+    {
+        delete *i;
+    }
+
+    delete Source;
+}
+
+// set new item source
+void list_view::set_source (list_source *source)
+{
+    // rows of the old source might not fit the new one
+    Size = 0;
+    update_rows (true);
+    for (std::vector<gui::widget*>::iterator i = Pool.begin(); i != Pool.end(); i++)
+    {
+        delete *i;
+    }
+    Pool.clear ();
+
+    delete Source;
+    Source = source;
+
+    RowHeight = 0;
+    First = 0;
+    Current = 0;
+
+    refresh ();
+}
+
+// items changed
+void list_view::refresh ()
+{
+    Size = Source ? Source->size () : 0;
+
+    // keep selection and view within the list
+    if (Current >= Size) Current = Size ? Size - 1 : 0;
+    if (First + rows_in_view () > Size) First = Size > rows_in_view () ? Size - rows_in_view () : 0;
+
+    update_rows (true);
+
+    if (Focused && !Children.empty())
+    {
+        Children[Selected].Child->focus ();
+    }
+}
+
+// select item
+void list_view::select_item (const u_int32 & index)
+{
+    if (index >= Size || index == Current) return;
+
+    if (Focused && Current >= First && Current - First < Children.size())
+    {
+        Children[Current - First].Child->unfocus ();
+    }
+
+    Current = index;
+    show_item (Current);
+
+    if (Focused && !Children.empty())
+    {
+        Children[Selected].Child->focus ();
+    }
+
+    gui::ui_event evt (this, "layout_switch");
+    events::manager::raise_event (&evt);
+}
+
+// scroll item into view
+void list_view::show_item (const u_int32 & index)
+{
+    if (index < First)
+    {
+        First = index;
+    }
+    else if (index >= First + rows_in_view ())
+    {
+        First = index - rows_in_view () + 1;
+    }
+
+    update_rows (false);
+}
+
+// receive focus
+bool list_view::focus ()
+{
+    if (!layout::focus ()) return false;
+
+    Current = First + Selected;
+    return true;
+}
+
+// handle paging
+bool list_view::keydown (input::keyboard_event & k)
+{
+    if (layout::keydown (k)) return true;
+    if (!Visible || Size == 0) return false;
+
+    u_int32 page = rows_in_view ();
+    switch (k.key())
+    {
+        case input::keyboard_event::PAGEUP_KEY:
+        {
+            select_item (Current > page ? Current - page : 0);
+            return true;
+        }
+        case input::keyboard_event::PAGEDOWN_KEY:
+        {
+            select_item (Current + page < Size ? Current + page : Size - 1);
+            return true;
+        }
+        case input::keyboard_event::HOME_KEY:
+        {
+            select_item (0);
+            return true;
+        }
+        case input::keyboard_event::END_KEY:
+        {
+            select_item (Size - 1);
+            return true;
+        }
+        default: return false;
+    }
+}
+
+// select previous item
+bool list_view::moveup ()
+{
+    if (Current == 0) return false;
+
+    select_item (Current - 1);
+    return true;
+}
+
+// select next item
+bool list_view::movedown ()
+{
+    if (Current + 1 >= Size) return false;
+
+    select_item (Current + 1);
+    return true;
+}
+
+// rows fitting into the view
+u_int32 list_view::rows_in_view () const
+{
+    if (RowHeight == 0) return 1;
+
+    gfx::drawing_area client (0, 0, length(), height());
+    client.shrink (Look->border ());
+
+    u_int32 rows = (client.height() > SPACING ? client.height() - SPACING : 0) / RowHeight;
+    return rows ? rows : 1;
+}
+
+// assign items to rows
+void list_view::update_rows (const bool & rebind)
+{
+    u_int32 count = 0;
+    if (Source && Size)
+    {
+        // all rows have the size of the first
+        if (RowHeight == 0)
+        {
+            gui::widget *row = Source->create_row ();
+            if (row == NULL) return;
+
+            Pool.push_back (row);
+            RowHeight = row->height() + SPACING;
+        }
+
+        // include a row that is only partially in view
+        gfx::drawing_area client (0, 0, length(), height());
+        client.shrink (Look->border ());
+        count = std::min ((u_int32) (client.height() + RowHeight - 1) / RowHeight, Size - First);
+    }
+
+    // rows still displaying an item in view are kept ...
+    std::vector<gui::widget*> rows (count, (gui::widget*) NULL);
+    for (u_int32 k = 0; k < Children.size(); k++)
+    {
+        u_int32 item = Shown + k;
+        if (!rebind && item >= First && item < First + count)
+        {
+            rows[item - First] = Children[k].Child;
+        }
+        // ... and the others become available for reuse
+        else
+        {
+            Children[k].Child->unfocus ();
+            Children[k].Child->Parent = NULL;
+            Pool.push_back (Children[k].Child);
+        }
+    }
+
+    Children.clear ();
+
+    s_int16 x = SPACING + Look->border().x();
+    s_int16 y = SPACING + Look->border().y();
+
+    for (u_int32 k = 0; k < count; k++, y += RowHeight)
+    {
+        gui::widget *row = rows[k];
+        if (row == NULL)
+        {
+            if (Pool.empty ())
+            {
+                row = Source->create_row ();
+                if (row == NULL)
+                {
+                    // keep the remaining rows for later
+                    for (u_int32 r = k + 1; r < count; r++)
+                    {
+                        if (rows[r] == NULL) continue;
+                        rows[r]->unfocus ();
+                        rows[r]->Parent = NULL;
+                        Pool.push_back (rows[r]);
+                    }
+                    break;
+                }
+            }
+            else
+            {
+                row = Pool.back ();
+                Pool.pop_back ();
+            }
+
+            Source->bind_row (*row, First + k);
+        }
+
+        gfx::drawing_area pos (x, y, row->length(), row->height());
+        Children.push_back (layoutchild (row, pos));
+        row->Parent = this;
+    }
+
+    Shown = First;
+    Selected = Current >= First && Current - First < Children.size() ? Current - First : 0;
+
+    invalidate ();
+}
@@ -0,0 +1,275 @@
+/*
+ Copyright (C) 2011 Kai Sterker <kai.sterker@gmail.com>
+ Part of the Adonthell Project http://adonthell.linuxgames.com
+
+ Adonthell is free software; you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation; either version 2 of the License, or
+ (at your option) any later version.
+
+ Adonthell is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with Adonthell; if not, write to the Free Software
+ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+*/
+
+/**
+ * @file   gui/listview.h
+ * @author Kai Sterker <kai.sterker@gmail.com>
+ * @brief  Declares the list_view and list_source classes.
+ */
+
+#ifndef GUI_LISTVIEW_H
+#define GUI_LISTVIEW_H
+
+#include <Python.h>
+#include "layout.h"
+
+namespace gui
+{
+
+/**
+ * Provides the items displayed by a list_view. Each item is
+ * shown by a row widget. Since only the rows in view exist,
+ * rows are reused for different items while scrolling.
+ */
+class list_source
+{
+public:
+    /**
+     * Destructor.
+     */
+    virtual ~list_source () { }
+
+    /**
+     * Get the number of items in the list.
+     * @return number of items.
+     */
+    virtual u_int32 size () = 0;
+
+    /**
+     * Create a new, empty row. All rows must have the same
+     * size. The list_view takes ownership of the row.
+     * @return a new row widget.
+     */
+    virtual gui::widget *create_row () = 0;
+
+    /**
+     * Display the given item in a row. Rows are reused, so
+     * the row may still display a different item.
+     * @param row a row created by create_row.
+     * @param index index of the item to display.
+     */
+    virtual void bind_row (gui::widget & row, const u_int32 & index) = 0;
+};
+
+#ifndef SWIG
+/**
+ * A list_source implemented in Python. Wraps an instance
+ * providing the methods size(), create_row() and
+ * bind_row(row, index).
+ */
+class list_source_python : public list_source
+{
+public:
+    /**
+     * Wrap the given Python object.
+     * @param source the object providing the list items.
+     */
+    list_source_python (PyObject *source);
+
+    /**
+     * Release the Python object.
+     */
+    virtual ~list_source_python ();
+
+    /**
+     * @copydoc list_source::size
+     */
+    virtual u_int32 size ();
+
+    /**
+     * @copydoc list_source::create_row
+     */
+    virtual gui::widget *create_row ();
+
+    /**
+     * @copydoc list_source::bind_row
+     */
+    virtual void bind_row (gui::widget & row, const u_int32 & index);
+
+private:
+    /// the Python object providing the list items
+    PyObject *Source;
+};
+#endif
+
+/**
+ * A vertical list that can display a very large number of
+ * items. Unlike a list_layout, it does not keep a widget for
+ * each item, but only for the items that fit into the view.
+ * These rows are requested from a list_source and recycled
+ * while scrolling, so the cost of opening, drawing and
+ * navigating the list does not depend on the number of items.
+ */
+class list_view : public layout
+{
+public:
+    /**
+     * Create a new, empty list view with the given size.
+     * @param l view length
+     * @param h view height
+     */
+    list_view (const u_int16 & l, const u_int16 & h)
+    : layout(l, h), Source(NULL), Size(0), First(0), Shown(0), Current(0), RowHeight(0)
+    {
+        ResizeMode = NONE;
+    }
+
+    /**
+     * Create list view widget with the given decoration.
+     * Size will be set to that of the background image.
+     * @param style filename of widget decoration.
+     */
+    list_view (const std::string & style)
+    : layout(style), Source(NULL), Size(0), First(0), Shown(0), Current(0), RowHeight(0)
+    {
+        ResizeMode = NONE;
+    }
+
+    /**
+     * Delete list view, its rows and its source.
+     */
+    virtual ~list_view ();
+
+    /**
+     * @name List items
+     */
+    //@{
+    /**
+     * Set the source of the items to display. The list view
+     * takes ownership of the source.
+     * @param source the new item source, or NULL to clear the list.
+     */
+    void set_source (list_source *source);
+
+    /**
+     * Update the view after items have been added, removed or
+     * changed. All rows in view are bound again.
+     */
+    void refresh ();
+
+    /**
+     * Get the number of items in the list.
+     * @return number of items.
+     */
+    u_int32 num_items () const { return Size; }
+
+    /**
+     * Get the index of the selected item.
+     * @return index of the selected item.
+     */
+    u_int32 selected_item () const { return Current; }
+
+    /**
+     * Get the index of the topmost item in view.
+     * @return index of the first item in view.
+     */
+    u_int32 first_item () const { return First; }
+
+    /**
+     * Select the given item, scrolling it into view if required.
+     * @param index index of the item to select.
+     */
+    void select_item (const u_int32 & index);
+
+    /**
+     * Scroll just enough to bring the given item into view.
+     * @param index index of the item to show.
+     */
+    void show_item (const u_int32 & index);
+    //@}
+
+    /**
+     * Called when the container receives the focus.
+     * @return true when a row accepts the focus.
+     */
+    virtual bool focus ();
+
+#ifndef SWIG
+    GET_TYPE_NAME_VIRTUAL(gui::list_view);
+#endif
+
+protected:
+    /**
+     * Called when a key has been pressed by the user. Handles
+     * paging through the list in addition to row selection.
+     * @param k the keyboard event.
+     * @return true if the event was consumed, false otherwise.
+     */
+    virtual bool keydown (input::keyboard_event & k);
+
+    /**
+     * Called when the user pressed the move right key.
+     * @return always false.
+     */
+    virtual bool moveright () { return false; }
+    /**
+     * Called when the user pressed the move left key.
+     * @return always false.
+     */
+    virtual bool moveleft () { return false; }
+    /**
+     * Called when the user pressed the move up key.
+     * @return true if the previous item became selected.
+     */
+    virtual bool moveup ();
+    /**
+     * Called when the user pressed the move down key.
+     * @return true if the next item became selected.
+     */
+    virtual bool movedown ();
+
+private:
+    /**
+     * Get the number of rows that fit into the view completely.
+     * @return number of rows in view, at least 1.
+     */
+    u_int32 rows_in_view () const;
+
+    /**
+     * Show the items starting at First, taking rows that display
+     * an item no longer in view, or new rows, for those that came
+     * into view.
+     * @param rebind whether to bind all rows again.
+     */
+    void update_rows (const bool & rebind);
+
+    /// hide from the public interface
+    using layout::add_child;
+    /// hide from the public interface
+    using layout::remove_child;
+
+    /// provides the list items
+    list_source *Source;
+    /// number of items
+    u_int32 Size;
+    /// item displayed at the top of the view
+    u_int32 First;
+    /// item displayed by the first row
+    u_int32 Shown;
+    /// the selected item
+    u_int32 Current;
+    /// distance between the top of two rows
+    u_int16 RowHeight;
+    /// rows not in view
+    std::vector<gui::widget*> Pool;
+};
+
+}
+
+#endif /* GUI_LISTVIEW_H */
@@ -59,6 +59,7 @@ namespace gui
 	void option::activate()
 	{
 		Clicked = !Clicked;
+		invalidate();
 
         gui::ui_event evt (this, "activate");
         events::manager::raise_event (&evt);
@@ -65,7 +65,11 @@ namespace gui
 		 * does not trigger an event.
 		 * @param s true to select, false otherwise.
 		 */
-		void set_state(const bool & s) { Clicked = s; }
+		void set_state(const bool & s)
+		{
+			if (Clicked != s) invalidate();
+			Clicked = s;
+		}
 
 		/**
 		 * Get selection state of option widget.
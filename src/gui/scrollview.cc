@@ -102,6 +102,7 @@ void scrollview::show (const gui::widget & c)
 {
 	gui::layout *container = (gui::layout*) Children[0].Child;
 	gfx::drawing_area pos = container->get_location (c);
+	s_int32 ox = Ox, oy = Oy;
 
     // space occupied by scroll bars
     u_int16 xo = ((ScrollMode & SCROLL_Y) == SCROLL_Y) ? VScroll->length() : 0;
@@ -134,6 +135,8 @@ void scrollview::show (const gui::widget & c)
 			Oy = pos.y() + pos.height() - client_area.height();
 		}
 	}
+
+	if (Ox != ox || Oy != oy) invalidate ();
 }
 
 // center the given widget in the view
@@ -141,6 +144,7 @@ void scrollview::center (const gui::widget & c)
 {
 	gui::layout *container = (gui::layout*) Children[0].Child;
 	gfx::drawing_area pos = container->get_location (c);
+	s_int32 ox = Ox, oy = Oy;
 
     // space occupied by scroll bars
     u_int16 xo = ((ScrollMode & SCROLL_Y) == SCROLL_Y) ? VScroll->length() : 0;
@@ -159,6 +163,8 @@ void scrollview::center (const gui::widget & c)
 	{
 		Oy = pos.y() + (pos.height() - client_area.height()) / 2;
 	}
+
+	if (Ox != ox || Oy != oy) invalidate ();
 }
 
 // update scroll offset
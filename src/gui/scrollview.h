@@ -111,6 +111,7 @@ public:
 	 */
 	void reset ()
 	{
+		if (Ox != 0 || Oy != 0) invalidate ();
 		Ox = 0;
 		Oy = 0;
 	}
@@ -0,0 +1,64 @@
+/*
+ Copyright (C) 2011 Kai Sterker <kai.sterker@gmail.com>
+ Part of the Adonthell Project http://adonthell.linuxgames.com
+
+ Adonthell is free software; you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation; either version 2 of the License, or
+ (at your option) any later version.
+
+ Adonthell is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with Adonthell; if not, write to the Free Software
+ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+*/
+
+/**
+ * @file   gui/stats_overlay.cc
+ * @author Kai Sterker <kai.sterker@gmail.com>
+ * @brief  Implements the stats_overlay class.
+ */
+
+#include <adonthell/base/base.h>
+#include <adonthell/base/profiler.h>
+#include "stats_overlay.h"
+
+namespace gui
+{
+    // ctor
+    stats_overlay::stats_overlay (const u_int16 & width, const u_int16 & height, const u_int32 & interval)
+    : label (width, height), Interval (interval), LastRefresh (0)
+    {
+        set_multiline (true, false);
+    }
+
+    // render statistics
+    void stats_overlay::draw (const s_int16 & x, const s_int16 & y, const gfx::drawing_area *da, gfx::surface *target) const
+    {
+        if (::base::Timer.current_time () - LastRefresh >= Interval)
+        {
+            ((stats_overlay *) this)->refresh ();
+        }
+
+        label::draw (x, y, da, target);
+    }
+
+    // fetch latest statistics
+    void stats_overlay::refresh ()
+    {
+        LastRefresh = ::base::Timer.current_time ();
+
+        if (::base::profiler::enabled ())
+        {
+            set_string (::base::profiler::summary ());
+        }
+        else
+        {
+            set_string ("Profiler disabled");
+        }
+    }
+}
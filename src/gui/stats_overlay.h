@@ -0,0 +1,76 @@
+/*
+ Copyright (C) 2011 Kai Sterker <kai.sterker@gmail.com>
+ Part of the Adonthell Project http://adonthell.linuxgames.com
+
+ Adonthell is free software; you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation; either version 2 of the License, or
+ (at your option) any later version.
+
+ Adonthell is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with Adonthell; if not, write to the Free Software
+ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+*/
+
+/**
+ * @file   gui/stats_overlay.h
+ * @author Kai Sterker <kai.sterker@gmail.com>
+ * @brief  Declares the stats_overlay class.
+ */
+
+#ifndef GUI_STATS_OVERLAY_H
+#define GUI_STATS_OVERLAY_H
+
+#include "label.h"
+
+namespace gui
+{
+	/**
+	 * A label showing the time spent in the zones recorded by
+	 * base::profiler, refreshed a few times per second. Add it
+	 * to the window_manager as an INTERFACE window to keep it
+	 * on screen while the game is running.
+	 */
+	class stats_overlay : public label
+	{
+	public:
+		/**
+		 * Create an overlay of the given size.
+		 * @param width the width of the overlay.
+		 * @param height the height of the overlay.
+		 * @param interval time between refreshes in milliseconds.
+		 */
+		stats_overlay (const u_int16 & width, const u_int16 & height, const u_int32 & interval = 500);
+
+		/**
+		 * Update the statistics if they are due and draw them.
+		 * @param x X position where to draw.
+		 * @param y Y position where to draw.
+		 * @param da optional drawing_area to use during the drawing operation.
+		 * @param target pointer to the surface where to draw. If NULL, draw on the screen.
+		 */
+		virtual void draw (const s_int16 & x, const s_int16 & y, const gfx::drawing_area *da = NULL, gfx::surface *target = NULL) const;
+
+		/**
+		 * Update the statistics immediately.
+		 */
+		void refresh ();
+
+#ifndef SWIG
+        GET_TYPE_NAME_VIRTUAL(gui::stats_overlay);
+#endif
+
+	private:
+		/// time between refreshes in milliseconds
+		u_int32 Interval;
+		/// time of the last refresh
+		u_int32 LastRefresh;
+	};
+}
+
+#endif//GUI_STATS_OVERLAY_H
@@ -29,7 +29,10 @@
 
 #include <adonthell/event/manager.h>
 #include <adonthell/input/keyboard_event.h>
+#include "canvas.h"
+#include "indicatorbar.h"
 #include "layout.h"
+#include "listview.h"
 #include "ui_event.h"
 #include "ui_event_manager.h"
 #include "widget.h"
@@ -37,15 +40,69 @@
 #include <gtest/gtest.h>
 #include <adonthell/input/keyboard_event.h>
 
+#include <map>
+
 namespace gui
 {
     class test_widget : public widget {
+    public:
+        test_widget() {
+        }
+
+        test_widget(const u_int16 & l, const u_int16 & h) : widget(l, h) {
+        }
+
     protected:
         bool focus() {
             return true;
         }
     };
 
+    /// cached layout whose layer can be inspected without a gfx backend
+    class cached_layout : public layout {
+    public:
+        cached_layout() : layout(100, 100) {
+            set_cached(true);
+        }
+
+        /// what layout::draw does after rendering the layer
+        void render() {
+            LayerValid = true;
+        }
+
+        /// whether the next draw renders the layer again
+        bool needs_render() const {
+            return !LayerValid;
+        }
+    };
+
+    /// list source that remembers which item each row displays
+    class test_source : public list_source {
+    public:
+        test_source(const u_int32 & size) : Size(size), Created(0) {
+        }
+
+        u_int32 size() {
+            return Size;
+        }
+
+        widget *create_row() {
+            Created++;
+            return new test_widget(50, 10);
+        }
+
+        void bind_row(widget & row, const u_int32 & index) {
+            Bound[&row] = index;
+        }
+
+        /// number of items in the list
+        u_int32 Size;
+        /// number of rows created
+        u_int32 Created;
+        /// item displayed by each row
+        std::map<const widget*, u_int32> Bound;
+    };
+
     class layout_Test : public ::testing::Test {
 
     protected:
@@ -76,6 +133,11 @@ namespace gui
         ((ui_event_manager *)manager)->update();
     }
 
+    void push(input::keyboard_event::key_type key, layout & l) {
+        input::keyboard_event k(input::keyboard_event::KEY_PUSHED, key, "");
+        l.on_keyboard_event(&k);
+    }
+
     TEST_F(layout_Test, switching_conversation_options_fires_switch_event) {
         layout *l = new layout(2, 2);
 
@@ -105,6 +167,162 @@ namespace gui
         EXPECT_EQ(4, test_value);
     }
 
+    TEST_F(layout_Test, changed_child_rerenders_cached_layout) {
+        cached_layout l;
+        indicator_bar bar(50, 10);
+        canvas c(10, 10);
+        canvas d(10, 10);
+        cached_layout inner;
+
+        l.add_child(bar, 0, 0);
+        l.add_child(c, 0, 20);
+        l.add_child(inner, 0, 40);
+        EXPECT_TRUE(l.needs_render());
+
+        l.render();
+        EXPECT_FALSE(l.needs_render());
+
+        // setting the same values changes nothing
+        bar.set_values(0, 100);
+        EXPECT_FALSE(l.needs_render());
+
+        bar.set_values(10, 50);
+        EXPECT_TRUE(l.needs_render());
+
+        l.render();
+        bar.set_upper_val(60);
+        EXPECT_TRUE(l.needs_render());
+
+        l.render();
+        bar.set_lower_val(20);
+        EXPECT_TRUE(l.needs_render());
+
+        l.render();
+        c.set_drawable(bar);
+        EXPECT_TRUE(l.needs_render());
+
+        // changes propagate through nested layouts
+        l.render();
+        inner.render();
+        inner.add_child(d, 0, 0);
+        EXPECT_TRUE(inner.needs_render());
+        EXPECT_TRUE(l.needs_render());
+
+        // a child that goes away first no longer refers to its layout
+        {
+            canvas gone(10, 10);
+            l.add_child(gone, 50, 50);
+            l.render();
+        }
+        EXPECT_TRUE(l.needs_render());
+        EXPECT_EQ(3u, l.num_children());
+    }
+
+    TEST_F(layout_Test, list_view_keeps_rows_in_view_only) {
+        // 4 rows of 10 pixels and spacing fit completely, a 5th partially
+        list_view view(100, 55);
+        test_source *source = new test_source(1000);
+        view.set_source(source);
+
+        EXPECT_EQ(1000u, view.num_items());
+        EXPECT_EQ(5u, view.num_children());
+        EXPECT_EQ(5u, source->Created);
+
+        for (u_int32 k = 0; k < view.num_children(); k++) {
+            EXPECT_EQ(k, source->Bound[&view.get_child(k)]);
+        }
+
+        // scrolling reuses rows that went out of view
+        for (int i = 0; i < 100; i++) {
+            push(input::keyboard_event::DOWN_KEY, view);
+        }
+
+        EXPECT_EQ(100u, view.selected_item());
+        EXPECT_EQ(97u, view.first_item());
+        EXPECT_EQ(5u, view.num_children());
+        EXPECT_EQ(5u, source->Created);
+
+        for (u_int32 k = 0; k < view.num_children(); k++) {
+            EXPECT_EQ(97 + k, source->Bound[&view.get_child(k)]);
+        }
+    }
+
+    TEST_F(layout_Test, list_view_pages_within_bounds) {
+        list_view view(100, 55);
+        test_source *source = new test_source(1000);
+        view.set_source(source);
+
+        push(input::keyboard_event::END_KEY, view);
+        EXPECT_EQ(999u, view.selected_item());
+        EXPECT_EQ(996u, view.first_item());
+        EXPECT_EQ(4u, view.num_children());
+
+        push(input::keyboard_event::PAGEDOWN_KEY, view);
+        EXPECT_EQ(999u, view.selected_item());
+
+        push(input::keyboard_event::PAGEUP_KEY, view);
+        EXPECT_EQ(995u, view.selected_item());
+        EXPECT_EQ(995u, view.first_item());
+
+        push(input::keyboard_event::HOME_KEY, view);
+        EXPECT_EQ(0u, view.selected_item());
+        EXPECT_EQ(0u, view.first_item());
+
+        push(input::keyboard_event::PAGEDOWN_KEY, view);
+        EXPECT_EQ(4u, view.selected_item());
+        EXPECT_EQ(1u, view.first_item());
+
+        push(input::keyboard_event::PAGEUP_KEY, view);
+        push(input::keyboard_event::PAGEUP_KEY, view);
+        EXPECT_EQ(0u, view.selected_item());
+        EXPECT_EQ(0u, view.first_item());
+
+        // nothing to select beyond the first item
+        push(input::keyboard_event::UP_KEY, view);
+        EXPECT_EQ(0u, view.selected_item());
+
+        EXPECT_EQ(5u, source->Created);
+    }
+
+    TEST_F(layout_Test, list_view_refresh_after_shrinking) {
+        list_view view(100, 55);
+        test_source *source = new test_source(1000);
+        view.set_source(source);
+
+        push(input::keyboard_event::END_KEY, view);
+
+        source->Size = 3;
+        view.refresh();
+
+        EXPECT_EQ(3u, view.num_items());
+        EXPECT_EQ(2u, view.selected_item());
+        EXPECT_EQ(0u, view.first_item());
+        EXPECT_EQ(3u, view.num_children());
+
+        for (u_int32 k = 0; k < view.num_children(); k++) {
+            EXPECT_EQ(k, source->Bound[&view.get_child(k)]);
+        }
+
+        source->Size = 0;
+        view.refresh();
+
+        EXPECT_EQ(0u, view.num_items());
+        EXPECT_EQ(0u, view.selected_item());
+        EXPECT_EQ(0u, view.num_children());
+
+        // paging through an empty list does nothing
+        push(input::keyboard_event::END_KEY, view);
+        push(input::keyboard_event::PAGEDOWN_KEY, view);
+        EXPECT_EQ(0u, view.selected_item());
+
+        // rows are reused once the list grows again
+        source->Size = 1000;
+        view.refresh();
+
+        EXPECT_EQ(5u, view.num_children());
+        EXPECT_EQ(5u, source->Created);
+    }
+
 } // namespace{}
 
 
@@ -54,8 +54,8 @@ namespace gui
     void textbox::draw (const s_int16 & x, const s_int16 & y, const gfx::drawing_area *da, gfx::surface *target) const
 	{
 		//we need to move the text over if the length is too long
-		u_int32 nw, h2, offset;
-		Font->get_text_size(Text.substr(0, InsertPos), nw, h2);
+		u_int32 nw, offset;
+		nw = layout().offset(InsertPos);
 		if (nw > .8 * length())
 		{
             offset = nw - .8 * length();
@@ -98,6 +98,7 @@ namespace gui
                 else
                 {
                     InsertPos -= ::base::utf8::left(Text, InsertPos);
+                    invalidate();
                     return true;
                 }
             }
@@ -111,6 +112,7 @@ namespace gui
                 else
                 {
                     InsertPos += ::base::utf8::right(Text, InsertPos);
+                    invalidate();
                     return true;
                 }
             }
@@ -121,6 +123,8 @@ namespace gui
                     u_int32 len = ::base::utf8::left(Text, InsertPos);
                     InsertPos -= len;
                     Text.erase(InsertPos, len);
+                    Layout.invalidate();
+                    invalidate();
                     return true;
                 }
                 break;
@@ -130,6 +134,8 @@ namespace gui
                 if (InsertPos >= 0 && (size_t)InsertPos < Text.size())
                 {
                     Text.erase(InsertPos, ::base::utf8::right(Text, InsertPos));
+                    Layout.invalidate();
+                    invalidate();
                     return true;
                 }
                 break;
@@ -137,11 +143,13 @@ namespace gui
             case input::keyboard_event::END_KEY:
             {
                 InsertPos = Text.size();
+                invalidate();
                 return true;
             }
             case input::keyboard_event::HOME_KEY:
             {
                 InsertPos = 0;
+                invalidate();
                 return true;
             }
             default:
@@ -155,8 +163,10 @@ namespace gui
     bool textbox::input(input::keyboard_event&k)
     {
          Text.insert(InsertPos, k.unikey());
+         Layout.invalidate();
          
          InsertPos += k.unikey().length();
+         invalidate();
          return true;
     }
              
@@ -24,11 +24,28 @@
  */
 
 #include "widget.h"
+#include "layout.h"
 
 namespace gui
 {
+    // dtor
+    widget::~widget ()
+    {
+        // layout must not keep a dangling child
+        if (Parent) Parent->forget_child (this);
+        delete Look;
+    }
+
     void widget::draw (const s_int16 & x, const s_int16 & y, const gfx::drawing_area * da, gfx::surface * target) const
 	{
 		Look->draw (x, y, da, target);
+		drawn_at (x, y, target);
 	}
+
+    // report change of appearance
+    void widget::invalidate () const
+    {
+        gfx::drawable::invalidate ();
+        if (Parent) Parent->invalidate ();
+    }
 }
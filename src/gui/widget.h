@@ -39,6 +39,7 @@
 namespace gui
 {
 	class layout;
+	class list_view;
 
     /// callback for being notified of gui events
     typedef ::base::functor_1<const events::event*> * ui_callback;
@@ -60,7 +61,7 @@ namespace gui
          * @param height the inital height.
          */
 		widget(const u_int16 & width, const u_int16 & height)
-        : Visible(true), Selhilite(true)
+        : Visible(true), Selhilite(true), Highlighted(false), Parent(NULL)
         {
             Look = new decoration();
             set_size (width, height);
@@ -72,7 +73,7 @@ namespace gui
          * @param style filename of widget decoration.
          */
 		widget (const std::string & style)
-        : Visible(true), Selhilite(true)
+        : Visible(true), Selhilite(true), Highlighted(false), Parent(NULL)
         {
             u_int16 w = 0, h = 0;
 
@@ -87,12 +88,9 @@ namespace gui
         }
         
         /**
-         * Destroy widget and its input listener.
+         * Destroy widget and remove it from its layout, if any.
          */
-		virtual ~widget()
-        {
-            delete Look;
-        }
+		virtual ~widget();
         
         /** 
          * Draw the object on the %screen.
@@ -112,6 +110,7 @@ namespace gui
          */
 		virtual void set_size(const u_int16 & width, const u_int16 & height)
         {
+            invalidate ();
             set_length (width);
             set_height (height);
             Look->set_size (width, height);
@@ -125,19 +124,28 @@ namespace gui
 		{
 			Look->init (style);
 			Look->set_size (length(), height());
+			invalidate ();
 		}
 
+        /**
+         * Report that the appearance of the widget has changed, so
+         * that it gets drawn again. This includes the cached content
+         * of any layout containing the widget.
+         */
+        virtual void invalidate () const;
+
 #ifndef SWIG
         GET_TYPE_NAME_VIRTUAL(gui::widget);
 #endif
 
     protected:
         friend class gui::layout;
+        friend class gui::list_view;
 
         /**
          * Create an empty widget.
          */
-        widget () : Visible(true), Selhilite(true), Look(NULL)
+        widget () : Visible(true), Selhilite(true), Highlighted(false), Look(NULL), Parent(NULL)
         { }
 
 		/** 
@@ -203,7 +211,12 @@ namespace gui
          */
 		void enable_focus (const bool & enable) 
         { 
-            Look->set_focused (Selhilite && enable);
+            bool highlight = Selhilite && enable;
+            if (highlight == Highlighted) return;
+
+            Highlighted = highlight;
+            Look->set_focused (highlight);
+            invalidate ();
         }
         //@}
 
@@ -211,8 +224,12 @@ namespace gui
         bool Visible;
         /// whether widget indicates focus
 		bool Selhilite;
+        /// whether widget currently indicates focus
+        bool Highlighted;
         /// graphical representation of the widget
         decoration *Look;
+        /// the layout containing the widget, if any
+        layout *Parent;
 
     private:
         /// forbid copy construction
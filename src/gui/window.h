@@ -29,6 +29,11 @@
 
 #include <adonthell/gfx/screen.h>
 
+namespace world
+{
+    class entity;
+}
+
 namespace gui
 {
     /**
@@ -86,6 +91,10 @@ namespace gui
             Area = area;
             Dx = 0;
             Dy = 0;
+            Anchor = NULL;
+            Placed = false;
+            Ax = 0;
+            Ay = 0;
         }
 
         virtual ~window() { }
@@ -94,12 +103,12 @@ namespace gui
          * Get the display location of the window in X direction
          * @return window X coordinate offset by fading
          */
-        s_int16 display_x() { return Dx + x(); }
+        s_int16 display_x() { return Dx + Ax + x(); }
         /**
          * Get the display location of the window in X direction
          * @return window Y coordinate offset by fading
          */
-        s_int16 display_y() { return Dy + y(); }
+        s_int16 display_y() { return Dy + Ay + y(); }
         /**
          * Get the length of the window
          * @return window size in X direction
@@ -130,6 +139,71 @@ namespace gui
             Content->draw (clip_rect.x(), clip_rect.y(), &clip_rect, target);
         }
         
+        /**
+         * @name Attaching to map objects
+         */
+        //@{
+        /**
+         * Let a world-relative window follow an object on the map,
+         * like a name plate or speech bubble. Its position is then
+         * relative to the top left corner of the object on screen,
+         * and it is only shown while the object is visible.
+         *
+         * The window manager detaches it when the active map changes.
+         * Otherwise the window does not notice when the object is
+         * deleted. It must be detached before, see window_manager::detach,
+         * or it might follow whatever object is created at the same
+         * address later on.
+         * @param object the object to follow, or NULL to detach.
+         */
+        void attach (const world::entity *object)
+        {
+            Anchor = object;
+            Placed = false;
+            Ax = 0;
+            Ay = 0;
+        }
+
+        /**
+         * Get the object the window is following.
+         * @return object on the map, or NULL if the window is not attached.
+         */
+        const world::entity *anchor () const { return Anchor; }
+
+        /**
+         * Update the position of an attached window.
+         * @param object area covered by the anchor in the world view,
+         *      or NULL if the anchor is not visible.
+         * @return true if the position of the window changed.
+         */
+        bool place (const gfx::drawing_area *object)
+        {
+            bool placed = object != NULL;
+            s_int16 ax = placed ? object->x() : 0;
+            s_int16 ay = placed ? object->y() : 0;
+
+            if (placed == Placed && ax == Ax && ay == Ay) return false;
+
+            Placed = placed;
+            Ax = ax;
+            Ay = ay;
+            return true;
+        }
+
+        /**
+         * Check whether the window is shown. Only windows attached
+         * to an object that is currently not visible are hidden.
+         * @return false if the window is hidden, true otherwise.
+         */
+        bool shown () const { return Anchor == NULL || Placed; }
+        //@}
+
+        /**
+         * Get the element displayed by the window.
+         * @return content of the window.
+         */
+        const gfx::drawable *content () const { return Content; }
+
         /**
          * Setup window to fade in.
          * @param fading the type of fading.
@@ -218,6 +292,14 @@ namespace gui
         s_int16 Dx;
         /// current offset when fading from off-screen
         s_int16 Dy;
+        /// object the window is following
+        const world::entity *Anchor;
+        /// whether the object the window is following is visible
+        bool Placed;
+        /// position of the object the window is following
+        s_int16 Ax;
+        /// position of the object the window is following
+        s_int16 Ay;
     };
 }
 
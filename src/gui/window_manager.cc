@@ -24,9 +24,12 @@
  * @brief Handles window order and input.
  */
 
+#include <adonthell/gfx/screen.h>
 #include <adonthell/world/area_manager.h>
 #include <adonthell/world/vector3.h>
+#include <adonthell/event/listener_python.h>
 #include "window_manager.h"
+#include "fontcache.h"
 
 using gui::window_manager;
 
@@ -36,6 +39,8 @@ std::list<gui::window*> window_manager::Windows;
 std::list<gui::window*> window_manager::WorldRelativeWindows;
 /// storage for pending events.
 std::list<events::listener*> window_manager::PendingEvents;
+/// number of map changes seen
+u_int32 window_manager::MapChanges = 0;
 
 // render to screen
 void window_manager::update()
@@ -43,49 +48,22 @@ void window_manager::update()
     // trigger the event listeners
     fire_events();
 
-    /* draw all mapviews
-    for (std::list<gui::mapview_container>::reverse_iterator i = Mapviews.rbegin(); i != Mapviews.rend(); i++)
+    // objects windows were attached to are gone with their map,
+    // which might also have been changed by an event listener
+    if (MapChanges != world::area_manager::map_changes())
     {
-        i->Map->draw(i->X, i->Y);
+        MapChanges = world::area_manager::map_changes();
+        detach (NULL);
+    }
 
-        if (FirstWorldRelative != Windows.end()) // skip retrieving mapobjects if not necessary
-        {
-            // get all objects visible in the mapview
-            std::list<world::chunk_info*> objects_in_mapview = world::area_manager::get_map()->objects_in_view(
-                i->Map->get_view_start_x(),
-                i->Map->get_view_start_y(),
-                i->Map->get_z(),
-                i->Map->length(),
-                i->Map->height()
-            );
-
-            // draw all windows that should be visible in the mapview
-            for (std::list<gui::maprel_window>::reverse_iterator w = MaprelWindows.rbegin(); w != MaprelWindows.rend(); w++)
-            {
-                // Only draw window, if the object it's bound to is visible
-                for (std::list<world::chunk_info*>::iterator ci = objects_in_mapview.begin(); ci != objects_in_mapview.end(); ci++)
-                {
-                    world::entity *en = (*ci)->get_entity();
-                    if(en->has_name() && *(en->id()) == w->Entity_id)
-                    {
-                        world::vector3<s_int32> objpos = (*ci)->center_min();
-                        // The coords: where mapview starts being displayed +
-                        // + (mapobject's coords - coords of mapview's starting map point)
-                        s_int16 coord_x = i->X + i->Map->get_view_offset_x () + objpos.x() + w->Relative_x - i->Map->get_view_start_x();
-                        s_int16 coord_y = i->Y + i->Map->get_view_offset_y () + objpos.y() + w->Relative_y - i->Map->get_view_start_y();
-                        w->Window->draw (coord_x, coord_y, NULL, gfx::screen::get_surface ());
-                        break;
-                    }
-                }
-            }
-        }
-    } */
+    // add glyphs rendered in the background
+    if (FontCache) FontCache->update();
 
-    // draw all windows
+    // move fading windows and close those that faded out
     std::list<gui::window*>::reverse_iterator i = Windows.rbegin();
     while (i != Windows.rend())
     {
-        if ((*i)->fading() && (*i)->fade ())
+        if ((*i)->fading() && fade (*i))
         {
             delete *i;
             i = std::list<gui::window*>::reverse_iterator(Windows.erase (--(i.base())));
@@ -98,26 +76,120 @@ void window_manager::update()
             continue;
         }
 
+        if ((*i)->type() == WORLD_VIEW)
+        {
+            // fade world-relative windows, if any
+            std::list<gui::window*>::reverse_iterator j = WorldRelativeWindows.rbegin();
+            while (j != WorldRelativeWindows.rend())
+            {
+                if ((*j)->fading() && fade (*j, (*i)->display_x(), (*i)->display_y()))
+                {
+                    delete *j;
+
+                    j = std::list<gui::window*>::reverse_iterator(WorldRelativeWindows.erase (--(j.base())));
+                    continue;
+                }
+
+                j++;
+            }
+        }
+
+        i++;
+    }
+
+    // find what world views show in this frame only once, no matter
+    // in how many parts they are drawn, and move attached windows
+    // along before finding what changed
+    std::list<const world::mapview*> views;
+    for (std::list<gui::window*>::iterator i = Windows.begin(); i != Windows.end(); i++)
+    {
+        if ((*i)->type() != WORLD_VIEW) continue;
+
+        const world::mapview *map = dynamic_cast<const world::mapview*> ((*i)->content());
+        if (map)
+        {
+            map->begin_frame ();
+            views.push_back (map);
+        }
+
+        place_windows (*i);
+    }
+
+    if (!gfx::screen::damage_tracking())
+    {
+        draw_windows (NULL);
+    }
+    else
+    {
+        // only redraw the parts of the screen that changed
+        const std::list<gfx::drawing_area> & dirty = gfx::screen::dirty_rects ();
+        for (std::list<gfx::drawing_area>::const_iterator area = dirty.begin(); area != dirty.end(); area++)
+        {
+            gfx::screen::get_surface()->fillrect (area->x(), area->y(), area->length(), area->height(), 0);
+            draw_windows (&(*area));
+        }
+    }
+
+    for (std::list<const world::mapview*>::iterator map = views.begin(); map != views.end(); map++)
+    {
+        (*map)->end_frame ();
+    }
+}
+
+// fade window and report the area it covered
+bool window_manager::fade (gui::window *window, const s_int16 & x, const s_int16 & y)
+{
+    gfx::screen::invalidate (gfx::drawing_area (x + window->display_x(), y + window->display_y(), window->length(), window->height()));
+    if (window->fade ()) return true;
+
+    gfx::screen::invalidate (gfx::drawing_area (x + window->display_x(), y + window->display_y(), window->length(), window->height()));
+    return false;
+}
+
+// move attached windows along with their objects
+void window_manager::place_windows (gui::window *view)
+{
+    const world::mapview *map = dynamic_cast<const world::mapview*> (view->content());
+
+    for (std::list<gui::window*>::iterator j = WorldRelativeWindows.begin(); j != WorldRelativeWindows.end(); j++)
+    {
+        if ((*j)->anchor() == NULL) continue;
+
+        // the view knows what it rendered, no need to search the map
+        const gfx::drawing_area *object = map ? map->visible_area ((*j)->anchor()) : NULL;
+
+        bool shown = (*j)->shown();
+        gfx::drawing_area before (view->display_x() + (*j)->display_x(), view->display_y() + (*j)->display_y(), (*j)->length(), (*j)->height());
+
+        if (!(*j)->place (object)) continue;
+
+        // report the area covered before and after the move
+        if (shown) gfx::screen::invalidate (before);
+        if ((*j)->shown())
+        {
+            gfx::screen::invalidate (gfx::drawing_area (view->display_x() + (*j)->display_x(), view->display_y() + (*j)->display_y(), (*j)->length(), (*j)->height()));
+        }
+    }
+}
+
+// draw window stack
+void window_manager::draw_windows (const gfx::drawing_area *da)
+{
+    for (std::list<gui::window*>::reverse_iterator i = Windows.rbegin(); i != Windows.rend(); i++)
+    {
         switch ((*i)->type())
         {
             case WORLD_VIEW:
             {
-                (*i)->draw();
+                (*i)->draw(0, 0, da);
                 
                 // draw world-relative windows, if any
-                std::list<gui::window*>::reverse_iterator j = WorldRelativeWindows.rbegin();
-                while (j != WorldRelativeWindows.rend())
+                for (std::list<gui::window*>::reverse_iterator j = WorldRelativeWindows.rbegin(); j != WorldRelativeWindows.rend(); j++)
                 {
-                    if ((*j)->fading() && (*j)->fade ())
+                    if ((*j)->shown())
                     {
-                        delete *j;
-
-                        j = std::list<gui::window*>::reverse_iterator(WorldRelativeWindows.erase (--(j.base())));
-                        continue;
+                        (*j)->draw((*i)->display_x(), (*i)->display_y(), da);
                     }
-                    
-                    (*j)->draw((*i)->display_x(), (*i)->display_y());
-                    j++;
                 }
                 break;
             }
@@ -128,12 +200,10 @@ void window_manager::update()
             }
             default:
             {
-                (*i)->draw();
+                (*i)->draw(0, 0, da);
                 break;
             }
         }
-
-        i++;
     }
 }
 
@@ -175,6 +245,9 @@ void window_manager::add(window *window, const gui::fade_type & f)
         
         window->fade_in(f);
         
+        // window needs to be drawn
+        gfx::screen::invalidate (gfx::drawing_area (window->display_x(), window->display_y(), window->length(), window->height()));
+
         // acquire focus, if required
         window->receive_focus();
 
@@ -204,6 +277,37 @@ void window_manager::remove (gui::window *window, const gui::fade_type & f)
     window->fade_out(f);
 }
 
+// stop following an object
+void window_manager::detach (const world::entity *object)
+{
+    // world-relative windows are drawn on top of the world view
+    s_int16 x = 0, y = 0;
+    for (std::list<gui::window*>::iterator i = Windows.begin(); i != Windows.end(); i++)
+    {
+        if ((*i)->type() == WORLD_VIEW)
+        {
+            x = (*i)->display_x();
+            y = (*i)->display_y();
+            break;
+        }
+    }
+
+    for (std::list<gui::window*>::iterator j = WorldRelativeWindows.begin(); j != WorldRelativeWindows.end(); j++)
+    {
+        if ((*j)->anchor() == NULL) continue;
+        if (object != NULL && (*j)->anchor() != object) continue;
+
+        // report the area covered before and after detaching
+        if ((*j)->shown())
+        {
+            gfx::screen::invalidate (gfx::drawing_area (x + (*j)->display_x(), y + (*j)->display_y(), (*j)->length(), (*j)->height()));
+        }
+
+        (*j)->attach (NULL);
+        gfx::screen::invalidate (gfx::drawing_area (x + (*j)->display_x(), y + (*j)->display_y(), (*j)->length(), (*j)->height()));
+    }
+}
+
 void window_manager::fire_events()
 {
     // call event handlers
@@ -211,6 +315,7 @@ void window_manager::fire_events()
     {
         (*li)->raise_event ((*li)->get_event());
     }
+    events::listener_python::dispatch_batches ();
 
     // clear list of pending events
     PendingEvents.clear();
@@ -78,6 +78,16 @@ public:
      */
     static void remove(gui::window *window, const gui::fade_type & f = NONE);
 
+    /**
+     * Detach all world-relative windows from the given object. This
+     * must be called before an object windows are attached to is
+     * deleted. Windows are detached from all objects automatically
+     * once the active map changes.
+     * @param object the object about to be deleted, or NULL to detach
+     *      all windows from their objects.
+     */
+    static void detach (const world::entity *object);
+
     /**
      * Queue an ui event to execute before the next gui update. Required to
      * decouple ui event handling from ui event firing.
@@ -104,6 +114,30 @@ private:
     /// perform event handling
     static void fire_events ();
 
+    /**
+     * Move a fading window, reporting the area it covers before
+     * and after the move as changed.
+     * @param window the window to fade.
+     * @param x X offset of the window.
+     * @param y Y offset of the window.
+     * @return true if the window faded out completely.
+     */
+    static bool fade (gui::window *window, const s_int16 & x = 0, const s_int16 & y = 0);
+
+    /**
+     * Update the position of world-relative windows attached to
+     * objects on the map, using the objects the world view collected
+     * for the current frame. Costs a single lookup per attached window.
+     * @param view the world view the windows belong to.
+     */
+    static void place_windows (gui::window *view);
+
+    /**
+     * Draw all open windows.
+     * @param da area of the screen to update, or NULL for the whole screen.
+     */
+    static void draw_windows (const gfx::drawing_area *da);
+
     /// the list of open, absolute windows
     static std::list<window*> Windows;
 
@@ -112,6 +146,9 @@ private:
     
     /// storage for pending events.
     static std::list<events::listener*> PendingEvents;
+
+    /// number of map changes seen, to detach windows from objects gone
+    static u_int32 MapChanges;
 };
 
 } // namespace gui
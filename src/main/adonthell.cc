@@ -34,6 +34,7 @@
 #include <adonthell/gfx/gfx.h>
 #include <adonthell/base/nls.h>
 #include <adonthell/base/base.h>
+#include <adonthell/base/profiler.h>
 #include <adonthell/base/savegame.h>
 #include <adonthell/input/input.h>
 #include <adonthell/audio/audio.h>
@@ -120,7 +121,15 @@ bool app::init_modules (const u_int16 & modules)
     if (m & GFX)
     {
         gfx::setup (Cfg);
-        if (!gfx::init (Backend)) return false;
+
+        // graphics may use their own backend, e.g. to render without display
+        string gfx_backend = Backend;
+        if (Cfg.option ("Video", "Backend", base::cfg_option::FREE) != NULL)
+        {
+            gfx_backend = Cfg.get_string ("Video", "Backend", Backend);
+        }
+
+        if (!gfx::init (gfx_backend)) return false;
     }
 
     // startup input
@@ -330,6 +339,13 @@ bool app::init ()
     // init national language support
     base::nls::init (Cfg);
 
+    // pace main loop according to configuration
+    base::Scheduler.setup (Cfg);
+
+    // record where time is spent, if requested
+    base::profiler::set_enabled (Cfg.get_int ("General", "Profile", 0) == 1);
+    Cfg.option ("General", "Profile", base::cfg_option::BOOL);
+
     // platform / backend specific initialization
     return init_p (this);
 }
@@ -340,6 +356,12 @@ void app::cleanup () const
     // save configuration to disk
     Cfg.write (Config);
 
+    // save profiling results for chrome://tracing
+    if (base::profiler::enabled ())
+    {
+        base::profiler::write_trace (base::Paths().cfg_data_dir () + "/trace.json");
+    }
+
     // cleanup savegame system
     base::savegame::cleanup();
 
@@ -67,6 +67,20 @@ void py_to_cxx (PyObject *instance, const char *name, void **retval)
     }
 }
 
+// look up type descriptor by name
+void *py_type_query (const char *name)
+{
+	// get global typelist
+	swig_type_info ** typelist = SWIG_Python_GetTypeListHandle();
+	
+    swig_type_info * tt = SWIG_TypeQueryTL (*typelist, name);
+    if (tt) return tt;
+        
+    LOG(ERROR) << "py_type_query: '" << name << "' not found in SWIGs typelist:";
+	print_type_info (typelist);
+    exit(1);
+}
+
 // code below is compatible with SWIG 1.3.25, up to at least 1.3.31 (or maybe not)
 #else
 #if (SWIGVERSION >= 0x020011)
@@ -174,8 +188,43 @@ SWIGEXPORT void py_to_cxx (PyObject *instance, const char *name, void **retval)
     }
 }
 
+// look up type descriptor by name
+SWIGEXPORT void *py_type_query (const char *name)
+{
+    if (SWIG_Python_GetModule(CLIENTDATA))
+    {
+        swig_type_info * tt = SWIG_Python_TypeQuery (name);
+        if (tt) return tt;
+    
+        LOG(ERROR) << "py_type_query: '" << name << "' not found. ";
+        log_py_objects ();
+    }
+    else
+    {
+        LOG(ERROR) << "py_type_query: no Python module imported!";
+    }
+    
+    exit(1);
+}
+
 #endif // SWIGVERSION <= 0x010324
 
+// pass a C++ object of known type to Python
+SWIGEXPORT PyObject *cxx_to_py_type (void *instance, void *type, const bool & ownership)
+{
+    return SWIG_NewPointerObj (instance, (swig_type_info *) type, ownership);
+}
+
+// pass a Python object to C++, converting to known type
+SWIGEXPORT void py_to_cxx_type (PyObject *instance, void *type, void **retval)
+{
+    if (SWIG_ConvertPtr (instance, retval, (swig_type_info *) type, 0) == -1)
+    {
+        LOG(ERROR) << "py_to_cxx: cannot convert to '" << SWIG_TypePrettyName ((swig_type_info *) type) << "'";
+        exit(1);
+    }
+}
+
 SWIGEXPORT void check_module_version (const char *name, const unsigned int & module_ver)
 {
     if (SWIGVERSION != module_ver)
@@ -10,6 +10,7 @@
 #include <adonthell/base/diskio.h>
 #include <adonthell/base/configuration.h>
 #include <adonthell/base/savegame.h>
+#include <adonthell/base/profiler.h>
 
 #include <adonthell/python/callback.h>
 
@@ -162,6 +163,8 @@ namespace base {
 %include <adonthell/base/base.h>
 %include <adonthell/base/types.h>
 %include <adonthell/base/timer.h>
+%include <adonthell/base/frame_scheduler.h>
+%include <adonthell/base/profiler.h>
 %include <adonthell/base/file.h>
 %include <adonthell/base/flat.h>
 %include <adonthell/base/diskio.h>
@@ -179,6 +182,16 @@ typedef long time_t;
     {
         return new base::savegame (new python::functor_1<const s_int32>(callback));
     }
+    
+    bool save_in_background (const s_int32 & slot, const std::string & desc, const u_int32 & gametime, PyObject *callback = NULL)
+    {
+        base::functor_1<bool> *on_complete = NULL;
+        if (callback != NULL && callback != Py_None)
+        {
+            on_complete = new python::functor_1<bool>(callback);
+        }
+        return self->save_in_background (slot, desc, gametime, on_complete);
+    }
 }
 
 /* implement friend operators of igzstream */
@@ -273,4 +286,5 @@ typedef long time_t;
 
 %pythoncode %{
     Timer = cvar.Timer
+    Scheduler = cvar.Scheduler
 %}
@@ -10,11 +10,13 @@
 #include <adonthell/gui/button.h>
 #include <adonthell/gui/layout.h>
 #include <adonthell/gui/listlayout.h>
+#include <adonthell/gui/listview.h>
 #include <adonthell/gui/canvas.h>
 #include <adonthell/gui/indicatorbar.h>
 #include <adonthell/gui/scrollview.h>
 #include <adonthell/gui/option.h>
 #include <adonthell/gui/textbox.h>
+#include <adonthell/gui/stats_overlay.h>
 #include <adonthell/gui/ui_event.h>
 #include <adonthell/gui/conversation.h>
 #include <adonthell/gui/window_manager.h>
@@ -79,6 +81,16 @@ namespace gui {
     %ignore list_layout::add_child;
     %ignore list_layout::insert_child;
 
+    // wrap python object providing the items of a list_view
+    %extend list_view
+    {
+        void set_source (PyObject *source)
+        {
+            $self->set_source (source == Py_None ? NULL : new gui::list_source_python (source));
+        }
+    }
+    %ignore list_view::set_source;
+
     // make sure scrollview takes ownership of wrapped container
     %extend scrollview
     {
@@ -119,11 +131,13 @@ namespace gui {
 %include <adonthell/gui/button.h>
 %include <adonthell/gui/layout.h>
 %include <adonthell/gui/listlayout.h>
+%include <adonthell/gui/listview.h>
 %include <adonthell/gui/canvas.h>
 %include <adonthell/gui/indicatorbar.h>
 %include <adonthell/gui/scrollview.h>
 %include <adonthell/gui/option.h>
 %include <adonthell/gui/textbox.h>
+%include <adonthell/gui/stats_overlay.h>
 %include <adonthell/gui/ui_event.h>
 %include <adonthell/gui/conversation.h>
 %include <adonthell/gui/window.h>
@@ -38,16 +38,25 @@
  * This set of macros makes the class which name is given as argument 
  * available for Python argument passing, which means objects of this 
  * class can be passed as arguments to Python callbacks.
+ *
+ * Besides the name, each class gets a slot to remember the SWIG
+ * type descriptor, so that the type only needs to be looked up
+ * by name the first time an object of the class is passed.
  */
 #define GET_TYPE_NAME_VIRTUAL(CLASS) \
 virtual const char* get_type_name () const { return #CLASS " *"; } \
-static const char* get_type_name_s () { return #CLASS " *"; } 
+static const char* get_type_name_s () { return #CLASS " *"; } \
+virtual void *& get_type_info () const { return get_type_info_s (); } \
+static void *& get_type_info_s () { static void *type_info = 0; return type_info; }
 
 #define GET_TYPE_NAME_ABSTRACT(CLASS) \
-virtual const char* get_type_name () const = 0;
+virtual const char* get_type_name () const = 0; \
+virtual void *& get_type_info () const = 0;
 
 #define GET_TYPE_NAME(CLASS) \
 const char* get_type_name () const { return #CLASS " *"; } \
-static const char* get_type_name_s () { return #CLASS " *"; } 
+static const char* get_type_name_s () { return #CLASS " *"; } \
+void *& get_type_info () const { return get_type_info_s (); } \
+static void *& get_type_info_s () { static void *type_info = 0; return type_info; }
 
 #endif
@@ -81,6 +81,7 @@ bool method::execute (PyObject *args)
 {
     if (Method) 
     {
+        gil_lock lock;
         PyObject *result = PyObject_CallObject (Method, args);
         if (result) 
         {
@@ -94,6 +95,17 @@ bool method::execute (PyObject *args)
     return false;
 }
 
+// compare wrapped python methods
+bool method::equals (const method & m) const
+{
+    if (Script != m.Script || !Method || !m.Method) return false;
+    if (Method == m.Method) return true;
+
+    // each lookup creates a new bound method, so compare the functions
+    return PyMethod_Check (Method) && PyMethod_Check (m.Method) &&
+        PyMethod_GET_FUNCTION (Method) == PyMethod_GET_FUNCTION (m.Method);
+}
+
 // save callback connection to disk
 void method::put_state (base::flat & out) const
 {
@@ -79,6 +79,14 @@ namespace python
          */
         bool execute (PyObject *args);
 
+        /**
+         * Check whether the given %method wraps the same %python
+         * %method of the same %script as this one.
+         * @param m %method to compare with.
+         * @return \b true if both methods are the same, \b false otherwise.
+         */
+        bool equals (const method & m) const;
+
         /**
          * @name Loading / Saving
          */
@@ -26,11 +26,60 @@
  * 
  */
 
+#include <map>
+#include <algorithm>
+#include <adonthell/base/allow_threads.h>
 #include "python.h"
 #include "pool.h"
+#include "script.h"
 
 namespace python
 {
+    /**
+     * A weak reference to the Python object representing a C++ instance.
+     */
+    struct proxy
+    {
+        /// SWIG type descriptor of the instance
+        void *Type;
+        /// weak reference to the Python object
+        PyObject *Ref;
+    };
+
+    /// Python objects of instances passed with pass_cached_instance
+    static std::map<void*, proxy> Proxies;
+    /// whether to reuse Python objects
+    static bool ProxyCache = true;
+    /// cache size at which to drop entries of objects no longer alive
+    static size_t ProxySweep = 256;
+
+    /// release all cached Python objects
+    static void clear_proxies ()
+    {
+        for (std::map<void*, proxy>::iterator i = Proxies.begin (); i != Proxies.end (); i++)
+        {
+            Py_DECREF (i->second.Ref);
+        }
+        Proxies.clear ();
+    }
+
+    /// release Python objects no longer alive
+    static void sweep_proxies ()
+    {
+        std::map<void*, proxy>::iterator i = Proxies.begin ();
+        while (i != Proxies.end ())
+        {
+            if (PyWeakref_GetObject (i->second.Ref) == Py_None)
+            {
+                Py_DECREF (i->second.Ref);
+                Proxies.erase (i++);
+            }
+            else i++;
+        }
+
+        ProxySweep = std::max ((size_t) 256, Proxies.size () * 2);
+    }
+
     // print stacktrace if a python error occurred
     void show_traceback ()
     {
@@ -49,10 +98,36 @@ namespace python
         }
     }
 
+    /// release the GIL on behalf of base::allow_threads
+    static void *release_gil ()
+    {
+        return holds_gil () ? PyEval_SaveThread () : NULL;
+    }
+
+    /// acquire the GIL on behalf of base::allow_threads
+    static void acquire_gil (void *state)
+    {
+        PyEval_RestoreThread ((PyThreadState *) state);
+    }
+
+    // check whether calling thread holds the GIL
+    bool holds_gil ()
+    {
+#if PY_VERSION_HEX >= 0x03040000
+        return PyGILState_Check ();
+#else
+        PyThreadState *state = PyGILState_GetThisThreadState ();
+        return state != NULL && state == _PyThreadState_Current;
+#endif
+    }
+
     // start python interpreter
     void init ()
     {
         Py_Initialize ();
+        // create the GIL, held by the main thread from now on
+        PyEval_InitThreads ();
+        base::allow_threads::set_hooks (&release_gil, &acquire_gil);
         pool::init ();
 
         // make sure that PyErr_Print uses our own logging
@@ -62,10 +137,69 @@ namespace python
     // shutdown python interpreter
     void cleanup ()
     {
+        base::allow_threads::set_hooks (NULL, NULL);
+        clear_proxies ();
         pool::cleanup ();
+        script::release_names ();
         Py_Finalize ();
     }
 
+    // reuse python object of given instance
+    PyObject *get_proxy (void *instance, void *type)
+    {
+        if (!ProxyCache) return cxx_to_py_type (instance, type, c_owns);
+
+        std::map<void*, proxy>::iterator i = Proxies.find (instance);
+        if (i != Proxies.end ())
+        {
+            // still alive and not replaced by an object of different type?
+            PyObject *obj = PyWeakref_GetObject (i->second.Ref);
+            if (obj != Py_None && i->second.Type == type)
+            {
+                Py_INCREF (obj);
+                return obj;
+            }
+
+            Py_DECREF (i->second.Ref);
+            Proxies.erase (i);
+        }
+
+        PyObject *obj = cxx_to_py_type (instance, type, c_owns);
+
+        proxy p;
+        p.Type = type;
+        p.Ref = PyWeakref_NewRef (obj, NULL);
+        if (p.Ref == NULL)
+        {
+            // object does not support weak references
+            PyErr_Clear ();
+            return obj;
+        }
+
+        Proxies[instance] = p;
+        if (Proxies.size () > ProxySweep) sweep_proxies ();
+
+        return obj;
+    }
+
+    // drop python object of given instance
+    void forget_instance (void *instance)
+    {
+        std::map<void*, proxy>::iterator i = Proxies.find (instance);
+        if (i != Proxies.end ())
+        {
+            Py_DECREF (i->second.Ref);
+            Proxies.erase (i);
+        }
+    }
+
+    // enable or disable reuse of python objects
+    void set_proxy_cache (const bool & enable)
+    {
+        ProxyCache = enable;
+        if (!enable) clear_proxies ();
+    }
+
     // add path to python module search path    
     bool add_search_path (const std::string & path)
     {
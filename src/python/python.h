@@ -43,6 +43,9 @@
 extern "C" {
 	PyObject *cxx_to_py (void *instance, const char *name, const bool & ownership);
 	void py_to_cxx (PyObject *instance, const char *name, void **retval);
+	void *py_type_query (const char *name);
+	PyObject *cxx_to_py_type (void *instance, void *type, const bool & ownership);
+	void py_to_cxx_type (PyObject *instance, void *type, void **retval);
 }
 
 /**
@@ -86,6 +89,93 @@ namespace python
     void show_traceback();
 	//@}
 
+    /**
+     * @name Threading.
+     *
+     * The interpreter may only be used by the thread holding the
+     * global interpreter lock (GIL). After init(), the main thread
+     * holds it and keeps it, unless it is released explicitly.
+     *
+     * - Long running C++ code that does not touch %python objects
+     *   should release the GIL with gil_release (or base::allow_threads
+     *   in modules that cannot depend on %python), so that %python
+     *   threads keep running meanwhile.
+     * - Other threads that need to call into %python must acquire the
+     *   GIL with gil_lock first. python::script and python::method do
+     *   so when calling a %python method, so they can be used from
+     *   any thread, and from code that released the GIL.
+     * - Everything else in this module assumes that the calling
+     *   thread holds the GIL.
+     */
+    //@{
+    /**
+     * Check whether the calling thread holds the GIL.
+     * @return \b true if the GIL is held by this thread.
+     */
+    bool holds_gil ();
+
+    /**
+     * Acquires the GIL for as long as it exists. Can be
+     * used from any thread, whether it holds the GIL or not.
+     */
+    class gil_lock
+    {
+    public:
+        /**
+         * Acquire the GIL, if not already held by the calling thread.
+         */
+        gil_lock () : State (PyGILState_Ensure ())
+        {
+        }
+
+        /**
+         * Restore the GIL to the state before acquiring it.
+         */
+        ~gil_lock ()
+        {
+            PyGILState_Release (State);
+        }
+
+    private:
+        /// forbid copy construction
+        gil_lock (const gil_lock & l);
+
+        /// state of the GIL before acquiring it
+        PyGILState_STATE State;
+    };
+
+    /**
+     * Releases the GIL for as long as it exists, if held by the
+     * calling thread. Code in the scope of a gil_release instance
+     * must not touch %python objects other than through gil_lock.
+     */
+    class gil_release
+    {
+    public:
+        /**
+         * Release the GIL, if held by the calling thread.
+         */
+        gil_release () : State (holds_gil () ? PyEval_SaveThread () : NULL)
+        {
+        }
+
+        /**
+         * Acquire the GIL again, if it has been released.
+         */
+        ~gil_release ()
+        {
+            if (State) PyEval_RestoreThread (State);
+        }
+
+    private:
+        /// forbid copy construction
+        gil_release (const gil_release & r);
+
+        /// thread state of the calling thread, if the GIL was released
+        PyThreadState *State;
+    };
+    //@}
+
     /**
      * @name High-level functions.
      * 
@@ -140,9 +230,24 @@ namespace python
      */
     typedef enum { c_owns = 0, python_owns = 1 } ownership;
 
+    /**
+     * Get the SWIG type descriptor for the given type, looking it up by
+     * name if it is not yet known.
+     *
+     * @param type_info slot caching the type descriptor.
+     * @param name name of the type.
+     *
+     * @return the type descriptor.
+     */
+    inline void *get_type_info (void *& type_info, const char *name)
+    {
+        if (type_info == NULL) type_info = py_type_query (name);
+        return type_info;
+    }
+
     /** 
-     * Default version of pass_instance - it will fetch the name of the class
-     * that is passed using a specialized version of get_type_name to create
+     * Default version of pass_instance - it will fetch the type of the class
+     * that is passed using a specialized version of get_type_info to create
      * a Python object from a pointer.
      * 
      * @param arg a pointer to the object to pass to Python.
@@ -153,8 +258,56 @@ namespace python
     template <class A> inline
     PyObject * pass_instance(A arg, const ownership own = c_owns)
     { 
-        return cxx_to_py ((void *) arg, arg->get_type_name(), own);
+        return cxx_to_py_type ((void *) arg, get_type_info (arg->get_type_info(), arg->get_type_name()), own);
     }
+
+    /**
+     * Return the Python object representing the given C++ instance, if
+     * one is still alive, or create a new one. This is meant for long-lived
+     * objects, so that passing them repeatedly to Python will not create
+     * a new Python object each time. The Python object is only weakly
+     * referenced, so it is freed as soon as Python no longer uses it.
+     *
+     * The C++ object must call forget_instance when it is destroyed.
+     *
+     * @param instance a pointer to the object to pass to Python.
+     * @param type SWIG type descriptor of the object.
+     *
+     * @return a Python object representing \e instance, owned by C++.
+     */
+    PyObject *get_proxy (void *instance, void *type);
+
+    /**
+     * Like pass_instance, but reuse the Python object representing the
+     * given instance if it is still alive. See get_proxy for details.
+     *
+     * @param arg a pointer to the object to pass to Python.
+     *
+     * @return a Python object representing \e arg, owned by C++.
+     */
+    template <class A> inline
+    PyObject * pass_cached_instance(A arg)
+    {
+        return get_proxy ((void *) arg, get_type_info (arg->get_type_info(), arg->get_type_name()));
+    }
+
+    /**
+     * Remove the Python object representing the given instance from the
+     * cache used by pass_cached_instance. Call this when the instance is
+     * destroyed, so that a new object at the same address will not be
+     * mistaken for it.
+     *
+     * @param instance pointer to the object about to be destroyed.
+     */
+    void forget_instance (void *instance);
+
+    /**
+     * Enable or disable reuse of Python objects by pass_cached_instance.
+     * Disabling the cache will release all cached objects.
+     *
+     * @param enable \b true to reuse Python objects.
+     */
+    void set_proxy_cache (const bool & enable);
     
     /** 
      * Specialized version of pass_instance which makes a Python integer
@@ -256,7 +409,7 @@ namespace python
     A retrieve_instance(PyObject * pyinstance)
     {
         B *retvalue = NULL;
-		py_to_cxx (pyinstance, B::get_type_name_s(), (void **) &retvalue);
+		py_to_cxx_type (pyinstance, get_type_info (B::get_type_info_s(), B::get_type_name_s()), (void **) &retvalue);
 		
 		return retvalue;
     }
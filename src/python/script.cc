@@ -31,11 +31,15 @@
  * 
  */
 
+#include <adonthell/base/profiler.h>
 #include "script.h"
 
 using python::script;
 using std::string;
 
+/// Method names as interned Python strings
+static std::map<std::string, PyObject*> Names;
+
 script::script ()
 {
     Instance = NULL;
@@ -52,6 +56,8 @@ script::~script ()
 // Cleanup (and re-initialisation)
 void script::clear ()
 {
+    flush_methods ();
+
     // Delete our Instance
     Py_XDECREF (Instance);
     Py_XDECREF (Args);
@@ -123,25 +129,95 @@ bool script::instantiate (PyObject *module, const string & file, const string &
 // Execute a method of the script
 PyObject* script::call_method_ret (const string &name, PyObject *args) const
 {
+    PROFILE_ZONE ("script::call_method_ret");
+
     PyObject *result = NULL;
 
     if (Instance)
     {
-        PyObject *tocall = PyObject_GetAttrString (Instance, (char *) name.c_str ());
-
-        if (PyCallable_Check (tocall) == 1)
+        gil_lock lock;
+        PyObject *tocall = get_method (intern (name));
+        if (tocall)
         {
             result = PyObject_CallObject (tocall, args);
             if (!result) python::show_traceback ();
+
+            Py_DECREF (tocall);
         }
-        else
+    }
+
+    return result;
+}
+
+// find callable attribute of the instance
+PyObject *script::get_method (PyObject *name) const
+{
+    // an attribute assigned to the instance hides the method of its class
+    PyObject **dict = _PyObject_GetDictPtr (Instance);
+    bool hidden = dict && *dict && PyDict_GetItem (*dict, name);
+
+    if (!hidden)
+    {
+        std::map<PyObject*, PyObject*>::const_iterator i = Methods.find (name);
+        if (i != Methods.end ())
         {
-            LOG(ERROR) << "script::call_method_ret: '" << name << "' is not callable!";
+            Py_INCREF (i->second);
+            return i->second;
         }
-        Py_DECREF (tocall);
     }
 
-    return result;
+    PyObject *method = PyObject_GetAttr (Instance, name);
+    if (!method)
+    {
+        python::show_traceback ();
+        return NULL;
+    }
+
+    if (PyCallable_Check (method) != 1)
+    {
+        LOG(ERROR) << "script::call_method_ret: '" << PyString_AsString (name) << "' is not callable!";
+        Py_DECREF (method);
+        return NULL;
+    }
+
+    if (!hidden)
+    {
+        Py_INCREF (method);
+        Methods[name] = method;
+    }
+
+    return method;
+}
+
+// forget methods looked up so far
+void script::flush_methods ()
+{
+    for (std::map<PyObject*, PyObject*>::iterator i = Methods.begin (); i != Methods.end (); i++)
+    {
+        Py_DECREF (i->second);
+    }
+    Methods.clear ();
+}
+
+// get name as interned python string
+PyObject *script::intern (const std::string & name)
+{
+    std::map<std::string, PyObject*>::const_iterator i = Names.find (name);
+    if (i != Names.end ()) return i->second;
+
+    PyObject *str = PyString_InternFromString (name.c_str ());
+    Names[name] = str;
+    return str;
+}
+
+// release interned names
+void script::release_names ()
+{
+    for (std::map<std::string, PyObject*>::iterator i = Names.begin (); i != Names.end (); i++)
+    {
+        Py_DECREF (i->second);
+    }
+    Names.clear ();
 }
 
 // check for a certain attribute
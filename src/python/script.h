@@ -33,6 +33,7 @@
 #ifndef PYTHON_SCRIPT_H
 #define PYTHON_SCRIPT_H
                    
+#include <map>
 #include "python.h"
 
 namespace python 
@@ -99,7 +100,9 @@ namespace python
          */
         //@{
         /** 
-         * Call a method of this object.
+         * Call a method of this object. The method is looked up only
+         * once and then kept for subsequent calls, unless an attribute
+         * of the same name is assigned to the instance.
          * 
          * @param name name of the method to call.
          * @param args Python tuple containing the arguments to pass to the method.
@@ -119,6 +122,12 @@ namespace python
             PyObject *result = call_method_ret (name, args);
             Py_XDECREF (result);
         }
+
+        /**
+         * Forget the methods looked up by call_method. This is only
+         * required after replacing a method of the Python class.
+         */
+        void flush_methods ();
         //@}
     
         /**
@@ -259,6 +268,12 @@ namespace python
 #ifndef SWIG
         /// allow script to be passed through SWIG
         GET_TYPE_NAME_VIRTUAL(python::script);
+
+        /**
+         * Release the method names shared by all scripts. Called
+         * when shutting down the Python interpreter.
+         */
+        static void release_names ();
 #endif // SWIG
     
     protected:
@@ -268,6 +283,23 @@ namespace python
     private:
         /// Helper for create_instance and reload_instance
         bool instantiate (PyObject*, const std::string &, const std::string &, PyObject*);
+
+        /**
+         * Get a callable attribute of the instance.
+         * @param name interned name of the method.
+         * @return new reference to the method, or NULL on error.
+         */
+        PyObject *get_method (PyObject *name) const;
+
+        /**
+         * Get the interned Python string of the given name.
+         * @param name a method name.
+         * @return borrowed reference to the interned string.
+         */
+        static PyObject *intern (const std::string & name);
+
+        /// Bound methods of the instance, by interned name
+        mutable std::map<PyObject*, PyObject*> Methods;
     
         /// The class name of the current script
         std::string Classname;
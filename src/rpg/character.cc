@@ -86,6 +86,7 @@ character::character (const std::string & name, const std::string & id, const rp
 // dtor
 character::~character ()
 {
+    python::forget_instance (this);
     python::script::clear();
 }
 
@@ -78,7 +78,7 @@ namespace rpg
                 if (python::script::create_instance (CHARACTER_PACKAGE + templ, templ, args))
                 {
                     // add reference to character
-                    set_attribute ("this", python::pass_instance (this));
+                    set_attribute ("this", python::pass_cached_instance (this));
                     return true;
                 }
 
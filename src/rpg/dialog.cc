@@ -45,8 +45,8 @@ dialog::dialog (rpg::character & npc) : python::script ()
     
     // create arguments for Python dialogue class ctor
     Args = PyTuple_New (2);
-    PyTuple_SET_ITEM (Args, 0, python::pass_instance (rpg::character::get_player()));
-    PyTuple_SET_ITEM (Args, 1, python::pass_instance (&npc));
+    PyTuple_SET_ITEM (Args, 0, python::pass_cached_instance (rpg::character::get_player()));
+    PyTuple_SET_ITEM (Args, 1, python::pass_cached_instance (&npc));
     
     // instantiate Python dialogue class
     if (!create_instance (DIALOGUE_PACKAGE + dlg, dlg, Args))
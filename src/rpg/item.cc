@@ -70,7 +70,7 @@ bool item::can_equip (character *character)
     
     // pass character
     PyObject *args = PyTuple_New (1);
-    PyTuple_SetItem (args, 0, python::pass_instance (character));
+    PyTuple_SetItem (args, 0, python::pass_cached_instance (character));
     
     // call method
     PyObject *retval = call_method_ret ("can_equip", args);
@@ -123,7 +123,7 @@ bool item::use (character *character)
     
     // pass character
     PyObject *args = PyTuple_New (1);
-    PyTuple_SetItem (args, 0, python::pass_instance (character));
+    PyTuple_SetItem (args, 0, python::pass_cached_instance (character));
     
     // call method
     PyObject *retval = call_method_ret ("use", args);
@@ -79,7 +79,7 @@ bool action::init (const std::string & script, const std::string & method, PyObj
 // execute action
 void action::execute (world::character *actor, world::object *target)
 {
-    execute (python::pass_instance (actor), python::pass_instance (target));
+    execute (python::pass_cached_instance (actor), python::pass_cached_instance (target));
 }
 
 // execute action
@@ -26,6 +26,10 @@
  *
  */
 
+#include <adonthell/base/base.h>
+#include <adonthell/base/profiler.h>
+#include <adonthell/python/python.h>
+
 #include "area.h"
 #include "character.h"
 #include "object.h"
@@ -34,6 +38,47 @@ using world::coordinates;
 using world::placeable;
 using world::area;
 
+/// location of a record within a section of the map data
+typedef std::pair<const char*, u_int32> record_ref;
+
+// check whether all entries of a record are records with a unique name
+static bool is_keyed (base::flat & record)
+{
+    std::hash_set<std::string> names;
+    base::flat::data_type type;
+    u_int32 size;
+    void *value;
+    char *id;
+    
+    record.first ();
+    while ((type = record.next (&value, &size, &id)) != base::flat::T_UNKNOWN)
+    {
+        if (type != base::flat::T_FLAT || *id == '\0' || !names.insert (id).second)
+        {
+            record.first ();
+            return false;
+        }
+    }
+    
+    record.first ();
+    return true;
+}
+
+// index the records contained in the given record by name
+static void index_records (base::flat & record, std::hash_map<std::string, record_ref> & index)
+{
+    u_int32 size;
+    void *value;
+    char *id;
+    
+    record.first ();
+    while (record.next (&value, &size, &id) == base::flat::T_FLAT)
+    {
+        index[id] = record_ref ((const char*) value, size);
+    }
+    record.first ();
+}
+
 // dtor
 area::~area()
 {
@@ -61,6 +106,11 @@ void area::clear()
 
     Zones.clear();
     
+    // forget pristine state
+    Pristine.clear();
+    KeyedSections.clear();
+    PristineChecksum = 0;
+    
     // reset chunk
     chunk::clear();
 }
@@ -80,6 +130,8 @@ world::chunk_info *area::place_entity (const s_int32 & index, coordinates & pos)
 // update state of map
 void area::update()
 {
+    PROFILE_ZONE ("area::update");
+
     std::vector<world::entity*>::const_iterator i;
     for (i = Entities.begin(); i != Entities.end(); i++)
     {
@@ -529,6 +581,95 @@ bool area::save (const std::string & fname, const base::diskio::file_format & fo
     return false;
 }
 
+// save changes to pristine map
+bool area::save_delta (const std::string & fname)
+{
+    // without pristine map, there is nothing to compare with
+    if (Pristine.empty ())
+    {
+        return save (fname);
+    }
+    
+    base::flat state;
+    if (!put_state (state))
+    {
+        LOG(ERROR) << "area::save_delta: saving '" << fname << "' failed!";
+        return false;
+    }
+    
+    std::hash_map<std::string, u_int32>::const_iterator sum;
+    base::flat sections, changed, removed;
+    u_int32 size;
+    void *value;
+    char *id;
+
+    // compare map with pristine state section by section
+    while (state.next (&value, &size, &id) == base::flat::T_FLAT)
+    {
+        std::string name (id);
+        base::flat section ((const char*) value, size);
+        
+        // section is unchanged
+        sum = Pristine.find (name);
+        if (sum != Pristine.end () && sum->second == section.checksum ())
+        {
+            continue;
+        }
+        
+        // section cannot be compared entry by entry
+        if (KeyedSections.find (name) == KeyedSections.end () || !is_keyed (section))
+        {
+            sections.put_flat (name, section);
+            continue;
+        }
+        
+        // only keep entries that changed or have been added
+        base::flat changed_entries, removed_entries;
+        std::hash_set<std::string> names;
+        
+        while (section.next (&value, &size, &id) == base::flat::T_FLAT)
+        {
+            names.insert (id);
+            
+            base::flat entry ((const char*) value, size);
+            sum = Pristine.find (name + "/" + id);
+            if (sum == Pristine.end () || sum->second != entry.checksum ())
+            {
+                changed_entries.put_flat (id, entry);
+            }
+        }
+        
+        // remember entries no longer present
+        std::string prefix = name + "/";
+        for (sum = Pristine.begin (); sum != Pristine.end (); sum++)
+        {
+            if (sum->first.compare (0, prefix.length (), prefix) == 0 &&
+                names.find (sum->first.substr (prefix.length ())) == names.end ())
+            {
+                removed_entries.put_string ("", sum->first.substr (prefix.length ()));
+            }
+        }
+        
+        changed.put_flat (name, changed_entries);
+        removed.put_flat (name, removed_entries);
+    }
+    
+    base::diskio record;
+    record.put_string ("pristine", Filename);
+    record.put_uint32 ("checksum", PristineChecksum);
+    record.put_flat ("sections", sections);
+    record.put_flat ("changed", changed);
+    record.put_flat ("removed", removed);
+    
+    if (!record.put_record (fname))
+    {
+        LOG(ERROR) << "area::save_delta: saving '" << fname << "' failed!";
+        return false;
+    }
+    
+    return true;
+}
+
 // load from file
 bool area::load (const std::string & fname)
 {
@@ -538,6 +679,190 @@ bool area::load (const std::string & fname)
 
     // try to load area
     base::diskio record (base::diskio::BY_EXTENSION);
+    {
+        // reading the file does not involve any scripts yet
+        python::gil_release nogil;
+        if (!record.get_record (fname))
+        {
+            return false;
+        }
+    }
+    
+    // saved game might only contain changes to pristine map
+    if (record.get_string ("pristine", true) != "")
+    {
+        base::flat state;
+        return apply_delta (record, state) && get_state (state);
+    }
+
+    // map is loaded from game data, not from a saved game
+    std::string path = fname;
+    std::string data_path = fname;
+    if (base::Paths().find_in_path (path, false) && 
+        base::Paths().find_in_data_path (data_path, false) && path == data_path)
+    {
+        set_pristine (record);
+    }
+
+    return get_state (record);
+}
+
+// remember checksums of pristine map
+void area::set_pristine (base::flat & file)
+{
+    u_int32 size;
+    void *value;
+    char *id;
+    
+    Pristine.clear ();
+    KeyedSections.clear ();
+    PristineChecksum = file.checksum ();
+    
+    file.first ();
+    while (file.next (&value, &size, &id) == base::flat::T_FLAT)
+    {
+        std::string name (id);
+        base::flat section ((const char*) value, size);
+        Pristine[name] = section.checksum ();
+        
+        // entries of the section can be compared individually
+        if (is_keyed (section))
+        {
+            KeyedSections.insert (name);
+            while (section.next (&value, &size, &id) == base::flat::T_FLAT)
+            {
+                Pristine[name + "/" + id] = base::flat ((const char*) value, size).checksum ();
+            }
+        }
+    }
+    file.first ();
+}
 
-    return record.get_record (fname) && get_state (record);
+// merge saved changes into pristine map
+bool area::apply_delta (base::flat & delta, base::flat & file)
+{
+    std::string path = delta.get_string ("pristine");
+    if (!base::Paths().find_in_data_path (path))
+    {
+        return false;
+    }
+    
+    base::diskio pristine (base::diskio::BY_EXTENSION);
+    if (!pristine.get_record (path))
+    {
+        return false;
+    }
+    
+    // make sure pristine map has not been modified since saving
+    if (pristine.checksum () != delta.get_uint32 ("checksum"))
+    {
+        LOG(ERROR) << "area::apply_delta: '" << path << "' does not match the map '" << Filename << "' has been saved from!";
+        return false;
+    }
+    
+    set_pristine (pristine);
+    
+    base::flat sections = delta.get_flat ("sections");
+    base::flat changed = delta.get_flat ("changed");
+    base::flat removed = delta.get_flat ("removed");
+    
+    std::hash_map<std::string, record_ref> replaced_sections, changed_sections, removed_sections;
+    std::hash_map<std::string, record_ref>::const_iterator ref;
+    index_records (sections, replaced_sections);
+    index_records (changed, changed_sections);
+    index_records (removed, removed_sections);
+    
+    u_int32 size;
+    void *value;
+    char *id;
+    
+    // sections of the pristine map
+    std::hash_set<std::string> merged_sections;
+    
+    while (pristine.next (&value, &size, &id) == base::flat::T_FLAT)
+    {
+        std::string name (id);
+        merged_sections.insert (name);
+        
+        // section has been replaced completely
+        if ((ref = replaced_sections.find (name)) != replaced_sections.end ())
+        {
+            file.put_flat (name, base::flat (ref->second.first, ref->second.second));
+            continue;
+        }
+        
+        // section is unchanged
+        if ((ref = changed_sections.find (name)) == changed_sections.end ())
+        {
+            file.put_flat (name, base::flat ((const char*) value, size));
+            continue;
+        }
+        
+        base::flat entries (ref->second.first, ref->second.second);
+        std::hash_map<std::string, record_ref> changed_entries;
+        index_records (entries, changed_entries);
+        
+        std::hash_set<std::string> removed_entries;
+        if ((ref = removed_sections.find (name)) != removed_sections.end ())
+        {
+            char *entry;
+            base::flat names (ref->second.first, ref->second.second);
+            while (names.next ((void**) &entry) == base::flat::T_STRING)
+            {
+                removed_entries.insert (entry);
+            }
+        }
+        
+        // merge entries of pristine section with changed ones
+        base::flat section ((const char*) value, size);
+        base::flat merged;
+        
+        while (section.next (&value, &size, &id) == base::flat::T_FLAT)
+        {
+            if (removed_entries.find (id) != removed_entries.end ())
+            {
+                continue;
+            }
+            
+            if ((ref = changed_entries.find (id)) != changed_entries.end ())
+            {
+                merged.put_flat (id, base::flat (ref->second.first, ref->second.second));
+                changed_entries.erase (id);
+            }
+            else
+            {
+                merged.put_flat (id, base::flat ((const char*) value, size));
+            }
+        }
+        
+        // add new entries, in the order they have been saved
+        while (entries.next (&value, &size, &id) == base::flat::T_FLAT)
+        {
+            if (changed_entries.find (id) != changed_entries.end ())
+            {
+                merged.put_flat (id, base::flat ((const char*) value, size));
+            }
+        }
+        
+        file.put_flat (name, merged);
+    }
+    
+    // add sections the pristine map does not have, in the order they have been saved
+    while (sections.next (&value, &size, &id) == base::flat::T_FLAT)
+    {
+        if (merged_sections.insert (id).second)
+        {
+            file.put_flat (id, base::flat ((const char*) value, size));
+        }
+    }
+    
+    while (changed.next (&value, &size, &id) == base::flat::T_FLAT)
+    {
+        if (merged_sections.insert (id).second)
+        {
+            file.put_flat (id, base::flat ((const char*) value, size));
+        }
+    }
+    
+    return delta.success ();
 }
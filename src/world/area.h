@@ -53,7 +53,7 @@ namespace world
         /**
          * Create an empty map.
          */
-        area () : chunk () { }
+        area () : chunk (), PristineChecksum (0) { }
 
         /**
          * Delete the map and everything on it.
@@ -176,6 +176,17 @@ namespace world
          */
         bool save (const std::string & fname, const base::diskio::file_format & format = base::diskio::BY_EXTENSION);
 
+        /**
+         * Save only those parts of the %area state to file that differ
+         * from the map as it was shipped with the game. When loading
+         * the file again, these changes are merged with the pristine
+         * map. If the map has not been loaded from the game's data 
+         * directory, its complete state will be saved instead.
+         * @param fname file name.
+         * @return true on success, false otherwise.
+         */
+        bool save_delta (const std::string & fname);
+
         /**
          * Load %area state from file.
          * @param fname file name.
@@ -213,8 +224,30 @@ namespace world
         std::list <world::zone *> Zones;
 
     private:
+        /**
+         * Remember checksums of the given pristine map state, so that
+         * save_delta can determine which parts of the map changed.
+         * @param file the state of the map as shipped with the game.
+         */
+        void set_pristine (base::flat & file);
+
+        /**
+         * Load the pristine version of this map and merge the
+         * changes from the given saved game record into it.
+         * @param delta changes saved by save_delta.
+         * @param file receives the state of the map.
+         * @return true on success, false otherwise.
+         */
+        bool apply_delta (base::flat & delta, base::flat & file);
+
         /// name of map
         std::string Filename;
+        /// checksum of the pristine map
+        u_int32 PristineChecksum;
+        /// checksums of sections of the pristine map and their entries
+        std::hash_map<std::string, u_int32> Pristine;
+        /// sections of the pristine map whose entries are compared individually
+        std::hash_set<std::string> KeyedSections;
 #endif // SWIG
     };
 }
@@ -25,8 +25,11 @@
  */
 
 #include <fstream>
+#include <unistd.h>
 
 #include <adonthell/base/savegame.h>
+#include <adonthell/base/savegame_writer.h>
+#include <adonthell/gfx/sprite.h>
 #include "area_manager.h"
 
 using world::area_manager;
@@ -42,6 +45,9 @@ world::area* area_manager::ActiveMap = NULL;
 // the map view
 world::mapview area_manager::MapView;
 
+// number of map changes
+u_int32 area_manager::MapChanges = 0;
+
 // the pathfinder
 world::pathfinding_manager area_manager::PathFinder;
 
@@ -53,6 +59,7 @@ void area_manager::cleanup ()
 {
     delete ActiveMap;
     ActiveMap = NULL;
+    MapChanges++;
     PathFinder.clear ();
     MapView.clear ();
     TaintedMaps.clear ();
@@ -69,9 +76,23 @@ bool area_manager::set_active_map (const std::string & name, const bool & auto_s
             // there is a slight risk here that we're still running from
             // the initial save game, which we shouldn't override. The
             // proper thing here might be to do an auto-save here, but for
-            // now we just save the active map to the current slot.
-            std::string savedir = base::savegame::current_path();
-            ActiveMap->save (savedir);
+            // now we just save the active map to the slot we're running
+            // from. The map is captured right away, but written in the
+            // background, after any game that is still being saved.
+            base::savegame_writer *writer = new base::savegame_writer (base::savegame::save_path(), true);
+            writer->begin_capture ();
+            bool result = ActiveMap->save_delta (writer->staging_dir() + "/" + ActiveMap->filename());
+            writer->end_capture ();
+            
+            if (result)
+            {
+                base::savegame::update_in_background (writer);
+            }
+            else
+            {
+                writer->discard ();
+                delete writer;
+            }
         }
         
         // the current map has been modified, so we must make sure
@@ -89,12 +110,78 @@ bool area_manager::set_active_map (const std::string & name, const bool & auto_s
         ActiveMap = new area();
     }
     
+    // objects of the previous map are gone
+    MapChanges++;
+
     // load the map
     ActiveMap->load (name);
 
     return true;
 }
 
+// load graphics of map in advance
+bool area_manager::prefetch (const std::string & name)
+{
+    base::diskio record (base::diskio::BY_EXTENSION);
+    if (!record.get_record (name))
+    {
+        return false;
+    }
+
+    // saved game might only contain changes to pristine map,
+    // which still references most of the models in use
+    std::string pristine = record.get_string ("pristine", true);
+    if (pristine != "")
+    {
+        return prefetch (pristine);
+    }
+
+    std::vector<std::string> models;
+    std::hash_set<std::string> found;
+    base::flat objects = record.get_flat ("objects");
+    u_int32 size;
+    void *value;
+    char *id;
+
+    while (objects.next (&value, &size, &id) == base::flat::T_FLAT)
+    {
+        base::flat entity ((const char*) value, size);
+        std::string model = entity.get_string ("model");
+        if (found.insert (model).second)
+        {
+            models.push_back (model);
+        }
+    }
+
+    prefetch (models);
+    return record.success ();
+}
+
+// load sprites of models in advance
+void area_manager::prefetch (const std::vector<std::string> & models)
+{
+    std::hash_set<std::string> sprites;
+    u_int32 size;
+    void *value;
+    char *id;
+
+    for (std::vector<std::string>::const_iterator i = models.begin (); i != models.end (); i++)
+    {
+        base::diskio model;
+        if (!model.get_record (*i)) continue;
+
+        while (model.next (&value, &size, &id) == base::flat::T_FLAT)
+        {
+            base::flat pm ((const char*) value, size);
+            std::string sprite = pm.get_string ("sprite");
+            if (!sprite.empty () && sprites.insert (sprite).second)
+            {
+                gfx::sprite::prefetch (sprite);
+            }
+        }
+    }
+}
+
 // save to disk
 bool area_manager::save (const std::string & path)
 {
@@ -102,10 +189,10 @@ bool area_manager::save (const std::string & path)
     base::flat record;
     bool result = true;
         
-    // need to copy tainted maps to new save directory?
+    // need to link tainted maps to new save directory?
     if (path != base::savegame::current_path())
     {
-        result &= copy_tainted_maps (base::savegame::current_path(), path);
+        result &= link_tainted_maps (base::savegame::current_path(), path);
     }
     
     // save current map
@@ -114,7 +201,7 @@ bool area_manager::save (const std::string & path)
         LOG(ERROR) << "*** area_manager::save: no active map!";
         return false;
     }
-    result &= ActiveMap->save (path + "/" + ActiveMap->filename());
+    result &= ActiveMap->save_delta (path + "/" + ActiveMap->filename());
     
     // save world data
     file.put_string ("area", ActiveMap->filename());
@@ -162,21 +249,38 @@ bool area_manager::load ()
     return file.success();
 }
 
-// copy tainted maps from previous to new save game folder
-bool area_manager::copy_tainted_maps (const std::string & source, const std::string & target)
+// link tainted maps from previous to new save game folder
+bool area_manager::link_tainted_maps (const std::string & source, const std::string & target)
 {
     std::hash_set<std::string>::const_iterator i;
     char buffer[BUF_SIZE];
+    bool result = true;
     
     for (i = TaintedMaps.begin(); i != TaintedMaps.end(); i++)
     {
         // do not copy current map, it'll be saved anyway
         if (*i == ActiveMap->filename()) continue;
         
+        std::string source_name = source + "/" + *i;
+        std::string target_name = target + "/" + *i;
+        
+#ifndef WIN32
+        // map has not changed since it was saved, so share the file 
+        unlink (target_name.c_str());
+        if (link (source_name.c_str(), target_name.c_str()) == 0) continue;
+#endif
+        // file system does not support hard links, so copy the map 
         int bytes_read = 1;
         
-        ifstream source_file ((source + *i).c_str(), ios::binary);
-        ofstream target_file ((target + *i).c_str(), ios::binary | ios::trunc);
+        ifstream source_file (source_name.c_str(), ios::binary);
+        ofstream target_file (target_name.c_str(), ios::binary | ios::trunc);
+        
+        if (!source_file.is_open() || !target_file.is_open())
+        {
+            LOG(ERROR) << "*** area_manager::link_tainted_maps: cannot copy '" << source_name << "' to '" << target_name << "'";
+            result = false;
+            continue;
+        }
         
         while (bytes_read != 0)
         {
@@ -189,5 +293,5 @@ bool area_manager::copy_tainted_maps (const std::string & source, const std::str
         target_file.close();
     }
     
-    return true;
+    return result;
 }
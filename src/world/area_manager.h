@@ -69,6 +69,25 @@ public:
     {
         return set_active_map (name, true);
     }
+
+    /**
+     * Start loading the graphics of the given map, so that they
+     * are at hand once the map becomes active. Call this when the
+     * player approaches the map. With background loading enabled
+     * in gfx, this returns before the graphics are decoded.
+     *
+     * @param name name of the map to prefetch.
+     * @return true on success, false otherwise.
+     */
+    static bool prefetch (const std::string & name);
+
+#ifndef SWIG
+    /**
+     * Start loading the graphics of the given models.
+     * @param models model files whose sprites to prefetch.
+     */
+    static void prefetch (const std::vector<std::string> & models);
+#endif
     //@}
     
     /**
@@ -112,6 +131,17 @@ public:
     {
         return ActiveMap;
     }
+
+    /**
+     * Get the number of times the objects of the current map have
+     * been replaced, so that anyone referring to them can tell when
+     * those references became invalid.
+     * @return number of map changes.
+     */
+    static u_int32 map_changes ()
+    {
+        return MapChanges;
+    }
     //@}
 
     /**
@@ -150,17 +180,21 @@ protected:
     static pathfinding_manager PathFinder;
     /// the main view on the active map 
     static mapview MapView;
+    /// number of times the map objects have been replaced
+    static u_int32 MapChanges;
     
 private:
     /**
-     * Copy all tainted maps from the source directory to the target
-     * directory, except the currently active map. 
+     * Link all tainted maps from the source directory to the target
+     * directory, except the currently active map. As these maps have
+     * not changed since they were saved, saved games can share them.
+     * Where hard links are not supported, the files are copied instead.
      * 
      * @param source the source directory.
      * @param target the target directory.
      * @return true on success, false otherwise.
      */
-    static bool copy_tainted_maps (const std::string & source, const std::string & target);
+    static bool link_tainted_maps (const std::string & source, const std::string & target);
         
     /// forbid instantiation
     area_manager() {};
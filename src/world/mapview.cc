@@ -29,6 +29,8 @@
 
 #include <limits.h>
 
+#include <adonthell/base/base.h>
+#include <adonthell/base/profiler.h>
 #include <adonthell/gfx/screen.h>
 #include <adonthell/python/pool.h>
 #include "mapview.h"
@@ -53,6 +55,12 @@ mapview::mapview () : CurZ(0), Speed(0)
     RenderZone = NULL;
     Schedule = NULL;
     Args = NULL;
+    LastMap = NULL;
+    InFrame = false;
+
+    Ox = Oy = 0;
+    Sx = Sy = LastSx = LastSy = 0;
+    FrameX = FrameY = 0;
 }
 
 // ctor
@@ -67,6 +75,12 @@ mapview::mapview (const u_int32 & length, const u_int32 & height, const renderer
     RenderZone = NULL;
     Schedule = NULL;
     Args = NULL;
+    LastMap = NULL;
+    InFrame = false;
+
+    Ox = Oy = 0;
+    Sx = Sy = LastSx = LastSy = 0;
+    FrameX = FrameY = 0;
 }
 
 // dtor
@@ -85,6 +99,10 @@ void mapview::clear ()
     RenderZone = NULL;
     Schedule = NULL;
     Args = NULL;    
+
+    Visible.clear ();
+    InView.clear ();
+    InFrame = false;
 }
 
 // set script called to position view on map
@@ -167,25 +185,55 @@ void mapview::center_on (const s_int32 & x, const s_int32 & y)
     }
 }
 
-// render map
-void mapview::draw (const s_int16 & x, const s_int16 & y, const gfx::drawing_area * da_opt, gfx::surface * target) const
+// collect objects for the coming frame
+void mapview::begin_frame () const
 {
-    area *map = world::area_manager::get_map();
-    
-    // is there something to draw at all?
-    if (!map || !map->length() || !map->height()) return;
-    
-    // this is the area we need to draw
-    gfx::drawing_area da (x + Ox, y + Oy, length() - Ox, height() - Oy);
-    if (da_opt)
+    collect_objects ();
+    track_damage ();
+    InFrame = true;
+}
+
+// search map again when drawing
+void mapview::end_frame () const
+{
+    InFrame = false;
+}
+
+// view position in between updates
+void mapview::interpolate_view (const float & alpha) const
+{
+    FrameX = Sx;
+    FrameY = Sy;
+
+    // do not scroll across the map when the view jumps
+    if (alpha >= 1.0f || std::abs (Sx - LastSx) > (s_int32) length() || std::abs (Sy - LastSy) > (s_int32) height())
     {
-        da.assign_drawing_area (da_opt);
-        da = da.setup_rects ();
+        return;
     }
- 
+
+    // round like moving objects, so that followed characters stay in place
+    FrameX += static_cast<s_int32>(round (LastSx + (Sx - LastSx) * alpha) - Sx);
+    FrameY += static_cast<s_int32>(round (LastSy + (Sy - LastSy) * alpha) - Sy);
+}
+
+// find objects in view
+void mapview::collect_objects () const
+{
+    PROFILE_ZONE ("mapview::collect_objects");
+
+    InView.clear ();
+    Visible.clear ();
+
+    // the view moves in between updates, like the objects on the map
+    const float alpha = base::Scheduler.alpha ();
+    interpolate_view (alpha);
+
+    area *map = world::area_manager::get_map();
+    if (!map || !map->length() || !map->height()) return;
+
     // get objects we need to draw
     std::list<world::chunk_info*> objectlist;
-    map->objects_in_view (Sx, Sx + length(), Sy, Sy + height(), objectlist);
+    map->objects_in_view (FrameX, FrameX + length(), FrameY, FrameY + height(), objectlist);
     
     // are there any zones limiting what we have to render?
     std::vector<world::zone*> zones;
@@ -253,8 +301,147 @@ void mapview::draw (const s_int16 & x, const s_int16 & y, const gfx::drawing_are
         }
     }
     
+    // remember what is on screen
+    for (std::list<world::chunk_info*>::const_iterator i = objectlist.begin(); i != objectlist.end(); i++)
+    {
+        gfx::drawing_area area = area_in_view (*i, alpha);
+        Visible[(*i)->get_entity()] = area;
+        InView.push_back (std::make_pair (*i, area));
+    }
+}
+
+// render map
+void mapview::draw (const s_int16 & x, const s_int16 & y, const gfx::drawing_area * da_opt, gfx::surface * target) const
+{
+    PROFILE_ZONE ("mapview::draw");
+
+    area *map = world::area_manager::get_map();
+    
+    // is there something to draw at all?
+    if (!map || !map->length() || !map->height())
+    {
+        Visible.clear ();
+        InView.clear ();
+        return;
+    }
+    
+    // this is the area we need to draw
+    gfx::drawing_area da (x + Ox, y + Oy, length() - Ox, height() - Oy);
+    if (da_opt)
+    {
+        da.assign_drawing_area (da_opt);
+        da = da.setup_rects ();
+    }
+ 
+    // within a frame, the map is only searched once
+    if (!InFrame) collect_objects ();
+
+    // only pass on objects that overlap the area to draw
+    std::list<world::chunk_info*> objectlist;
+    for (std::vector<std::pair<world::chunk_info*, gfx::drawing_area> >::const_iterator i = InView.begin(); i != InView.end(); i++)
+    {
+        const gfx::drawing_area & area = i->second;
+        if (x + area.x() >= da.x() + da.length() || x + area.x() + area.length() <= da.x() ||
+            y + area.y() >= da.y() + da.height() || y + area.y() + area.height() <= da.y())
+        {
+            continue;
+        }
+
+        objectlist.push_back (i->first);
+    }
+
     // draw everything on screen
-    Renderer->render (da.x() - Sx, da.y() - Sy, objectlist, da, target);
+    Renderer->render (x + Ox - FrameX, y + Oy - FrameY, objectlist, da, target);
+    drawn_at (x, y, target);
+}
+
+// area of an object in the view
+gfx::drawing_area mapview::area_in_view (const chunk_info *object, const float & alpha) const
+{
+    // moving objects are drawn in between updates, so they
+    // may change position on screen with every frame
+    vector3<s_int32> offset;
+    const placeable *obj = object->get_object();
+    if (obj->type() == CHARACTER)
+    {
+        offset = ((const moving *) obj)->interpolation_offset (alpha);
+    }
+
+    // on screen, the object extends from its top to its bottom face,
+    // and its shadow may fall down to the ground below
+    s_int32 top = object->Min.y() - object->Max.z() + offset.y() - offset.z();
+    s_int32 bottom = object->Max.y() - std::min (object->Min.z(), 0) + offset.y();
+
+    return gfx::drawing_area (Ox + object->Min.x() + offset.x() - FrameX, Oy + top - FrameY,
+        object->Max.x() - object->Min.x(), bottom - top);
+}
+
+// find parts of the view that changed
+void mapview::track_damage () const
+{
+    if (!gfx::screen::damage_tracking()) return;
+
+    area *map = world::area_manager::get_map();
+    const gfx::drawing_area & view = drawn_area ();
+
+    // nothing on screen yet
+    if (!map || !view.length() || !view.height())
+    {
+        OnScreen.clear ();
+        return;
+    }
+
+    // scrolling changes the whole view
+    bool scrolled = map != LastMap || FrameX != LastView[0] || FrameY != LastView[1] || Ox != LastView[2] || Oy != LastView[3];
+    if (scrolled)
+    {
+        invalidate ();
+
+        LastMap = map;
+        LastView[0] = FrameX;
+        LastView[1] = FrameY;
+        LastView[2] = Ox;
+        LastView[3] = Oy;
+    }
+
+    // objects of this frame have already been found
+    std::map<const world::entity*, gfx::drawing_area> visible;
+    for (std::vector<std::pair<world::chunk_info*, gfx::drawing_area> >::const_iterator i = InView.begin(); i != InView.end(); i++)
+    {
+        gfx::drawing_area area = i->second;
+        area.move (view.x() + area.x(), view.y() + area.y());
+
+        visible[i->first->get_entity()] = area;
+        if (scrolled) continue;
+
+        // report objects that moved or appeared
+        std::map<const world::entity*, gfx::drawing_area>::iterator prev = OnScreen.find (i->first->get_entity());
+        if (prev == OnScreen.end())
+        {
+            gfx::screen::invalidate (area);
+        }
+        else
+        {
+            if (prev->second.x() != area.x() || prev->second.y() != area.y() ||
+                prev->second.length() != area.length() || prev->second.height() != area.height())
+            {
+                gfx::screen::invalidate (prev->second);
+                gfx::screen::invalidate (area);
+            }
+            OnScreen.erase (prev);
+        }
+    }
+
+    // report objects that disappeared
+    if (!scrolled)
+    {
+        for (std::map<const world::entity*, gfx::drawing_area>::const_iterator i = OnScreen.begin(); i != OnScreen.end(); i++)
+        {
+            gfx::screen::invalidate (i->second);
+        }
+    }
+
+    OnScreen.swap (visible);
 }
 
 // update render limit
@@ -321,8 +508,8 @@ bool mapview::get_state (base::flat & file)
     // get coordinates
     Ox = record.get_uint16("vox"); 
     Oy = record.get_uint16("voy");
-    Sx = record.get_uint16("vsx"); 
-    Sy = record.get_uint16("vsy"); 
+    Sx = LastSx = record.get_uint16("vsx"); 
+    Sy = LastSy = record.get_uint16("vsy"); 
 
     // get position related variables
     Pos.set_str (record.get_string ("pos"));
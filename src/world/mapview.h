@@ -32,6 +32,8 @@
 
 #include <cmath>
 #include <cstdlib>
+#include <map>
+#include <vector>
 
 #include <adonthell/python/method.h>
 #include "renderer.h"
@@ -39,6 +41,8 @@
 
 namespace world
 {
+    class area;
+
     /**
      * Displays a part of a map on screen. Which part of a map
      * is displayed is determined by a python script that is
@@ -98,22 +102,27 @@ namespace world
         /**
          * Update the position of the mapview. Call this every game
          * cycle to make sure the position of the mapview is up to
-         * date.
+         * date. Frames rendered in between updates show the view
+         * in between its previous and new position.
          */
         bool update ()
         {
+            LastSx = Sx;
+            LastSy = Sy;
+
             if (CurZ != Pos.z())
             {
                 if (std::abs (Pos.z() - CurZ) < std::abs (Speed)) CurZ = Pos.z();
                 else CurZ += Speed;
             }
             
+            bool result = true;
             if (Schedule)
             {
-                return Schedule->execute (Args);
+                result = Schedule->execute (Args);
             }
             
-            return true;
+            return result;
         }
         
         /**
@@ -139,8 +148,8 @@ namespace world
         {
             Pos.set (x, y, z);
             CurZ = z;
-            Sx = x;
-            Sy = y - z;
+            Sx = LastSx = x;
+            Sy = LastSy = y - z;
             Ox = 0;
             Oy = 0;
         }
@@ -265,6 +274,35 @@ namespace world
          * @param limit objects above this plane will not be rendered.
          */
         void limit_z (const s_int32 & limit);
+
+        /**
+         * Collect the objects in view for the coming frame. Until
+         * end_frame is called, drawing the view, even in several
+         * parts, reuses them instead of searching the map again.
+         * Also updates the areas returned by visible_area and reports
+         * the parts of the view that changed since the previous frame
+         * to the %screen, if it tracks damage.
+         */
+        void begin_frame () const;
+
+        /**
+         * Stop reusing the objects collected by begin_frame.
+         */
+        void end_frame () const;
+
+        /**
+         * Get the area covered by the given object during the last
+         * time the view was drawn. Coordinates are relative to the
+         * position the view was drawn at. This allows to place
+         * elements on top of objects without searching the map.
+         * @param object an object on the map.
+         * @return area covered by the object, or NULL if it was not visible.
+         */
+        const gfx::drawing_area *visible_area (const world::entity *object) const
+        {
+            std::map<const world::entity*, gfx::drawing_area>::const_iterator i = Visible.find (object);
+            return i == Visible.end() ? NULL : &(i->second);
+        }
         //@}
         
         /**
@@ -294,6 +332,33 @@ namespace world
 #endif
         
     private:
+        /**
+         * Report the parts of the view that changed since the
+         * previous frame to the %screen, if it tracks damage.
+         * Uses the objects found by collect_objects.
+         */
+        void track_damage () const;
+
+        /**
+         * Get the area an object covers in the view.
+         * @param object the object on the map.
+         * @param alpha progress towards the next game cycle.
+         * @return area relative to the origin of the view.
+         */
+        gfx::drawing_area area_in_view (const chunk_info *object, const float & alpha) const;
+
+        /**
+         * Find the objects to draw and the area they cover.
+         */
+        void collect_objects () const;
+
+        /**
+         * Set the start of the view for the current frame, in between
+         * its position at the previous and the latest update.
+         * @param alpha progress towards the next game cycle.
+         */
+        void interpolate_view (const float & alpha) const;
+
         /**
          * @name Positioning script 
          */
@@ -328,6 +393,15 @@ namespace world
         
         /// zone limiting rendering to a certain height.
         zone *RenderZone;
+
+        /// area covered by each object during the last rendering.
+        mutable std::map<const world::entity*, gfx::drawing_area> Visible;
+
+        /// objects to draw, in the order found on the map.
+        mutable std::vector<std::pair<world::chunk_info*, gfx::drawing_area> > InView;
+
+        /// whether objects were collected for the current frame.
+        mutable bool InFrame;
         //@}
         
         /**
@@ -342,6 +416,26 @@ namespace world
         s_int32 Sx;
         /// position from where to start rendering map (y axis).
         s_int32 Sy;
+        /// Sx before the latest update.
+        s_int32 LastSx;
+        /// Sy before the latest update.
+        s_int32 LastSy;
+        /// position from where the map is rendered in the current frame (x axis).
+        mutable s_int32 FrameX;
+        /// position from where the map is rendered in the current frame (y axis).
+        mutable s_int32 FrameY;
+        //@}
+        
+        /**
+         * @name Damage tracking
+         */
+        //@{
+        /// the map shown during the previous frame
+        mutable const area *LastMap;
+        /// FrameX, FrameY, Ox and Oy during the previous frame
+        mutable s_int32 LastView[4];
+        /// area covered by each object during the previous frame
+        mutable std::map<const world::entity*, gfx::drawing_area> OnScreen;
         //@}
     };
 }
@@ -66,7 +66,7 @@ struct z_order : public std::binary_function<const chunk_info *, const chunk_inf
 
 // ctor
 moving::moving (world::area & mymap, const std::string & hash)
-    : placeable (mymap, hash), coordinates (), Position(), Velocity()
+    : placeable (mymap, hash), coordinates (), Position(), LastPosition(), Velocity()
 {
     GroundPos = -10000;
     MyShadow = NULL;
@@ -111,6 +111,10 @@ void moving::set_position (const s_int32 & x, const s_int32 & y)
     // precise location
     Position.set_x (x);
     Position.set_y (y);
+
+    // don't glide to the new location
+    LastPosition.set_x (x);
+    LastPosition.set_y (y);
 }
 
 // set z position
@@ -118,6 +122,7 @@ void moving::set_altitude (const s_int32 & z)
 {
     coordinates::set_z (z);
     Position.set_z (z);
+    LastPosition.set_z (z);
     GroundPos = z;
 }
 
@@ -401,6 +406,9 @@ bool moving::update ()
 {
     // this is a dummy, as we don't know the real entity
     named_entity e (this, "", false);
+
+    // remember where we came from for rendering in between updates
+    LastPosition = Position;
     
 #if DEBUG_COLLISION
     // clear image
@@ -430,6 +438,19 @@ bool moving::update ()
     return true; 
 }
 
+// where to draw in between updates
+vector3<s_int32> moving::interpolation_offset (const float & alpha) const
+{
+    if (alpha >= 1.0f) return vector3<s_int32> ();
+
+    // positions are drawn in whole pixels
+    const vector3<float> pos = LastPosition + (Position - LastPosition) * alpha;
+    return vector3<s_int32> (
+        static_cast<s_int32>(round (pos.x()) - round (Position.x())),
+        static_cast<s_int32>(round (pos.y()) - round (Position.y())),
+        static_cast<s_int32>(round (pos.z()) - round (Position.z())));
+}
+
 // debugging
 void moving::debug_collision (const u_int16 & x, const u_int16 & y) const
 {
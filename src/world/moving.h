@@ -141,6 +141,15 @@ namespace world
          */
         virtual bool update (); 
 
+        /**
+         * Get the distance from the current position of this object
+         * to where it should be drawn in between two updates.
+         * @param alpha progress towards the next update, as given by
+         *      base::frame_scheduler::alpha().
+         * @return offset to add to the current position when rendering.
+         */
+        vector3<s_int32> interpolation_offset (const float & alpha) const;
+
         /**
          * When compiled with -DDEBUG_COLLISION, calling this method
          * before blitting a frame to the screen will create an overlay with
@@ -194,6 +203,8 @@ namespace world
         
         /// precise position of object
         vector3<float> Position;
+        /// precise position of object before the last update
+        vector3<float> LastPosition;
         /// velocites along the 3 axis in world space.
         vector3<float> Velocity;
         /// shadow cast by this object
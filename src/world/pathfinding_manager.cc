@@ -25,6 +25,8 @@
  */
 
 #include <adonthell/base/diskio.h>
+#include <adonthell/base/profiler.h>
+#include <adonthell/python/python.h>
 #include "pathfinding_manager.h"
 #include "area_manager.h"
 #include "character.h"
@@ -278,6 +280,8 @@ const world::pathfinding_task* pathfinding_manager::get_task(const s_int16 & id)
 
 void pathfinding_manager::update()
 {
+    PROFILE_ZONE ("pathfinding_manager::update");
+
     for (s_int16 id = 0; id <= m_taskHighest; id++)
     {
         if (m_locked[id] == true)
@@ -286,8 +290,12 @@ void pathfinding_manager::update()
             {
                 case PHASE_PATHFINDING:
                 {
-                    // calculate the path
-                    bool pathFound = m_task[id]->m_pathfinding.find_path(m_task[id]->chr, m_task[id]->target, m_task[id]->target2, &m_task[id]->path);
+                    // calculate the path, letting scripts run meanwhile
+                    bool pathFound;
+                    {
+                        python::gil_release nogil;
+                        pathFound = m_task[id]->m_pathfinding.find_path(m_task[id]->chr, m_task[id]->target, m_task[id]->target2, &m_task[id]->path);
+                    }
                     if (pathFound)
                     {
                         // used to check if we're stuck
@@ -32,6 +32,7 @@
 #include "placeable_shape.h"
 #include "area.h"
 #include <adonthell/base/logging.h>
+#include <adonthell/python/python.h>
 
 using world::placeable;
 
@@ -67,6 +68,8 @@ placeable::placeable(world::area & mymap, const std::string & hash)
 // dtor
 placeable::~placeable()
 {
+    python::forget_instance (this);
+
     for (std::vector<world::placeable_model*>::iterator i = Model.begin(); i != Model.end(); i++)
     {
         delete *i;
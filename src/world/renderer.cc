@@ -27,9 +27,11 @@
  * 
  */
 
-#include <adonthell/base/timer.h>
+#include <adonthell/base/base.h>
+#include <adonthell/base/profiler.h>
 #include <adonthell/gfx/screen.h>
 #include "renderer.h"
+#include "moving.h"
 
 namespace world
 {
@@ -64,16 +66,26 @@ void renderer_base::draw (const s_int16 & x, const s_int16 & y, const render_inf
 // default rendering
 void default_renderer::render (const s_int16 & x, const s_int16 & y, const std::list <world::chunk_info*> & objectlist, const gfx::drawing_area & da, gfx::surface * target) const
 {
+    PROFILE_ZONE ("renderer::render");
+
     std::list <render_info> render_queue;
+    const float alpha = base::Scheduler.alpha ();
 
     // populate render queue
     for (std::list<world::chunk_info*>::const_iterator i = objectlist.begin(); i != objectlist.end(); i++)
     {
         const placeable *object = (*i)->get_object();
+        vector3<s_int32> pos = (*i)->center_min();
+
+        // draw moving objects in between their last two positions
+        if (object->type() == CHARACTER)
+        {
+            pos = pos + ((const moving *) object)->interpolation_offset (alpha);
+        }
         
         for (placeable::iterator obj = object->begin(); obj != object->end(); obj++)
         {
-            render_queue.push_back (render_info ((*obj)->current_shape(), (*obj)->get_sprite(), (*i)->center_min(), (*i)->get_shadow(*obj)));
+            render_queue.push_back (render_info ((*obj)->current_shape(), (*obj)->get_sprite(), pos, (*i)->get_shadow(*obj)));
         }
     }
     
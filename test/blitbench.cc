@@ -0,0 +1,82 @@
+/**
+ * Measures how long it takes to draw many small images onto an
+ * offscreen surface, the way mapview and the gui compose their
+ * output before it goes to the screen.
+ *
+ * Usage: blitbench [-b backend] [blits] [image size]
+ */
+
+#include <cstdio>
+#include <cstdlib>
+#include <unistd.h>
+#include <sys/time.h>
+
+#include <adonthell/base/base.h>
+#include <adonthell/gfx/gfx.h>
+#include <adonthell/gfx/screen.h>
+#include <adonthell/main/adonthell.h>
+
+// time in microseconds
+static double now ()
+{
+    struct timeval tv;
+    gettimeofday (&tv, NULL);
+    return tv.tv_sec * 1000000.0 + tv.tv_usec;
+}
+
+class blit_bench : public adonthell::app
+{
+public:
+    int main ()
+    {
+        // arguments following the engine's own options
+        int blits = Argc > optind ? atoi (Argv[optind]) : 100000;
+        int size = Argc > optind + 1 ? atoi (Argv[optind + 1]) : 16;
+        if (blits < 1) blits = 1;
+        if (size < 1) size = 1;
+
+        // Initialize the gfx system
+        init_modules (GFX);
+        gfx::screen::set_video_mode (640, 480);
+
+        // offscreen surface to compose the images on
+        gfx::surface *target = gfx::create_surface ();
+        target->set_alpha (255, true);
+        target->resize (gfx::screen::length (), gfx::screen::height ());
+        target->fillrect (0, 0, target->length (), target->height (), target->map_color (0, 0, 0, 255));
+
+        // small images with and without alpha channel
+        gfx::surface *images[2];
+        for (int i = 0; i < 2; i++)
+        {
+            images[i] = gfx::create_surface ();
+            images[i]->set_alpha (255, i == 1);
+            images[i]->resize (size, size);
+            images[i]->fillrect (0, 0, size, size, images[i]->map_color (0xff, 0x88 * i, 0x00, 0x88));
+        }
+
+        for (int i = 0; i < 2; i++)
+        {
+            double start = now ();
+            for (int j = 0; j < blits; j++)
+            {
+                images[i]->draw ((j * 7) % (target->length () - size), (j * 13) % (target->height () - size), NULL, target);
+            }
+
+            // include the cost of bringing the result on screen
+            target->draw (0, 0);
+            gfx::screen::update ();
+
+            double elapsed = now () - start;
+            printf ("%d blits of %dx%d %s image: %.1f ms, %.3f us per blit\n", blits, size, size,
+                i == 1 ? "alpha" : "opaque", elapsed / 1000.0, elapsed / blits);
+        }
+
+        delete images[0];
+        delete images[1];
+        delete target;
+        return 0;
+    }
+};
+
+blit_bench myApp;
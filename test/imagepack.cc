@@ -0,0 +1,92 @@
+/**
+ * Builds an image pack from all PNG files found below the given
+ * game data directory. Put the resulting pack into the game data
+ * directory to have images loaded from it instead of decoding the
+ * PNG files at runtime. The pack needs to be rebuilt whenever any
+ * of the images change.
+ *
+ * Usage: imagepack [-z] <data directory> [pack file]
+ *
+ *   -z  compress images with LZ4, if support for it has been compiled in
+ */
+
+#include <adonthell/gfx/image_pack.h>
+#include <iostream>
+#include <vector>
+#include <cstring>
+#include <dirent.h>
+#include <sys/stat.h>
+
+using std::cout;
+using std::endl;
+
+// collect all png files below the given directory, relative to root
+static void find_png_files (const std::string & root, const std::string & dirname, std::vector<std::string> & files)
+{
+    struct dirent *dirent;
+    struct stat statbuf;
+    DIR *dir;
+
+    if ((dir = opendir ((root + "/" + dirname).c_str ())) == NULL)
+    {
+        return;
+    }
+
+    while ((dirent = readdir (dir)) != NULL)
+    {
+        std::string name = dirent->d_name;
+        if (name[0] == '.') continue;
+
+        std::string path = dirname.empty () ? name : dirname + "/" + name;
+        if (stat ((root + "/" + path).c_str (), &statbuf) == -1) continue;
+
+        if (S_ISDIR (statbuf.st_mode))
+        {
+            find_png_files (root, path, files);
+        }
+        else if (name.length () > 4 && name.compare (name.length () - 4, 4, ".png") == 0)
+        {
+            files.push_back (path);
+        }
+    }
+
+    closedir (dir);
+}
+
+int main (int argc, char* argv[])
+{
+    bool compress = false;
+    int arg = 1;
+
+    if (argc > arg && strcmp (argv[arg], "-z") == 0)
+    {
+        compress = true;
+        arg++;
+    }
+
+    if (argc <= arg)
+    {
+        cout << "Usage: " << argv[0] << " [-z] <data directory> [pack file]" << endl;
+        return 1;
+    }
+
+    std::string root = argv[arg];
+    std::string pack = argc > arg + 1 ? argv[arg + 1] : root + "/" + IMAGE_PACK_FILE;
+
+    std::vector<std::string> files;
+    find_png_files (root, "", files);
+    if (files.empty ())
+    {
+        cout << "No png files found in '" << root << "'" << endl;
+        return 1;
+    }
+
+    if (!gfx::image_pack::create (pack, root, files, compress))
+    {
+        cout << "Failed creating '" << pack << "'" << endl;
+        return 1;
+    }
+
+    cout << "Packed " << files.size () << " images into '" << pack << "'" << endl;
+    return 0;
+}
@@ -25,6 +25,7 @@
 #include <adonthell/audio/audio.h>
 #include <adonthell/base/base.h>
 #include <adonthell/base/savegame.h>
+#include <adonthell/base/profiler.h>
 #include <adonthell/event/date.h>
 #include <adonthell/gfx/sprite.h>
 #include <adonthell/gfx/screen.h>
@@ -33,6 +34,7 @@
 #include <adonthell/world/area_manager.h>
 #include <adonthell/gui/ui_event.h>
 #include <adonthell/gui/window_manager.h>
+#include <adonthell/gui/stats_overlay.h>
 #include <adonthell/base/logging.h>
 
 static world::debug_renderer DEBUG_RENDERER;
@@ -173,14 +175,23 @@ public:
         // add mapview to window stack
         gui::window_manager::add(0, 0, *world::area_manager::get_mapview(), gui::fade_type::NONE, gui::window_type::WORLD_VIEW);
 
-        base::Timer.synch();
+        // show where time is spent
+        gui::stats_overlay stats (gfx::screen::length() / 2, gfx::screen::height() / 2);
+        if (base::profiler::enabled())
+        {
+            gui::window_manager::add(0, 0, stats, gui::fade_type::NONE, gui::window_type::INTERFACE);
+        }
+
+        base::Scheduler.set_max_steps (MAX_FRAMES_TO_SKIP);
+        base::Scheduler.synch();
 	    while (IsRunning)
     	{
             u_int16 i;
+            base::Scheduler.begin_frame ();
 	        currentTime = base::Timer.current_time();
 
-        	// catch up with frames missed last time round
-        	for (u_int32 j = 0; j <= base::Timer.frames_missed () && j < MAX_FRAMES_TO_SKIP; j++)
+        	// catch up with the time passed since last frame
+        	while (base::Scheduler.step ())
 	        {
         	    audio::update();
         	    input::manager::update();
@@ -233,7 +244,7 @@ public:
             totalTime += base::Timer.current_time() - currentTime;
             totalFrames++;
 
-	        base::Timer.update ();
+	        base::Scheduler.end_frame ();
 	    } // while (main loop)
 
         LOG(INFO) << "Cleaning up faction... ";
@@ -242,6 +253,8 @@ public:
         
         LOG(ERROR) << "Rendered " << totalFrames << " frames in " << totalTime << " ms.";
         LOG(ERROR) << "Average time required per frame is " << std::setprecision(4) << (double) totalTime / totalFrames  << " ms.";
+        LOG(ERROR) << "Frame time median is " << base::Scheduler.percentile (0.5f) << " ms, 99th percentile is "
+                   << base::Scheduler.percentile (0.99f) << " ms, " << base::Scheduler.steps_dropped () << " updates dropped.";
 
 	    return 0;
 	}
@@ -0,0 +1,106 @@
+/**
+ * Measures how long it takes to load the XML data files found in
+ * the given directory (test/data by default), to keep an eye on
+ * the performance of base::disk_writer_xml.
+ *
+ * Usage: xmlbench [directory] [iterations]
+ */
+
+#include <adonthell/base/diskwriter_xml.h>
+#include <iostream>
+#include <vector>
+#include <cstdlib>
+#include <dirent.h>
+#include <sys/stat.h>
+#include <sys/time.h>
+
+using std::cout;
+using std::endl;
+
+// collect all xml files below the given directory
+static void find_xml_files (const std::string & dirname, std::vector<std::string> & files)
+{
+    struct dirent *dirent;
+    struct stat statbuf;
+    DIR *dir;
+
+    if ((dir = opendir (dirname.c_str ())) == NULL)
+    {
+        return;
+    }
+
+    while ((dirent = readdir (dir)) != NULL)
+    {
+        std::string name = dirent->d_name;
+        if (name[0] == '.') continue;
+
+        std::string path = dirname + "/" + name;
+        if (stat (path.c_str (), &statbuf) == -1) continue;
+
+        if (S_ISDIR (statbuf.st_mode))
+        {
+            find_xml_files (path, files);
+        }
+        else if (name.length () > 4 && name.compare (name.length () - 4, 4, ".xml") == 0)
+        {
+            files.push_back (path);
+        }
+    }
+
+    closedir (dir);
+}
+
+// time in microseconds
+static double now ()
+{
+    struct timeval tv;
+    gettimeofday (&tv, NULL);
+    return tv.tv_sec * 1000000.0 + tv.tv_usec;
+}
+
+int main (int argc, char* argv[])
+{
+    std::string dirname = argc > 1 ? argv[1] : "data";
+    int iterations = argc > 2 ? atoi (argv[2]) : 10;
+    if (iterations < 1) iterations = 1;
+
+    std::vector<std::string> files;
+    find_xml_files (dirname, files);
+    if (files.empty ())
+    {
+        cout << "No xml files found in '" << dirname << "'" << endl;
+        return 1;
+    }
+
+    base::disk_writer_xml reader;
+    double total = 0.0;
+    u_int32 bytes = 0;
+
+    for (std::vector<std::string>::const_iterator i = files.begin (); i != files.end (); i++)
+    {
+        base::flat record;
+        double start = now ();
+
+        for (int j = 0; j < iterations; j++)
+        {
+            if (!reader.get_state (*i, record))
+            {
+                cout << "Failed loading '" << *i << "'" << endl;
+                break;
+            }
+        }
+
+        double elapsed = (now () - start) / iterations;
+        total += elapsed;
+        bytes += record.size ();
+
+        cout << *i << ": " << elapsed / 1000.0 << " ms, " << record.size () << " bytes, checksum "
+             << (std::hex) << record.checksum () << (std::dec) << endl;
+    }
+
+    cout << files.size () << " files, " << bytes << " bytes loaded in " << total / 1000.0 << " ms";
+    if (total > 0.0) cout << " (" << bytes / total << " MB/s)";
+    cout << endl;
+
+    return 0;
+}